@@ -1,7 +1,8 @@
 /// \file ijkIO.txx
 /// IO templates for reading/writing meshes.
 /// - Input formats: Geomview .off.
-/// - Output formats: Geomview .off, OpenInventor .iv (3D), Fig .fig (2D).
+/// - Output formats: Geomview .off, OpenInventor .iv (3D), Fig .fig (2D),
+///     binary little endian .ply (3D), raw binary mesh.
 /// - Version 0.1.1
 
 /*
@@ -26,7 +27,15 @@
 #ifndef _IJKIO_
 #define _IJKIO_
 
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <locale>
+#include <type_traits>
 #include <vector>
 #include <string>
 
@@ -739,6 +748,715 @@ namespace IJK {
     ijkoutQuadOFF(std::cout, dim, coord, quad_vert, flag_reorder_vertices);
   }
 
+  // ******************************************
+  // Text input and output buffers
+  // ******************************************
+
+  namespace {
+
+    /// Buffer for fast text output.
+    /// Numbers are formatted into the buffer without going through
+    ///   std::ostream formatting.  The buffer is written to the output 
+    ///   stream in large blocks.
+    /// Floating point numbers are formatted exactly as std::ostream 
+    ///   formats them with the stream's precision and default flags.
+    ///   If the stream has other flags or a non-classic locale,
+    ///   floating point numbers are formatted by the stream.
+    class TEXT_OUT_BUFFER {
+
+    protected:
+      std::ostream * out;
+      std::vector<char> buffer;
+      std::size_t num_bytes;      ///< Number of bytes stored in buffer.
+      int precision;              ///< Floating point precision.
+      bool flag_format_float;     ///< If true, format floats in buffer.
+
+      /// Ensure room for n more characters.
+      void Reserve(const std::size_t n)
+      { if (num_bytes + n > buffer.size()) { Flush(); } }
+
+      template <typename T>
+      void WriteInteger(const T x)
+      {
+        // Enough characters for any 64-bit integer.
+        const int MAX_DIGITS = 24;
+        char digits[MAX_DIGITS];
+        int k = MAX_DIGITS;
+
+        Reserve(MAX_DIGITS);
+
+        bool is_negative = (x < 0);
+        unsigned long long y = 
+          (is_negative) ? (0ULL - (unsigned long long)(x)) : 
+          (unsigned long long)(x);
+        do {
+          k--;
+          digits[k] = char('0' + (y%10));
+          y = y/10;
+        } while (y != 0);
+        if (is_negative) { buffer[num_bytes++] = '-'; }
+        std::memcpy(&(buffer[num_bytes]), digits+k, MAX_DIGITS-k);
+        num_bytes += MAX_DIGITS-k;
+      }
+
+      /// Format float x as "%.*g" in fixed point notation.
+      /// Return false if x requires scientific notation or if
+      ///   x*10^k cannot be computed exactly in double precision.
+      /// Float x has a 24 bit mantissa and 10^k has at most 29 bits 
+      ///   for k <= 12, so x*10^k is exact in double precision and
+      ///   rounds to the same digits as snprintf.
+      bool WriteFloatFixed(const float x)
+      {
+        const int MAX_PRECISION = 8;
+        const int MAX_POW10 = 12;
+        const double pow10[MAX_POW10+1] = 
+          { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+            1e10, 1e11, 1e12 };
+        char digits[MAX_PRECISION];
+
+        if (precision > MAX_PRECISION || !std::isfinite(x)) 
+          { return(false); }
+
+        const double a = std::fabs(double(x));
+        if (a == 0) {
+          if (std::signbit(x)) { Put('-'); }
+          Put('0');
+          return(true);
+        }
+
+        // Find e such that 10^(precision-1) <= a*10^(precision-1-e) 
+        //   < 10^precision.
+        int e = int(std::floor(std::log10(a)));
+        double y;
+        for (int k = 0; k < 3; k++) {
+          const int ipow = precision-1-e;
+          if (ipow < 0 || ipow > MAX_POW10) { return(false); }
+          y = a*pow10[ipow];
+          if (y < pow10[precision-1]) { e--; }
+          else if (y >= pow10[precision]) { e++; }
+          else { break; }
+        }
+        if (y < pow10[precision-1] || y >= pow10[precision]) 
+          { return(false); }
+
+        // Round half to even, as snprintf.
+        double r = std::nearbyint(y);
+        if (r >= pow10[precision]) {
+          r = pow10[precision-1];
+          e++;
+        }
+
+        // "%g" uses scientific notation if e < -4 or e >= precision.
+        if (e < -4 || e >= precision) { return(false); }
+
+        long long ir = (long long)(r);
+        for (int i = precision-1; i >= 0; i--) {
+          digits[i] = char('0' + (ir%10));
+          ir = ir/10;
+        }
+
+        // Remove trailing zeros after the decimal point.
+        int num_digits = precision;
+        while (num_digits > e+1 && num_digits > 1 &&
+               digits[num_digits-1] == '0') 
+          { num_digits--; }
+
+        Reserve(precision+8);
+        if (x < 0) { buffer[num_bytes++] = '-'; }
+        if (e < 0) {
+          buffer[num_bytes++] = '0';
+          buffer[num_bytes++] = '.';
+          for (int i = 0; i < -e-1; i++) { buffer[num_bytes++] = '0'; }
+          for (int i = 0; i < num_digits; i++) 
+            { buffer[num_bytes++] = digits[i]; }
+        }
+        else {
+          for (int i = 0; i <= e; i++) { buffer[num_bytes++] = digits[i]; }
+          if (num_digits > e+1) {
+            buffer[num_bytes++] = '.';
+            for (int i = e+1; i < num_digits; i++) 
+              { buffer[num_bytes++] = digits[i]; }
+          }
+        }
+
+        return(true);
+      }
+
+      template <typename T>
+      bool WriteFloatFixed(const T x)
+      { return(false); }
+
+      template <typename T>
+      void WriteFloat(const T x)
+      {
+        // Enough characters for "%.*g" with precision at most 64.
+        const int MAX_LENGTH = 96;
+
+        if (!flag_format_float) {
+          Flush();
+          (*out) << x;
+          return;
+        }
+
+        if (WriteFloatFixed(x)) { return; }
+
+        Reserve(MAX_LENGTH);
+        int n = std::snprintf(&(buffer[num_bytes]), MAX_LENGTH, "%.*g", 
+                              precision, double(x));
+        if (n > 0 && n < MAX_LENGTH) { num_bytes += n; }
+      }
+
+      template <typename T>
+      void WriteNumber(const T x, const std::true_type)
+      { WriteInteger(x); }
+
+      template <typename T>
+      void WriteNumber(const T x, const std::false_type)
+      { WriteFloat(x); }
+
+    public:
+      TEXT_OUT_BUFFER(std::ostream & out, const std::size_t buffer_size)
+      {
+        const std::ios_base::fmtflags float_flags =
+          std::ios_base::floatfield | std::ios_base::showpoint |
+          std::ios_base::showpos | std::ios_base::uppercase;
+
+        this->out = &out;
+        buffer.resize(buffer_size);
+        num_bytes = 0;
+        precision = out.precision();
+        flag_format_float = 
+          ((out.flags() & float_flags) == 0) && 
+          precision > 0 && precision <= 64 &&
+          out.getloc() == std::locale::classic();
+      }
+
+      ~TEXT_OUT_BUFFER() { Flush(); }
+
+      /// Write buffer to output stream.
+      void Flush()
+      {
+        if (num_bytes > 0) { out->write(&(buffer[0]), num_bytes); }
+        num_bytes = 0;
+      }
+
+      /// Write character c.
+      void Put(const char c)
+      {
+        Reserve(1);
+        buffer[num_bytes++] = c;
+      }
+
+      /// Write number x.
+      template <typename T>
+      void Write(const T x)
+      { WriteNumber(x, std::integral_constant
+                    <bool, std::numeric_limits<T>::is_integer>()); }
+    };
+
+
+    /// Buffer for fast text input.
+    /// Read the remainder of an input stream into memory 
+    ///   and parse numbers directly from memory.
+    class TEXT_IN_BUFFER {
+
+    protected:
+      std::vector<char> buffer;   ///< Stream contents, null terminated.
+      const char * p;             ///< Current position.
+      bool flag_good;             ///< False if a read failed.
+
+      /// Parse decimal number [sign] digits [. digits] [e [sign] digits]
+      ///   into mantissa m and exponent exp10.
+      /// Return pointer to character following the number.
+      /// Return NULL if the number has more than 19 significant digits,
+      ///   has no digits or is followed by a letter or '.'.
+      const char * ParseDecimal
+      (bool & is_negative, unsigned long long & m, int & exp10) const
+      {
+        const int MAX_DIGITS = 19;
+        const char * s = p;
+        int num_digits = 0;
+        bool flag_digit = false;
+
+        is_negative = false;
+        m = 0;
+        exp10 = 0;
+
+        if (*s == '-') { is_negative = true; s++; }
+        else if (*s == '+') { s++; }
+
+        while (*s >= '0' && *s <= '9') {
+          if (m != 0 || *s != '0') { num_digits++; }
+          m = 10*m + (*s - '0');
+          flag_digit = true;
+          s++;
+        }
+
+        if (*s == '.') {
+          s++;
+          while (*s >= '0' && *s <= '9') {
+            if (m != 0 || *s != '0') { num_digits++; }
+            m = 10*m + (*s - '0');
+            exp10--;
+            flag_digit = true;
+            s++;
+          }
+        }
+
+        if (!flag_digit || num_digits > MAX_DIGITS) { return(NULL); }
+
+        if (*s == 'e' || *s == 'E') {
+          const char * s2 = s+1;
+          bool is_exp_negative = false;
+          int e = 0;
+          if (*s2 == '-') { is_exp_negative = true; s2++; }
+          else if (*s2 == '+') { s2++; }
+          if (*s2 < '0' || *s2 > '9') { return(NULL); }
+          while (*s2 >= '0' && *s2 <= '9') {
+            if (e < 10000) { e = 10*e + (*s2 - '0'); }
+            s2++;
+          }
+          if (is_exp_negative) { exp10 -= e; }
+          else { exp10 += e; }
+          s = s2;
+        }
+
+        if ((*s >= 'a' && *s <= 'z') || (*s >= 'A' && *s <= 'Z') ||
+            *s == '.') 
+          { return(NULL); }
+
+        return(s);
+      }
+
+      /// Read float.
+      /// If mantissa m < 2^24 and |exp10| <= 10, m and 10^|exp10| are
+      ///   exact floats and one float multiplication or division
+      ///   gives the correctly rounded result, as strtof.
+      void ReadNumber(float & x, const std::false_type)
+      {
+        const float pow10[11] = 
+          { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f,
+            1e10f };
+        bool is_negative;
+        unsigned long long m;
+        int exp10;
+
+        const char * s = ParseDecimal(is_negative, m, exp10);
+        if (s != NULL && m < (1ULL << 24) && exp10 >= -10 && exp10 <= 10) {
+          float y = float(m);
+          if (exp10 < 0) { y = y/pow10[-exp10]; }
+          else { y = y*pow10[exp10]; }
+          x = (is_negative) ? -y : y;
+          p = s;
+          return;
+        }
+
+        char * end;
+        x = std::strtof(p, &end);
+        if (end == p) { flag_good = false; } else { p = end; }
+      }
+
+      /// Read double.
+      /// If mantissa m < 2^53 and |exp10| <= 22, m and 10^|exp10| are
+      ///   exact doubles and one multiplication or division
+      ///   gives the correctly rounded result, as strtod.
+      void ReadNumber(double & x, const std::false_type)
+      {
+        const double pow10[23] = 
+          { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+            1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+            1e20, 1e21, 1e22 };
+        bool is_negative;
+        unsigned long long m;
+        int exp10;
+
+        const char * s = ParseDecimal(is_negative, m, exp10);
+        if (s != NULL && m < (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+          double y = double(m);
+          if (exp10 < 0) { y = y/pow10[-exp10]; }
+          else { y = y*pow10[exp10]; }
+          x = (is_negative) ? -y : y;
+          p = s;
+          return;
+        }
+
+        char * end;
+        x = std::strtod(p, &end);
+        if (end == p) { flag_good = false; } else { p = end; }
+      }
+
+      template <typename T>
+      void ReadNumber(T & x, const std::false_type)
+      {
+        char * end;
+        x = T(std::strtod(p, &end));
+        if (end == p) { flag_good = false; } else { p = end; }
+      }
+
+      template <typename T>
+      void ReadNumber(T & x, const std::true_type)
+      {
+        bool is_negative = false;
+        if (*p == '-') { is_negative = true; p++; }
+        else if (*p == '+') { p++; }
+
+        if (*p < '0' || *p > '9') {
+          flag_good = false;
+          return;
+        }
+
+        unsigned long long y = 0;
+        while (*p >= '0' && *p <= '9') {
+          y = 10*y + (*p - '0');
+          p++;
+        }
+
+        x = (is_negative) ? T(-(long long)(y)) : T(y);
+      }
+
+    public:
+      /// Read from current position of in to end of stream.
+      TEXT_IN_BUFFER(std::istream & in)
+      {
+        // Size of each block read from in.
+        const std::streamsize BLOCK_SIZE = (1 << 20);
+
+        std::size_t n = 0;
+        std::streamsize k;
+        flag_good = in.good();
+        do {
+          buffer.resize(n+BLOCK_SIZE);
+          k = in.rdbuf()->sgetn(&(buffer[n]), BLOCK_SIZE);
+          if (k > 0) { n += k; }
+        } while (k == BLOCK_SIZE);
+
+        buffer.resize(n+1);
+        buffer[n] = '\0';
+        p = &(buffer[0]);
+        in.setstate(std::ios_base::eofbit);
+      }
+
+      /// Return true if no read has failed.
+      /// Same name as std::istream::good(), so templates reading
+      ///   from std::istream also read from TEXT_IN_BUFFER.
+      bool good() const { return(flag_good); }
+
+      /// Skip white space.
+      void SkipSpace()
+      { while (*p == ' ' || (*p >= '\t' && *p <= '\r')) { p++; } }
+
+      /// Skip to beginning of next line.
+      void SkipLine()
+      {
+        while (*p != '\0' && *p != '\n') { p++; }
+        if (*p == '\n') { p++; }
+      }
+
+      /// Read word delimited by white space.
+      void Read(std::string & s)
+      {
+        SkipSpace();
+        const char * p0 = p;
+        while (*p != '\0' && *p != ' ' && (*p < '\t' || *p > '\r')) { p++; }
+        s.assign(p0, p);
+        if (p == p0) { flag_good = false; }
+      }
+
+      /// Read number x.
+      template <typename T>
+      void Read(T & x)
+      {
+        SkipSpace();
+        if (!flag_good) { return; }
+        ReadNumber(x, std::integral_constant
+                   <bool, std::numeric_limits<T>::is_integer>());
+      }
+
+      template <typename T>
+      TEXT_IN_BUFFER & operator >> (T & x)
+      {
+        Read(x);
+        return(*this);
+      }
+    };
+
+    /// Default size (bytes) of text output buffer.
+    const std::size_t TEXT_OUT_BUFFER_SIZE = (1 << 20);
+  }
+
+
+  // ******************************************
+  // Binary output buffer
+  // ******************************************
+
+  namespace {
+
+    /// Buffer for binary little endian output.
+    /// Values are converted to little endian and copied to the buffer.
+    /// The buffer is written to the output stream in large blocks.
+    class BINARY_OUT_BUFFER {
+
+    protected:
+      std::ostream * out;
+      std::vector<char> buffer;
+      std::size_t num_bytes;      ///< Number of bytes stored in buffer.
+      bool is_little_endian;      ///< True if host is little endian.
+
+    public:
+      BINARY_OUT_BUFFER(std::ostream & out, const std::size_t buffer_size)
+      {
+        const std::uint16_t one = 1;
+        unsigned char c;
+        std::memcpy(&c, &one, 1);
+
+        this->out = &out;
+        buffer.resize(buffer_size);
+        num_bytes = 0;
+        is_little_endian = (c == 1);
+      }
+
+      ~BINARY_OUT_BUFFER() { Flush(); }
+
+      /// Write buffer to output stream.
+      void Flush()
+      {
+        if (num_bytes > 0) { out->write(&(buffer[0]), num_bytes); }
+        num_bytes = 0;
+      }
+
+      /// Write bytes without conversion.
+      void WriteBytes(const char * s, const std::size_t n)
+      {
+        if (n == 0) { return; }
+        if (num_bytes + n > buffer.size()) { Flush(); }
+        if (n > buffer.size()) { out->write(s, n); }
+        else {
+          std::memcpy(&(buffer[num_bytes]), s, n);
+          num_bytes += n;
+        }
+      }
+
+      /// Write value x as type OTYPE, in little endian order.
+      template <typename OTYPE, typename T>
+      void Write(const T x)
+      {
+        const OTYPE y = OTYPE(x);
+
+        if (num_bytes + sizeof(OTYPE) > buffer.size()) { Flush(); }
+        char * p = &(buffer[num_bytes]);
+        std::memcpy(p, &y, sizeof(OTYPE));
+        if (!is_little_endian) {
+          for (std::size_t i = 0; i < sizeof(OTYPE)/2; i++)
+            { std::swap(p[i], p[sizeof(OTYPE)-1-i]); }
+        }
+        num_bytes += sizeof(OTYPE);
+      }
+
+      /// Write n values of array a[] as type OTYPE, in little endian order.
+      /// If no conversion is needed, write a[] directly to the stream.
+      template <typename OTYPE, typename T>
+      void WriteArray(const T * a, const std::size_t n)
+      {
+        if (is_little_endian && sizeof(T) == sizeof(OTYPE) &&
+            std::numeric_limits<T>::is_integer == 
+            std::numeric_limits<OTYPE>::is_integer &&
+            std::numeric_limits<T>::is_signed == 
+            std::numeric_limits<OTYPE>::is_signed) {
+          WriteBytes(reinterpret_cast<const char *>(a), n*sizeof(T));
+        }
+        else {
+          for (std::size_t i = 0; i < n; i++) { Write<OTYPE>(a[i]); }
+        }
+      }
+    };
+
+    /// Default size (bytes) of binary output buffer.
+    const std::size_t BINARY_OUT_BUFFER_SIZE = (1 << 20);
+  }
+
+
+  // ******************************************
+  // Write binary PLY file
+  // ******************************************
+
+  /// Output binary little endian .ply file.
+  /// Two types of polygons, typically triangles and quadrilaterals.
+  /// Vertex coordinates are written as float.
+  /// Polygons are written as a uchar list of int vertex indices.
+  /// @param out = Output stream.  Should be opened in binary mode.
+  /// @param dim = Dimension of vertices.  Must be 3.
+  /// @param coord = Array of coordinates. 
+  ///        coord[dim*i+k] = k'th coordinate of vertex i (k < dim).
+  /// @param numv = Number of vertices.
+  /// @param poly1_vlist = List of vertices of poly 1.
+  /// @param numv_per_poly1 = Number of vertices per polygon in poly1_vlist.
+  /// @param num_poly1 = Number of poly1 polygons.
+  /// @param poly2_vlist = List of vertices of poly 2.
+  /// @param numv_per_poly2 = Number of vertices per polygon in poly2_vlist.
+  /// @param num_poly2 = Number of poly2 polygons.
+  /// @param flag_reorder_quad_vertices = If true, swap the last two 
+  ///        vertices of each poly2 quadrilateral, to output vertices 
+  ///        in counter-clockwise order around quad.
+  template <typename CTYPE, typename VTYPE1, typename VTYPE2> 
+  void ijkoutPLYbinary
+  (std::ostream & out, const int dim, const CTYPE * coord, const int numv,
+   const VTYPE1 * poly1_vlist, const int numv_per_poly1, const int num_poly1,
+   const VTYPE2 * poly2_vlist, const int numv_per_poly2, const int num_poly2,
+   const bool flag_reorder_quad_vertices)
+  {
+    const int num_poly = num_poly1 + num_poly2;
+    IJK::PROCEDURE_ERROR error("ijkoutPLYbinary");
+
+    if (dim != 3) {
+      error.AddMessage("Illegal dimension ", dim, ".");
+      error.AddMessage("  PLY format is only defined for dimension 3.");
+      throw error;
+    }
+
+    if (numv_per_poly1 > 255 || numv_per_poly2 > 255) {
+      error.AddMessage("Too many vertices per polygon.");
+      throw error;
+    }
+
+    out << "ply" << "\n";
+    out << "format binary_little_endian 1.0" << "\n";
+    out << "element vertex " << numv << "\n";
+    out << "property float x" << "\n";
+    out << "property float y" << "\n";
+    out << "property float z" << "\n";
+    out << "element face " << num_poly << "\n";
+    out << "property list uchar int vertex_indices" << "\n";
+    out << "end_header" << "\n";
+
+    BINARY_OUT_BUFFER buffer(out, BINARY_OUT_BUFFER_SIZE);
+
+    buffer.WriteArray<float>(coord, std::size_t(dim)*numv);
+
+    for (int i = 0; i < num_poly1; i++) {
+      const VTYPE1 * pvert = poly1_vlist + i*numv_per_poly1;
+      buffer.Write<unsigned char>(numv_per_poly1);
+      for (int k = 0; k < numv_per_poly1; k++)
+        { buffer.Write<std::int32_t>(pvert[k]); }
+    }
+
+    const bool flag_swap = (flag_reorder_quad_vertices && numv_per_poly2 == 4);
+    for (int i = 0; i < num_poly2; i++) {
+      const VTYPE2 * pvert = poly2_vlist + i*numv_per_poly2;
+      buffer.Write<unsigned char>(numv_per_poly2);
+      if (flag_swap) {
+        // Note change in order between pvert[2] and pvert[3]
+        buffer.Write<std::int32_t>(pvert[0]);
+        buffer.Write<std::int32_t>(pvert[1]);
+        buffer.Write<std::int32_t>(pvert[3]);
+        buffer.Write<std::int32_t>(pvert[2]);
+      }
+      else {
+        for (int k = 0; k < numv_per_poly2; k++)
+          { buffer.Write<std::int32_t>(pvert[k]); }
+      }
+    }
+
+    buffer.Flush();
+  }
+
+  /// Output binary little endian .ply file.
+  /// C++ STL vector format for coord[], poly1_vlist[] and poly2_vlist[].
+  template <typename CTYPE, typename VTYPE1, typename VTYPE2> 
+  void ijkoutPLYbinary
+  (std::ostream & out, const int dim, const std::vector<CTYPE> & coord,
+   const std::vector<VTYPE1> & poly1_vlist, const int numv_per_poly1,
+   const std::vector<VTYPE2> & poly2_vlist, const int numv_per_poly2,
+   const bool flag_reorder_quad_vertices)
+  {
+    const int numv = coord.size()/dim;
+    const int num_poly1 = poly1_vlist.size()/numv_per_poly1;
+    const int num_poly2 = poly2_vlist.size()/numv_per_poly2;
+
+    ijkoutPLYbinary
+      (out, dim, vector2pointer(coord), numv,
+       vector2pointer(poly1_vlist), numv_per_poly1, num_poly1,
+       vector2pointer(poly2_vlist), numv_per_poly2, num_poly2,
+       flag_reorder_quad_vertices);
+  }
+
+
+  // ******************************************
+  // Write raw binary mesh file
+  // ******************************************
+
+  /// Output raw binary mesh file.
+  /// Two types of polygons, typically triangles and quadrilaterals.
+  /// All values are little endian.
+  /// - Header (32 bytes): 8 character identifier "IJKRAW1" followed 
+  ///     by a null character, then six 32-bit integers
+  ///     dim, numv, numv_per_poly1, num_poly1, numv_per_poly2, num_poly2.
+  /// - dim*numv 32-bit float vertex coordinates.
+  /// - numv_per_poly1*num_poly1 32-bit integer poly1 vertex indices.
+  /// - numv_per_poly2*num_poly2 32-bit integer poly2 vertex indices.
+  /// @param out = Output stream.  Should be opened in binary mode.
+  /// @param flag_reorder_quad_vertices = If true, swap the last two 
+  ///        vertices of each poly2 quadrilateral, to output vertices 
+  ///        in counter-clockwise order around quad.
+  template <typename CTYPE, typename VTYPE1, typename VTYPE2> 
+  void ijkoutRAW
+  (std::ostream & out, const int dim, const CTYPE * coord, const int numv,
+   const VTYPE1 * poly1_vlist, const int numv_per_poly1, const int num_poly1,
+   const VTYPE2 * poly2_vlist, const int numv_per_poly2, const int num_poly2,
+   const bool flag_reorder_quad_vertices)
+  {
+    const char id[8] = { 'I', 'J', 'K', 'R', 'A', 'W', '1', '\0' };
+    BINARY_OUT_BUFFER buffer(out, BINARY_OUT_BUFFER_SIZE);
+
+    buffer.WriteBytes(id, 8);
+    buffer.Write<std::int32_t>(dim);
+    buffer.Write<std::int32_t>(numv);
+    buffer.Write<std::int32_t>(numv_per_poly1);
+    buffer.Write<std::int32_t>(num_poly1);
+    buffer.Write<std::int32_t>(numv_per_poly2);
+    buffer.Write<std::int32_t>(num_poly2);
+
+    buffer.WriteArray<float>(coord, std::size_t(dim)*numv);
+    buffer.WriteArray<std::int32_t>
+      (poly1_vlist, std::size_t(numv_per_poly1)*num_poly1);
+
+    if (flag_reorder_quad_vertices && numv_per_poly2 == 4) {
+      for (int i = 0; i < num_poly2; i++) {
+        const VTYPE2 * pvert = poly2_vlist + i*numv_per_poly2;
+        // Note change in order between pvert[2] and pvert[3]
+        buffer.Write<std::int32_t>(pvert[0]);
+        buffer.Write<std::int32_t>(pvert[1]);
+        buffer.Write<std::int32_t>(pvert[3]);
+        buffer.Write<std::int32_t>(pvert[2]);
+      }
+    }
+    else {
+      buffer.WriteArray<std::int32_t>
+        (poly2_vlist, std::size_t(numv_per_poly2)*num_poly2);
+    }
+
+    buffer.Flush();
+  }
+
+  /// Output raw binary mesh file.
+  /// C++ STL vector format for coord[], poly1_vlist[] and poly2_vlist[].
+  template <typename CTYPE, typename VTYPE1, typename VTYPE2> 
+  void ijkoutRAW
+  (std::ostream & out, const int dim, const std::vector<CTYPE> & coord,
+   const std::vector<VTYPE1> & poly1_vlist, const int numv_per_poly1,
+   const std::vector<VTYPE2> & poly2_vlist, const int numv_per_poly2,
+   const bool flag_reorder_quad_vertices)
+  {
+    const int numv = coord.size()/dim;
+    const int num_poly1 = poly1_vlist.size()/numv_per_poly1;
+    const int num_poly2 = poly2_vlist.size()/numv_per_poly2;
+
+    ijkoutRAW
+      (out, dim, vector2pointer(coord), numv,
+       vector2pointer(poly1_vlist), numv_per_poly1, num_poly1,
+       vector2pointer(poly2_vlist), numv_per_poly2, num_poly2,
+       flag_reorder_quad_vertices);
+  }
+
   // ******************************************
   // Write Geomview LINE file
   // ******************************************
@@ -951,6 +1669,9 @@ namespace IJK {
     {
       while (in.good() && !in.eof() && in.get() != '\n') {};
     }
+
+    inline void gobble_line(TEXT_IN_BUFFER & in)
+    { in.SkipLine(); }
   }
 
   /// \brief Read header of Geomview .off file.
@@ -960,8 +1681,9 @@ namespace IJK {
   /// @param nums Number of simplices.
   /// @param nume Number of edges.
   /// @param flag_normals Normals flag.  True if file contains vertex normals.
+  template <typename ISTREAM_TYPE>
   inline void ijkinOFFheader
-  (std::istream & in, int & dim, int & numv, int & nums, int & nume,
+  (ISTREAM_TYPE & in, int & dim, int & numv, int & nums, int & nume,
    bool & flag_normals)
   {
     std::string header_keyword;
@@ -1048,8 +1770,9 @@ namespace IJK {
   /// @param numv = Number of vertices.
   /// @param nums = Number of simplices.
   /// @param nume = Number of edges.
+  template <typename ISTREAM_TYPE>
   inline void ijkinOFFheader
-  (std::istream & in, int & dim, int & numv, int & nums, int & nume)
+  (ISTREAM_TYPE & in, int & dim, int & numv, int & nums, int & nume)
   {
     bool flag_normals;
 
@@ -1065,8 +1788,8 @@ namespace IJK {
   /// @param coord = Array of coordinates. 
   ///        coord[dim*i+k] = k'th coordinate of vertex i (k < dim).
   /// @pre Array coord[] is preallocated with size at least \a numv * \a dim.
-  template <typename T> void ijkinOFFcoord
-  (std::istream & in, const int dim, const int numv, T * coord)
+  template <typename ISTREAM_TYPE, typename T> void ijkinOFFcoord
+  (ISTREAM_TYPE & in, const int dim, const int numv, T * coord)
   {
     IJK::PROCEDURE_ERROR error("ijkinOFFcoord");
 
@@ -1105,8 +1828,9 @@ namespace IJK {
   /// @param normal Array of normals.
   ///        normal[dim*i+k] k'th coordinate of normal of vertex i (k < dim).
   /// @pre Array normal[] is preallocated with size at least \a numv * \a dim.
-  template <typename CTYPE, typename NTYPE> void ijkinNOFFcoord
-  (std::istream & in, const int dim, const int numv, 
+  template <typename ISTREAM_TYPE, typename CTYPE, typename NTYPE> 
+  void ijkinNOFFcoord
+  (ISTREAM_TYPE & in, const int dim, const int numv, 
    CTYPE * coord, NTYPE * normal)
   {
     IJK::PROCEDURE_ERROR error("ijkinNOFFcoord");
@@ -1144,8 +1868,8 @@ namespace IJK {
   }
 
   /// \brief Read coordinates from Geomview .off file.
-  template <typename T> void ijkinOFFcoord
-  (std::istream & in, const int dim, const int numv, std::vector<T> & coord)
+  template <typename ISTREAM_TYPE, typename T> void ijkinOFFcoord
+  (ISTREAM_TYPE & in, const int dim, const int numv, std::vector<T> & coord)
   {
     if (dim < 1) {
       coord.clear();
@@ -1158,8 +1882,9 @@ namespace IJK {
   }
 
   /// \brief Read coordinates from Geomview .off file.
-  template <typename CTYPE, typename NTYPE> void ijkinNOFFcoord
-  (std::istream & in, const int dim, const int numv, 
+  template <typename ISTREAM_TYPE, typename CTYPE, typename NTYPE> 
+  void ijkinNOFFcoord
+  (ISTREAM_TYPE & in, const int dim, const int numv, 
    std::vector<CTYPE> & coord, std::vector<NTYPE> & normal)
   {
     if (dim < 1) {
@@ -1183,8 +1908,8 @@ namespace IJK {
   ///        vert[k] = k'th vertex.
   /// @pre Array vert[] has been preallocated
   ///      with size at least \a numv.
-  template <typename T> void ijkinOFFvert
-  (std::istream & in, const int numv, T * vert)
+  template <typename ISTREAM_TYPE, typename T> void ijkinOFFvert
+  (ISTREAM_TYPE & in, const int numv, T * vert)
   {
     for (int k = 0; k < numv; k++) 
       { in >> vert[k]; }
@@ -1202,8 +1927,8 @@ namespace IJK {
   ///            k'th vertex index of polytope jp.
   /// @pre Array poly_vert[] has been preallocated
   ///      with size at least \a numv_per_poly * \a (jpoly+1).
-  template <typename T> void ijkinOFFpolyVert
-  (std::istream & in, const int jpoly, const int numv_per_poly,
+  template <typename ISTREAM_TYPE, typename T> void ijkinOFFpolyVert
+  (ISTREAM_TYPE & in, const int jpoly, const int numv_per_poly,
    T * poly_vert)
   {
     for (int k = 0; k < numv_per_poly; k++) 
@@ -1215,8 +1940,8 @@ namespace IJK {
   /// C++ STL vector format for poly_vert[].
   /// @pre C++ vector poly_vert[] has size at least 
   ///        \a numv_per_poly * \a (jpoly+1).
-  template <typename T> void ijkinOFFpolyVert
-  (std::istream & in, const int jpoly, const int numv_per_poly,
+  template <typename ISTREAM_TYPE, typename T> void ijkinOFFpolyVert
+  (ISTREAM_TYPE & in, const int jpoly, const int numv_per_poly,
    std::vector<T> & poly_vert)
   {
     ijkinOFFpolyVert(in, jpoly, numv_per_poly, &(poly_vert[0]));
@@ -1235,13 +1960,13 @@ namespace IJK {
   ///            k'th vertex index of simplex js.
   /// @pre Array simplex_vert[] has been preallocated
   ///      with size at least \a numv_per_simplex * \a (js+1).
-  template <typename T> void ijkinOFFsimplex
-  (std::istream & in, const int ifirst, const int nums, 
+  template <typename ISTREAM_TYPE, typename T> void ijkinOFFsimplex
+  (ISTREAM_TYPE & in, const int ifirst, const int nums, 
    const int numv_per_simplex, T * simplex_vert)
   {
     IJK::PROCEDURE_ERROR error("ijkinOFFsimplex");
 
-    int nvert;
+    int nvert = 0;
     for (int i = ifirst; i < ifirst + nums; i++) {
 
       in >> nvert;
@@ -1268,8 +1993,8 @@ namespace IJK {
   /// C++ STL vector format for simplex_vert[].
   /// @pre C++ vector simplex_vert[] has been preallocated
   ///      with size at least \a numv_per_simplex * \a (js+1).
-  template <typename T> void ijkinOFFsimplex
-  (std::istream & in, const int ifirst, const int nums, 
+  template <typename ISTREAM_TYPE, typename T> void ijkinOFFsimplex
+  (ISTREAM_TYPE & in, const int ifirst, const int nums, 
    const int numv_per_simplex, std::vector<T> & simplex_vert)
   {
     ijkinOFFsimplex(in, ifirst, nums, numv_per_simplex,
@@ -1294,6 +2019,9 @@ namespace IJK {
   (std::istream & in, int & dim, int & mesh_dim,
    T * & coord, int & numv, int * & simplex_vert, int & nums)
   {
+    // Read remainder of stream into memory and parse from memory.
+    TEXT_IN_BUFFER in_buffer(in);
+
     int nume;
 
     IJK::PROCEDURE_ERROR error("ijkinOFF");
@@ -1302,15 +2030,15 @@ namespace IJK {
     simplex_vert = NULL;
     mesh_dim = 0;            // default mesh dimension
 
-    ijkinOFFheader(in, dim, numv, nums, nume);
+    ijkinOFFheader(in_buffer, dim, numv, nums, nume);
 
     coord = new T[numv*dim];
-    ijkinOFFcoord(in, dim, numv, coord);
+    ijkinOFFcoord(in_buffer, dim, numv, coord);
 
     if (nums > 0) {
       // use first simplex to set mesh dimension
       int num_simplex_vert = 0;
-      in >> num_simplex_vert;
+      in_buffer >> num_simplex_vert;
       if (num_simplex_vert > 0) { 
         mesh_dim = num_simplex_vert-1; 
       }
@@ -1319,9 +2047,9 @@ namespace IJK {
       simplex_vert = new int[nums*num_simplex_vert];
 
       // read in first simplex
-      ijkinOFFpolyVert(in, 0, num_simplex_vert, simplex_vert);
+      ijkinOFFpolyVert(in_buffer, 0, num_simplex_vert, simplex_vert);
 
-      ijkinOFFsimplex(in, 1, nums-1, num_simplex_vert, simplex_vert);
+      ijkinOFFsimplex(in_buffer, 1, nums-1, num_simplex_vert, simplex_vert);
     };
   }
 
@@ -1331,6 +2059,9 @@ namespace IJK {
   (std::istream & in, int & dim, int & mesh_dim,
    std::vector<T> & coord, std::vector<int> & simplex_vert)
   {
+    // Read remainder of stream into memory and parse from memory.
+    TEXT_IN_BUFFER in_buffer(in);
+
     int numv, nums, nume;
 
     IJK::PROCEDURE_ERROR error("ijkinOFF");
@@ -1340,14 +2071,14 @@ namespace IJK {
 
     mesh_dim = 0;            // default mesh dimension
 
-    ijkinOFFheader(in, dim, numv, nums, nume);
+    ijkinOFFheader(in_buffer, dim, numv, nums, nume);
 
-    ijkinOFFcoord(in, dim, numv, coord);
+    ijkinOFFcoord(in_buffer, dim, numv, coord);
 
     if (nums > 0) {
       // use first simplex to set mesh dimension
       int num_simplex_vert = 0;
-      in >> num_simplex_vert;
+      in_buffer >> num_simplex_vert;
       if (num_simplex_vert > 0) { 
         mesh_dim = num_simplex_vert-1; 
       }
@@ -1356,10 +2087,10 @@ namespace IJK {
       simplex_vert.resize(nums*num_simplex_vert);
 
       // read vertices of first simplex
-      ijkinOFFpolyVert(in, 0, num_simplex_vert, simplex_vert);
+      ijkinOFFpolyVert(in_buffer, 0, num_simplex_vert, simplex_vert);
 
       // read remaining simplex vertices
-      ijkinOFFsimplex(in, 1, nums-1, num_simplex_vert, simplex_vert);
+      ijkinOFFsimplex(in_buffer, 1, nums-1, num_simplex_vert, simplex_vert);
     };
   }
 
@@ -1397,6 +2128,9 @@ namespace IJK {
   (std::istream & in, int & dim, T * & coord, int & numv,
    int * & simplex_vert, int & nums)
   {
+    // Read remainder of stream into memory and parse from memory.
+    TEXT_IN_BUFFER in_buffer(in);
+
     const int numv_per_simplex = dim;
     int nume;
 
@@ -1405,17 +2139,17 @@ namespace IJK {
     coord = NULL;
     simplex_vert = NULL;
 
-    if (!in.good()) {
+    if (!in_buffer.good()) {
       throw error("Error: Corrupted input stream. Unable to read input.");
     }
 
-    ijkinOFFheader(in, dim, numv, nums, nume);
+    ijkinOFFheader(in_buffer, dim, numv, nums, nume);
 
     coord = new T[numv*dim];
-    ijkinOFFcoord(in, dim, numv, coord);
+    ijkinOFFcoord(in_buffer, dim, numv, coord);
 
     simplex_vert = new int[nums*dim];
-    ijkinOFFsimplex(in, 0, nums, numv_per_simplex, simplex_vert);
+    ijkinOFFsimplex(in_buffer, 0, nums, numv_per_simplex, simplex_vert);
   }
 
   /// \brief Read Geomview .off file where each simplex has dimension \a dim-1 
@@ -1434,6 +2168,9 @@ namespace IJK {
    std::vector<CTYPE> & coord, std::vector<NTYPE> & normal, 
    std::vector<int> & simplex_vert)
   {
+    // Read remainder of stream into memory and parse from memory.
+    TEXT_IN_BUFFER in_buffer(in);
+
     bool flag_normals;
     int numv, nums, nume;
 
@@ -1445,19 +2182,19 @@ namespace IJK {
 
     mesh_dim = 0;            // default mesh dimension
 
-    ijkinOFFheader(in, dim, numv, nums, nume, flag_normals);
+    ijkinOFFheader(in_buffer, dim, numv, nums, nume, flag_normals);
 
     if (flag_normals) {
-      ijkinNOFFcoord(in, dim, numv, coord, normal);
+      ijkinNOFFcoord(in_buffer, dim, numv, coord, normal);
     }
     else {
-      ijkinOFFcoord(in, dim, numv, coord);
+      ijkinOFFcoord(in_buffer, dim, numv, coord);
     }
 
     if (nums > 0) {
       // use first simplex to set mesh dimension
       int num_simplex_vert = 0;
-      in >> num_simplex_vert;
+      in_buffer >> num_simplex_vert;
       if (num_simplex_vert > 0) { 
         mesh_dim = num_simplex_vert-1; 
       }
@@ -1466,10 +2203,10 @@ namespace IJK {
       simplex_vert.resize(nums*num_simplex_vert);
 
       // read vertices of first simplex
-      ijkinOFFpolyVert(in, 0, num_simplex_vert, simplex_vert);
+      ijkinOFFpolyVert(in_buffer, 0, num_simplex_vert, simplex_vert);
 
       // read remaining simplex vertices
-      ijkinOFFsimplex(in, 1, nums-1, num_simplex_vert, simplex_vert);
+      ijkinOFFsimplex(in_buffer, 1, nums-1, num_simplex_vert, simplex_vert);
     };
   }
 
@@ -1492,6 +2229,9 @@ namespace IJK {
   (std::istream & in, int & dim, std::vector<T> & coord, 
    std::vector<int> & tri_vert, std::vector<int> & quad_vert)
   {
+    // Read remainder of stream into memory and parse from memory.
+    TEXT_IN_BUFFER in_buffer(in);
+
     const int NUM_TRIANGLE_VERTICES = 3;
     const int NUM_QUAD_VERTICES = 4;
     IJK::PROCEDURE_ERROR error("ijkinOFF_tri_quad");
@@ -1504,25 +2244,25 @@ namespace IJK {
 
     // nump: Total number of triangle and quads.
     int numv, nump;
-    ijkinOFFheader(in, dim, numv, nump, nume);
+    ijkinOFFheader(in_buffer, dim, numv, nump, nume);
 
-    ijkinOFFcoord(in, dim, numv, coord);
+    ijkinOFFcoord(in_buffer, dim, numv, coord);
 
     int numt = 0;
     int numq = 0;
     for (int i = 0; i < nump; i++) {
-      int nvert;
+      int nvert = 0;
 
-      in >> nvert;
+      in_buffer >> nvert;
 
       if (nvert == NUM_TRIANGLE_VERTICES) {
         tri_vert.resize(NUM_TRIANGLE_VERTICES*(numt+1));
-        ijkinOFFpolyVert(in, numt, NUM_TRIANGLE_VERTICES, tri_vert);
+        ijkinOFFpolyVert(in_buffer, numt, NUM_TRIANGLE_VERTICES, tri_vert);
         numt++;
       }
       else if (nvert == NUM_QUAD_VERTICES) {
         quad_vert.resize(NUM_QUAD_VERTICES*(numq+1));
-        ijkinOFFpolyVert(in, numq, NUM_QUAD_VERTICES, quad_vert);
+        ijkinOFFpolyVert(in_buffer, numq, NUM_QUAD_VERTICES, quad_vert);
         numq++;
       }
       else {
@@ -1561,6 +2301,9 @@ namespace IJK {
    std::vector<int> & num_poly_vert,
    std::vector<int> & poly_vert, std::vector<int> & first_poly_vert)
   {
+    // Read remainder of stream into memory and parse from memory.
+    TEXT_IN_BUFFER in_buffer(in);
+
     const int NUM_TRIANGLE_VERTICES = 3;
     const int NUM_QUAD_VERTICES = 4;
     IJK::PROCEDURE_ERROR error("ijkinPolyOFF");
@@ -1576,26 +2319,26 @@ namespace IJK {
 
     // nump: Total number of polygons.
     int numv, nump;
-    ijkinOFFheader(in, dim, numv, nump, nume);
+    ijkinOFFheader(in_buffer, dim, numv, nump, nume);
 
-    ijkinOFFcoord(in, dim, numv, coord);
+    ijkinOFFcoord(in_buffer, dim, numv, coord);
 
     int numt = 0;
     int numq = 0;
     int num_not_qt = 0;   // Number of polygons which are not tri or quad
     for (int i = 0; i < nump; i++) {
-      int nvert;
+      int nvert = 0;
 
-      in >> nvert;
+      in_buffer >> nvert;
 
       if (nvert == NUM_TRIANGLE_VERTICES) {
         tri_vert.resize(NUM_TRIANGLE_VERTICES*(numt+1));
-        ijkinOFFpolyVert(in, numt, NUM_TRIANGLE_VERTICES, tri_vert);
+        ijkinOFFpolyVert(in_buffer, numt, NUM_TRIANGLE_VERTICES, tri_vert);
         numt++;
       }
       else if (nvert == NUM_QUAD_VERTICES) {
         quad_vert.resize(NUM_QUAD_VERTICES*(numq+1));
-        ijkinOFFpolyVert(in, numq, NUM_QUAD_VERTICES, quad_vert);
+        ijkinOFFpolyVert(in_buffer, numq, NUM_QUAD_VERTICES, quad_vert);
         numq++;
       }
       else {
@@ -1603,7 +2346,7 @@ namespace IJK {
         int k = poly_vert.size();
         first_poly_vert.push_back(k);
         poly_vert.resize(k+nvert);
-        ijkinOFFvert(in, nvert, &(poly_vert[k]));
+        ijkinOFFvert(in_buffer, nvert, &(poly_vert[k]));
         num_not_qt++;
       }
     }
@@ -1617,9 +2360,10 @@ namespace IJK {
   /// @param first_poly_vert = Array indexing first vertex of each polytope.
   ///        Polytope i has vertices poly_vert[first_poly_vert[i]] to
   ///        poly_vert[first_poly_vert[i]+num_poly_vert[i]-1].
-  template <typename NTYPE, typename VTYPE, typename ITYPE>
+  template <typename ISTREAM_TYPE, 
+            typename NTYPE, typename VTYPE, typename ITYPE>
   void ijkinOFFpolyList
-  (std::istream & in, const int nump, std::vector<NTYPE> & num_poly_vert,
+  (ISTREAM_TYPE & in, const int nump, std::vector<NTYPE> & num_poly_vert,
    std::vector<VTYPE> & poly_vert, std::vector<ITYPE> & first_poly_vert)
   {
     for (int i = 0; i < nump; i++) {
@@ -1653,6 +2397,9 @@ namespace IJK {
    std::vector<int> & num_poly_vert,
    std::vector<int> & poly_vert, std::vector<int> & first_poly_vert)
   {
+    // Read remainder of stream into memory and parse from memory.
+    TEXT_IN_BUFFER in_buffer(in);
+
     IJK::PROCEDURE_ERROR error("ijkinPolytopeOFF");
 
     int nume, nump;
@@ -1662,13 +2409,13 @@ namespace IJK {
     poly_vert.clear();
     first_poly_vert.clear();
 
-    ijkinOFFheader(in, dim, numv, nump, nume);
+    ijkinOFFheader(in_buffer, dim, numv, nump, nume);
 
     coord = new T[numv*dim];
-    ijkinOFFcoord(in, dim, numv, coord);
+    ijkinOFFcoord(in_buffer, dim, numv, coord);
 
     ijkinOFFpolyList
-      (in, nump, num_poly_vert, poly_vert, first_poly_vert);
+      (in_buffer, nump, num_poly_vert, poly_vert, first_poly_vert);
   }
 
   /// \brief Read polytopes from Geomview .off file.
@@ -1691,6 +2438,9 @@ namespace IJK {
    std::vector<int> & num_poly_vert,
    std::vector<int> & poly_vert, std::vector<int> & first_poly_vert)
   {
+    // Read remainder of stream into memory and parse from memory.
+    TEXT_IN_BUFFER in_buffer(in);
+
     IJK::PROCEDURE_ERROR error("ijkinPolytopeOFF");
 
     int nume;
@@ -1702,12 +2452,12 @@ namespace IJK {
 
     // nump: Total number of polytopes.
     int numv, nump;
-    ijkinOFFheader(in, dim, numv, nump, nume);
+    ijkinOFFheader(in_buffer, dim, numv, nump, nume);
 
-    ijkinOFFcoord(in, dim, numv, coord);
+    ijkinOFFcoord(in_buffer, dim, numv, coord);
 
     ijkinOFFpolyList
-      (in, nump, num_poly_vert, poly_vert, first_poly_vert);
+      (in_buffer, nump, num_poly_vert, poly_vert, first_poly_vert);
   }
 
   // ******************************************
@@ -1720,8 +2470,9 @@ namespace IJK {
   /// @param dim = Vertex dimension.
   /// @param numv = Number of vertices.
   /// @param nume = Number of edges.
+  template <typename ISTREAM_TYPE>
   inline void ijkinLINEheader
-  (std::istream & in, int & dim, int & numv, int & nume)
+  (ISTREAM_TYPE & in, int & dim, int & numv, int & nume)
   {
     float r,g,b,a;
     std::string header_keyword;
@@ -1778,8 +2529,8 @@ namespace IJK {
   ///        edge_enpdoint[2*je+k] = index of k'th endpoint of edge je.
   /// @pre Array edge_endpoint[] has been preallocated
   ///      with size at least 2 * \a nume.
-  template <typename T> void ijkinLINEedge
-  (std::istream & in, const int nume, T * & edge_endpoint)
+  template <typename ISTREAM_TYPE, typename T> void ijkinLINEedge
+  (ISTREAM_TYPE & in, const int nume, T * & edge_endpoint)
   {
     IJK::PROCEDURE_ERROR error("ijkinLINEedge");
 
@@ -1810,21 +2561,24 @@ namespace IJK {
   (std::istream & in, int & dim, T * & coord, int & numv, 
    int * & edge_endpoint, int & nume)
   {
+    // Read remainder of stream into memory and parse from memory.
+    TEXT_IN_BUFFER in_buffer(in);
+
     IJK::PROCEDURE_ERROR error("ijkinLINE");
 
     coord = NULL;
     edge_endpoint = NULL;
 
-    ijkinLINEheader(in, dim, numv, nume);
+    ijkinLINEheader(in_buffer, dim, numv, nume);
 
     coord = new T[numv*dim];
-    ijkinOFFcoord(in, dim, numv, coord);
+    ijkinOFFcoord(in_buffer, dim, numv, coord);
 
     int num_edge_endpoint = 0;
     edge_endpoint = new int[2*nume];
 
     // read in first edge
-    ijkinLINEedge(in, nume, edge_endpoint);
+    ijkinLINEedge(in_buffer, nume, edge_endpoint);
   }
 
   // ******************************************
@@ -1991,11 +2745,13 @@ namespace IJK {
     template <typename CTYPE> void ijkoutVertexCoord
     (std::ostream & out, const int dim, const CTYPE * coord, const int numv)
     {
+      TEXT_OUT_BUFFER buffer(out, TEXT_OUT_BUFFER_SIZE);
+
       for (int iv = 0; iv < numv; iv++) {
         for (int d = 0; d < dim; d++) {
-          out << coord[iv*dim + d];
-          if (d < dim-1) { out << " "; }
-          else { out << std::endl; };
+          buffer.Write(coord[iv*dim + d]);
+          if (d < dim-1) { buffer.Put(' '); }
+          else { buffer.Put('\n'); };
         }
       }
     }
@@ -2011,12 +2767,15 @@ namespace IJK {
     (std::ostream & out, const int numv_per_polygon,
      const VTYPE * poly_vert, const int nump)
     {
+      TEXT_OUT_BUFFER buffer(out, TEXT_OUT_BUFFER_SIZE);
+
       for (int is = 0; is < nump; is++) {
-        out << numv_per_polygon << " ";
+        buffer.Write(numv_per_polygon);
+        buffer.Put(' ');
         for (int iv = 0; iv < numv_per_polygon; iv++) {
-          out << poly_vert[is*numv_per_polygon + iv];
-          if (iv < numv_per_polygon-1) { out << " "; }
-          else { out << std::endl; };
+          buffer.Write(poly_vert[is*numv_per_polygon + iv]);
+          if (iv < numv_per_polygon-1) { buffer.Put(' '); }
+          else { buffer.Put('\n'); };
         }
       }
     }
@@ -2028,15 +2787,18 @@ namespace IJK {
      const NTYPE * num_poly_vert, const VTYPE * poly_vert,
      const ITYPE * first_poly_vert, const int num_poly)
     {
+      TEXT_OUT_BUFFER buffer(out, TEXT_OUT_BUFFER_SIZE);
+
       for (int ipoly = 0; ipoly < num_poly; ipoly++) {
         const ITYPE * pvert = poly_vert + first_poly_vert[ipoly];
         NTYPE num_pvert = num_poly_vert[ipoly];
 
-        out << num_pvert << " ";
+        buffer.Write(num_pvert);
+        buffer.Put(' ');
         for (int i = 0; i < num_pvert; i++) {
-          out << pvert[i];
-          if (i+1 < num_pvert) { out << " "; }
-          else { out << std::endl; };
+          buffer.Write(pvert[i]);
+          if (i+1 < num_pvert) { buffer.Put(' '); }
+          else { buffer.Put('\n'); };
         }
       }
 
@@ -2095,13 +2857,22 @@ namespace IJK {
       const int NUMV_PER_QUAD = 4;
 
       if (flag_reorder_vertices) {
+        TEXT_OUT_BUFFER buffer(out, TEXT_OUT_BUFFER_SIZE);
+
         for (int iq = 0; iq < numq; iq++) {
-          out << NUMV_PER_QUAD << " ";
+          buffer.Write(NUMV_PER_QUAD);
+          buffer.Put(' ');
           const VTYPE * v = quad_vert+iq*NUMV_PER_QUAD;
-          out << v[0] << " " << v[1] << " ";
+          buffer.Write(v[0]);
+          buffer.Put(' ');
+          buffer.Write(v[1]);
+          buffer.Put(' ');
 
           // Note change in order between v[2] and v[3]
-          out << v[3] << " " << v[2] << std::endl;
+          buffer.Write(v[3]);
+          buffer.Put(' ');
+          buffer.Write(v[2]);
+          buffer.Put('\n');
         }
       }
       else {
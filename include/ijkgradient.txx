@@ -0,0 +1,368 @@
+/// \file ijkgradient.txx
+/// Compute gradients of scalar grids.
+/// Version 0.1.0
+
+/*
+  IJK: Isosurface Jeneration Kode
+  Copyright (C) 2011 Rephael Wenger
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef _IJKGRADIENT_
+#define _IJKGRADIENT_
+
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Note: Uses only standard library headers so that programs with
+//   their own copies of the IJK grid templates can include this file.
+
+namespace IJK {
+
+  // **************************************************
+  // RUN LOOP IN PARALLEL
+  // **************************************************
+
+  /// Return number of threads to use.
+  /// If num_threads is 0, return number of hardware threads.
+  inline int get_num_threads(const int num_threads)
+  {
+    int n = num_threads;
+    if (n <= 0) {
+      n = std::thread::hardware_concurrency();
+      if (n <= 0) { n = 1; }
+    }
+    return(n);
+  }
+
+  /// Split [0,num) into blocks of consecutive indices.
+  /// Call run_block(k0, k1) on each block in its own thread.
+  /// Rethrow the first exception thrown by any block.
+  /// @param num_threads Number of threads.
+  ///   If num_threads is 0, use all hardware threads.
+  template <typename NTYPE, typename BLOCK_FUNCTION>
+  void for_each_block_in_parallel
+  (const NTYPE num, const int num_threads, BLOCK_FUNCTION run_block)
+  {
+    NTYPE num_blocks = get_num_threads(num_threads);
+    if (num_blocks > num) { num_blocks = num; }
+
+    if (num_blocks <= 1) {
+      if (num > 0) { run_block(NTYPE(0), num); }
+      return;
+    }
+
+    std::vector<std::thread> thread_list;
+    std::vector<std::exception_ptr> thread_error(num_blocks);
+
+    // Block k is [(num*k)/num_blocks, (num*(k+1))/num_blocks),
+    //   computed without forming num*k, which could overflow NTYPE.
+    const NTYPE q = num/num_blocks;
+    const NTYPE r = num%num_blocks;
+    for (NTYPE k = 0; k < num_blocks; k++) {
+      const NTYPE k0 = q*k + (r*k)/num_blocks;
+      const NTYPE k1 = q*(k+1) + (r*(k+1))/num_blocks;
+      std::exception_ptr * error_ptr = &(thread_error[k]);
+
+      thread_list.push_back
+        (std::thread([=, &run_block]() {
+          try { run_block(k0, k1); }
+          catch (...) { *error_ptr = std::current_exception(); }
+        }));
+    }
+
+    for (std::size_t k = 0; k < thread_list.size(); k++)
+      { thread_list[k].join(); }
+
+    for (std::size_t k = 0; k < thread_error.size(); k++) {
+      if (thread_error[k]) { std::rethrow_exception(thread_error[k]); }
+    }
+  }
+
+  /// Call process_vertex(iv, is_boundary, scratch) on each vertex iv
+  ///   of a 3D grid.
+  /// Split the grid into blocks of consecutive z-slices.
+  ///   Process each block in its own thread.
+  ///   Process vertices in each block in increasing order.
+  /// is_boundary is true if iv is on the grid boundary.
+  /// @param block_scratch[] Scratch data for each block.
+  ///   Resized to the number of blocks and reset to SCRATCH_TYPE().
+  ///   Block k passes block_scratch[k] to process_vertex.
+  ///   Blocks are in increasing z order, so combining block_scratch[0],
+  ///   block_scratch[1], ... in order gives the same result
+  ///   for any number of threads.
+  /// @param num_threads Number of threads.
+  ///   If num_threads is 0, use all hardware threads.
+  /// @pre grid.Dimension() = 3.
+  template <typename GRID_TYPE, typename SCRATCH_TYPE,
+            typename VERTEX_FUNCTION>
+  void for_each_vertex_3D_in_parallel
+  (const GRID_TYPE & grid, const int num_threads,
+   std::vector<SCRATCH_TYPE> & block_scratch,
+   VERTEX_FUNCTION process_vertex)
+  {
+    const std::ptrdiff_t nx = grid.AxisSize(0);
+    const std::ptrdiff_t ny = grid.AxisSize(1);
+    const std::ptrdiff_t nz = grid.AxisSize(2);
+    std::ptrdiff_t num_blocks = get_num_threads(num_threads);
+    if (num_blocks > nz) { num_blocks = nz; }
+    if (num_blocks < 1) { num_blocks = 1; }
+
+    block_scratch.assign(num_blocks, SCRATCH_TYPE());
+
+    for_each_block_in_parallel
+      (num_blocks, int(num_blocks),
+       [&](const std::ptrdiff_t b0, const std::ptrdiff_t b1) {
+        for (std::ptrdiff_t b = b0; b < b1; b++) {
+          const std::ptrdiff_t z0 = (nz*b)/num_blocks;
+          const std::ptrdiff_t z1 = (nz*(b+1))/num_blocks;
+          SCRATCH_TYPE & scratch = block_scratch[b];
+
+          for (std::ptrdiff_t z = z0; z < z1; z++) {
+            const bool is_zboundary = (z == 0 || z+1 >= nz);
+            for (std::ptrdiff_t y = 0; y < ny; y++) {
+              const bool is_yzboundary =
+                (is_zboundary || y == 0 || y+1 >= ny);
+              const std::ptrdiff_t iv0 = (z*ny + y)*nx;
+              for (std::ptrdiff_t x = 0; x < nx; x++) {
+                const bool is_boundary =
+                  (is_yzboundary || x == 0 || x+1 >= nx);
+                process_vertex(iv0+x, is_boundary, scratch);
+              }
+            }
+          }
+        }
+      });
+  }
+
+  /// Call process_vertex(iv, is_boundary) on each vertex iv of a 3D grid.
+  /// Version without scratch data.
+  template <typename GRID_TYPE, typename VERTEX_FUNCTION>
+  void for_each_vertex_3D_in_parallel
+  (const GRID_TYPE & grid, const int num_threads,
+   VERTEX_FUNCTION process_vertex)
+  {
+    std::vector<char> block_scratch;
+
+    for_each_vertex_3D_in_parallel
+      (grid, num_threads, block_scratch,
+       [&](const std::ptrdiff_t iv, const bool is_boundary, char &)
+       { process_vertex(iv, is_boundary); });
+  }
+
+  // **************************************************
+  // CENTRAL DIFFERENCE GRADIENTS
+  // **************************************************
+
+  /// Compute gradients of vertices (x,y,z) of a 3D grid
+  ///   with x in [x0,x1).
+  /// Store gradient of vertex (x,y,z) in gradient_x0[3*(x-x0)].
+  /// Interior vertices use central difference.
+  /// Boundary vertices use compute_boundary_gradient(iv, gradient).
+  /// If flag_magnitude, compute gradient magnitudes.
+  ///   Set gradients with magnitude less than min_magnitude to zero.
+  ///   If flag_normalize, normalize gradients with magnitude
+  ///     at least min_magnitude.
+  ///   If magnitude_x0 is not NULL, store magnitude of vertex (x,y,z)
+  ///     in magnitude_x0[x-x0].
+  /// @param axis_size[] Grid axis sizes.
+  /// @param dist[d] Divide differences along axis d by dist[d].
+  /// @pre 0 <= x0 <= x1 <= axis_size[0].
+  template <typename STYPE, typename DIST_TYPE, typename MTYPE,
+            typename BOUNDARY_FUNCTION, typename GTYPE>
+  void compute_gradient_central_difference_3D_row_segment
+  (const STYPE * scalar, const std::ptrdiff_t axis_size[3],
+   const DIST_TYPE dist[3], const bool flag_magnitude,
+   const MTYPE min_magnitude, const bool flag_normalize,
+   const BOUNDARY_FUNCTION & compute_boundary_gradient,
+   const std::ptrdiff_t x0, const std::ptrdiff_t x1,
+   const std::ptrdiff_t y, const std::ptrdiff_t z,
+   GTYPE * gradient_x0, MTYPE * magnitude_x0)
+  {
+    const std::ptrdiff_t nx = axis_size[0];
+    const std::ptrdiff_t ny = axis_size[1];
+    const std::ptrdiff_t nz = axis_size[2];
+    const std::ptrdiff_t nxy = nx*ny;
+    const std::ptrdiff_t iv0 = z*nxy + y*nx;
+
+    if (x0 >= x1) { return; }
+
+    if (z == 0 || z+1 >= nz || y == 0 || y+1 >= ny || nx < 3) {
+      for (std::ptrdiff_t x = x0; x < x1; x++)
+        { compute_boundary_gradient(iv0+x, gradient_x0+3*(x-x0)); }
+    }
+    else {
+      const STYPE * s = scalar + iv0;
+      const DIST_TYPE dist0 = dist[0];
+      const DIST_TYPE dist1 = dist[1];
+      const DIST_TYPE dist2 = dist[2];
+      const std::ptrdiff_t xa = (x0 > 1) ? x0 : 1;
+      const std::ptrdiff_t xb = (x1 < nx-1) ? x1 : nx-1;
+
+      if (x0 == 0) 
+        { compute_boundary_gradient(iv0, gradient_x0); }
+
+      // No branches or function calls.  Compilers vectorize this loop.
+      GTYPE * g = gradient_x0 + 3*(xa-x0);
+      for (std::ptrdiff_t x = xa; x < xb; x++) {
+        g[0] = (s[x+1] - s[x-1])/dist0;
+        g[1] = (s[x+nx] - s[x-nx])/dist1;
+        g[2] = (s[x+nxy] - s[x-nxy])/dist2;
+        g += 3;
+      }
+
+      if (x1 == nx) 
+        { compute_boundary_gradient(iv0+nx-1, gradient_x0+3*(nx-1-x0)); }
+    }
+
+    if (!flag_magnitude) { return; }
+
+    // Compute magnitudes while the row is in cache.
+    for (std::ptrdiff_t x = x0; x < x1; x++) {
+      GTYPE * g = gradient_x0 + 3*(x-x0);
+      MTYPE mag = 0;
+      mag = mag + g[0]*g[0];
+      mag = mag + g[1]*g[1];
+      mag = mag + g[2]*g[2];
+      mag = std::sqrt(mag);
+
+      if (mag < min_magnitude)
+        { g[0] = 0; g[1] = 0; g[2] = 0; }
+      else if (flag_normalize)
+        { g[0] = g[0]/mag; g[1] = g[1]/mag; g[2] = g[2]/mag; }
+
+      if (magnitude_x0 != NULL) { magnitude_x0[x-x0] = mag; }
+    }
+  }
+
+  /// Compute gradients of vertices (x,y,z) of a 3D grid
+  ///   with x in [x0,x1).
+  /// Store gradient of vertex iv in gradient[3*iv].
+  /// If magnitude is not NULL, store magnitude of vertex iv
+  ///   in magnitude[iv].
+  /// Same computations as compute_gradient_central_difference_3D_row_segment().
+  /// @pre 0 <= x0 <= x1 <= axis_size[0].
+  template <typename STYPE, typename DIST_TYPE, typename MTYPE,
+            typename BOUNDARY_FUNCTION, typename GTYPE>
+  void compute_gradient_central_difference_3D_row
+  (const STYPE * scalar, const std::ptrdiff_t axis_size[3],
+   const DIST_TYPE dist[3], const bool flag_magnitude,
+   const MTYPE min_magnitude, const bool flag_normalize,
+   const BOUNDARY_FUNCTION & compute_boundary_gradient,
+   const std::ptrdiff_t x0, const std::ptrdiff_t x1,
+   const std::ptrdiff_t y, const std::ptrdiff_t z,
+   GTYPE * gradient, MTYPE * magnitude)
+  {
+    const std::ptrdiff_t iv = z*axis_size[0]*axis_size[1] + y*axis_size[0] + x0;
+    MTYPE * magnitude_x0 = NULL;
+
+    if (magnitude != NULL) { magnitude_x0 = magnitude + iv; }
+
+    compute_gradient_central_difference_3D_row_segment
+      (scalar, axis_size, dist, flag_magnitude, min_magnitude, flag_normalize,
+       compute_boundary_gradient, x0, x1, y, z, gradient+3*iv, magnitude_x0);
+  }
+
+  /// Compute gradients of vertices in z-slices [z0,z1) of a 3D grid.
+  /// Same computations as compute_gradient_central_difference_3D_row().
+  template <typename STYPE, typename DIST_TYPE, typename MTYPE,
+            typename BOUNDARY_FUNCTION, typename GTYPE>
+  void compute_gradient_central_difference_3D_slices
+  (const STYPE * scalar, const std::ptrdiff_t axis_size[3],
+   const DIST_TYPE dist[3], const bool flag_magnitude,
+   const MTYPE min_magnitude, const bool flag_normalize,
+   const BOUNDARY_FUNCTION & compute_boundary_gradient,
+   const std::ptrdiff_t z0, const std::ptrdiff_t z1,
+   GTYPE * gradient, MTYPE * magnitude)
+  {
+    const std::ptrdiff_t nx = axis_size[0];
+    const std::ptrdiff_t ny = axis_size[1];
+
+    for (std::ptrdiff_t z = z0; z < z1; z++) {
+      for (std::ptrdiff_t y = 0; y < ny; y++) {
+        compute_gradient_central_difference_3D_row
+          (scalar, axis_size, dist, flag_magnitude, min_magnitude,
+           flag_normalize, compute_boundary_gradient, 0, nx, y, z,
+           gradient, magnitude);
+      }
+    }
+  }
+
+  /// Compute gradients of a 3D scalar grid using central difference.
+  /// Process z-slices in parallel.
+  /// Boundary vertices use compute_boundary_gradient(iv, gradient).
+  ///   compute_boundary_gradient must be safe to call from multiple threads.
+  /// Gradients with magnitude less than min_magnitude are set to zero.
+  /// @param dist[d] Divide differences along axis d by dist[d].
+  /// @param flag_normalize If true, normalize gradients with magnitude
+  ///   at least min_magnitude.
+  /// @param num_threads Number of threads.
+  ///   If num_threads is 0, use all hardware threads.
+  /// @param gradient[] Gradient coordinates.
+  ///   Gradient of vertex iv is (gradient[3*iv], ..., gradient[3*iv+2]).
+  /// @param magnitude[] Gradient magnitudes.
+  ///   If magnitude is NULL, magnitudes are not stored.
+  /// @pre scalar_grid.Dimension() = 3.
+  /// @pre Arrays gradient[] and magnitude[] are preallocated.
+  template <typename SGRID_TYPE, typename DIST_TYPE, typename MTYPE,
+            typename BOUNDARY_FUNCTION, typename GTYPE>
+  void compute_gradient_central_difference_3D
+  (const SGRID_TYPE & scalar_grid, const DIST_TYPE dist[3],
+   const MTYPE min_magnitude, const bool flag_normalize,
+   const int num_threads,
+   const BOUNDARY_FUNCTION & compute_boundary_gradient,
+   GTYPE * gradient, MTYPE * magnitude)
+  {
+    const bool flag_magnitude =
+      (magnitude != NULL || flag_normalize || min_magnitude > 0);
+    std::ptrdiff_t axis_size[3];
+
+    for (int d = 0; d < 3; d++)
+      { axis_size[d] = scalar_grid.AxisSize(d); }
+
+    for_each_block_in_parallel
+      (axis_size[2], num_threads,
+       [&](const std::ptrdiff_t z0, const std::ptrdiff_t z1) {
+        compute_gradient_central_difference_3D_slices
+          (scalar_grid.ScalarPtrConst(), axis_size, dist, flag_magnitude,
+           min_magnitude, flag_normalize, compute_boundary_gradient,
+           z0, z1, gradient, magnitude);
+      });
+  }
+
+  /// Compute gradients of a 3D scalar grid using central difference.
+  /// Version without magnitudes.
+  template <typename SGRID_TYPE, typename DIST_TYPE,
+            typename BOUNDARY_FUNCTION, typename GTYPE>
+  void compute_gradient_central_difference_3D
+  (const SGRID_TYPE & scalar_grid, const DIST_TYPE dist[3],
+   const int num_threads,
+   const BOUNDARY_FUNCTION & compute_boundary_gradient,
+   GTYPE * gradient)
+  {
+    GTYPE * magnitude = NULL;
+
+    compute_gradient_central_difference_3D
+      (scalar_grid, dist, GTYPE(0), false, num_threads,
+       compute_boundary_gradient, gradient, magnitude);
+  }
+
+}
+
+#endif
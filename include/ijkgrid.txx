@@ -281,6 +281,7 @@ namespace IJK {
     void InitLocal();
     void FreeLocal();
     void Create();            ///< Allocate and set data in GRID_PLUS.
+    void ComputeIncrements(); ///< Compute increments from axis_size[].
 
   public:
     /// Constructors.
@@ -1918,11 +1919,10 @@ namespace IJK {
   void compute_axis_increment
   (const DTYPE dimension, const ATYPE * axis_size, ITYPE * increment)
   {
-    IJK::PROCEDURE_ERROR error("compute_increment");
-
     if (dimension <= 0) { return; };
 
     if (axis_size == NULL || increment == NULL) {
+      IJK::PROCEDURE_ERROR error("compute_increment");
       error.AddMessage("Programming error. axis_size == NULL or increment == NULL.");
       throw error;
     }
@@ -2132,16 +2132,16 @@ namespace IJK {
   (const DTYPE dimension, const ITYPE1 * axis_increment, 
    ITYPE2 * cube_vertex_increment)
   {
-    IJK::PROCEDURE_ERROR error("compute_cube_vertex_increment");
-
     if (dimension <= 0) { return; };
 
     if (axis_increment == NULL) {
+      IJK::PROCEDURE_ERROR error("compute_cube_vertex_increment");
       error.AddMessage("Programming error. Array axis_increment[] must be allocated and set before calling compute_cube_vertex_increment.");
       throw error;
     }
 
     if (cube_vertex_increment == NULL) {
+      IJK::PROCEDURE_ERROR error("compute_cube_vertex_increment");
       error.AddMessage("Programming error. Array cube_vertex_increment[] must be allocated before calling compute_cube_vertex_increment.");
       throw error;
     }
@@ -2184,16 +2184,16 @@ namespace IJK {
   (const DTYPE dimension, const DTYPE ifacet,
    const ITYPE * cube_vertex_increment, ITYPE * facet_vertex_increment)
   {
-    IJK::PROCEDURE_ERROR error("compute_facet_vertex_increment");
-
     if (dimension <= 0) { return; };
 
     if (cube_vertex_increment == NULL) {
+      IJK::PROCEDURE_ERROR error("compute_facet_vertex_increment");
       error.AddMessage("Programming error. Array cube_vertex_increment[] must be allocated and set before calling compute_facet_vertex_increment.");
       throw error;
     }
 
     if (facet_vertex_increment == NULL) {
+      IJK::PROCEDURE_ERROR error("compute_facet_vertex_increment");
       error.AddMessage("Programming error. Array facet_vertex_increment[] must be allocated before calling compute_facet_vertex_increment.");
       throw error;
     }
@@ -2248,16 +2248,16 @@ namespace IJK {
   (const DTYPE dimension, const DTYPE orth_dir0, const DTYPE orth_dir1,
    const ITYPE * cube_vertex_increment, ITYPE * ridge_vertex_increment)
   {
-    IJK::PROCEDURE_ERROR error("compute_ridge_vertex_increment");
-
     if (dimension <= 0) { return; };
 
     if (cube_vertex_increment == NULL) {
+      IJK::PROCEDURE_ERROR error("compute_ridge_vertex_increment");
       error.AddMessage("Programming error. Array cube_vertex_increment[] must be allocated and set before calling compute_ridge_vertex_increment.");
       throw error;
     }
 
     if (ridge_vertex_increment == NULL) {
+      IJK::PROCEDURE_ERROR error("compute_ridge_vertex_increment");
       error.AddMessage("Programming error. Array ridge_vertex_increment[] must be allocated before calling compute_ridge_vertex_increment.");
       throw error;
     }
@@ -2279,6 +2279,7 @@ namespace IJK {
     }
 
     if (i != num_cube_ridge_vertices) {
+      IJK::PROCEDURE_ERROR error("compute_ridge_vertex_increment");
       error.AddMessage("Programming error.  Added ", i,
                        " values to ridge_vertex_increment[].");
       error.AddMessage("  Should have added ",
@@ -2405,14 +2406,16 @@ namespace IJK {
    const VTYPE subgrid_origin, const ATYPE * subgrid_axis_size, 
    VTYPE * vlist, NTYPE & num_subgrid_vertices)
   {
-    IJK::PROCEDURE_ERROR error("get_subgrid_vertices");
-
     compute_num_grid_vertices
       (dimension, subgrid_axis_size, num_subgrid_vertices);
     if (num_subgrid_vertices < 1) { return; };
     // Note: subgrid_axis_size[d] >= 1 for all d
 
-    if (!check_vertex_list(vlist, error)) { throw error; };
+    if (vlist == NULL) {
+      IJK::PROCEDURE_ERROR error("get_subgrid_vertices");
+      check_vertex_list(vlist, error);
+      throw error;
+    }
 
     // add vertices along dimension 0 to vlist.
     vlist[0] = subgrid_origin;
@@ -2440,9 +2443,12 @@ namespace IJK {
       prev_num_vertices = prev_num_vertices*subgrid_axis_size[d];
     }
 
-    if (!check_num_vertices_added
-        (prev_num_vertices, num_subgrid_vertices, error))
+    if (prev_num_vertices != num_subgrid_vertices) {
+      IJK::PROCEDURE_ERROR error("get_subgrid_vertices");
+      check_num_vertices_added
+        (prev_num_vertices, num_subgrid_vertices, error);
       throw error;
+    }
   }
 
   /// Get vertices in subgrid.
@@ -3883,24 +3889,30 @@ namespace IJK {
   void GRID<DTYPE,ATYPE,VTYPE,NTYPE>::SetSize
   (const DTYPE2 dimension, const ATYPE2 * axis_size)
   {
-    FreeAll();
+    // Reallocate axis_size[] only if dimension changes.
+    // Avoids reallocation when a grid is repeatedly resized.
+    if (dimension <= 0 || this->axis_size == NULL ||
+        this->dimension != dimension) {
 
-    if (dimension < 0) {
-      IJK::PROCEDURE_ERROR error("Grid::SetSize");
-      error.AddMessage("Programming error.  Illegal dimension ",
-                       dimension, ".");
-      error.AddMessage("Dimension should be non-negative.");
-      throw error;
-    }
+      FreeAll();
 
-    this->dimension = dimension;
-    this->axis_size = NULL;
-    if (dimension > 0)
-      { this->axis_size = new ATYPE[dimension]; }
-    else {
-      // allocate axis_size even if dimension equals 0
-      this->axis_size = new ATYPE[1];
-      this->axis_size[0] = 0;
+      if (dimension < 0) {
+        IJK::PROCEDURE_ERROR error("Grid::SetSize");
+        error.AddMessage("Programming error.  Illegal dimension ",
+                         dimension, ".");
+        error.AddMessage("Dimension should be non-negative.");
+        throw error;
+      }
+
+      this->dimension = dimension;
+      this->axis_size = NULL;
+      if (dimension > 0)
+        { this->axis_size = new ATYPE[dimension]; }
+      else {
+        // allocate axis_size even if dimension equals 0
+        this->axis_size = new ATYPE[1];
+        this->axis_size[0] = 0;
+      }
     }
       
     for (DTYPE d = 0; d < dimension; d++)
@@ -4732,6 +4744,19 @@ namespace IJK {
       new VTYPE[num_cube_ridge_vertices*dimension*dimension];
     this->unit_cube_coord = new NTYPE[num_cube_vertices*dimension];
 
+    ComputeIncrements();
+
+    compute_unit_cube_vertex_coord
+      (dimension, this->unit_cube_coord);
+  }
+
+  /// Compute axis, cube, facet and ridge vertex increments.
+  /// @pre Arrays are allocated to match \a dimension.
+  template <typename DTYPE, typename ATYPE, typename VTYPE, typename NTYPE> 
+  void GRID_PLUS<DTYPE,ATYPE,VTYPE,NTYPE>::ComputeIncrements()
+  {
+    const DTYPE dimension = this->Dimension();
+
     compute_increment
       (dimension, this->AxisSize(), this->axis_increment);
     compute_cube_vertex_increment
@@ -4758,9 +4783,6 @@ namespace IJK {
              this->ridge_vertex_increment+
              this->num_cube_ridge_vertices*(orth_dir0+dimension*orth_dir1));
         }
-
-    compute_unit_cube_vertex_coord
-      (dimension, this->unit_cube_coord);
   }
 
   /// Free memory in the derived typename GRID_PLUS.
@@ -4781,12 +4803,17 @@ namespace IJK {
   void GRID_PLUS<DTYPE,ATYPE,VTYPE,NTYPE>::SetSize
   (const DTYPE2 dimension, const ATYPE2 * axis_size)
   {
-    IJK::PROCEDURE_ERROR error("GRID_PLUS::SetSize");
-
-    FreeLocal();
-
-    GRID<DTYPE,ATYPE,VTYPE,NTYPE>::SetSize(dimension, axis_size);
-    Create();
+    if (dimension > 0 && dimension == this->Dimension() &&
+        axis_increment != NULL) {
+      // Reuse arrays.  Avoids reallocation when a grid is repeatedly resized.
+      GRID<DTYPE,ATYPE,VTYPE,NTYPE>::SetSize(dimension, axis_size);
+      ComputeIncrements();
+    }
+    else {
+      FreeLocal();
+      GRID<DTYPE,ATYPE,VTYPE,NTYPE>::SetSize(dimension, axis_size);
+      Create();
+    }
   }
 
   template <typename DTYPE, typename ATYPE, typename VTYPE, typename NTYPE> 
@@ -0,0 +1,134 @@
+/// \file ijkmmap.h
+/// Memory mapped files.
+/// - Memory mapping uses the POSIX routine mmap().
+/// - On systems without mmap(), MEMORY_MAPPED_FILE::IsSupported()
+///   returns false and MEMORY_MAPPED_FILE::Map() always fails.
+///   Callers should then read the file instead.
+
+/*
+  IJK: Isosurface Jeneration Kode
+  Copyright (C) 2015 Rephael Wenger
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef _IJKMMAP_
+#define _IJKMMAP_
+
+#include <cstddef>
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#define IJK_NO_MMAP
+#endif
+
+#ifndef IJK_NO_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace IJK {
+
+  // **************************************************
+  // CLASS MEMORY_MAPPED_FILE
+  // **************************************************
+
+  /// Memory mapped file.
+  /// The file is mapped privately.  Mapped bytes may be modified
+  ///   without changing the file.
+  class MEMORY_MAPPED_FILE {
+
+  protected:
+    char * map_ptr;          ///< Start of mapped file.
+    size_t map_length;       ///< Number of mapped bytes.
+
+    // copy constructor and assignment: NOT IMPLEMENTED
+    MEMORY_MAPPED_FILE(const MEMORY_MAPPED_FILE &);
+    const MEMORY_MAPPED_FILE & operator = (const MEMORY_MAPPED_FILE &);
+
+  public:
+    MEMORY_MAPPED_FILE() { map_ptr = NULL; map_length = 0; };
+    ~MEMORY_MAPPED_FILE() { Unmap(); };
+
+    /// Return true if memory mapping is supported on this system.
+    static bool IsSupported()
+    {
+#ifdef IJK_NO_MMAP
+      return(false);
+#else
+      return(true);
+#endif
+    }
+
+    /// Map entire file.
+    /// Return false if the file cannot be opened or mapped,
+    ///   if the file is empty or if mapping is not supported.
+    bool Map(const char * filename);
+
+    /// Unmap file.  Does nothing if no file is mapped.
+    void Unmap();
+
+    // Get functions.
+    bool IsMapped() const { return(map_ptr != NULL); };
+    char * Ptr() { return(map_ptr); };
+    const char * PtrConst() const { return(map_ptr); };
+    size_t Length() const { return(map_length); };
+  };
+
+  // **************************************************
+  // MEMORY_MAPPED_FILE MEMBER FUNCTIONS
+  // **************************************************
+
+  inline bool MEMORY_MAPPED_FILE::Map(const char * filename)
+  {
+    Unmap();
+
+#ifdef IJK_NO_MMAP
+    return(false);
+#else
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0) { return(false); }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+      close(fd);
+      return(false);
+    }
+
+    const size_t length = file_stat.st_size;
+    void * ptr =
+      mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) { return(false); }
+
+    map_ptr = (char *) ptr;
+    map_length = length;
+    return(true);
+#endif
+  }
+
+  inline void MEMORY_MAPPED_FILE::Unmap()
+  {
+#ifndef IJK_NO_MMAP
+    if (map_ptr != NULL) { munmap(map_ptr, map_length); }
+#endif
+    map_ptr = NULL;
+    map_length = 0;
+  }
+
+}
+
+#endif
@@ -385,12 +385,12 @@ namespace IJK {
     /// Project scalar grid onto minmax grid
     /// Compute min and max of projection
     void ProjectMinMax
-    (const DTYPE dimension, const ATYPE * axis_size, const STYPE * scalar,
+    (const ATYPE * axis_size, const STYPE * scalar,
      const ATYPE num_region_edges, const ATYPE facet_index,
      const ATYPE axis_increment);
 
     void ProjectMinMax
-    (const DTYPE dimension, const ATYPE * axis_size, const STYPE * scalar,
+    (const ATYPE * axis_size, const STYPE * scalar,
      const ATYPE istart, const ATYPE iend, const ATYPE ionto,
      const ATYPE axis_increment);
 
@@ -452,6 +452,88 @@ namespace IJK {
     void ComputeMinMax
     (const SCALAR_GRID_BASE<GRID_CLASS,STYPE> & scalar_grid,
      const ATYPE region_edge_length, const ATYPE offset_edge_length);
+
+    /// Compute min and max of regions formed by merging
+    ///   each 2x2x...x2 block of regions in \a child_regions.
+    /// Region edge length is twice the child region edge length.
+    void ComputeMinMax(const MINMAX_REGIONS<GRID_CLASS,STYPE> & child_regions);
+  };
+
+  // **************************************************
+  // TEMPLATE CLASS MINMAX_PYRAMID
+  // **************************************************
+
+  /// Hierarchy of min & max of scalar grid regions.
+  /// Level 0 stores min and max of regions with edge length
+  ///   region_edge_length.
+  /// Each region in level k+1 is the union of a 2x2x...x2 block
+  ///   of regions in level k.  The top level has a single region.
+  template <typename GRID_CLASS, typename STYPE>
+  class MINMAX_PYRAMID {
+
+  protected:
+    typedef typename GRID_CLASS::DIMENSION_TYPE DTYPE;
+    typedef typename GRID_CLASS::AXIS_SIZE_TYPE ATYPE;
+    typedef typename GRID_CLASS::VERTEX_INDEX_TYPE VTYPE;
+    typedef typename GRID_CLASS::NUMBER_TYPE NTYPE;
+
+    /// level[k] = Min and max of regions at level k.
+    std::vector< MINMAX_REGIONS<GRID_CLASS,STYPE> * > level;
+
+    void FreeAll();
+
+    /// Get active cubes in region iregion of level ilevel.
+    /// @param scratch_coord Scratch array of length at least
+    ///   (ilevel+4)*dimension.
+    template <typename SGRID_TYPE, typename VTYPE2>
+    void GetActiveCubesInRegion
+    (const SGRID_TYPE & scalar_grid, const STYPE s,
+     const NTYPE ilevel, const VTYPE iregion,
+     ATYPE * scratch_coord, std::vector<VTYPE2> & cube_list) const;
+
+  public:
+    MINMAX_PYRAMID() {};
+    ~MINMAX_PYRAMID() { FreeAll(); };
+
+    // copy constructor and assignment: NOT IMPLEMENTED
+    MINMAX_PYRAMID(const MINMAX_PYRAMID & minmax_pyramid);
+    const MINMAX_PYRAMID & operator = (const MINMAX_PYRAMID & right);
+
+    // get functions
+    NTYPE NumLevels() const { return(level.size()); };
+    const MINMAX_REGIONS<GRID_CLASS,STYPE> & Level(const NTYPE k) const
+    { return(*level[k]); };
+
+    /// Return region edge length of level 0.
+    ATYPE RegionEdgeLength() const
+    { 
+      if (level.size() == 0) { return(0); }
+      else { return(level[0]->RegionEdgeLength()); }
+    };
+
+    /// Compute all levels of the pyramid.
+    void ComputeMinMax
+    (const DTYPE dimension, const ATYPE * axis_size,
+     const STYPE * scalar, const ATYPE region_edge_length);
+
+    template <typename GRID_CLASS2>
+    void ComputeMinMax
+    (const SCALAR_GRID_BASE<GRID_CLASS2,STYPE> & scalar_grid,
+     const ATYPE region_edge_length)
+    {
+      ComputeMinMax(scalar_grid.Dimension(), scalar_grid.AxisSize(),
+                    scalar_grid.ScalarPtrConst(), region_edge_length);
+    }
+
+    /// Get list of cubes where \a s is greater than the min scalar value
+    ///   and less than or equal to the max scalar value of the cube vertices.
+    /// Skips regions whose min and max exclude \a s.
+    /// Returns cubes in increasing order of cube index.
+    /// @pre Pyramid was computed from scalar_grid.
+    template <typename SGRID_TYPE, typename VTYPE2>
+    void GetActiveCubes
+    (const SGRID_TYPE & scalar_grid, const STYPE s,
+     std::vector<VTYPE2> & cube_list) const;
   };
 
   // **************************************************
@@ -665,7 +747,7 @@ namespace IJK {
       for (ATYPE j = 0; j < num_regions_along_axis; j++) {
 
         minmax_grid.ProjectMinMax
-          (dimension, axis_size, scalar, region_edge_length, j*region_edge_length,
+          (axis_size, scalar, region_edge_length, j*region_edge_length,
            axis_increment[d_last]);
 
         minmax_grid.OverwriteWithMinMax(region_edge_length);
@@ -701,7 +783,7 @@ namespace IJK {
       for (ATYPE j = 0; j < num_regions_along_axis; j++) {
 
         minmax_grid.ProjectMinMax
-          (dimension, axis_size, scalar, region_edge_length, j*region_edge_length,
+          (axis_size, scalar, region_edge_length, j*region_edge_length,
            axis_increment[d_last]);
 
         region_min[iregion] = minmax_grid.Min(0);
@@ -781,7 +863,7 @@ namespace IJK {
         if (iend > axis_size[d_last]) { iend = axis_size[d_last]; };
 
         minmax_grid.ProjectMinMax
-          (dimension, axis_size, scalar, istart, iend, j*region_edge_length,
+          (axis_size, scalar, istart, iend, j*region_edge_length,
            axis_increment[d_last]);
 
         minmax_grid.OverwriteWithMinMax(region_edge_length, offset_edge_length);
@@ -822,7 +904,7 @@ namespace IJK {
         if (iend > axis_size[d_last]) { iend = axis_size[d_last]; };
 
         minmax_grid.ProjectMinMax
-          (dimension, axis_size, scalar, istart, iend, j*region_edge_length,
+          (axis_size, scalar, istart, iend, j*region_edge_length,
            axis_increment[d_last]);
 
         region_min[iregion] = minmax_grid.Min(0);
@@ -1621,12 +1703,12 @@ namespace IJK {
         (this->dimension, this->axis_size, elength.PtrConst(), vlist.Ptr());
 
       ATYPE num_subsample_vertices_along_axis =
-        compute_subsample_size(AxisSize(d), region_edge_length);
+        compute_subsample_size(this->AxisSize(d), region_edge_length);
 
       for (ATYPE j = 0; j < num_subsample_vertices_along_axis; j++) {
         ATYPE num_edges = region_edge_length;
-        if ((j+1)*region_edge_length +1 > AxisSize(d)) {
-          num_edges = AxisSize(d) - j*region_edge_length - 1;
+        if ((j+1)*region_edge_length +1 > this->AxisSize(d)) {
+          num_edges = this->AxisSize(d) - j*region_edge_length - 1;
         }
 
         VTYPE facet_increment = (j*region_edge_length)*axis_increment[d];
@@ -1727,7 +1809,7 @@ namespace IJK {
   template <typename GRID_CLASS, typename STYPE>
   void MINMAX_GRID<GRID_CLASS,STYPE>::
   ProjectMinMax
-  (const DTYPE dimension, const ATYPE * axis_size, const STYPE * scalar,
+  (const ATYPE * axis_size, const STYPE * scalar,
    const ATYPE region_edge_length, const ATYPE facet_index,
    const ATYPE axis_increment)
     // region_edge_length = number of grid edges per region edge
@@ -1770,7 +1852,7 @@ namespace IJK {
   template <typename GRID_CLASS, typename STYPE>
   void MINMAX_GRID<GRID_CLASS,STYPE>::
   ProjectMinMax
-  (const DTYPE dimension, const ATYPE * axis_size, const STYPE * scalar,
+  (const ATYPE * axis_size, const STYPE * scalar,
    const ATYPE istart, const ATYPE iend, const ATYPE ionto,
    const ATYPE axis_increment)
     // istart = starting hyperplane
@@ -1807,7 +1889,7 @@ namespace IJK {
    const ATYPE region_edge_length, const ATYPE facet_index,
    const ATYPE axis_increment)
   {
-    ProjectMinMax(scalar_grid.Dimension(), scalar_grid.AxisSize(),
+    ProjectMinMax(scalar_grid.AxisSize(),
                   scalar_grid.ScalarPtrConst(), region_edge_length,
                   facet_index, axis_increment);
   }
@@ -1863,7 +1945,7 @@ namespace IJK {
         compute_num_regions_along_axis(axis_size[d], region_edge_length);
     }
 
-    SetSize(dimension, num_regions_along_axis.PtrConst());
+    this->SetSize(dimension, num_regions_along_axis.PtrConst());
 
     compute_region_minmax
       (dimension, axis_size, scalar, region_edge_length,
@@ -1912,6 +1994,175 @@ namespace IJK {
                   offset_edge_length);
   }
 
+  /// Compute min and max of regions formed by merging
+  ///   each 2x2x...x2 block of regions in child_regions.
+  template <typename GRID_CLASS, typename STYPE>
+  void MINMAX_REGIONS<GRID_CLASS,STYPE>::ComputeMinMax
+  (const MINMAX_REGIONS<GRID_CLASS,STYPE> & child_regions)
+  {
+    const DTYPE dimension = child_regions.Dimension();
+    IJK::ARRAY<ATYPE> num_regions_along_axis(dimension);
+    IJK::ARRAY<ATYPE> coord(dimension);
+
+    this->region_edge_length = 2*child_regions.RegionEdgeLength();
+
+    for (DTYPE d = 0; d < dimension; d++) 
+      { num_regions_along_axis[d] = (child_regions.AxisSize(d)+1)/2; }
+
+    this->SetSize(dimension, num_regions_along_axis.PtrConst());
+
+    // Initialize with min and max of the first child region.
+    for (VTYPE iv = 0; iv < this->NumRegions(); iv++) {
+      this->ComputeCoord(iv, coord.Ptr());
+      for (DTYPE d = 0; d < dimension; d++) { coord[d] = 2*coord[d]; }
+      const VTYPE jv = child_regions.ComputeVertexIndex(coord.PtrConst());
+      this->scalar_min[iv] = child_regions.Min(jv);
+      this->scalar_max[iv] = child_regions.Max(jv);
+    }
+
+    for (VTYPE jv = 0; jv < child_regions.NumRegions(); jv++) {
+      child_regions.ComputeCoord(jv, coord.Ptr());
+      for (DTYPE d = 0; d < dimension; d++) { coord[d] = coord[d]/2; }
+      const VTYPE iv = this->ComputeVertexIndex(coord.PtrConst());
+
+      if (this->scalar_min[iv] > child_regions.Min(jv))
+        { this->scalar_min[iv] = child_regions.Min(jv); }
+      if (this->scalar_max[iv] < child_regions.Max(jv))
+        { this->scalar_max[iv] = child_regions.Max(jv); }
+    }
+  }
+
+  // **************************************************
+  // TEMPLATE CLASS MINMAX_PYRAMID MEMBER FUNCTIONS
+  // **************************************************
+
+  template <typename GRID_CLASS, typename STYPE>
+  void MINMAX_PYRAMID<GRID_CLASS,STYPE>::FreeAll()
+  {
+    for (size_t k = 0; k < level.size(); k++) 
+      { delete level[k]; }
+    level.clear();
+  }
+
+  /// Compute all levels of the pyramid.
+  template <typename GRID_CLASS, typename STYPE>
+  void MINMAX_PYRAMID<GRID_CLASS,STYPE>::ComputeMinMax
+  (const DTYPE dimension, const ATYPE * axis_size,
+   const STYPE * scalar, const ATYPE region_edge_length)
+  {
+    FreeAll();
+
+    if (dimension < 1) { return; }
+
+    level.push_back(new MINMAX_REGIONS<GRID_CLASS,STYPE>);
+    level[0]->ComputeMinMax
+      (dimension, axis_size, scalar, region_edge_length);
+
+    if (level[0]->NumRegions() < 1) { return; }
+
+    while (level.back()->NumRegions() > 1) {
+      const MINMAX_REGIONS<GRID_CLASS,STYPE> & child_regions = *level.back();
+      level.push_back(new MINMAX_REGIONS<GRID_CLASS,STYPE>);
+      level.back()->ComputeMinMax(child_regions);
+    }
+  }
+
+  /// Get list of active cubes, skipping regions whose min and max exclude s.
+  template <typename GRID_CLASS, typename STYPE>
+  template <typename SGRID_TYPE, typename VTYPE2>
+  void MINMAX_PYRAMID<GRID_CLASS,STYPE>::GetActiveCubes
+  (const SGRID_TYPE & scalar_grid, const STYPE s,
+   std::vector<VTYPE2> & cube_list) const
+  {
+    cube_list.clear();
+
+    if (level.size() == 0) { return; }
+
+    const NTYPE itop = level.size()-1;
+    const DTYPE dimension = level[itop]->Dimension();
+    IJK::ARRAY<ATYPE> scratch_coord((itop+4)*dimension);
+
+    for (VTYPE iregion = 0; iregion < level[itop]->NumRegions(); iregion++) {
+      GetActiveCubesInRegion
+        (scalar_grid, s, itop, iregion, scratch_coord.Ptr(), cube_list);
+    }
+
+    std::sort(cube_list.begin(), cube_list.end());
+  }
+
+  /// Get active cubes in region iregion of level ilevel.
+  /// Region coordinates at level ilevel are stored in
+  ///   scratch_coord[(ilevel+3)*dimension].  Lower levels and the cube
+  ///   loop use the locations before it, so no allocation is needed
+  ///   in the recursion.
+  template <typename GRID_CLASS, typename STYPE>
+  template <typename SGRID_TYPE, typename VTYPE2>
+  void MINMAX_PYRAMID<GRID_CLASS,STYPE>::GetActiveCubesInRegion
+  (const SGRID_TYPE & scalar_grid, const STYPE s,
+   const NTYPE ilevel, const VTYPE iregion,
+   ATYPE * scratch_coord, std::vector<VTYPE2> & cube_list) const
+  {
+    const MINMAX_REGIONS<GRID_CLASS,STYPE> & regions = *level[ilevel];
+    const DTYPE dimension = regions.Dimension();
+    ATYPE * coord = scratch_coord + (ilevel+3)*dimension;
+    ATYPE * coord2 = scratch_coord;
+
+    // Same test as is_gt_cube_min_le_cube_max().
+    if (!(regions.Min(iregion) < s && s <= regions.Max(iregion))) 
+      { return; }
+
+    regions.ComputeCoord(iregion, coord);
+
+    if (ilevel > 0) {
+      const MINMAX_REGIONS<GRID_CLASS,STYPE> & child_regions = 
+        *level[ilevel-1];
+      const NTYPE num_children = (NTYPE(1) << dimension);
+
+      for (NTYPE k = 0; k < num_children; k++) {
+        bool is_in_grid = true;
+        for (DTYPE d = 0; d < dimension; d++) {
+          coord2[d] = 2*coord[d] + ((k >> d) & 1);
+          if (coord2[d] >= child_regions.AxisSize(d)) { is_in_grid = false; }
+        }
+
+        if (is_in_grid) {
+          const VTYPE jregion = child_regions.ComputeVertexIndex(coord2);
+          GetActiveCubesInRegion
+            (scalar_grid, s, ilevel-1, jregion, scratch_coord, cube_list);
+        }
+      }
+    }
+    else {
+      // Visit cubes in region.
+      const ATYPE region_edge_length = regions.RegionEdgeLength();
+      ATYPE * cube_coord0 = scratch_coord + dimension;
+      ATYPE * cube_coord1 = scratch_coord + 2*dimension;
+
+      for (DTYPE d = 0; d < dimension; d++) {
+        cube_coord0[d] = coord[d]*region_edge_length;
+        cube_coord1[d] = cube_coord0[d] + region_edge_length;
+        if (cube_coord1[d] > scalar_grid.AxisSize(d)-1)
+          { cube_coord1[d] = scalar_grid.AxisSize(d)-1; }
+        if (cube_coord0[d] >= cube_coord1[d]) { return; }
+        coord2[d] = cube_coord0[d];
+      }
+
+      while (true) {
+        const VTYPE2 icube = scalar_grid.ComputeVertexIndex(coord2);
+        if (is_gt_cube_min_le_cube_max(scalar_grid, icube, s))
+          { cube_list.push_back(icube); }
+
+        DTYPE d = 0;
+        while (d < dimension && coord2[d]+1 >= cube_coord1[d]) {
+          coord2[d] = cube_coord0[d];
+          d++;
+        }
+        if (d >= dimension) { break; }
+        coord2[d]++;
+      }
+    }
+  }
+
   // **************************************************
   // SCALAR GRID TEMPLATE FUNCTIONS
   // **************************************************
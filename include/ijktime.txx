@@ -25,7 +25,18 @@
 #ifndef _IJKTIME_
 #define _IJKTIME_
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <ctime>
+#include <iomanip>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace IJK {
 
@@ -39,6 +50,416 @@ namespace IJK {
     seconds = S_TYPE(t)/CLOCKS_PER_SEC;
   }
 
+  // **************************************************
+  // WALL CLOCK TIME
+  // **************************************************
+
+  /// Wall clock time point.
+  typedef std::chrono::steady_clock::time_point WALL_TIME_POINT;
+
+  /// Wall clock duration.
+  typedef std::chrono::steady_clock::duration WALL_TIME_DURATION;
+
+  /// Return current wall clock time.
+  inline WALL_TIME_POINT wall_clock()
+  {
+    return(std::chrono::steady_clock::now());
+  }
+
+  /// Convert wall clock duration to seconds.
+  template <typename S_TYPE>
+  inline void clock2seconds(const WALL_TIME_DURATION t, S_TYPE & seconds)
+  {
+    seconds = std::chrono::duration<S_TYPE>(t).count();
+  }
+
+  // **************************************************
+  // CLASS STAGE_PROFILER
+  // **************************************************
+
+  /// Hierarchical wall clock profiler.
+  /// - Stages are named and nested.  A stage begun while another stage
+  ///   is running in the same thread is a child of the running stage.
+  /// - Each thread accumulates its own stage times.
+  ///   Begin() and End() lock only on the first call from a thread.
+  /// - Stage names are stored as pointers.  Names should be string
+  ///   literals or otherwise outlive the profiler.
+  class STAGE_PROFILER {
+
+  protected:
+
+    /// Stage in the stage tree of a single thread.
+    class STAGE_NODE {
+
+    public:
+      const char * name;
+      int parent;                  ///< Index of parent.  -1 for root.
+      std::vector<int> child;      ///< Indices of children.
+      double seconds;              ///< Total wall time in stage.
+      long num_calls;              ///< Number of times stage was run.
+
+      STAGE_NODE(const char * name, const int parent):
+        name(name), parent(parent), seconds(0), num_calls(0) {};
+    };
+
+    /// Completed stage, recorded for trace output.
+    class TRACE_EVENT {
+
+    public:
+      const char * name;
+      double start;                ///< Start time in microseconds.
+      double duration;             ///< Duration in microseconds.
+    };
+
+    /// Stage tree and trace events of a single thread.
+    class THREAD_DATA {
+
+    public:
+      std::thread::id thread_id;
+      std::vector<STAGE_NODE> node;   ///< Stage tree.  node[0] is the root.
+      int current;                    ///< Index of running stage.
+      std::vector<WALL_TIME_POINT> start_time;  ///< Running stage starts.
+      std::vector<TRACE_EVENT> trace;
+
+      THREAD_DATA(const std::thread::id thread_id):
+        thread_id(thread_id), node(1, STAGE_NODE("", -1)), current(0) {};
+    };
+
+    /// Row of the stage table.  Combines a stage over all threads.
+    class TABLE_NODE {
+
+    public:
+      const char * name;
+      std::vector<int> child;
+      double seconds;              ///< Total wall time over all threads.
+      double max_thread_seconds;   ///< Max wall time in a single thread.
+      long num_calls;
+      int num_threads;
+
+      TABLE_NODE(const char * name):
+        name(name), seconds(0), max_thread_seconds(0), 
+        num_calls(0), num_threads(0) {};
+    };
+
+    /// Unique profiler identifier.  Used to cache thread data.
+    const unsigned long profiler_id;
+
+    /// Start time of profiler.  Trace events are relative to start time.
+    WALL_TIME_POINT profiler_start_time;
+
+    /// If true, record trace events.
+    bool flag_trace;
+
+    /// Record trace events only for stages running at least
+    ///   min_trace_seconds.
+    double min_trace_seconds;
+
+    /// Data for each thread.  A list so thread data never moves.
+    std::list<THREAD_DATA> thread_data;
+    mutable std::mutex thread_data_mutex;
+
+    static unsigned long NewProfilerId()
+    {
+      static std::atomic<unsigned long> next_id(1);
+      return(next_id++);
+    }
+
+    /// Return data for the calling thread.
+    THREAD_DATA * ThreadData();
+
+    /// Add thread stage tree below node ithread to table below node itable.
+    void AddToTable
+    (const THREAD_DATA & data, const int ithread, const int itable,
+     std::vector<TABLE_NODE> & table) const;
+
+    /// Print table node and its descendants.
+    void PrintTableNode
+    (std::ostream & out, const std::string & line_prefix,
+     const std::vector<TABLE_NODE> & table, const int itable,
+     const int depth) const;
+
+  public:
+    STAGE_PROFILER():
+      profiler_id(NewProfilerId()), profiler_start_time(wall_clock()),
+      flag_trace(false), min_trace_seconds(1.0e-5) {};
+
+    /// Begin stage.  Stage is a child of the running stage.
+    void Begin(const char * stage_name);
+
+    /// End running stage.
+    void End();
+
+    /// Set flag for recording trace events.
+    /// @param min_seconds Record only stages running at least min_seconds.
+    void SetTrace(const bool flag, const double min_seconds = 1.0e-5)
+    {
+      flag_trace = flag;
+      min_trace_seconds = min_seconds;
+    }
+
+    /// Return true if recording trace events.
+    bool Trace() const
+    { return(flag_trace); }
+
+    /// Clear all stage times and trace events.
+    /// @pre No stage is running.
+    void Clear();
+
+    /// Print table of stage times.
+    void PrintTable
+    (std::ostream & out, const std::string & line_prefix) const;
+
+    /// Write trace events in Chrome trace event format (JSON).
+    /// View with chrome://tracing or https://ui.perfetto.dev.
+    void WriteChromeTrace(std::ostream & out) const;
+
+  private:
+    STAGE_PROFILER(const STAGE_PROFILER &);               // not implemented
+    STAGE_PROFILER & operator = (const STAGE_PROFILER &); // not implemented
+  };
+
+  // **************************************************
+  // CLASS SCOPED_STAGE
+  // **************************************************
+
+  /// Run stage from construction to destruction.
+  /// Does nothing if profiler is NULL.
+  class SCOPED_STAGE {
+
+  protected:
+    STAGE_PROFILER * profiler;
+
+  public:
+    SCOPED_STAGE(STAGE_PROFILER * profiler, const char * stage_name):
+      profiler(profiler)
+    { if (profiler != NULL) { profiler->Begin(stage_name); } }
+
+    ~SCOPED_STAGE()
+    { End(); }
+
+    /// End stage before destruction.
+    void End()
+    {
+      if (profiler != NULL) { profiler->End(); }
+      profiler = NULL;
+    }
+
+  private:
+    SCOPED_STAGE(const SCOPED_STAGE &);               // not implemented
+    SCOPED_STAGE & operator = (const SCOPED_STAGE &); // not implemented
+  };
+
+  // **************************************************
+  // STAGE_PROFILER MEMBER FUNCTIONS
+  // **************************************************
+
+  inline STAGE_PROFILER::THREAD_DATA * STAGE_PROFILER::ThreadData()
+  {
+    // Cache thread data of the last profiler used by this thread.
+    static thread_local unsigned long cached_profiler_id = 0;
+    static thread_local THREAD_DATA * cached_data = NULL;
+
+    if (cached_profiler_id == profiler_id) { return(cached_data); }
+
+    const std::thread::id thread_id = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(thread_data_mutex);
+
+    THREAD_DATA * data = NULL;
+    for (std::list<THREAD_DATA>::iterator iter = thread_data.begin();
+         iter != thread_data.end(); iter++) {
+      if (iter->thread_id == thread_id) 
+        { data = &(*iter); break; }
+    }
+
+    if (data == NULL) {
+      thread_data.push_back(THREAD_DATA(thread_id));
+      data = &thread_data.back();
+    }
+
+    cached_profiler_id = profiler_id;
+    cached_data = data;
+    return(data);
+  }
+
+  inline void STAGE_PROFILER::Begin(const char * stage_name)
+  {
+    THREAD_DATA * data = ThreadData();
+    const int iparent = data->current;
+
+    int ichild = -1;
+    const std::vector<int> & child = data->node[iparent].child;
+    for (size_t j = 0; j < child.size(); j++) {
+      const char * name = data->node[child[j]].name;
+      if (name == stage_name || std::strcmp(name, stage_name) == 0)
+        { ichild = child[j]; break; }
+    }
+
+    if (ichild < 0) {
+      ichild = data->node.size();
+      data->node.push_back(STAGE_NODE(stage_name, iparent));
+      data->node[iparent].child.push_back(ichild);
+    }
+
+    data->current = ichild;
+    data->start_time.push_back(wall_clock());
+  }
+
+  inline void STAGE_PROFILER::End()
+  {
+    const WALL_TIME_POINT end_time = wall_clock();
+    THREAD_DATA * data = ThreadData();
+
+    if (data->start_time.empty()) { return; }
+
+    const WALL_TIME_POINT start_time = data->start_time.back();
+    data->start_time.pop_back();
+
+    double seconds;
+    clock2seconds(end_time-start_time, seconds);
+
+    STAGE_NODE & stage = data->node[data->current];
+    stage.seconds += seconds;
+    stage.num_calls++;
+
+    if (flag_trace && seconds >= min_trace_seconds) {
+      TRACE_EVENT event;
+      double start;
+      clock2seconds(start_time-profiler_start_time, start);
+      event.name = stage.name;
+      event.start = 1.0e6*start;
+      event.duration = 1.0e6*seconds;
+      data->trace.push_back(event);
+    }
+
+    data->current = stage.parent;
+  }
+
+  inline void STAGE_PROFILER::Clear()
+  {
+    std::lock_guard<std::mutex> lock(thread_data_mutex);
+
+    // Keep thread data so that cached pointers remain valid.
+    for (std::list<THREAD_DATA>::iterator iter = thread_data.begin();
+         iter != thread_data.end(); iter++) {
+      iter->node.assign(1, STAGE_NODE("", -1));
+      iter->current = 0;
+      iter->start_time.clear();
+      iter->trace.clear();
+    }
+    profiler_start_time = wall_clock();
+  }
+
+  inline void STAGE_PROFILER::AddToTable
+  (const THREAD_DATA & data, const int ithread, const int itable,
+   std::vector<TABLE_NODE> & table) const
+  {
+    const std::vector<int> & child = data.node[ithread].child;
+    for (size_t j = 0; j < child.size(); j++) {
+      const STAGE_NODE & stage = data.node[child[j]];
+
+      int k = -1;
+      for (size_t m = 0; m < table[itable].child.size(); m++) {
+        const int k2 = table[itable].child[m];
+        if (std::strcmp(table[k2].name, stage.name) == 0)
+          { k = k2; break; }
+      }
+
+      if (k < 0) {
+        k = table.size();
+        table.push_back(TABLE_NODE(stage.name));
+        table[itable].child.push_back(k);
+      }
+
+      table[k].seconds += stage.seconds;
+      table[k].num_calls += stage.num_calls;
+      table[k].num_threads++;
+      if (stage.seconds > table[k].max_thread_seconds)
+        { table[k].max_thread_seconds = stage.seconds; }
+
+      AddToTable(data, child[j], k, table);
+    }
+  }
+
+  inline void STAGE_PROFILER::PrintTableNode
+  (std::ostream & out, const std::string & line_prefix,
+   const std::vector<TABLE_NODE> & table, const int itable,
+   const int depth) const
+  {
+    const TABLE_NODE & row = table[itable];
+    std::string name = std::string(2*depth, ' ') + row.name;
+
+    out << line_prefix << std::left << std::setw(32) << name << std::right
+        << std::setw(10) << row.num_calls 
+        << std::setw(8) << row.num_threads
+        << std::fixed << std::setprecision(4)
+        << std::setw(12) << row.seconds
+        << std::setw(12) << row.max_thread_seconds << std::endl;
+    out.unsetf(std::ios::fixed);
+
+    for (size_t j = 0; j < row.child.size(); j++)
+      { PrintTableNode(out, line_prefix, table, row.child[j], depth+1); }
+  }
+
+  inline void STAGE_PROFILER::PrintTable
+  (std::ostream & out, const std::string & line_prefix) const
+  {
+    std::vector<TABLE_NODE> table(1, TABLE_NODE(""));
+
+    {
+      std::lock_guard<std::mutex> lock(thread_data_mutex);
+      for (std::list<THREAD_DATA>::const_iterator iter = thread_data.begin();
+           iter != thread_data.end(); iter++)
+        { AddToTable(*iter, 0, 0, table); }
+    }
+
+    const std::streamsize precision = out.precision();
+    out << line_prefix << std::left << std::setw(32) << "Stage" << std::right
+        << std::setw(10) << "Calls" << std::setw(8) << "Threads"
+        << std::setw(12) << "Wall(s)" << std::setw(12) << "Max thr(s)"
+        << std::endl;
+
+    for (size_t j = 0; j < table[0].child.size(); j++)
+      { PrintTableNode(out, line_prefix, table, table[0].child[j], 0); }
+    out.precision(precision);
+  }
+
+  inline void STAGE_PROFILER::WriteChromeTrace(std::ostream & out) const
+  {
+    std::lock_guard<std::mutex> lock(thread_data_mutex);
+
+    out << "{\"traceEvents\":[";
+
+    int tid = 0;
+    bool flag_first = true;
+    for (std::list<THREAD_DATA>::const_iterator iter = thread_data.begin();
+         iter != thread_data.end(); iter++) {
+
+      for (size_t j = 0; j < iter->trace.size(); j++) {
+        const TRACE_EVENT & event = iter->trace[j];
+
+        std::string name;
+        for (const char * s = event.name; *s != '\0'; s++) {
+          if (*s == '"' || *s == '\\') { name += '\\'; }
+          name += *s;
+        }
+
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(3)
+             << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":0"
+             << ",\"tid\":" << tid << ",\"ts\":" << event.start
+             << ",\"dur\":" << event.duration << "}";
+
+        if (!flag_first) { out << ","; }
+        out << std::endl << line.str();
+        flag_first = false;
+      }
+
+      tid++;
+    }
+
+    out << std::endl << "]}" << std::endl;
+  }
+
 }
 
 #endif
@@ -25,6 +25,7 @@
 #define _SHARPISO_GRIDS_
 
 #include <algorithm>
+#include <cmath>
 
 #include "sharpiso_types.h"
 
@@ -49,8 +50,86 @@ namespace SHARPISO {
 
   typedef IJK::GRID_PLUS<NUM_TYPE, AXIS_SIZE_TYPE, VERTEX_INDEX, NUM_TYPE>
     GRID_PLUS;                      ///< Regular grid.
-  typedef IJK::GRID_SPACING<COORD_TYPE, GRID_PLUS>
-    SHARPISO_GRID;                  ///< Grid and spacing information.
+  /// Grid and spacing information.
+  /// The grid may be a subgrid, such as a z-slab, of a larger grid.
+  ///   Vertex 0 has grid coordinates coord_offset[] in the larger grid.
+  ///   Scaled coordinates are coordinates in the larger grid.
+  ///   Vertex indices and unscaled coordinates are in the subgrid.
+  class SHARPISO_GRID:public IJK::GRID_SPACING<COORD_TYPE, GRID_PLUS> {
+
+  protected:
+    typedef IJK::GRID_SPACING<COORD_TYPE, GRID_PLUS> BASE_CLASS;
+
+    /// Grid coordinates of vertex 0 in the larger grid.
+    GRID_COORD_TYPE coord_offset[DIM3];
+
+    void InitCoordOffset()
+    { for (int d = 0; d < DIM3; d++) { coord_offset[d] = 0; } }
+
+  public:
+    SHARPISO_GRID() { InitCoordOffset(); };
+    template <typename DTYPE2, typename ATYPE2>
+    SHARPISO_GRID(const DTYPE2 dimension, const ATYPE2 * axis_size):
+      BASE_CLASS(dimension, axis_size)
+    { InitCoordOffset(); };
+    template <typename DTYPE2, typename ATYPE2, typename VTYPE2,
+              typename NTYPE2>
+    SHARPISO_GRID(const IJK::GRID<DTYPE2,ATYPE2,VTYPE2,NTYPE2> & grid2):
+      BASE_CLASS(grid2)
+    { InitCoordOffset(); };
+    SHARPISO_GRID(const SHARPISO_GRID & grid2):BASE_CLASS(grid2)
+    { SetCoordOffset(grid2.CoordOffsetPtrConst()); };
+
+    /// Set grid coordinates of vertex 0 in the larger grid.
+    void SetCoordOffset(const GRID_COORD_TYPE * coord_offset2)
+    { std::copy(coord_offset2, coord_offset2+DIM3, coord_offset); }
+
+    /// Return coordinate d of vertex 0 in the larger grid.
+    GRID_COORD_TYPE CoordOffset(const int d) const
+    { return(coord_offset[d]); }
+
+    /// Return pointer to coordinates of vertex 0 in the larger grid.
+    const GRID_COORD_TYPE * CoordOffsetPtrConst() const
+    { return(coord_offset); }
+
+    /// Compute scaled coordinates of vertex iv in the larger grid.
+    /// Same as BASE_CLASS::ComputeScaledCoord() if coord_offset[] is zero.
+    template <typename VTYPE2, typename CTYPE>
+    void ComputeScaledCoord(const VTYPE2 iv, CTYPE * coord) const
+    {
+      this->ComputeCoord(iv, coord);
+      for (int d = 0; d < this->Dimension(); d++)
+        { coord[d] = (coord[d] + coord_offset[d])*this->Spacing(d); }
+    }
+
+    /// Compute scaled coordinates of cube center in the larger grid.
+    template <typename VTYPE2, typename CTYPE>
+    void ComputeCubeCenterScaledCoord(const VTYPE2 iv, CTYPE * coord) const
+    {
+      ComputeScaledCoord(iv, coord);
+      for (int d = 0; d < this->Dimension(); d++)
+        { coord[d] += this->Spacing(d)/2.0; }
+    }
+
+    /// Return true if grid contains point.
+    /// Point coordinates are in the larger grid.
+    template <typename CTYPE>
+    bool ContainsPoint(const CTYPE * coord) const
+    {
+      for (int d = 0; d < this->Dimension(); d++) {
+        if (coord[d] < coord_offset[d] ||
+            coord[d]+1 > coord_offset[d]+this->AxisSize(d))
+          { return(false); }
+      }
+      return(true);
+    }
+
+    /// Return true if grid contains point.
+    template <typename CTYPE>
+    bool ContainsPoint(const std::vector<CTYPE> & coord) const
+    { return(ContainsPoint(&(coord[0]))); }
+  };
+
   typedef IJK::GRID_NEIGHBORS
     <NUM_TYPE, AXIS_SIZE_TYPE, VERTEX_INDEX, INDEX_DIFF_TYPE, NUM_TYPE>
     GRID_NEIGHBORS;                 ///< Grid with neighbor data.
@@ -63,12 +142,6 @@ namespace SHARPISO {
     SHARPISO_SCALAR_GRID_WRAPPER;   ///< sharpiso scalar grid wrapper.
   typedef IJK::SCALAR_GRID<SHARPISO_GRID, SCALAR_TYPE>
     SHARPISO_SCALAR_GRID;           ///< sharpiso scalar grid.
-  typedef IJK::VECTOR_GRID_BASE
-    <SHARPISO_GRID, GRADIENT_LENGTH_TYPE, GRADIENT_COORD_TYPE>
-    GRADIENT_GRID_BASE;             ///<  sharpiso base gradient grid
-  typedef IJK::VECTOR_GRID
-    <SHARPISO_GRID, GRADIENT_LENGTH_TYPE, GRADIENT_COORD_TYPE>
-    GRADIENT_GRID;                  ///< sharpiso gradient grid
 
   /// Index grid.  Signed to allow for -1.
   typedef IJK::SCALAR_GRID<SHARPISO_GRID, INDEX_DIFF_TYPE> SHARPISO_INDEX_GRID;
@@ -83,6 +156,267 @@ namespace SHARPISO {
   typedef IJK::BOOL_GRID<SHARPISO_GRID> 
     SHARPISO_BOOL_GRID;             ///< Boolean grid.
 
+  /// Hierarchy of min and max scalar values of grid regions.
+  typedef IJK::MINMAX_PYRAMID
+    <IJK::GRID<NUM_TYPE, AXIS_SIZE_TYPE, VERTEX_INDEX, NUM_TYPE>, SCALAR_TYPE>
+    SHARPISO_MINMAX_PYRAMID;
+
+
+  // **************************************************
+  // GRADIENT GRID BASE
+  // **************************************************
+
+  /// Number of grid vertices along each axis of a gradient block.
+  const AXIS_SIZE_TYPE GRADIENT_BLOCK_WIDTH = 8;
+  const int GRADIENT_BLOCK_WIDTH_BITS = 3;  ///< log2(GRADIENT_BLOCK_WIDTH)
+  const NUM_TYPE GRADIENT_BLOCK_NUM_VERTICES = 512;
+
+  /// sharpiso base gradient grid.
+  /// Gradients are stored in array vec[] of all grid vertices
+  ///   or in blocks of GRADIENT_BLOCK_WIDTH^3 vertices.
+  /// Block storage is used if block_gradient is not NULL.
+  ///   block_gradient[ib] points to the gradients of block ib
+  ///   or is NULL if no gradients of block ib are stored.
+  ///   Gradients which are not stored are zero.
+  /// VectorPtrConst(iv), Vector(iv,ic) and the magnitude functions
+  ///   support both storage types.  Functions which access all of vec[],
+  ///   such as VectorPtr(), Copy() or Subsample(), require array storage.
+  /// Does not allocate or free gradients.
+  class GRADIENT_GRID_BASE:public IJK::VECTOR_GRID_BASE
+  <SHARPISO_GRID, GRADIENT_LENGTH_TYPE, GRADIENT_COORD_TYPE> {
+
+  protected:
+    typedef IJK::VECTOR_GRID_BASE
+    <SHARPISO_GRID, GRADIENT_LENGTH_TYPE, GRADIENT_COORD_TYPE> BASE_CLASS;
+
+    /// If not NULL, gradients are stored in blocks.
+    GRADIENT_COORD_TYPE * const * block_gradient;
+
+    /// Number of blocks along each axis.
+    VERTEX_INDEX num_blocks_along_axis[DIM3];
+
+    /// Set pointer to block gradients.
+    /// @param block_gradient[] Array of pointers to block gradients.
+    ///   Length is at least NumBlocks().
+    void SetBlockGradient(GRADIENT_COORD_TYPE * const * block_gradient)
+    { this->block_gradient = block_gradient; }
+
+    /// Compute number of blocks along each axis from grid axis sizes.
+    /// @pre Dimension() == DIM3.
+    void ComputeNumBlocksAlongAxis()
+    {
+      for (int d = 0; d < DIM3; d++) {
+        num_blocks_along_axis[d] = 
+          (this->AxisSize(d) + GRADIENT_BLOCK_WIDTH - 1) / 
+          GRADIENT_BLOCK_WIDTH;
+      }
+    }
+
+  public:
+    GRADIENT_GRID_BASE()
+    {
+      block_gradient = NULL;
+      for (int d = 0; d < DIM3; d++) { num_blocks_along_axis[d] = 0; }
+    };
+    GRADIENT_GRID_BASE
+    (const int dimension, const AXIS_SIZE_TYPE * axis_size,
+     const GRADIENT_LENGTH_TYPE vector_length):
+      BASE_CLASS(dimension, axis_size, vector_length)
+    {
+      block_gradient = NULL;
+      for (int d = 0; d < DIM3; d++) { num_blocks_along_axis[d] = 0; }
+    };
+
+    /// Return true if gradients are stored in blocks.
+    bool IsStoredInBlocks() const
+    { return(block_gradient != NULL); }
+
+    /// Return number of blocks.
+    VERTEX_INDEX NumBlocks() const
+    { return(num_blocks_along_axis[0]*num_blocks_along_axis[1]*
+             num_blocks_along_axis[2]); }
+
+    /// Compute block containing vertex iv 
+    ///   and location of vertex iv in the block.
+    void ComputeBlockLocation
+    (const VERTEX_INDEX iv, VERTEX_INDEX & iblock, NUM_TYPE & k) const
+    {
+      const VERTEX_INDEX x = iv % this->AxisSize(0);
+      const VERTEX_INDEX yz = iv / this->AxisSize(0);
+      const VERTEX_INDEX y = yz % this->AxisSize(1);
+      const VERTEX_INDEX z = yz / this->AxisSize(1);
+      const int nbits = GRADIENT_BLOCK_WIDTH_BITS;
+      const VERTEX_INDEX mask = GRADIENT_BLOCK_WIDTH-1;
+
+      iblock = (x >> nbits) + num_blocks_along_axis[0]*
+        ((y >> nbits) + num_blocks_along_axis[1]*(z >> nbits));
+      k = (x & mask) + 
+        (((y & mask) + ((z & mask) << nbits)) << nbits);
+    }
+
+    /// Return pointer to gradient at iv.
+    using BASE_CLASS::VectorPtrConst;
+    const GRADIENT_COORD_TYPE * VectorPtrConst(const VERTEX_INDEX iv) const
+    {
+      if (block_gradient == NULL) 
+        { return(this->vec + iv*this->vector_length); }
+
+      static const GRADIENT_COORD_TYPE zero_vector[DIM3] = { 0, 0, 0 };
+      VERTEX_INDEX iblock;
+      NUM_TYPE k;
+      ComputeBlockLocation(iv, iblock, k);
+      if (block_gradient[iblock] == NULL) { return(zero_vector); }
+      return(block_gradient[iblock] + k*DIM3);
+    }
+
+    /// Return coordinate ic of gradient at iv.
+    GRADIENT_COORD_TYPE Vector
+    (const VERTEX_INDEX iv, const GRADIENT_LENGTH_TYPE ic) const
+    { return(VectorPtrConst(iv)[ic]); }
+
+    /// Compute squared magnitude of gradient at iv.
+    GRADIENT_COORD_TYPE ComputeMagnitudeSquared(const VERTEX_INDEX iv) const
+    {
+      GRADIENT_COORD_TYPE magnitude_squared = 0;
+      const GRADIENT_COORD_TYPE * v_ptr = VectorPtrConst(iv);
+      for (GRADIENT_LENGTH_TYPE d = 0; d < this->VectorLength(); d++) {
+        GRADIENT_COORD_TYPE s = v_ptr[d];
+        magnitude_squared += s*s;
+      }
+      return(magnitude_squared);
+    }
+
+    /// Compute magnitude of gradient at iv.
+    GRADIENT_COORD_TYPE ComputeMagnitude(const VERTEX_INDEX iv) const
+    {
+      GRADIENT_COORD_TYPE magnitude = ComputeMagnitudeSquared(iv);
+      if (magnitude > 0.0)
+        { magnitude = std::sqrt(magnitude); }
+      return(magnitude);
+    }
+
+    /// Return true if magnitude is greater than or equal to mag.
+    template <typename MAG_TYPE>
+    bool IsMagnitudeGE(const VERTEX_INDEX iv, const MAG_TYPE mag) const
+    { return(ComputeMagnitudeSquared(iv) >= (mag*mag)); }
+
+    /// Return true if magnitude is greater than mag.
+    template <typename MAG_TYPE>
+    bool IsMagnitudeGT(const VERTEX_INDEX iv, const MAG_TYPE mag) const
+    { return(ComputeMagnitudeSquared(iv) > (mag*mag)); }
+  };
+
+  typedef IJK::VECTOR_GRID_ALLOC<GRADIENT_GRID_BASE>
+    GRADIENT_GRID;                  ///< sharpiso gradient grid
+
+
+  // **************************************************
+  // EDGE INDEX TABLE
+  // **************************************************
+
+  /// Sparse table of indices of edge-isosurface intersections.
+  /// Stores only intersected edges, sorted by edge key
+  ///   (grid vertex index * dimension + edge direction).
+  /// Memory is proportional to the number of intersected edges,
+  ///   not the number of grid vertices.
+  /// Supports Vector() like SHARPISO_EDGE_INDEX_GRID.
+  class SHARPISO_EDGE_INDEX_TABLE:public SHARPISO_GRID {
+
+  public:
+    typedef long EDGE_KEY_TYPE;
+
+    /// Table entry.
+    class ENTRY {
+    public:
+      EDGE_KEY_TYPE key;
+      INDEX_DIFF_TYPE index;
+
+      bool operator < (const ENTRY & entryB) const
+      { return(key < entryB.key); }
+    };
+
+  protected:
+    std::vector<ENTRY> entry;
+
+  public:
+    SHARPISO_EDGE_INDEX_TABLE() {};
+
+    /// Return edge key of edge (iv, edge_dir).
+    EDGE_KEY_TYPE EdgeKey
+    (const VERTEX_INDEX iv, const int edge_dir) const
+    { return(EDGE_KEY_TYPE(iv)*this->Dimension() + edge_dir); }
+
+    /// Return number of edges in table.
+    NUM_TYPE NumEdges() const
+    { return(entry.size()); }
+
+    /// Remove all edges.
+    void Clear()
+    { entry.clear(); }
+
+    /// Reserve memory for n edges.
+    void Reserve(const NUM_TYPE n)
+    { entry.reserve(n); }
+
+    /// Add index of edge (iv, edge_dir).
+    /// @pre Sort() must be called after adding edges
+    ///   and before calling Vector().
+    void Add(const VERTEX_INDEX iv, const int edge_dir,
+             const INDEX_DIFF_TYPE index)
+    {
+      ENTRY x;
+      x.key = EdgeKey(iv, edge_dir);
+      x.index = index;
+      entry.push_back(x);
+    }
+
+    /// Set table to edges edge_key[0..(num_edges-1)].
+    /// Edge edge_key[i] has index i.
+    void SetKeys(const EDGE_KEY_TYPE * edge_key, const NUM_TYPE num_edges)
+    {
+      entry.resize(num_edges);
+      for (NUM_TYPE i = 0; i < num_edges; i++) {
+        entry[i].key = edge_key[i];
+        entry[i].index = i;
+      }
+      Sort();
+    }
+
+    /// Sort edges and remove duplicates.
+    /// If an edge was added more than once, keep the first index added.
+    void Sort()
+    {
+      if (!std::is_sorted(entry.begin(), entry.end()))
+        { std::stable_sort(entry.begin(), entry.end()); }
+
+      NUM_TYPE n = 0;
+      for (size_t i = 0; i < entry.size(); i++) {
+        if (n == 0 || entry[n-1].key != entry[i].key) {
+          entry[n] = entry[i];
+          n++;
+        }
+      }
+      entry.resize(n);
+    }
+
+    /// Return index of edge (iv, edge_dir).
+    /// Return -1 if edge is not in table.
+    INDEX_DIFF_TYPE Vector(const VERTEX_INDEX iv, const int edge_dir) const
+    {
+      ENTRY x;
+      x.key = EdgeKey(iv, edge_dir);
+
+      std::vector<ENTRY>::const_iterator pos =
+        std::lower_bound(entry.begin(), entry.end(), x);
+
+      if (pos == entry.end() || pos->key != x.key) { return(-1); }
+      return(pos->index);
+    }
+  };
+
+  typedef SHARPISO_EDGE_INDEX_TABLE::EDGE_KEY_TYPE
+    EDGE_KEY_TYPE;                  ///< Grid edge key.
+
 
   // **************************************************
   // BIN_GRID
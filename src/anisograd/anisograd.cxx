@@ -21,9 +21,12 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include "anisograd.h"
 
 #include "ijkcoord.txx"
+#include "ijkgradient.txx"
 
 // local type definition
 namespace {
@@ -37,34 +40,30 @@ typedef IJK::BOOL_GRID<SHARPISO_GRID> BOOL_GRID;
 // **************************************************
 
 // Compute central difference main function
+// Interior slabs are processed in parallel.
 void compute_gradient_central_difference
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
 		const int icube,
+		const int num_threads,
 		GRADIENT_GRID & gradient_grid)
 {
 	const int dimension = scalar_grid.Dimension();
+	const GRADIENT_COORD_TYPE dist[DIM3] = { 2, 2, 2 };
 
 	gradient_grid.SetSize(scalar_grid, dimension);
 
-	BOOL_GRID boundary_grid;
-	boundary_grid.SetSize(scalar_grid);
-	compute_boundary_grid(boundary_grid);
-
-	for (VERTEX_INDEX iv = 0; iv < scalar_grid.NumVertices(); iv++) {
-		if (boundary_grid.Scalar(iv)) {
-			compute_boundary_gradient(scalar_grid, iv, gradient_grid.VectorPtr(iv));
-		}
-		else {
-			compute_central_difference
-			(scalar_grid, iv, gradient_grid.VectorPtr(iv));
-		}
-	}
+	IJK::compute_gradient_central_difference_3D
+	(scalar_grid, dist, num_threads,
+			[&](const VERTEX_INDEX iv, GRADIENT_COORD_TYPE * gradient)
+			{ compute_boundary_gradient(scalar_grid, iv, gradient); },
+			gradient_grid.VectorPtr());
 }
 
 // **************************************************
 // ANISOTROPIC GRADIENT FILTERING
 // **************************************************
 // anisotropic gradient filtering per vertex
+// Store new gradient of vertex iv1 in newN.
 void anisotropic_diff_per_vert
 (const SHARPISO::SHARPISO_SCALAR_GRID_BASE & scalar_grid,
 		const float mu,
@@ -72,11 +71,11 @@ void anisotropic_diff_per_vert
 		const VERTEX_INDEX iv1,
 		const int flag_aniso,
 		const int icube,
-		const GRADIENT_GRID & gradient_grid,
-		GRADIENT_GRID & temp_gradient_grid)
+		const GRADIENT_GRID_BASE & gradient_grid,
+		GRADIENT_COORD_TYPE newN[DIM3])
 {
 	const GRADIENT_COORD_TYPE * N = gradient_grid.VectorPtrConst(iv1);
-	GRADIENT_COORD_TYPE w[DIM3], w_orth[DIM3], newN[DIM3];
+	GRADIENT_COORD_TYPE w[DIM3], w_orth[DIM3];
 
 	compute_w(scalar_grid, mu, iv1, flag_aniso, gradient_grid, w);
 
@@ -84,13 +83,23 @@ void anisotropic_diff_per_vert
 
 	for (int d=0; d<DIM3; d++)
 	{ newN[d] = N[d]  + lambda * w_orth[d]; }
+}
 
-	// update the temporary gradient grid
-	temp_gradient_grid.Set(iv1, newN);
+// Set normalized boundary gradient of vertex iv1.
+void set_normalized_boundary_gradient
+(const SHARPISO::SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+		const VERTEX_INDEX iv1,
+		GRADIENT_GRID_BASE & gradient_grid)
+{
+	GRADIENT_COORD_TYPE * grad = gradient_grid.VectorPtr(iv1);
+	compute_boundary_gradient(scalar_grid, iv1, grad);
+	normalize(grad, DIM3, EPSILON);
 }
 
 
 /// calculate the anisotropic diff of the gradients per iteration
+/// Vertices with all coordinates at least 2 from the grid boundary
+///   are interior.  Z-slabs of interior vertices are processed in parallel.
 void anisotropic_diff_iter_k
 (
 		const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
@@ -99,43 +108,55 @@ void anisotropic_diff_iter_k
 		const int iter_k,
 		const int flag_aniso,
 		const int icube,
-		const int dimension,
-		GRADIENT_GRID & gradient_grid
+		const bool flag_set_boundary,
+		const int num_threads,
+		const GRADIENT_GRID_BASE & gradient_grid,
+		GRADIENT_GRID_BASE & new_gradient_grid
 )
 {
-	// create a temporary grid for each iteration
-	GRADIENT_GRID temp_gradient_grid;
-	temp_gradient_grid.SetSize(scalar_grid, dimension);
-
-	for (VERTEX_INDEX iv = 0; iv<scalar_grid.NumVertices(); iv++)
-	{
-		GRID_COORD_TYPE coord[DIM3];
-		scalar_grid.ComputeCoord(iv, coord);
-
-		if (2 <= coord[0] && coord[0]+2 < scalar_grid.AxisSize(0) &&
-				2 <= coord[1] && coord[1]+2 < scalar_grid.AxisSize(1) &&
-				2 <= coord[2] && coord[2]+2 < scalar_grid.AxisSize(2)) {
-
-			// Store new gradient values in temp_gradient_grid
-			anisotropic_diff_per_vert
-			(scalar_grid, mu, lambda, iv, flag_aniso, icube, gradient_grid, temp_gradient_grid );
-		}
-		else {
-			compute_boundary_gradient
-			(scalar_grid, iv, temp_gradient_grid.VectorPtr(iv));
+	const VERTEX_INDEX nx = scalar_grid.AxisSize(0);
+	const VERTEX_INDEX ny = scalar_grid.AxisSize(1);
+	const VERTEX_INDEX nz = scalar_grid.AxisSize(2);
+	const VERTEX_INDEX x0 = std::min(VERTEX_INDEX(2), nx);
+	const VERTEX_INDEX x1 = std::max(x0, nx-2);
+
+	IJK::for_each_block_in_parallel
+	(nz, num_threads, [&](const VERTEX_INDEX z0, const VERTEX_INDEX z1) {
+
+		for (VERTEX_INDEX z = z0; z < z1; z++) {
+			for (VERTEX_INDEX y = 0; y < ny; y++) {
+
+				const VERTEX_INDEX iv0 = (z*ny + y)*nx;
+
+				if (2 <= y && y+2 < ny && 2 <= z && z+2 < nz) {
+
+					for (VERTEX_INDEX x = x0; x < x1; x++) {
+						GRADIENT_COORD_TYPE * newN = new_gradient_grid.VectorPtr(iv0+x);
+
+						anisotropic_diff_per_vert
+						(scalar_grid, mu, lambda, iv0+x, flag_aniso, icube,
+								gradient_grid, newN);
+						normalize(newN, DIM3, EPSILON);
+					}
+
+					if (flag_set_boundary) {
+						for (VERTEX_INDEX x = 0; x < x0; x++)
+						{ set_normalized_boundary_gradient(scalar_grid, iv0+x, new_gradient_grid); }
+						for (VERTEX_INDEX x = x1; x < nx; x++)
+						{ set_normalized_boundary_gradient(scalar_grid, iv0+x, new_gradient_grid); }
+					}
+				}
+				else if (flag_set_boundary) {
+					for (VERTEX_INDEX x = 0; x < nx; x++)
+					{ set_normalized_boundary_gradient(scalar_grid, iv0+x, new_gradient_grid); }
+				}
+			}
 		}
-	}
-
-	// Copy temp_gradient_grid to gradient_grid.
-	for (int l=0; l<scalar_grid.NumVertices(); l++) {
-		GRADIENT_COORD_TYPE * grad = temp_gradient_grid.VectorPtr(l);
-		// debug normalize
-		normalize(grad, DIM3, EPSILON);
-		gradient_grid.Set(l, grad);
-	}
+	});
 }
 
 // Calculate the anisotropic diffusion of the gradients.
+// Alternate between gradient_grid and a temporary grid.
 void anisotropic_diff
 (
 		const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
@@ -144,6 +165,7 @@ void anisotropic_diff
 		const int num_iter,
 		const int flag_aniso,
 		const int icube,
+		const int num_threads,
 		GRADIENT_GRID & gradient_grid
 )
 {
@@ -151,13 +173,29 @@ void anisotropic_diff
 	const int dimension = scalar_grid.Dimension();
 	gradient_grid.SetSize(scalar_grid, dimension);
 
+	GRADIENT_GRID temp_gradient_grid;
+	temp_gradient_grid.SetSize(scalar_grid, dimension);
+
+	GRADIENT_GRID * grad_grid = &gradient_grid;
+	GRADIENT_GRID * new_grad_grid = &temp_gradient_grid;
 
 	for (int k=0; k<num_iter; k++) {
 		// DEBUG
 			cout <<" iteration ["<<num_iter<<"] of ["<<num_iter<<"]."<<endl;
+
+		// Boundary gradients are the same in every iteration.
+		// Set them once in each of the two grids.
+		const bool flag_set_boundary = (k < 2);
+
 		anisotropic_diff_iter_k
-		(scalar_grid, mu, lambda, k, flag_aniso, icube, dimension, gradient_grid);
+		(scalar_grid, mu, lambda, k, flag_aniso, icube, flag_set_boundary,
+				num_threads, *grad_grid, *new_grad_grid);
+
+		std::swap(grad_grid, new_grad_grid);
 	}
+
+	if (grad_grid != &gradient_grid)
+	{ gradient_grid.CopyVector(*grad_grid); }
 };
 
 
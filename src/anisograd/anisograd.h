@@ -35,11 +35,15 @@ const float EPSILON = 0.001;
 
 using namespace SHARPISO;
 using namespace std;
+
+// Compute gradients using central difference.
+// num_threads = Number of threads.  If 0, use all hardware threads.
 void compute_gradient_central_difference
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
- const int icube, GRADIENT_GRID & gradient_grid);
+ const int icube, const int num_threads, GRADIENT_GRID & gradient_grid);
 
 // Calculate the anisotropic diff of the gradients.
+// num_threads = Number of threads.  If 0, use all hardware threads.
 void anisotropic_diff
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const float mu,
@@ -47,10 +51,14 @@ void anisotropic_diff
  const int num_iter,
  const int flag_aniso,
  const int icube,
+ const int num_threads,
  GRADIENT_GRID & gradient_grid);
 
 
 // Calculate the anisotropic diff per iteration
+// Read gradients from gradient_grid.
+// Write new gradients of interior vertices to new_gradient_grid.
+// If flag_set_boundary, also write boundary gradients to new_gradient_grid.
 void anisotropic_diff_iter_k
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const float mu,
@@ -58,8 +66,10 @@ void anisotropic_diff_iter_k
  const int iter_k,
  const int flag_aniso,
  const int icube,
- const int dimension,
- GRADIENT_GRID & gradient_grid);
+ const bool flag_set_boundary,
+ const int num_threads,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ GRADIENT_GRID_BASE & new_gradient_grid);
 
 
 // Compute C d for direction 'd' for  vertex iv1
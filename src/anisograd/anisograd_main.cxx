@@ -39,6 +39,7 @@ char * scalar_filename = NULL;
 char * gradient_filename = NULL;
 bool report_time_flag = false;
 bool flag_gzip = false;
+int num_threads = 0;
 bool flag_cdiff = false;
 bool flag_iso = false;
 float large_magnitude = 2.0;
@@ -93,13 +94,13 @@ int main(int argc, char **argv)
 		}
 		if (flag_cdiff) {
 			compute_gradient_central_difference
-			(full_scalar_grid, icube, gradient_grid);
+			(full_scalar_grid, icube, num_threads, gradient_grid);
 		}
 		else
 		{
 			// compute the central gradients first
 			compute_gradient_central_difference
-			(full_scalar_grid, icube, gradient_grid);
+			(full_scalar_grid, icube, num_threads, gradient_grid);
 
 			//normalize the gradients
 			normalize_and_store_gradient_magnitudes
@@ -108,12 +109,12 @@ int main(int argc, char **argv)
 			if (flag_iso)
 			{
 				cout << "isotropic diffusion called "<<endl;
-				anisotropic_diff (full_scalar_grid,  mu, lambda, num_iter, 0, icube, gradient_grid);
+				anisotropic_diff (full_scalar_grid,  mu, lambda, num_iter, 0, icube, num_threads, gradient_grid);
 			}
 			else
 			{
 				// Compute the anisotropic diffusion of the gradients
-				anisotropic_diff (full_scalar_grid,  mu, lambda, num_iter, 1, icube, gradient_grid);
+				anisotropic_diff (full_scalar_grid,  mu, lambda, num_iter, 1, icube, num_threads, gradient_grid);
 			}
 			//reset the magnitudes
 			reset_gradient_magnitudes
@@ -196,6 +197,12 @@ void parse_command_line(int argc, char **argv)
 			if (iarg >= argc) { usage_error(); };
 			sscanf(argv[iarg], "%d", &num_iter);
 		}
+		else if (string(argv[iarg]) == "-num_threads")
+		{
+			iarg++;
+			if (iarg >= argc) { usage_error(); };
+			sscanf(argv[iarg], "%d", &num_threads);
+		}
 		else if (string(argv[iarg]) == "-icube")
 		{
 			iarg++;
@@ -223,6 +230,7 @@ void usage_msg()
 	cerr <<"                 [-mu]       extent of anisotropic diffusion"<< endl;
 	cerr <<"                 [-lambda]   extent of diffusion in each iteration " <<endl;
 	cerr <<"                 [-num_iter] number of iterations "<<endl;
+	cerr <<"                 [-num_threads {N}] number of threads (0: all hardware threads)"<<endl;
 	cerr << endl;
 }
 
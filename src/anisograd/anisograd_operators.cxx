@@ -469,6 +469,12 @@ void compute_w
 	compute_m_d
 	(scalar_grid, gradient_grid, prev_vert[2], 2, mZprevZ);
 
+	// The curvature weights gK and gKprev are not used in computing w.
+	// They are computed only by the DEBUG version below.
+	// Computing them took more than half the time of anisotropic diffusion.
+
+   // DEBUG
+	/*
 	// Compute 'k' for each dimensions ,
 	// used for anisotropic gradients
 
@@ -477,8 +483,6 @@ void compute_w
 
 	SCALAR_TYPE gKprev[DIM3]={0.0};
 
-	GRADIENT_COORD_TYPE   mag=0.0;
-
 	// compute_curvature for the present vertex
 	compute_curvature_iv(scalar_grid, gradient_grid, iv1, K);
 
@@ -493,8 +497,7 @@ void compute_w
 
 		compute_g_x(mu, K[d], flag_aniso, gKprev[d]);
 	}
-   // DEBUG
-	/*
+
 	for (int i=0; i<DIM3; i++) {
 		w[i] =  gK[i]*mX[i] - gKprev[i]*mXprevX[i] +
 				gK[i]*mY[i] - gKprev[i]*mYprevY[i] +
@@ -22,6 +22,7 @@
 */
 
 #include "cgradient.h"
+#include "ijkgradient.txx"
 #include "ijkscalar_grid.txx"
 #include "isodual3D_datastruct.h"
 
@@ -44,13 +45,25 @@ void compute_boundary_gradient
  const VERTEX_INDEX iv1, GRADIENT_TYPE * gradient);
 
 void compute_gradient_central_difference
-(const ISODUAL_SCALAR_GRID_BASE & scalar_grid,
+(const ISODUAL_SCALAR_GRID_BASE & scalar_grid, const int num_threads,
  GRADIENT_GRID & gradient_grid)
 {
+  const int DIM3 = 3;
   const int dimension = scalar_grid.Dimension();
 
   gradient_grid.SetSize(scalar_grid, dimension);
 
+  if (dimension == DIM3) {
+    // Process interior slabs in parallel.
+    const GRADIENT_TYPE dist[DIM3] = { 2, 2, 2 };
+    IJK::compute_gradient_central_difference_3D
+      (scalar_grid, dist, num_threads,
+       [&](const VERTEX_INDEX iv, GRADIENT_TYPE * gradient)
+       { compute_boundary_gradient(scalar_grid, iv, gradient); },
+       gradient_grid.VectorPtr());
+    return;
+  }
+
   BOOL_GRID boundary_grid;
   boundary_grid.SetSize(scalar_grid);
   compute_boundary_grid(boundary_grid);
@@ -24,7 +24,11 @@
 #include "isodual3D_datastruct.h"
 #include "ijkscalar_grid.txx"
 
+/// Compute gradients using central difference.
+/// Use one-sided difference on the grid boundary.
+/// @param num_threads Number of threads.
+///   If num_threads is 0, use all hardware threads.
 void compute_gradient_central_difference
 (const ISODUAL3D::ISODUAL_SCALAR_GRID_BASE & scalar_grid,
- ISODUAL3D::GRADIENT_GRID & gradient_grid);
+ const int num_threads, ISODUAL3D::GRADIENT_GRID & gradient_grid);
 
@@ -22,6 +22,7 @@
 */
 
 
+#include <cstdlib>
 #include <iostream>
 
 #include "ijkNrrd.h"
@@ -38,6 +39,7 @@ char * scalar_filename = NULL;
 char * gradient_filename = NULL;
 bool report_time_flag = false;
 bool flag_gzip = false;
+int num_threads = 0;
 
 using namespace std;
 
@@ -72,7 +74,8 @@ int main(int argc, char **argv)
     if (nrrd_in.ReadFailed()) { throw error; }
 
     GRADIENT_GRID gradient_grid;
-    compute_gradient_central_difference(full_scalar_grid, gradient_grid);
+    compute_gradient_central_difference
+      (full_scalar_grid, num_threads, gradient_grid);
 
     if (flag_gzip) {
       write_vector_grid_nrrd_gzip(gradient_filename, gradient_grid);
@@ -128,6 +131,12 @@ void parse_command_line(int argc, char **argv)
       { report_time_flag = true;   }
     else if (string(argv[iarg]) == "-gzip")
       { flag_gzip = true; }
+    else if (string(argv[iarg]) == "-num_threads") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      num_threads = atoi(argv[iarg]);
+      if (num_threads < 0) { usage_error(); }
+    }
     else 
       { usage_error(); }
     iarg++;
@@ -141,8 +150,11 @@ void parse_command_line(int argc, char **argv)
 
 void usage_msg()
 {
-  cerr << "Usage: cgradient [-gzip] [-time] {scalar nrrd file} {gradient nrrd file}"
+  cerr << "Usage: cgradient [-gzip] [-time] [-num_threads {N}] {scalar nrrd file} {gradient nrrd file}"
        << endl;
+  cerr << "  -num_threads {N}: Compute gradients using N threads."
+       << endl
+       << "      Default: Use all hardware threads." << endl;
 }
 
 void usage_error()
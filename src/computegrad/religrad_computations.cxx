@@ -6,6 +6,7 @@
 #include "ijkcoord.txx"
 #include "sharpiso_scalar.txx"
 #include "ijkgrid_macros.h"
+#include "ijkgradient.txx"
 #include "sharpiso_types.h"
 #include <algorithm>
 #include <vector>
@@ -13,6 +14,45 @@ using namespace RELIGRADIENT;
 using namespace std;
 using namespace SHARPISO;
 
+// local type definition
+namespace {
+
+	/// Counters and vertices computed by one block
+	///   of a parallel reliability test.
+	/// Blocks are combined in order by add_block_counters.
+	class RELIGRAD_BLOCK_INFO {
+	public:
+		unsigned long int num_reliable;
+		unsigned long int num_unreliable;
+		unsigned long int grad_mag_zero;
+		unsigned long int num_vertices_mag_grt_zero;
+		vector<VERTEX_INDEX> vertex_list;
+
+		RELIGRAD_BLOCK_INFO()
+		{
+			num_reliable = 0;
+			num_unreliable = 0;
+			grad_mag_zero = 0;
+			num_vertices_mag_grt_zero = 0;
+		}
+	};
+
+	/// Add counters of each block to io_info.
+	void add_block_counters
+		(const vector<RELIGRAD_BLOCK_INFO> & block_info,
+		INPUT_INFO & io_info)
+	{
+		for (size_t k = 0; k < block_info.size(); k++) {
+			io_info.out_info.num_reliable += block_info[k].num_reliable;
+			io_info.out_info.num_unreliable += block_info[k].num_unreliable;
+			io_info.out_info.grad_mag_zero += block_info[k].grad_mag_zero;
+			io_info.num_vertices_mag_grt_zero +=
+				block_info[k].num_vertices_mag_grt_zero;
+		}
+	}
+
+};
+
 
 /**
 * Does orthogonal directions match
@@ -156,57 +196,70 @@ void compute_boundary_gradient_normalized(
 		}
 }
 
+// Divisors for central difference along each axis.
+void get_central_difference_dist(
+	const RELIGRADIENT_SCALAR_GRID_BASE & scalar_grid, COORD_TYPE dist[DIM3]) {
+		for (int d = 0; d < DIM3; d++) 
+			{ dist[d] = scalar_grid.Spacing(d) * 2.0; }
+}
+
 /*
 * Compute gradients using central difference
+* Set interior gradients with magnitude less than io_info.min_gradient_mag
+*   to zero.  Boundary gradients are not changed.
+* Interior slabs are processed in parallel.
 */
 void compute_gradient_central_difference(
 	const RELIGRADIENT_SCALAR_GRID_BASE & scalar_grid,
 	GRADIENT_GRID & gradient_grid, const INPUT_INFO & io_info) {
 		const int dimension = scalar_grid.Dimension();
+		const GRADIENT_COORD_TYPE min_gradient_mag = io_info.min_gradient_mag;
+		COORD_TYPE dist[DIM3];
 		gradient_grid.SetSize(scalar_grid, dimension);
 		gradient_grid.SetSpacing(scalar_grid);
-		BOOL_GRID boundary_grid;
-		boundary_grid.SetSize(scalar_grid);
-		compute_boundary_grid(boundary_grid);
-		for (VERTEX_INDEX iv = 0; iv < scalar_grid.NumVertices(); iv++) {
-			if (boundary_grid.Scalar(iv)) {
-				compute_boundary_gradient(scalar_grid, iv,
-					gradient_grid.VectorPtr(iv));
-			} else {
-				compute_gradient_central_difference(scalar_grid, iv,
-					gradient_grid.VectorPtr(iv), io_info.min_gradient_mag);
-			}
-		}
+		get_central_difference_dist(scalar_grid, dist);
+
+		IJK::compute_gradient_central_difference_3D
+			(scalar_grid, dist, io_info.num_threads,
+			[&](const VERTEX_INDEX iv, GRADIENT_COORD_TYPE * gradient)
+			{ compute_boundary_gradient(scalar_grid, iv, gradient); },
+			gradient_grid.VectorPtr());
+
+		IJK::for_each_vertex_3D_in_parallel
+			(scalar_grid, io_info.num_threads,
+			[&](const VERTEX_INDEX iv, const bool is_boundary)
+			{
+				if (is_boundary) { return; }
+
+				GRADIENT_COORD_TYPE * gradient = gradient_grid.VectorPtr(iv);
+				SCALAR_TYPE mag = 0.0;
+				IJK::compute_magnitude_3D(gradient, mag);
+				if (mag < min_gradient_mag) 
+					{ IJK::set_coord(DIM3, 0.0, gradient); }
+			});
 }
 
 //compute gradient using central difference
 //also computed the normalized gradients and the gradient magnitudes
+//  in the same pass.
 void compute_gradient_central_difference_normalized(
 	const RELIGRADIENT_SCALAR_GRID_BASE & scalar_grid,
 	GRADIENT_GRID & normalized_grad_grid,
 	GRADIENT_MAGNITUDE_GRID & grad_magnitude_grid,
 	const INPUT_INFO & io_info) {
 		const int dimension = scalar_grid.Dimension();
+		COORD_TYPE dist[DIM3];
 		normalized_grad_grid.SetSize(scalar_grid, dimension);
 		normalized_grad_grid.SetSpacing(scalar_grid);
 		grad_magnitude_grid.SetSize(scalar_grid);
-
-		BOOL_GRID boundary_grid;
-		boundary_grid.SetSize(scalar_grid);
-		compute_boundary_grid(boundary_grid);
-		for (VERTEX_INDEX iv = 0; iv < scalar_grid.NumVertices(); iv++) {
-			GRADIENT_COORD_TYPE grad_mag = 0.0;
-			if (boundary_grid.Scalar(iv)) {
-				compute_boundary_gradient_normalized(scalar_grid, iv,
-					normalized_grad_grid.VectorPtr(iv), grad_mag,
-					io_info.min_gradient_mag);
-			} else {
-				compute_gradient_central_difference_normalized(scalar_grid, iv,
-					normalized_grad_grid.VectorPtr(iv), grad_mag,
-					io_info.min_gradient_mag);
-			}
-			grad_magnitude_grid.Set(iv, grad_mag);
-		}
+		get_central_difference_dist(scalar_grid, dist);
+
+		IJK::compute_gradient_central_difference_3D
+			(scalar_grid, dist, io_info.min_gradient_mag, true,
+			io_info.num_threads,
+			[&](const VERTEX_INDEX iv, GRADIENT_COORD_TYPE * gradient)
+			{ compute_boundary_gradient(scalar_grid, iv, gradient); },
+			normalized_grad_grid.VectorPtr(), grad_magnitude_grid.ScalarPtr());
 }
 
 /* 
@@ -298,9 +351,14 @@ void compute_reliable_gradients_angle(
 	BOOL_GRID & reliable_grid,
 	INPUT_INFO & io_info) 
 {
-	int numAgree = 0;
-	for (VERTEX_INDEX iv = 0; iv < scalar_grid.NumVertices(); iv++) {
-		numAgree = 0;
+	vector<RELIGRAD_BLOCK_INFO> block_info;
+
+	IJK::for_each_vertex_3D_in_parallel
+		(scalar_grid, io_info.num_threads, block_info,
+		[&](const VERTEX_INDEX iv, const bool,
+		RELIGRAD_BLOCK_INFO & info)
+	{
+		int numAgree = 0;
 		GRADIENT_COORD_TYPE gradient_iv[DIM3] = { 0.0, 0.0, 0.0 };
 		GRADIENT_COORD_TYPE gradient_iv_mag = grad_mag_grid.Scalar(iv);
 
@@ -340,18 +398,20 @@ void compute_reliable_gradients_angle(
 			if (numAgree < io_info.min_num_agree) 
 			{
 				reliable_grid.Set(iv, false);
-				io_info.out_info.num_unreliable++;
+				info.num_unreliable++;
 			} 
 			else 
 			{
-				io_info.out_info.num_reliable++;
+				info.num_reliable++;
 			}
 		} 
 		else 
 		{
-			io_info.out_info.grad_mag_zero++;
+			info.grad_mag_zero++;
 		}
-	}
+	});
+
+	add_block_counters(block_info, io_info);
 }
 
 // scalar based 
@@ -376,16 +436,21 @@ void compute_reliable_gradients_SBP
 	IJK::BOOL_GRID<RELIGRADIENT_GRID> & reliable_grid,
 	INPUT_INFO & io_info) 
 {
-	GRADIENT_COORD_TYPE grad_iv[DIM3];  // unscaled gradient vector
-	GRADIENT_COORD_TYPE normalized_grad_iv[DIM3]; // normalized grad_iv
-	COORD_TYPE coord_iv[DIM3]; // Coordinates of vertex iv.
-	COORD_TYPE coord_nv[DIM3]; // Coordinates of vertex nv.
-	GRADIENT_COORD_TYPE mag1;
-	COORD_TYPE err_distance;
+	vector<RELIGRAD_BLOCK_INFO> block_info;
 
+	IJK::for_each_vertex_3D_in_parallel
+		(scalar_grid, io_info.num_threads, block_info,
+		[&](const VERTEX_INDEX iv, const bool is_boundary,
+		RELIGRAD_BLOCK_INFO & info)
+	{
+		GRADIENT_COORD_TYPE grad_iv[DIM3];  // unscaled gradient vector
+		GRADIENT_COORD_TYPE normalized_grad_iv[DIM3]; // normalized grad_iv
+		COORD_TYPE coord_iv[DIM3]; // Coordinates of vertex iv.
+		COORD_TYPE coord_nv[DIM3]; // Coordinates of vertex nv.
+		GRADIENT_COORD_TYPE mag1;
+		COORD_TYPE err_distance;
+		bool debug = false;
 
-	bool debug = false;
-	for (VERTEX_INDEX iv = 0; iv < scalar_grid.NumVertices(); iv++) {
 
 
 		// only run the test if gradient at vertex iv is reliable
@@ -416,7 +481,7 @@ void compute_reliable_gradients_SBP
 				// set up a vector to keep track of the distances
 				vector<SCALAR_TYPE> vec_scalar_dists;
 
-				io_info.num_vertices_mag_grt_zero++;
+				info.num_vertices_mag_grt_zero++;
 				// find the normalized gradient
 				// point on the plane
 				// find neighbor vertices
@@ -457,14 +522,16 @@ void compute_reliable_gradients_SBP
 
 				if (!flag_correct) {
 					reliable_grid.Set(iv, false);
-					io_info.out_info.num_unreliable++;
+					info.num_unreliable++;
 				}
 				else {
-					io_info.out_info.num_reliable++;
+					info.num_reliable++;
 				}
 			}
 		}
-	}
+	});
+
+	add_block_counters(block_info, io_info);
 }
 
 // Compute vector between two grid coords
@@ -548,8 +615,12 @@ void compute_reliable_gradients_advangle(
 
 	//float degree_param = 30*M_PI/180.0;
 	float degree_param = io_info.neighbor_angle_parameter*M_PI/180.0;
+	vector<RELIGRAD_BLOCK_INFO> block_info;
 
-	for (VERTEX_INDEX iv = 0; iv < scalar_grid.NumVertices(); iv++) 
+	IJK::for_each_vertex_3D_in_parallel
+		(scalar_grid, io_info.num_threads, block_info,
+		[&](const VERTEX_INDEX iv, const bool is_boundary,
+		RELIGRAD_BLOCK_INFO & info)
 	{
 		COORD_TYPE coord_iv[DIM3] = {0.0,0.0,0.0};
 		COORD_TYPE coord1[DIM3] = {0.0,0.0,0.0};
@@ -618,16 +689,18 @@ void compute_reliable_gradients_advangle(
 				//cout <<"not reliable "<< tangent_vertex_list.size()<<" vs "<< numAgree<<endl;
 
 				reliable_grid.Set(iv, false);
-				io_info.out_info.num_unreliable++;
+				info.num_unreliable++;
 			}
 			else
 			{
 				//cout <<"reliable\n";
-				io_info.out_info.num_reliable++;
+				info.num_reliable++;
 			}
 
 		}// if end 
-	}
+	});
+
+	add_block_counters(block_info, io_info);
 }
 
 
@@ -639,16 +712,21 @@ void compute_reliable_gradients_advangle_version2(
 	IJK::BOOL_GRID<RELIGRADIENT_GRID> & reliable_grid,
 	INPUT_INFO & io_info) 
 {
-	GRADIENT_COORD_TYPE grad_iv[DIM3];  // unscaled gradient vector
-	GRADIENT_COORD_TYPE normalized_grad_iv[DIM3]; // normalized grad_iv
-	COORD_TYPE coord_iv[DIM3]; // Coordinates of vertex iv.
-	COORD_TYPE coord_nv[DIM3]; // Coordinates of vertex nv.
-	GRADIENT_COORD_TYPE mag1;
-	COORD_TYPE err_distance;
+	vector<RELIGRAD_BLOCK_INFO> block_info;
 
+	IJK::for_each_vertex_3D_in_parallel
+		(scalar_grid, io_info.num_threads, block_info,
+		[&](const VERTEX_INDEX iv, const bool is_boundary,
+		RELIGRAD_BLOCK_INFO & info)
+	{
+		GRADIENT_COORD_TYPE grad_iv[DIM3];  // unscaled gradient vector
+		GRADIENT_COORD_TYPE normalized_grad_iv[DIM3]; // normalized grad_iv
+		COORD_TYPE coord_iv[DIM3]; // Coordinates of vertex iv.
+		COORD_TYPE coord_nv[DIM3]; // Coordinates of vertex nv.
+		GRADIENT_COORD_TYPE mag1;
+		COORD_TYPE err_distance;
+		bool debug = false;
 
-	bool debug = false;
-	for (VERTEX_INDEX iv = 0; iv < scalar_grid.NumVertices(); iv++) {
 		int numAgree = 0;
 		// only run the test if gradient at vertex iv is reliable
 		if (reliable_grid.Scalar(iv)) {
@@ -679,7 +757,7 @@ void compute_reliable_gradients_advangle_version2(
 				// set up a vector to keep track of the distances
 				vector<SCALAR_TYPE> vec_scalar_dists;
 
-				io_info.num_vertices_mag_grt_zero++;
+				info.num_vertices_mag_grt_zero++;
 				// find the normalized gradient
 				// point on the plane
 				// find neighbor vertices
@@ -724,17 +802,19 @@ void compute_reliable_gradients_advangle_version2(
 						cout <<"not reliable "<< tangent_vertex_list.size()<<" vs "<< numAgree<<endl;
 
 					reliable_grid.Set(iv, false);
-					io_info.out_info.num_unreliable++;
+					info.num_unreliable++;
 				}
 				else
 				{
 					if(debug)
 						cout <<"reliable\n"<< tangent_vertex_list.size()<<" vs "<< numAgree<<endl;
-					io_info.out_info.num_reliable++;
+					info.num_reliable++;
 				}
 			}
 		}
-	}
+	});
+
+	add_block_counters(block_info, io_info);
 }
 
 
@@ -2026,15 +2106,17 @@ void compute_reliable_gradients_curvature_based_algo12(
 {
 	//debug
 	cerr <<"Running algorithm : " << io_info.cdist <<".\n";
-	const int numVertices = scalar_grid.NumVertices();
-	for (int iv = 0; iv < numVertices; iv++)
+
+	IJK::for_each_vertex_3D_in_parallel
+		(scalar_grid, io_info.num_threads,
+		[&](const VERTEX_INDEX iv, const bool)
 	{
 		if(!boundary_grid.Scalar(iv))
 		{
 			algo12_per_vertex(iv, scalar_grid, gradient_grid,
 				grad_mag_grid, reliable_grid, io_info);
 		}
-	}
+	});
 }
 /*
 *Curvature based reliable gradients computations B
@@ -2050,11 +2132,14 @@ void compute_reliable_gradients_curvature_basedB(
 	INPUT_INFO & io_info
 	)
 {
-	const int numVertices = scalar_grid.NumVertices();
-	bool debugVertex = false; 
-
-	for (unsigned int iv = 0; iv < numVertices; iv++)
+	// curvature_based_B_per_vertex does not read reliable_grid,
+	//   so each vertex can set reliable_grid directly.
+	IJK::for_each_vertex_3D_in_parallel
+		(scalar_grid, io_info.num_threads,
+		[&](const VERTEX_INDEX iv, const bool is_boundary)
 	{
+		bool debugVertex = false; 
+
 		if(!boundary_grid.Scalar(iv))
 		{
 			pair<bool, string> isReli =
@@ -2064,33 +2149,40 @@ void compute_reliable_gradients_curvature_basedB(
 				reliable_grid.Set(iv, true);
 			}
 		}
-	}
+	});
+
 	// check if extended
 	if (io_info.extended_curv_based)
 	{
 		for (int i = 0; i < io_info.extend_max; i++)
 		{
-			vector<VERTEX_INDEX>  vertex_index_of_extended_correct_grads;
+			// extended_curvature_based_B_per_vertex reads reliable_grid
+			//   at neighbors of iv.  Collect the vertices in each block
+			//   and set reliable_grid after all blocks are done.
+			vector<RELIGRAD_BLOCK_INFO> block_info;
+
 			//reset num unreliables. 
 			io_info.out_info.num_unreliable = 0;
 			io_info.out_info.num_reliable = 0;
 
-			for (int iv = 0; iv < numVertices; iv++)
+			IJK::for_each_vertex_3D_in_parallel
+				(scalar_grid, io_info.num_threads, block_info,
+				[&](const VERTEX_INDEX iv, const bool is_boundary,
+				RELIGRAD_BLOCK_INFO & info)
 			{
-				//debug
-				GRID_COORD_TYPE * coord = new GRID_COORD_TYPE [3];
-				scalar_grid.ComputeCoord(iv, coord);
 				if(!boundary_grid.Scalar(iv))
 				{
 					bool flag = extended_curvature_based_B_per_vertex(iv,
 						scalar_grid, gradient_grid, grad_mag_grid, reliable_grid, io_info);
-					if (flag)  vertex_index_of_extended_correct_grads.push_back(iv);
+					if (flag)  info.vertex_list.push_back(iv);
 				}
-			}
+			});
 
-			for (int i = 0; i < vertex_index_of_extended_correct_grads.size(); i++)
+			for (size_t k = 0; k < block_info.size(); k++)
 			{
-				reliable_grid.Set( vertex_index_of_extended_correct_grads[i], true);
+				const vector<VERTEX_INDEX> & vlist = block_info[k].vertex_list;
+				for (size_t j = 0; j < vlist.size(); j++)
+					{ reliable_grid.Set(vlist[j], true); }
 			}
 		}
 	}
@@ -56,6 +56,7 @@ public:
 	int print_info_vertex;
 	float param_angle;
 	float min_gradient_mag;   // minimum gradient
+	int num_threads;          // number of threads. 0: all hardware threads.
 	float min_cos_of_angle;
 	bool draw;
 	int draw_vert;
@@ -92,6 +93,7 @@ public:
 		flag_print_grad_loc = false;
 		print_info = false;
 		min_gradient_mag = 0.001;
+		num_threads = 0;
 		param_angle = 20; //default angle threshold
 		neighbor_angle_parameter = 30;
 		draw = false;
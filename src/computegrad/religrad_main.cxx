@@ -457,6 +457,7 @@ void main_options_msg() {
 	cerr << "OPTIONS:" << endl;
 	cerr << "  [-curvature_based] [-extended_curv] [-cdiff]"   << endl;
   cerr << "  [-cdist {D}] [-angle {A}] [-min_gradient_mag {M}]" << endl;
+	cerr << "  [-num_threads {N}]" << endl;
 	cerr << "  [-gzip] [-out_param] [-print_info {V}] [-print_grad_loc]"
        << endl;
   cerr << "  [-help] [-version] [-list_all_options]" << endl;
@@ -500,6 +501,9 @@ void help_main_options()
 	cout << "  -angle {A}: Set angle to {A} (float).  (Default: A="
        << DEFAULT_ANGLE << ".)" << endl;
 	cout << "  -min_gradient_mag {M}:  Set min gradient magnitude to {M} (float)." << endl;
+	cout << "  -num_threads {N}: Compute gradients and reliability tests using {N} threads."
+       << endl
+       << "      (Default: Use all hardware threads.)" << endl;
 	cout << "  -gzip: Store gradients in compressed (gzip) format." << endl;
 	cout << "  -out_param:  Print parameters." << endl;
 	cout << "  -print_info {V} : Print information about vertex {IV}." << endl;
@@ -609,6 +613,11 @@ void parse_command_line(int argc, char **argv, INPUT_INFO & io_info) {
 			iarg++;
 			io_info.min_gradient_mag = (float) atof(argv[iarg]);
 		} 
+		else if (s == "-num_threads") {
+			iarg++;
+			if (iarg >= argc) { usage_error(); }
+			io_info.num_threads = atoi(argv[iarg]);
+		} 
 		else if (s == "-angle") {
 			iarg++;
 			io_info.param_angle = (float) atof(argv[iarg]);
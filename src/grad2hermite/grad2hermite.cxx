@@ -47,12 +47,19 @@ char * normals_filename(NULL);
 SCALAR_TYPE isovalue;
 GRADIENT_COORD_TYPE max_small_magnitude(0.0001);
 bool flag_interpolate(false);
+bool flag_binary(false);
+bool flag_quantize_normals(false);
 
 // I/O routine.
 void write_off_file
 (const char * filename, 
  const std::vector<COORD_TYPE> & coord,
  const std::vector<GRADIENT_COORD_TYPE> & normal_coord);
+void write_hermite_file
+(const char * filename, const SHARPISO_GRID & grid,
+ const std::vector<EDGE_KEY_TYPE> & edge_key,
+ const std::vector<COORD_TYPE> & coord,
+ const std::vector<GRADIENT_COORD_TYPE> & normal_coord);
 
 // local subroutines
 void memory_exhaustion();
@@ -72,6 +79,7 @@ int main(int argc, char **argv)
   GRADIENT_GRID gradient_grid;
   std::vector<COORD_TYPE> edgeI_coord;
   std::vector<GRADIENT_COORD_TYPE> edgeI_normal_coord;
+  std::vector<EDGE_KEY_TYPE> edgeI_edge_key;
   IJK::ERROR error;
 
   try {
@@ -108,15 +116,21 @@ int main(int argc, char **argv)
     if (flag_interpolate) {
       compute_all_edgeI_linear_interpolate
         (scalar_grid, gradient_grid, isovalue, max_small_magnitude,
-         edgeI_coord, edgeI_normal_coord);
+         edgeI_coord, edgeI_normal_coord, edgeI_edge_key);
     }
     else {
       compute_all_edgeI
         (scalar_grid, gradient_grid, isovalue, max_small_magnitude,
-         edgeI_coord, edgeI_normal_coord);
+         edgeI_coord, edgeI_normal_coord, edgeI_edge_key);
     }
 
-    write_off_file(normals_filename, edgeI_coord, edgeI_normal_coord);
+    if (flag_binary) {
+      write_hermite_file(normals_filename, scalar_grid, edgeI_edge_key,
+                         edgeI_coord, edgeI_normal_coord);
+    }
+    else {
+      write_off_file(normals_filename, edgeI_coord, edgeI_normal_coord);
+    }
   }
   catch (ERROR error) {
     if (error.NumMessages() == 0) {
@@ -172,6 +186,29 @@ void write_off_file
   cout << "Wrote output to file: " << outfilename << endl;
 }
 
+void write_hermite_file
+(const char * filename, const SHARPISO_GRID & grid,
+ const std::vector<EDGE_KEY_TYPE> & edge_key,
+ const std::vector<COORD_TYPE> & coord,
+ const std::vector<GRADIENT_COORD_TYPE> & normal_coord)
+{
+  std::string outfilename;
+
+  if (filename != NULL) {
+    outfilename = filename;
+  }
+  else {
+    outfilename = remove_nrrd_suffix(scalar_filename);
+    outfilename += ".hermite";
+  }
+
+  SHARPISO::write_hermite_file
+    (outfilename.c_str(), grid, edge_key, coord, normal_coord,
+     flag_quantize_normals);
+
+  cout << "Wrote output to file: " << outfilename << endl;
+}
+
 // **************************************************
 // MISC ROUTINES
 // **************************************************
@@ -196,6 +233,13 @@ void parse_command_line(int argc, char **argv)
       if (s == "-interpolate") {
         flag_interpolate = true;
       }
+      else if (s == "-binary") {
+        flag_binary = true;
+      }
+      else if (s == "-quantize_normals") {
+        flag_binary = true;
+        flag_quantize_normals = true;
+      }
       else {
         cerr << "Illegal option: " << s << endl;
         usage_error();
@@ -231,8 +275,11 @@ void parse_command_line(int argc, char **argv)
 
 void usage_msg()
 {
-  cerr << "Usage: grad2hermite [-interpolate] {isovalue} {scalar nrrd file} [gradient nrrd file] [normals off filename]"
+  cerr << "Usage: grad2hermite [-interpolate] [-binary] [-quantize_normals] {isovalue} {scalar nrrd file} [gradient nrrd file] [output filename]"
        << endl;
+  cerr << "  -binary: Write binary hermite file instead of OFF file." << endl;
+  cerr << "  -quantize_normals: Write binary hermite file" << endl
+       << "     with normal coordinates stored as 16 bit integers." << endl;
 }
 
 void usage_error()
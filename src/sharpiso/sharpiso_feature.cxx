@@ -75,6 +75,32 @@ void SHARPISO::svd_compute_sharp_vertex_for_cube_lindstrom
 	NUM_TYPE & num_large_eigenvalues,
 	SVD_INFO & svd_info)
 {
+  GET_GRADIENTS_BUFFER buffer;
+
+  svd_compute_sharp_vertex_for_cube_lindstrom
+    (scalar_grid, gradient_grid, cube_index, isovalue, 
+     sharpiso_param, voxel, sharp_coord, edge_direction, orth_direction,
+     eigenvalues, num_large_eigenvalues, svd_info, buffer);
+}
+
+/// Compute sharp isosurface vertex using singular valued decomposition.
+/// Use Lindstrom's formula.
+/// Version which reuses storage in buffer.
+void SHARPISO::svd_compute_sharp_vertex_for_cube_lindstrom
+	(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+	const GRADIENT_GRID_BASE & gradient_grid,
+	const VERTEX_INDEX cube_index,
+	const SCALAR_TYPE isovalue,
+	const SHARP_ISOVERT_PARAM & sharpiso_param,
+	const OFFSET_VOXEL & voxel,
+	COORD_TYPE sharp_coord[DIM3],
+  COORD_TYPE edge_direction[DIM3],
+  COORD_TYPE orth_direction[DIM3],
+	EIGENVALUE_TYPE eigenvalues[DIM3],
+	NUM_TYPE & num_large_eigenvalues,
+	SVD_INFO & svd_info,
+  GET_GRADIENTS_BUFFER & buffer)
+{
 
 	COORD_TYPE central_point[DIM3];
 	compute_central_point
@@ -85,7 +111,7 @@ void SHARPISO::svd_compute_sharp_vertex_for_cube_lindstrom
     (scalar_grid, gradient_grid, cube_index, isovalue, 
      sharpiso_param, voxel, central_point, 
      sharp_coord, edge_direction, orth_direction,
-     eigenvalues, num_large_eigenvalues, svd_info);
+     eigenvalues, num_large_eigenvalues, svd_info, buffer);
 }
 
 /// Compute sharp isosurface vertex using singular valued decomposition.
@@ -106,14 +132,44 @@ void SHARPISO::svd_compute_sharp_vertex_for_cube_lindstrom
 	EIGENVALUE_TYPE eigenvalues[DIM3],
 	NUM_TYPE & num_large_eigenvalues,
 	SVD_INFO & svd_info)
+{
+  GET_GRADIENTS_BUFFER buffer;
+
+  svd_compute_sharp_vertex_for_cube_lindstrom
+    (scalar_grid, gradient_grid, cube_index, isovalue, 
+     sharpiso_param, voxel, pointX, 
+     sharp_coord, edge_direction, orth_direction,
+     eigenvalues, num_large_eigenvalues, svd_info, buffer);
+}
+
+/// Compute sharp isosurface vertex using singular valued decomposition.
+/// Use Lindstrom's formula.
+/// Version which reuses storage in buffer.
+/// @param pointX Compute vertex closest to pointX.
+/// Also post processes vertices.
+void SHARPISO::svd_compute_sharp_vertex_for_cube_lindstrom
+ (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+  const GRADIENT_GRID_BASE & gradient_grid,
+  const VERTEX_INDEX cube_index,
+  const SCALAR_TYPE isovalue,
+  const SHARP_ISOVERT_PARAM & sharpiso_param,
+  const OFFSET_VOXEL & voxel,
+  const COORD_TYPE pointX[DIM3],
+	COORD_TYPE sharp_coord[DIM3],
+  COORD_TYPE edge_direction[DIM3],
+  COORD_TYPE orth_direction[DIM3],
+	EIGENVALUE_TYPE eigenvalues[DIM3],
+	NUM_TYPE & num_large_eigenvalues,
+	SVD_INFO & svd_info,
+  GET_GRADIENTS_BUFFER & buffer)
 {
 	const EIGENVALUE_TYPE max_small_eigenvalue =
 		sharpiso_param.max_small_eigenvalue;
 
 	NUM_TYPE num_gradients = 0;
-	std::vector<COORD_TYPE> point_coord;
-	std::vector<GRADIENT_COORD_TYPE> gradient_coord;
-	std::vector<SCALAR_TYPE> scalar;
+	std::vector<COORD_TYPE> & point_coord = buffer.point_coord;
+	std::vector<GRADIENT_COORD_TYPE> & gradient_coord = buffer.gradient_coord;
+	std::vector<SCALAR_TYPE> & scalar = buffer.scalar;
 
 	// Scale cube coord by spacings
 	COORD_TYPE cube_coord[DIM3];
@@ -122,7 +178,7 @@ void SHARPISO::svd_compute_sharp_vertex_for_cube_lindstrom
 	get_gradients
 		(scalar_grid, gradient_grid, cube_index, isovalue,
 		sharpiso_param, voxel, sharpiso_param.flag_sort_gradients,
-		point_coord, gradient_coord, scalar, num_gradients);
+		point_coord, gradient_coord, scalar, num_gradients, buffer);
 
 	if(num_gradients == 0)
 	{
@@ -151,6 +207,101 @@ void SHARPISO::svd_compute_sharp_vertex_for_cube_lindstrom
 		sharpiso_param, sharp_coord, svd_info);
 }
 
+/// Compute sharp isosurface vertices for a list of cubes
+///   using singular valued decomposition and Lindstrom's formula.
+/// Lindstrom matrices for all the cubes are solved in one batch.
+void SHARPISO::svd_compute_sharp_vertex_for_cubes_lindstrom
+ (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+  const GRADIENT_GRID_BASE & gradient_grid,
+  const VERTEX_INDEX * cube_index,
+  const NUM_TYPE num_cubes,
+  const SCALAR_TYPE isovalue,
+  const SHARP_ISOVERT_PARAM & sharpiso_param,
+  const OFFSET_VOXEL & voxel,
+  COORD_TYPE * sharp_coord,
+  COORD_TYPE * edge_direction,
+  COORD_TYPE * orth_direction,
+  EIGENVALUE_TYPE * eigenvalues,
+  NUM_TYPE * num_large_eigenvalues,
+  SVD_INFO * svd_info,
+  GET_GRADIENTS_BUFFER & buffer,
+  LINDSTROM_BATCH & batch)
+{
+	const EIGENVALUE_TYPE max_small_eigenvalue =
+		sharpiso_param.max_small_eigenvalue;
+  std::vector<NUM_TYPE> batch_cube;
+	std::vector<COORD_TYPE> & point_coord = buffer.point_coord;
+	std::vector<GRADIENT_COORD_TYPE> & gradient_coord = buffer.gradient_coord;
+	std::vector<SCALAR_TYPE> & scalar = buffer.scalar;
+  IJK::PROCEDURE_ERROR error("svd_compute_sharp_vertex_for_cubes_lindstrom");
+
+  if (num_cubes > batch.MaxNumCubes()) {
+    error.AddMessage("Programming error.  Number of cubes ", num_cubes,
+                     " exceeds batch size ", batch.MaxNumCubes(), ".");
+    throw error;
+  }
+
+  batch.Clear();
+  batch_cube.reserve(num_cubes);
+
+  // Gather gradients.
+  for (NUM_TYPE k = 0; k < num_cubes; k++) {
+
+    COORD_TYPE central_point[DIM3];
+    NUM_TYPE num_gradients = 0;
+
+    compute_central_point
+      (scalar_grid, gradient_grid, isovalue, cube_index[k],
+       sharpiso_param, central_point, svd_info[k]);
+
+    get_gradients
+      (scalar_grid, gradient_grid, cube_index[k], isovalue,
+       sharpiso_param, voxel, sharpiso_param.flag_sort_gradients,
+       point_coord, gradient_coord, scalar, num_gradients, buffer);
+
+    if (num_gradients == 0) {
+      compute_edgeI_centroid
+        (scalar_grid, isovalue, cube_index[k], sharp_coord+DIM3*k);
+      IJK::set_coord_3D(0, edge_direction+DIM3*k);
+      IJK::set_coord_3D(0, orth_direction+DIM3*k);
+      IJK::set_coord_3D(0, eigenvalues+DIM3*k);
+      num_large_eigenvalues[k] = 0;
+
+      svd_info[k].location = CENTROID;
+      continue;
+    }
+
+    svd_info[k].location = LOC_SVD;
+    svd_info[k].flag_conflict = false;
+    svd_info[k].flag_Linf_iso_vertex_location = false;
+
+    batch.AddCube(num_gradients, &(scalar[0]), &(point_coord[0]),
+                  &(gradient_coord[0]), central_point);
+    batch_cube.push_back(k);
+  }
+
+  batch.ComputeSharpPoints(isovalue, max_small_eigenvalue);
+
+  for (NUM_TYPE i = 0; i < batch.NumCubes(); i++) {
+    const NUM_TYPE k = batch_cube[i];
+
+    IJK::copy_coord_3D(batch.SharpCoord(i), sharp_coord+DIM3*k);
+    IJK::copy_coord_3D(batch.EdgeDirection(i), edge_direction+DIM3*k);
+    IJK::copy_coord_3D(batch.OrthDirection(i), orth_direction+DIM3*k);
+    IJK::copy_coord_3D(batch.Eigenvalues(i), eigenvalues+DIM3*k);
+    num_large_eigenvalues[k] = batch.NumLargeEigenvalues(i);
+
+    // Scale cube coord by spacings
+    COORD_TYPE cube_coord[DIM3];
+    scalar_grid.ComputeScaledCoord(cube_index[k], cube_coord);
+
+    // post process the isovertex. 
+    postprocess_isovert_location
+      (scalar_grid, gradient_grid, cube_index[k], cube_coord, isovalue,
+       sharpiso_param, sharp_coord+DIM3*k, svd_info[k]);
+  }
+}
+
 /// Compute sharp isosurface vertex using singular valued decomposition.
 /// Use Lindstrom's formula.
 /// If num_large_eigenvalues == 2, position vertex on plane.
@@ -169,14 +320,41 @@ void SHARPISO::svd_compute_sharp_vertex_on_plane_lindstrom
 	EIGENVALUE_TYPE eigenvalues[DIM3],
 	NUM_TYPE & num_large_eigenvalues,
 	SVD_INFO & svd_info)
+{
+  GET_GRADIENTS_BUFFER buffer;
+
+  svd_compute_sharp_vertex_on_plane_lindstrom
+    (scalar_grid, gradient_grid, cube_index, isovalue, sharpiso_param,
+     voxel, pointX, plane_normal, sharp_coord, eigenvalues,
+     num_large_eigenvalues, svd_info, buffer);
+}
+
+/// Compute sharp isosurface vertex using singular valued decomposition.
+/// Use Lindstrom's formula.
+/// If num_large_eigenvalues == 2, position vertex on plane.
+/// Version which reuses storage in buffer.
+void SHARPISO::svd_compute_sharp_vertex_on_plane_lindstrom
+ (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+  const GRADIENT_GRID_BASE & gradient_grid,
+  const VERTEX_INDEX cube_index,
+  const SCALAR_TYPE isovalue,
+  const SHARP_ISOVERT_PARAM & sharpiso_param,
+  const OFFSET_VOXEL & voxel,
+  const COORD_TYPE pointX[DIM3],
+  const COORD_TYPE plane_normal[DIM3],
+	COORD_TYPE sharp_coord[DIM3],
+	EIGENVALUE_TYPE eigenvalues[DIM3],
+	NUM_TYPE & num_large_eigenvalues,
+	SVD_INFO & svd_info,
+  GET_GRADIENTS_BUFFER & buffer)
 {
 	const EIGENVALUE_TYPE max_small_eigenvalue =
 		sharpiso_param.max_small_eigenvalue;
 
 	NUM_TYPE num_gradients = 0;
-	std::vector<COORD_TYPE> point_coord;
-	std::vector<GRADIENT_COORD_TYPE> gradient_coord;
-	std::vector<SCALAR_TYPE> scalar;
+	std::vector<COORD_TYPE> & point_coord = buffer.point_coord;
+	std::vector<GRADIENT_COORD_TYPE> & gradient_coord = buffer.gradient_coord;
+	std::vector<SCALAR_TYPE> & scalar = buffer.scalar;
 
 	// Scale cube coord by spacings
 	COORD_TYPE cube_coord[DIM3];
@@ -185,7 +363,7 @@ void SHARPISO::svd_compute_sharp_vertex_on_plane_lindstrom
 	get_gradients
 		(scalar_grid, gradient_grid, cube_index, isovalue,
 		sharpiso_param, voxel, sharpiso_param.flag_sort_gradients,
-		point_coord, gradient_coord, scalar, num_gradients);
+		point_coord, gradient_coord, scalar, num_gradients, buffer);
 
 	if (num_gradients == 0)
 	{
@@ -220,6 +398,83 @@ void SHARPISO::svd_compute_sharp_vertex_on_plane_lindstrom
   }
 }
 
+namespace {
+
+  /// Compute sharp isosurface vertex using singular valued decomposition.
+  /// @param edge_index Index of intersection on each grid edge.
+  ///   Supports edge_index.Vector(iv, edge_dir).
+  template <typename EDGE_INDEX_TYPE>
+  void svd_compute_sharp_vertex_hermite_edge_index
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const std::vector<COORD_TYPE> & edgeI_coord,
+   const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+   const EDGE_INDEX_TYPE & edge_index,
+   const VERTEX_INDEX cube_index,
+   const SCALAR_TYPE isovalue,
+   const SHARP_ISOVERT_PARAM & sharpiso_param,
+   COORD_TYPE sharp_coord[DIM3],
+   EIGENVALUE_TYPE eigenvalues[DIM3],
+   NUM_TYPE & num_large_eigenvalues,
+   SVD_INFO & svd_info)
+  {
+    const EIGENVALUE_TYPE max_small_eigenvalue =
+      sharpiso_param.max_small_eigenvalue;
+    const COORD_TYPE max_dist = sharpiso_param.max_dist;
+    IJK::PROCEDURE_ERROR error("svd_compute_sharp_vertex_for_cube");
+
+    NUM_TYPE num_gradients = 0;
+    std::vector<COORD_TYPE> point_coord;
+    std::vector<GRADIENT_COORD_TYPE> gradient_coord;
+    std::vector<SCALAR_TYPE> scalar;
+
+    if (!sharpiso_param.use_lindstrom) {
+      error.AddMessage("Programming error.  Normal based computation only implemented with Lindstrom.");
+      throw error;
+    }
+
+    // Compute coord of the cube.
+    COORD_TYPE cube_coord[DIM3];
+    scalar_grid.ComputeScaledCoord(cube_index, cube_coord);
+
+    get_gradients_from_list
+      (scalar_grid, edgeI_coord, edgeI_normal_coord, edge_index, 
+       cube_index, isovalue, sharpiso_param, 
+       point_coord, gradient_coord, scalar, num_gradients);
+
+    svd_info.location = LOC_SVD;
+    svd_info.flag_conflict = false;
+    svd_info.flag_Linf_iso_vertex_location = false;
+
+    // svd_calculate_sharpiso vertex using lindstrom
+    COORD_TYPE central_point[DIM3];
+    if (sharpiso_param.flag_dist2centroid) {
+      compute_edgeI_centroid
+        (scalar_grid, edgeI_coord, edge_index, isovalue, cube_index, 
+         central_point);
+    }
+    else {
+      scalar_grid.ComputeCubeCenterScaledCoord(cube_index, central_point);
+    }
+    IJK::copy_coord(DIM3, central_point, svd_info.central_point);
+
+    // use the sharp version with the Garland-Heckbert way of storing normals
+    svd_calculate_sharpiso_vertex_using_lindstrom_fast
+      (num_gradients, max_small_eigenvalue, isovalue, &(scalar[0]), 
+       &(point_coord[0]), &(gradient_coord[0]), central_point,
+       num_large_eigenvalues, eigenvalues, sharp_coord);
+
+    svd_info.cube_containing_coord = cube_index;
+
+    // *** PROBABLY should call postprocess_isovert_location HERE ***
+    if (!is_dist_to_cube_le(sharp_coord, cube_coord, 
+                            scalar_grid.SpacingPtrConst(), max_dist)) {
+      process_far_point(scalar_grid, cube_index, cube_coord, isovalue,
+                        sharpiso_param, sharp_coord, svd_info);
+    }
+  }
+
+}
+
 // Compute sharp isosurface vertex using singular valued decomposition.
 // Use input edge-isosurface intersections and normals
 //   to position isosurface vertices on sharp features.
@@ -236,60 +491,32 @@ void SHARPISO::svd_compute_sharp_vertex_for_cube_hermite
  NUM_TYPE & num_large_eigenvalues,
  SVD_INFO & svd_info)
 {
-  const EIGENVALUE_TYPE max_small_eigenvalue =
-    sharpiso_param.max_small_eigenvalue;
-  const COORD_TYPE max_dist = sharpiso_param.max_dist;
-  IJK::PROCEDURE_ERROR error("svd_compute_sharp_vertex_for_cube");
-
-  NUM_TYPE num_gradients = 0;
-  std::vector<COORD_TYPE> point_coord;
-  std::vector<GRADIENT_COORD_TYPE> gradient_coord;
-  std::vector<SCALAR_TYPE> scalar;
-
-  if (!sharpiso_param.use_lindstrom) {
-    error.AddMessage("Programming error.  Normal based computation only implemented with Lindstrom.");
-    throw error;
-  }
-
-  // Compute coord of the cube.
-  COORD_TYPE cube_coord[DIM3];
-  scalar_grid.ComputeScaledCoord(cube_index, cube_coord);
-
-  get_gradients_from_list
-    (scalar_grid, edgeI_coord, edgeI_normal_coord, edge_index, 
+  svd_compute_sharp_vertex_hermite_edge_index
+    (scalar_grid, edgeI_coord, edgeI_normal_coord, edge_index,
      cube_index, isovalue, sharpiso_param, 
-     point_coord, gradient_coord, scalar, num_gradients);
-
-  svd_info.location = LOC_SVD;
-  svd_info.flag_conflict = false;
-  svd_info.flag_Linf_iso_vertex_location = false;
-
-  // svd_calculate_sharpiso vertex using lindstrom
-  COORD_TYPE central_point[DIM3];
-  if (sharpiso_param.flag_dist2centroid) {
-    compute_edgeI_centroid
-      (scalar_grid, edgeI_coord, edge_index, isovalue, cube_index, 
-       central_point);
-  }
-  else {
-    scalar_grid.ComputeCubeCenterScaledCoord(cube_index, central_point);
-  }
-  IJK::copy_coord(DIM3, central_point, svd_info.central_point);
-
-  // use the sharp version with the Garland-Heckbert way of storing normals
-  svd_calculate_sharpiso_vertex_using_lindstrom_fast
-    (num_gradients, max_small_eigenvalue, isovalue, &(scalar[0]), 
-     &(point_coord[0]), &(gradient_coord[0]), central_point,
-     num_large_eigenvalues, eigenvalues, sharp_coord);
-
-  svd_info.cube_containing_coord = cube_index;
+     sharp_coord, eigenvalues, num_large_eigenvalues, svd_info);
+}
 
-  // *** PROBABLY should call postprocess_isovert_location HERE ***
-  if (!is_dist_to_cube_le(sharp_coord, cube_coord, 
-                          scalar_grid.SpacingPtrConst(), max_dist)) {
-    process_far_point(scalar_grid, cube_index, cube_coord, isovalue,
-                      sharpiso_param, sharp_coord, svd_info);
-  }
+// Compute sharp isosurface vertex using singular valued decomposition.
+// Use input edge-isosurface intersections and normals
+//   and sparse table of intersected edges.
+void SHARPISO::svd_compute_sharp_vertex_for_cube_hermite
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const std::vector<COORD_TYPE> & edgeI_coord,
+ const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+ const SHARPISO_EDGE_INDEX_TABLE & edge_index,
+ const VERTEX_INDEX cube_index,
+ const SCALAR_TYPE isovalue,
+ const SHARP_ISOVERT_PARAM & sharpiso_param,
+ COORD_TYPE sharp_coord[DIM3],
+ EIGENVALUE_TYPE eigenvalues[DIM3],
+ NUM_TYPE & num_large_eigenvalues,
+ SVD_INFO & svd_info)
+{
+  svd_compute_sharp_vertex_hermite_edge_index
+    (scalar_grid, edgeI_coord, edgeI_normal_coord, edge_index,
+     cube_index, isovalue, sharpiso_param, 
+     sharp_coord, eigenvalues, num_large_eigenvalues, svd_info);
 }
 
 
@@ -435,9 +662,9 @@ void SHARPISO::svd_compute_sharp_vertex_near_facet
   std::vector<COORD_TYPE> point_coord;
   std::vector<GRADIENT_COORD_TYPE> gradient_coord;
   std::vector<SCALAR_TYPE> scalar;
-  static COORD_TYPE v0_coord[DIM3];
-  static COORD_TYPE end[2][DIM3];
-  static COORD_TYPE endc[2];
+  COORD_TYPE v0_coord[DIM3];
+  COORD_TYPE end[2][DIM3];
+  COORD_TYPE endc[2];
 
   // Initialize
   sharp_vertex_location = 0;
@@ -534,16 +761,39 @@ void SHARPISO::subgrid_compute_sharp_vertex_in_cube
  const NUM_TYPE subgrid_axis_size,
  COORD_TYPE sharp_coord[DIM3],
  SCALAR_TYPE & scalar_stdev, SCALAR_TYPE & max_abs_scalar_error)
+{
+  GET_GRADIENTS_BUFFER buffer;
+
+  subgrid_compute_sharp_vertex_in_cube
+    (scalar_grid, gradient_grid, cube_index, isovalue, get_gradients_param,
+     offset_voxel, subgrid_axis_size, sharp_coord, 
+     scalar_stdev, max_abs_scalar_error, buffer);
+}
+
+/// Compute sharp vertex.
+/// Use subgrid sampling to locate isosurface vertex on sharp edge/corner.
+/// Version which reuses storage in buffer.
+void SHARPISO::subgrid_compute_sharp_vertex_in_cube
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const VERTEX_INDEX cube_index,
+ const SCALAR_TYPE isovalue,
+ const GET_GRADIENTS_PARAM & get_gradients_param,
+ const OFFSET_VOXEL & offset_voxel,
+ const NUM_TYPE subgrid_axis_size,
+ COORD_TYPE sharp_coord[DIM3],
+ SCALAR_TYPE & scalar_stdev, SCALAR_TYPE & max_abs_scalar_error,
+ GET_GRADIENTS_BUFFER & buffer)
 {
   NUM_TYPE num_gradients = 0;
-  std::vector<COORD_TYPE> point_coord;
-  std::vector<GRADIENT_COORD_TYPE> gradient_coord;
-  std::vector<SCALAR_TYPE> scalar;
+  std::vector<COORD_TYPE> & point_coord = buffer.point_coord;
+  std::vector<GRADIENT_COORD_TYPE> & gradient_coord = buffer.gradient_coord;
+  std::vector<SCALAR_TYPE> & scalar = buffer.scalar;
 
   get_gradients
     (scalar_grid, gradient_grid, cube_index, isovalue,
      get_gradients_param, offset_voxel, false,
-     point_coord, gradient_coord, scalar, num_gradients);
+     point_coord, gradient_coord, scalar, num_gradients, buffer);
 
   IJK::ARRAY<GRID_COORD_TYPE> cube_coord(DIM3);
   scalar_grid.ComputeScaledCoord(cube_index, cube_coord.Ptr());
@@ -659,14 +909,13 @@ void SHARPISO::compute_edgeI_centroid
  const SCALAR_TYPE isovalue, const VERTEX_INDEX iv,
  COORD_TYPE * coord)
 {
-  const int dimension = scalar_grid.Dimension();
-  
-  IJK::ARRAY<COORD_TYPE> vcoord(dimension);
-  IJK::ARRAY<COORD_TYPE> coord0(dimension);
-  IJK::ARRAY<COORD_TYPE> coord1(dimension);
-  IJK::ARRAY<COORD_TYPE> coord2(dimension);
+  const int dimension = DIM3;
+  COORD_TYPE vcoord[DIM3];
+  COORD_TYPE coord0[DIM3];
+  COORD_TYPE coord1[DIM3];
+  COORD_TYPE coord2[DIM3];
   int num_intersected_edges = 0;
-  IJK::set_coord(dimension, 0.0, vcoord.Ptr());
+  IJK::set_coord(dimension, 0.0, vcoord);
 
   for (int edge_dir = 0; edge_dir < dimension; edge_dir++)
     for (int k = 0; k < scalar_grid.NumFacetVertices(); k++) {
@@ -677,13 +926,13 @@ void SHARPISO::compute_edgeI_centroid
         SCALAR_TYPE s0 = scalar_grid.Scalar(iend0);
         SCALAR_TYPE s1 = scalar_grid.Scalar(iend1);
 
-        scalar_grid.ComputeScaledCoord(iend0, coord0.Ptr());
-        scalar_grid.ComputeScaledCoord(iend1, coord1.Ptr());
+        scalar_grid.ComputeScaledCoord(iend0, coord0);
+        scalar_grid.ComputeScaledCoord(iend1, coord1);
 
         IJK::linear_interpolate_coord
-          (dimension, s0, coord0.Ptr(), s1, coord1.Ptr(), isovalue, coord2.Ptr());
+          (dimension, s0, coord0, s1, coord1, isovalue, coord2);
 
-        IJK::add_coord(dimension, vcoord.Ptr(), coord2.Ptr(), vcoord.Ptr());
+        IJK::add_coord(dimension, vcoord, coord2, vcoord);
 
         num_intersected_edges++;
       }
@@ -691,13 +940,68 @@ void SHARPISO::compute_edgeI_centroid
 
   if (num_intersected_edges > 0) {
     IJK::multiply_coord
-      (dimension, 1.0/num_intersected_edges, vcoord.Ptr(), vcoord.Ptr());
+      (dimension, 1.0/num_intersected_edges, vcoord, vcoord);
   }
   else {
-    scalar_grid.ComputeCubeCenterScaledCoord(iv, vcoord.Ptr());
+    scalar_grid.ComputeCubeCenterScaledCoord(iv, vcoord);
   }
 
-  IJK::copy_coord(dimension, vcoord.Ptr(), coord);
+  IJK::copy_coord(dimension, vcoord, coord);
+
+}
+
+namespace {
+
+  /// Compute centroid of intersections of isosurface and grid edges.
+  /// @param edge_index Index of intersection on each grid edge.
+  ///   Supports edge_index.Vector(iv, edge_dir).
+  template <typename EDGE_INDEX_TYPE>
+  void compute_edgeI_centroid_edge_index
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const std::vector<COORD_TYPE> & edgeI_coord,
+   const EDGE_INDEX_TYPE & edge_index,
+   const SCALAR_TYPE isovalue, const VERTEX_INDEX cube_index,
+   COORD_TYPE * coord)
+  {
+    const int dimension = scalar_grid.Dimension();
+    IJK::ARRAY<COORD_TYPE> vcoord(dimension);
+    IJK::PROCEDURE_ERROR error("compute_edgeI_centroid");
+
+    int num_intersected_edges = 0;
+    IJK::set_coord(dimension, 0.0, vcoord.Ptr());
+
+    for (int edge_dir = 0; edge_dir < dimension; edge_dir++)
+      for (int k = 0; k < scalar_grid.NumFacetVertices(); k++) {
+        VERTEX_INDEX iend0 = scalar_grid.FacetVertex(cube_index, edge_dir, k);
+        VERTEX_INDEX iend1 = scalar_grid.NextVertex(iend0, edge_dir);
+
+        if (is_gt_min_le_max(scalar_grid, iend0, iend1, isovalue)) {
+
+          INDEX_DIFF_TYPE j = edge_index.Vector(iend0, edge_dir);
+
+          if (j < 0) {
+            error.AddMessage
+              ("Error.  Missing edge-isosurface intersection for edge (",
+               iend0, ",", iend1, ").");
+            throw error;
+          }
+
+          IJK::add_coord(dimension, vcoord.Ptr(), &(edgeI_coord[j*DIM3]), vcoord.Ptr());
+
+          num_intersected_edges++;
+        }
+      }
+
+    if (num_intersected_edges > 0) {
+      IJK::multiply_coord
+        (dimension, 1.0/num_intersected_edges, vcoord.Ptr(), vcoord.Ptr());
+    }
+    else {
+      scalar_grid.ComputeCubeCenterScaledCoord(cube_index, vcoord.Ptr());
+    }
+
+    IJK::copy_coord(dimension, vcoord.Ptr(), coord);
+  }
 
 }
 
@@ -710,44 +1014,22 @@ void SHARPISO::compute_edgeI_centroid
  const SCALAR_TYPE isovalue, const VERTEX_INDEX cube_index,
  COORD_TYPE * coord)
 {
-  const int dimension = scalar_grid.Dimension();
-  IJK::ARRAY<COORD_TYPE> vcoord(dimension);
-  IJK::PROCEDURE_ERROR error("compute_edgeI_centroid");
-
-  int num_intersected_edges = 0;
-  IJK::set_coord(dimension, 0.0, vcoord.Ptr());
-
-  for (int edge_dir = 0; edge_dir < dimension; edge_dir++)
-    for (int k = 0; k < scalar_grid.NumFacetVertices(); k++) {
-      VERTEX_INDEX iend0 = scalar_grid.FacetVertex(cube_index, edge_dir, k);
-      VERTEX_INDEX iend1 = scalar_grid.NextVertex(iend0, edge_dir);
-
-      if (is_gt_min_le_max(scalar_grid, iend0, iend1, isovalue)) {
-
-        INDEX_DIFF_TYPE j = edge_index.Vector(iend0, edge_dir);
-
-        if (j < 0) {
-          error.AddMessage
-            ("Error.  Missing edge-isosurface intersection for edge (",
-             iend0, ",", iend1, ").");
-          throw error;
-        }
-
-        IJK::add_coord(dimension, vcoord.Ptr(), &(edgeI_coord[j*DIM3]), vcoord.Ptr());
-
-        num_intersected_edges++;
-      }
-    }
-
-  if (num_intersected_edges > 0) {
-    IJK::multiply_coord
-      (dimension, 1.0/num_intersected_edges, vcoord.Ptr(), vcoord.Ptr());
-  }
-  else {
-    scalar_grid.ComputeCubeCenterScaledCoord(cube_index, vcoord.Ptr());
-  }
+  compute_edgeI_centroid_edge_index
+    (scalar_grid, edgeI_coord, edge_index, isovalue, cube_index, coord);
+}
 
-  IJK::copy_coord(dimension, vcoord.Ptr(), coord);
+// Compute centroid of intersections of isosurface and grid edges.
+//   Edge-isosurface intersections are given in an input list.
+//   Use sparse table of intersected edges.
+void SHARPISO::compute_edgeI_centroid
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const std::vector<COORD_TYPE> & edgeI_coord,
+ const SHARPISO_EDGE_INDEX_TABLE & edge_index,
+ const SCALAR_TYPE isovalue, const VERTEX_INDEX cube_index,
+ COORD_TYPE * coord)
+{
+  compute_edgeI_centroid_edge_index
+    (scalar_grid, edgeI_coord, edge_index, isovalue, cube_index, coord);
 }
 
 /// Compute centroid of intersections of isosurface and grid edges.
@@ -858,7 +1140,7 @@ void SHARPISO::get_cube_containing_point
  VERTEX_INDEX & cube_index, bool & flag_boundary)
 {
   const COORD_TYPE * spacing = grid.SpacingPtrConst();
-  static COORD_TYPE coord2[DIM3];
+  COORD_TYPE coord2[DIM3];
 
   flag_boundary = false;
   for (int d = 0; d < DIM3; d++) {
@@ -867,6 +1149,9 @@ void SHARPISO::get_cube_containing_point
     if (coord2[d] == coord[d]/spacing[d])
       { flag_boundary = true; }
 
+    // Convert from coordinates in the larger grid.
+    coord2[d] -= grid.CoordOffset(d);
+
     if (coord2[d] < 0) {
       coord2[d] = 0;
       flag_boundary = true;
@@ -907,7 +1192,7 @@ void get_all_cubes_containing_point
  std::vector<VERTEX_INDEX> & cube_list)
 {
   const COORD_TYPE * spacing = grid.SpacingPtrConst();
-  static COORD_TYPE coord2[DIM3];
+  COORD_TYPE coord2[DIM3];
 
   cube_list.clear();
 
@@ -917,7 +1202,12 @@ void get_all_cubes_containing_point
     for (int d = 0; d < DIM3; d++) {
       coord2[d] = floor(coord[d]/spacing[d]);
 
-      if (coord2[d] == coord[d]/spacing[d]) {
+      const bool flag_on_boundary = (coord2[d] == coord[d]/spacing[d]);
+
+      // Convert from coordinates in the larger grid.
+      coord2[d] -= grid.CoordOffset(d);
+
+      if (flag_on_boundary) {
         int mask = (1L << d);
         if ((mask & index) == 0) {
           if (coord2[d] > 0)
@@ -1249,9 +1539,13 @@ void SHARPISO::SHARP_ISOVERT_PARAM::Init()
   max_small_eigenvalue = 0.1;
   round_denominator = 16;
   max_small_grad_coord_Linf = 0.2;
+  flag_recompute_isovert = true;
   flag_recompute_changing_gradS_offset = true;
   linf_dist_thresh_merge_sharp = 1.5;
   bin_width = 5;
+  num_threads = 1;
+  stage_profiler = NULL;
+  use_sparse_isovert_index = false;
   flag_map_extended = false;
   flag_select_mod3 = false;
   flag_select_mod6 = false;
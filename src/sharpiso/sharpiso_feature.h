@@ -32,8 +32,10 @@
 
 #include "ijkgrid.txx"
 #include "ijkscalar_grid.txx"
+#include "ijktime.txx"
 #include "ijkvector_grid.txx"
 
+class LINDSTROM_BATCH;      // Defined in sharpiso_svd.h.
 
 /// Definitions
 namespace SHARPISO {
@@ -67,6 +69,26 @@ namespace SHARPISO {
    NUM_TYPE & num_large_eigenvalues,
    SVD_INFO & svd_info);
 
+  /// Compute sharp isosurface vertex using singular valued decomposition.
+  /// Use Lindstrom's formula.
+  /// Version which reuses storage in buffer.
+  /// @param pointX Compute vertex closest to pointX.
+  void svd_compute_sharp_vertex_for_cube_lindstrom
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const GRADIENT_GRID_BASE & gradient_grid,
+   const VERTEX_INDEX cube_index,
+   const SCALAR_TYPE isovalue,
+   const SHARP_ISOVERT_PARAM & sharpiso_param,
+   const OFFSET_VOXEL & voxel,
+   const COORD_TYPE pointX[DIM3],
+   COORD_TYPE sharp_coord[DIM3],
+   COORD_TYPE edge_direction[DIM3],
+   COORD_TYPE orth_direction[DIM3],
+   EIGENVALUE_TYPE eigenvalues[DIM3],
+   NUM_TYPE & num_large_eigenvalues,
+   SVD_INFO & svd_info,
+   GET_GRADIENTS_BUFFER & buffer);
+
   /// Compute sharp isosurface vertex using singular valued decomposition.
   /// Use Lindstrom's formula.
   /// Compute vertex closest to cube center or centroid 
@@ -85,6 +107,58 @@ namespace SHARPISO {
    NUM_TYPE & num_large_eigenvalues,
    SVD_INFO & svd_info);
 
+  /// Compute sharp isosurface vertex using singular valued decomposition.
+  /// Use Lindstrom's formula.
+  /// Version which reuses storage in buffer.
+  void svd_compute_sharp_vertex_for_cube_lindstrom
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const GRADIENT_GRID_BASE & gradient_grid,
+   const VERTEX_INDEX cube_index,
+   const SCALAR_TYPE isovalue,
+   const SHARP_ISOVERT_PARAM & sharpiso_param,
+   const OFFSET_VOXEL & voxel,
+   COORD_TYPE sharp_coord[DIM3],
+   COORD_TYPE edge_direction[DIM3],
+   COORD_TYPE orth_direction[DIM3],
+   EIGENVALUE_TYPE eigenvalues[DIM3],
+   NUM_TYPE & num_large_eigenvalues,
+   SVD_INFO & svd_info,
+   GET_GRADIENTS_BUFFER & buffer);
+
+  /// Compute sharp isosurface vertices for a list of cubes
+  ///   using singular valued decomposition and Lindstrom's formula.
+  /// Lindstrom matrices for all the cubes are accumulated and solved
+  ///   together in one batch (LINDSTROM_BATCH).
+  /// Same output as svd_compute_sharp_vertex_for_cube_lindstrom
+  ///   (without pointX) on each cube.
+  /// Cubes without gradients and post processing of far or conflicting
+  ///   vertices are handled one cube at a time.
+  /// @param cube_index[] List of num_cubes cubes.
+  /// @param sharp_coord[] Sharp vertex coordinates.
+  ///   sharp_coord[DIM3*k+d] is the d'th coordinate 
+  ///   of the sharp vertex of cube_index[k].
+  ///   Array edge_direction[], orth_direction[] and eigenvalues[] 
+  ///   are stored the same way.
+  /// @param buffer Storage reused for each cube.
+  /// @param batch Batch reused for each call.  Cleared before use.
+  /// @pre batch.MaxNumCubes() >= num_cubes.
+  void svd_compute_sharp_vertex_for_cubes_lindstrom
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const GRADIENT_GRID_BASE & gradient_grid,
+   const VERTEX_INDEX * cube_index,
+   const NUM_TYPE num_cubes,
+   const SCALAR_TYPE isovalue,
+   const SHARP_ISOVERT_PARAM & sharpiso_param,
+   const OFFSET_VOXEL & voxel,
+   COORD_TYPE * sharp_coord,
+   COORD_TYPE * edge_direction,
+   COORD_TYPE * orth_direction,
+   EIGENVALUE_TYPE * eigenvalues,
+   NUM_TYPE * num_large_eigenvalues,
+   SVD_INFO * svd_info,
+   GET_GRADIENTS_BUFFER & buffer,
+   LINDSTROM_BATCH & batch);
+
   /// Compute sharp isosurface vertex using singular valued decomposition.
   /// Use Lindstrom's formula.
   /// If num_large_eigenvalues == 2, position vertex on plane.
@@ -104,6 +178,25 @@ namespace SHARPISO {
    NUM_TYPE & num_large_eigenvalues,
    SVD_INFO & svd_info);
 
+  /// Compute sharp isosurface vertex using singular valued decomposition.
+  /// Use Lindstrom's formula.
+  /// If num_large_eigenvalues == 2, position vertex on plane.
+  /// Version which reuses storage in buffer.
+  void svd_compute_sharp_vertex_on_plane_lindstrom
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const GRADIENT_GRID_BASE & gradient_grid,
+   const VERTEX_INDEX cube_index,
+   const SCALAR_TYPE isovalue,
+   const SHARP_ISOVERT_PARAM & sharpiso_param,
+   const OFFSET_VOXEL & voxel,
+   const COORD_TYPE pointX[DIM3],
+   const COORD_TYPE plane_normal[DIM3],
+   COORD_TYPE sharp_coord[DIM3],
+   EIGENVALUE_TYPE eigenvalues[DIM3],
+   NUM_TYPE & num_large_eigenvalues,
+   SVD_INFO & svd_info,
+   GET_GRADIENTS_BUFFER & buffer);
+
   /// Compute sharp isosurface vertex using singular valued decomposition.
   /// Use input edge-isosurface intersections and normals
   ///   to position isosurface vertices on sharp features.
@@ -120,6 +213,22 @@ namespace SHARPISO {
    NUM_TYPE & num_large_eigenvalues,
    SVD_INFO & svd_info);
 
+  /// Compute sharp isosurface vertex using singular valued decomposition.
+  /// Use input edge-isosurface intersections and normals
+  ///   and sparse table of intersected edges.
+  void svd_compute_sharp_vertex_for_cube_hermite
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const std::vector<COORD_TYPE> & edgeI_coord,
+   const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+   const SHARPISO_EDGE_INDEX_TABLE & edge_index,
+   const VERTEX_INDEX cube_index,
+   const SCALAR_TYPE isovalue,
+   const SHARP_ISOVERT_PARAM & sharpiso_param,
+   COORD_TYPE sharp_coord[DIM3],
+   EIGENVALUE_TYPE eigenvalues[DIM3],
+   NUM_TYPE & num_large_eigenvalues,
+   SVD_INFO & svd_info);
+
 
   // ********************************************************************
   // COMPUTE SHARP VERTEX/EDGE USING SVD & EDGE-ISOSURFACE INTERSECTIONS
@@ -205,6 +314,20 @@ namespace SHARPISO {
    COORD_TYPE sharp_coord[DIM3],
    SCALAR_TYPE & scalar_stdev, SCALAR_TYPE & max_abs_scalar_error);
 
+  /// Compute sharp isosurface vertex using subgrid sampling of cube.
+  /// Version which reuses storage in buffer.
+  void subgrid_compute_sharp_vertex_in_cube
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const GRADIENT_GRID_BASE & gradient_grid,
+   const VERTEX_INDEX cube_index,
+   const SCALAR_TYPE isovalue,
+   const GET_GRADIENTS_PARAM & get_gradients_param,
+   const OFFSET_VOXEL & offset_voxel,
+   const NUM_TYPE subgrid_axis_size,
+   COORD_TYPE sharp_coord[DIM3],
+   SCALAR_TYPE & scalar_stdev, SCALAR_TYPE & max_abs_scalar_error,
+   GET_GRADIENTS_BUFFER & buffer);
+
   /// Calculate isosurface vertex using regular subgrid of the cube.
   void subgrid_calculate_iso_vertex_in_cube
   (const COORD_TYPE * point_coord, const GRADIENT_COORD_TYPE * gradient_coord,
@@ -262,6 +385,15 @@ namespace SHARPISO {
    const SCALAR_TYPE isovalue, const VERTEX_INDEX cube_index,
    COORD_TYPE * coord);
 
+  /// Compute centroid of intersections of isosurface and grid edges.
+  ///   Use sparse table of intersected edges.
+  void compute_edgeI_centroid
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const std::vector<COORD_TYPE> & edgeI_coord,
+   const SHARPISO_EDGE_INDEX_TABLE & edge_index,
+   const SCALAR_TYPE isovalue, const VERTEX_INDEX cube_index,
+   COORD_TYPE * coord);
+
 
   // **************************************************
   // POINT LOCATION/CONFLICT ROUTINES
@@ -451,6 +583,18 @@ namespace SHARPISO {
     /// Width of bin in BIN_GRID.
     int bin_width;
 
+    /// Number of threads used in computing isosurface vertex positions.
+    /// If num_threads is 0, use all hardware threads.
+    int num_threads;
+
+    /// If not NULL, record stage running times in stage_profiler.
+    IJK::STAGE_PROFILER * stage_profiler;
+
+    /// If true, store the isosurface vertex index of each active cube
+    ///   in a hash table instead of a full size grid.
+    /// Uses less memory for large grids with few active cubes.
+    bool use_sparse_isovert_index;
+
     /// Round to nearest 1/round_denominator
     int round_denominator;
 
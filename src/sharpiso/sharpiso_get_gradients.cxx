@@ -21,6 +21,7 @@ License along with this library; if not, write to the Free Software
 Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <algorithm>
 #include <iomanip>
 
 #include "sharpiso_get_gradients.h"
@@ -147,9 +148,8 @@ namespace {
 	{
 		typedef SHARPISO_SCALAR_GRID::DIMENSION_TYPE DTYPE;
 
-		// static so not reallocated at each call
-		static GRID_COORD_TYPE vertex_coord[DIM3];
-		static SIGNED_COORD_TYPE coord[DIM3];
+		GRID_COORD_TYPE vertex_coord[DIM3];
+		SIGNED_COORD_TYPE coord[DIM3];
 
 		GRADIENT_COORD_TYPE magnitude_squared =
 			gradient_grid.ComputeMagnitudeSquared(iv);
@@ -190,7 +190,9 @@ namespace {
 		list_length = new_list_length;
 	}
 
-	/// Get selected vertices
+	/// Get selected vertices.
+	/// @param vertex_flag[] Array of length at least num_vertices.
+	///   Used as scratch storage.
 	void get_selected_vertices
 		(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
 		const GRADIENT_GRID_BASE & gradient_grid,
@@ -200,6 +202,7 @@ namespace {
 		const OFFSET_VOXEL & voxel,
 		const int num_vertices,
 		VERTEX_INDEX vertex_list[],
+		bool vertex_flag[],
 		NUM_TYPE & num_selected)
 	{
 		const GRADIENT_COORD_TYPE max_small_mag = 
@@ -207,14 +210,13 @@ namespace {
 		const GRADIENT_COORD_TYPE max_small_mag_squared = 
 			max_small_mag * max_small_mag;
 
-		// static so not reallocated at each call
-		static GRID_COORD_TYPE cube_coord[DIM3];
+		GRID_COORD_TYPE cube_coord[DIM3];
 
-		IJK::ARRAY<bool> vertex_flag(num_vertices, true);
+		std::fill(vertex_flag, vertex_flag+num_vertices, true);
 
 		deselect_vertices_with_small_gradients
 			(gradient_grid, vertex_list, num_vertices, max_small_mag_squared,
-			vertex_flag.Ptr());
+			vertex_flag);
 
 		if (sharpiso_param.use_selected_gradients &&
 			!sharpiso_param.select_based_on_grad_dir) {
@@ -223,12 +225,40 @@ namespace {
 
 				deselect_vertices_based_on_isoplanes
 					(scalar_grid, gradient_grid, cube_coord, voxel,
-					isovalue, vertex_list, num_vertices, vertex_flag.Ptr());
+					isovalue, vertex_list, num_vertices, vertex_flag);
 		}
 
 		num_selected = num_vertices;
-		get_flagged_list_elements
-			(vertex_flag.PtrConst(), vertex_list, num_selected);
+		get_flagged_list_elements(vertex_flag, vertex_list, num_selected);
+	}
+
+	/// Get selected vertices
+	void get_selected_vertices
+		(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+		const GRADIENT_GRID_BASE & gradient_grid,
+		const VERTEX_INDEX cube_index,
+		const SCALAR_TYPE isovalue,
+		const GET_GRADIENTS_PARAM & sharpiso_param,
+		const OFFSET_VOXEL & voxel,
+		const int num_vertices,
+		VERTEX_INDEX vertex_list[],
+		NUM_TYPE & num_selected)
+	{
+		// Use stack storage for short lists to avoid heap allocation.
+		const int MAX_NUM_STACK_FLAGS = 256;
+
+		if (num_vertices <= MAX_NUM_STACK_FLAGS) {
+			bool vertex_flag[MAX_NUM_STACK_FLAGS];
+			get_selected_vertices
+				(scalar_grid, gradient_grid, cube_index, isovalue, sharpiso_param,
+				voxel, num_vertices, vertex_list, vertex_flag, num_selected);
+		}
+		else {
+			IJK::ARRAY<bool> vertex_flag(num_vertices);
+			get_selected_vertices
+				(scalar_grid, gradient_grid, cube_index, isovalue, sharpiso_param,
+				voxel, num_vertices, vertex_list, vertex_flag.Ptr(), num_selected);
+		}
 	}
 
 	/// Get selected vertices.
@@ -288,11 +318,9 @@ namespace {
 		NUM_TYPE & num_selected)
 	{
 		// NOTE: cube_vertex_list is an array.
-		// static so not reallocated at each call
-		static GRID_COORD_TYPE cube_coord[DIM3];
+		GRID_COORD_TYPE cube_coord[DIM3];
 
 		NUM_TYPE num_vertices(0);
-		IJK::ARRAY<bool> vertex_flag(NUM_CUBE_VERTICES3D, true);
 
 		if (sharpiso_param.use_intersected_edge_endpoint_gradients) {
 
@@ -482,6 +510,30 @@ void SHARPISO::get_gradients
 	std::vector<GRADIENT_COORD_TYPE> & gradient_coord,
 	std::vector<SCALAR_TYPE> & scalar,
 	NUM_TYPE & num_gradients)
+{
+  GET_GRADIENTS_BUFFER buffer;
+
+  get_gradients
+    (scalar_grid, gradient_grid, cube_index, isovalue, sharpiso_param,
+     voxel, flag_sort_gradients, point_coord, gradient_coord, scalar,
+     num_gradients, buffer);
+}
+
+/// Get gradients.
+/// Version which reuses storage in buffer.
+void SHARPISO::get_gradients
+	(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+	const GRADIENT_GRID_BASE & gradient_grid,
+	const VERTEX_INDEX cube_index,
+	const SCALAR_TYPE isovalue,
+	const GET_GRADIENTS_PARAM & sharpiso_param,
+	const OFFSET_VOXEL & voxel,
+	const bool flag_sort_gradients,
+	std::vector<COORD_TYPE> & point_coord,
+	std::vector<GRADIENT_COORD_TYPE> & gradient_coord,
+	std::vector<SCALAR_TYPE> & scalar,
+	NUM_TYPE & num_gradients,
+  GET_GRADIENTS_BUFFER & buffer)
 {
 	//DEBUG
 	using namespace std;
@@ -511,7 +563,8 @@ void SHARPISO::get_gradients
 	{
 
 		// NOTE: vertex_list is a C++ vector.
-		std::vector<VERTEX_INDEX> vertex_list;
+		std::vector<VERTEX_INDEX> & vertex_list = buffer.vertex_list;
+		vertex_list.clear();
 		//cube gradients
 		if (sharpiso_param.use_only_cube_gradients) 
 		{
@@ -529,7 +582,7 @@ void SHARPISO::get_gradients
         if (sharpiso_param.use_new_version) {
           get_ie_endpoints_in_large_neighborhood
             (scalar_grid, gradient_grid, isovalue, cube_index,
-             sharpiso_param, vertex_list);
+             sharpiso_param, vertex_list, buffer);
         }
         else {
           get_ie_endpoints_in_large_neighborhood_old_version
@@ -1161,6 +1214,57 @@ void SHARPISO::get_intersected_neighbor_edge_endpoint_gradients
 
 }
 
+namespace {
+
+	/// Get gradients from list of edge-isosurface intersections.
+	/// @param edge_index Index of intersection on each grid edge.
+	///   Supports edge_index.Vector(iv, edge_dir).
+	template <typename EDGE_INDEX_TYPE>
+	void get_gradients_from_edge_index
+		(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+		const std::vector<COORD_TYPE> & edgeI_coord,
+		const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+		const EDGE_INDEX_TYPE & edge_index,
+		const VERTEX_INDEX cube_index,
+		const SCALAR_TYPE isovalue,
+		const GET_GRADIENTS_PARAM & sharpiso_param,
+		std::vector<COORD_TYPE> & point_coord,
+		std::vector<GRADIENT_COORD_TYPE> & gradient_coord,
+		std::vector<SCALAR_TYPE> & scalar,
+		NUM_TYPE & num_gradients)
+	{
+		const GRADIENT_COORD_TYPE max_small_mag =
+			sharpiso_param.max_small_magnitude;
+		const GRADIENT_COORD_TYPE max_small_mag_squared =
+			max_small_mag*max_small_mag;
+		IJK::PROCEDURE_ERROR error("get_gradients_from_list");
+
+		for (NUM_TYPE edge_dir = 0; edge_dir < DIM3; edge_dir++) {
+
+			for (NUM_TYPE k = 0; k < NUM_CUBE_FACET_VERTICES3D; k++) {
+				VERTEX_INDEX iv0 = scalar_grid.FacetVertex(cube_index, edge_dir, k);
+				VERTEX_INDEX iv1 = scalar_grid.NextVertex(iv0, edge_dir);
+
+				if (IJK::is_gt_min_le_max(scalar_grid, iv0, iv1, isovalue)) {
+					INDEX_DIFF_TYPE j = edge_index.Vector(iv0, edge_dir);
+
+					if (j < 0) {
+						error.AddMessage
+							("Error.  Missing edge-isosurface intersection for edge (",
+							iv0, ",", iv1, ").");
+						throw error;
+					}
+
+					add_large_gradient
+						(edgeI_coord, edgeI_normal_coord, j, isovalue, max_small_mag_squared,
+						point_coord, gradient_coord, scalar, num_gradients);
+				}
+			}
+		}
+	}
+
+}
+
 /// Get gradients from list of edge-isosurface intersections.
 /// @param sharpiso_param Determines which gradients are selected.
 /// @param flag_sort_gradients If true, sort gradients.  
@@ -1178,34 +1282,32 @@ void SHARPISO::get_gradients_from_list
 	std::vector<SCALAR_TYPE> & scalar,
 	NUM_TYPE & num_gradients)
 {
-	const GRADIENT_COORD_TYPE max_small_mag =
-		sharpiso_param.max_small_magnitude;
-	const GRADIENT_COORD_TYPE max_small_mag_squared =
-		max_small_mag*max_small_mag;
-	IJK::PROCEDURE_ERROR error("get_gradients_from_list");
-
-	for (NUM_TYPE edge_dir = 0; edge_dir < DIM3; edge_dir++) {
-
-		for (NUM_TYPE k = 0; k < NUM_CUBE_FACET_VERTICES3D; k++) {
-			VERTEX_INDEX iv0 = scalar_grid.FacetVertex(cube_index, edge_dir, k);
-			VERTEX_INDEX iv1 = scalar_grid.NextVertex(iv0, edge_dir);
-
-			if (IJK::is_gt_min_le_max(scalar_grid, iv0, iv1, isovalue)) {
-				INDEX_DIFF_TYPE j = edge_index.Vector(iv0, edge_dir);
-
-				if (j < 0) {
-					error.AddMessage
-						("Error.  Missing edge-isosurface intersection for edge (",
-						iv0, ",", iv1, ").");
-					throw error;
-				}
+	get_gradients_from_edge_index
+		(scalar_grid, edgeI_coord, edgeI_normal_coord, edge_index, 
+		cube_index, isovalue, sharpiso_param, 
+		point_coord, gradient_coord, scalar, num_gradients);
+}
 
-				add_large_gradient
-					(edgeI_coord, edgeI_normal_coord, j, isovalue, max_small_mag_squared,
-					point_coord, gradient_coord, scalar, num_gradients);
-			}
-		}
-	}
+/// Get gradients from list of edge-isosurface intersections.
+/// Use sparse table of intersected edges.
+/// @param sharpiso_param Determines which gradients are selected.
+void SHARPISO::get_gradients_from_list
+	(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+	const std::vector<COORD_TYPE> & edgeI_coord,
+	const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+	const SHARPISO_EDGE_INDEX_TABLE & edge_index,
+	const VERTEX_INDEX cube_index,
+	const SCALAR_TYPE isovalue,
+	const GET_GRADIENTS_PARAM & sharpiso_param,
+	std::vector<COORD_TYPE> & point_coord,
+	std::vector<GRADIENT_COORD_TYPE> & gradient_coord,
+	std::vector<SCALAR_TYPE> & scalar,
+	NUM_TYPE & num_gradients)
+{
+	get_gradients_from_edge_index
+		(scalar_grid, edgeI_coord, edgeI_normal_coord, edge_index, 
+		cube_index, isovalue, sharpiso_param, 
+		point_coord, gradient_coord, scalar, num_gradients);
 }
 
 
@@ -1360,8 +1462,7 @@ void SHARPISO::get_cube_neighbor_vertices
 {
 	typedef SHARPISO_SCALAR_GRID::DIMENSION_TYPE DTYPE;
 
-	// static so not reallocated at each call
-	static GRID_COORD_TYPE cube_coord[DIM3];
+	GRID_COORD_TYPE cube_coord[DIM3];
 
 	vertex_list.resize(NUM_CUBE_VERTICES3D);
 	get_cube_vertices(grid, cube_index, &vertex_list[0]);
@@ -1853,6 +1954,61 @@ void SHARPISO::get_ie_endpoints_in_large_neighborhood
 	const VERTEX_INDEX cube_index,
 	const GET_GRADIENTS_PARAM & gradient_param,
 	std::vector<VERTEX_INDEX> & vertex_list)
+{
+  GET_GRADIENTS_BUFFER buffer;
+
+  get_ie_endpoints_in_large_neighborhood
+    (scalar_grid, gradient_grid, isovalue, cube_index, gradient_param,
+     vertex_list, buffer);
+}
+
+// local namespace
+namespace {
+
+  /// Compute region within boundary around given cube.
+  /// 3D version of IJK::compute_region_around_cube()
+  ///   which does not allocate any memory.
+  void compute_region_around_cube_3D
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid, 
+   const VERTEX_INDEX icube, const NUM_TYPE dist2cube, 
+   VERTEX_INDEX & region_iv0, AXIS_SIZE_TYPE region_axis_size[DIM3])
+  {
+    const AXIS_SIZE_TYPE * axis_size = scalar_grid.AxisSize();
+    AXIS_SIZE_TYPE cube_coord[DIM3];
+    AXIS_SIZE_TYPE region_iv0_coord[DIM3];
+
+    IJK::compute_coord(icube, DIM3, axis_size, cube_coord);
+
+    for (int d = 0; d < DIM3; d++) {
+      if (cube_coord[d] > dist2cube) 
+        { region_iv0_coord[d] = cube_coord[d]-dist2cube; }
+      else
+        { region_iv0_coord[d] = 0; }
+
+      AXIS_SIZE_TYPE c = cube_coord[d]+dist2cube+2;
+      if (c <= axis_size[d]) 
+        { region_axis_size[d] = c-region_iv0_coord[d]; }
+      else 
+        { region_axis_size[d] = axis_size[d]-region_iv0_coord[d]; }
+    }
+
+    region_iv0 = 
+      IJK::compute_vertex_index<VERTEX_INDEX>
+      (region_iv0_coord, DIM3, axis_size);
+  }
+
+}
+
+/// Get intersected edge endpoints in large neighborhood.
+/// Version which reuses subgrids and lists in buffer.
+void SHARPISO::get_ie_endpoints_in_large_neighborhood
+	(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+	const GRADIENT_GRID_BASE & gradient_grid,
+	const SCALAR_TYPE isovalue,
+	const VERTEX_INDEX cube_index,
+	const GET_GRADIENTS_PARAM & gradient_param,
+	std::vector<VERTEX_INDEX> & vertex_list,
+  GET_GRADIENTS_BUFFER & buffer)
 {
 	typedef SHARPISO_SCALAR_GRID_BASE::DIMENSION_TYPE DTYPE;
 
@@ -1861,22 +2017,36 @@ void SHARPISO::get_ie_endpoints_in_large_neighborhood
 	const GRADIENT_COORD_TYPE max_small_magnitude =
 		gradient_param.max_small_magnitude;
 	VERTEX_INDEX region_iv0, subgrid_cube_index;
-	IJK::ARRAY<AXIS_SIZE_TYPE> region_axis_size(dimension);
-	std::vector<VERTEX_INDEX> vlist2;
+	NUM_TYPE num_subgrid_vertices;
+	AXIS_SIZE_TYPE region_axis_size[DIM3];
+	std::vector<VERTEX_INDEX> & vlist2 = buffer.vlist2;
+	SHARPISO_INDEX_GRID & subgrid = buffer.subgrid;
+	SHARPISO_BOOL_GRID & visited = buffer.visited;
+	SHARPISO_SCALAR_GRID & scalar_subgrid = buffer.scalar_subgrid;
 	long boundary_bits, boundary_bits2;
 
+	if (dimension != DIM3) {
+		IJK::PROCEDURE_ERROR error("get_ie_endpoints_in_large_neighborhood");
+		error.AddMessage("Programming error.  Grid dimension must be 3.");
+		throw error;
+	}
+
 	vertex_list.clear();
+	vlist2.clear();
 
 	get_cube_vertices_with_large_gradients
 		(scalar_grid, gradient_grid, cube_index, max_small_magnitude,
 		vertex_list);
 
-	IJK::compute_region_around_cube
-		(cube_index, dimension, scalar_grid.AxisSize(), max_grad_dist,
-		region_iv0, region_axis_size.Ptr());
+	compute_region_around_cube_3D
+		(scalar_grid, cube_index, max_grad_dist, region_iv0, region_axis_size);
 
-	SHARPISO_INDEX_GRID subgrid(dimension, region_axis_size.PtrConst());
-	subgrid.SetToVertexIndices(scalar_grid, region_iv0);
+	// Set subgrid to vertex indices using the precomputed axis increments
+	//   of scalar_grid.  Avoids allocating a temporary increment array.
+	subgrid.SetSize(dimension, region_axis_size);
+	IJK::get_subgrid_vertices
+		(dimension, scalar_grid.AxisSize(), scalar_grid.AxisIncrement(),
+		region_iv0, region_axis_size, subgrid.ScalarPtr(), num_subgrid_vertices);
 
 	// Locate subgrid_cube_index
 	subgrid_cube_index = 0;
@@ -1885,9 +2055,7 @@ void SHARPISO::get_ie_endpoints_in_large_neighborhood
 		{ subgrid_cube_index = iv; }
 	}
 
-	SHARPISO_BOOL_GRID visited;
 	visited.SetSize(subgrid);
-
 	visited.SetAll(false);
 
 	for (NUM_TYPE k = 0; k < NUM_CUBE_VERTICES3D; k++) {
@@ -1896,11 +2064,11 @@ void SHARPISO::get_ie_endpoints_in_large_neighborhood
 		vlist2.push_back(kv);
 	}
 
-	SHARPISO_SCALAR_GRID scalar_subgrid;
 	scalar_subgrid.SetSize(subgrid);
 
-	scalar_subgrid.CopyRegion
-		(scalar_grid, region_iv0, scalar_subgrid.AxisSize(), 0);
+	// Equivalent to CopyRegion() but without temporary arrays.
+	for (VERTEX_INDEX kv = 0; kv < subgrid.NumVertices(); kv++)
+		{ scalar_subgrid.Set(kv, scalar_grid.Scalar(subgrid.Scalar(kv))); }
 
 	while (vlist2.size() != 0) {
 		VERTEX_INDEX kv = vlist2.back();
@@ -2029,8 +2197,7 @@ void SHARPISO::sort_vertices_by_isoplane_dist2cc
 {
 	typedef SHARPISO_SCALAR_GRID::DIMENSION_TYPE DTYPE;
 
-	// static so not reallocated at each call
-	static COORD_TYPE cube_center[DIM3];
+	COORD_TYPE cube_center[DIM3];
 
 	scalar_grid.ComputeCoord(cube_index, cube_center);
 
@@ -2149,9 +2316,8 @@ void SHARPISO::deselect_vertices_based_on_isoplanes
 {
 	typedef SHARPISO_SCALAR_GRID::DIMENSION_TYPE DTYPE;
 
-	// static so not reallocated at each call
-	static COORD_TYPE vertex_coord[DIM3];
-	static COORD_TYPE coord[DIM3];
+	COORD_TYPE vertex_coord[DIM3];
+	COORD_TYPE coord[DIM3];
 
 	for (NUM_TYPE i = 0; i < num_vertices; i++) {
 
@@ -44,6 +44,7 @@ namespace SHARPISO {
 
   class OFFSET_VOXEL;
   class GET_GRADIENTS_PARAM;
+  class GET_GRADIENTS_BUFFER;
   
   // **************************************************
   // ROUTINES TO GET GRADIENTS
@@ -132,6 +133,24 @@ namespace SHARPISO {
    std::vector<SCALAR_TYPE> & scalar,
    NUM_TYPE & num_gradients);
 
+  /// Get gradients in cube and neighboring cubes.
+  /// Version which reuses storage in buffer.
+  /// @param buffer Storage for vertex lists and subgrids.
+  ///   Reused in each call.  Does not contain the output.
+  void get_gradients
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const GRADIENT_GRID_BASE & gradient_grid,
+   const VERTEX_INDEX cube_index,
+   const SCALAR_TYPE isovalue,
+   const GET_GRADIENTS_PARAM & sharpiso_param,
+   const OFFSET_VOXEL & voxel,
+   const bool flag_sort_gradients,
+   std::vector<COORD_TYPE> & point_coord,
+   std::vector<GRADIENT_COORD_TYPE> & gradient_coord,
+   std::vector<SCALAR_TYPE> & scalar,
+   NUM_TYPE & num_gradients,
+   GET_GRADIENTS_BUFFER & buffer);
+
   /// Get gradients from two cubes sharing a facet.
   /// Used in getting gradients around a facet.
   /// @param sharpiso_param Determines which gradients are selected.
@@ -242,6 +261,22 @@ namespace SHARPISO {
    std::vector<SCALAR_TYPE> & scalar,
    NUM_TYPE & num_gradients);
 
+  /// Get gradients from list of edge-isosurface intersections.
+  /// Use sparse table of intersected edges.
+  /// @param sharpiso_param Determines which gradients are selected.
+  void get_gradients_from_list
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const std::vector<COORD_TYPE> & edgeI_coord,
+   const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+   const SHARPISO_EDGE_INDEX_TABLE & edge_index,
+   const VERTEX_INDEX cube_index,
+   const SCALAR_TYPE isovalue,
+   const GET_GRADIENTS_PARAM & sharpiso_param,
+   std::vector<COORD_TYPE> & point_coord,
+   std::vector<GRADIENT_COORD_TYPE> & gradient_coord,
+   std::vector<SCALAR_TYPE> & scalar,
+   NUM_TYPE & num_gradients);
+
   // **************************************************
   // GET VERTICES
   // **************************************************
@@ -370,6 +405,17 @@ namespace SHARPISO {
    const GET_GRADIENTS_PARAM & gradient_param,
    std::vector<VERTEX_INDEX> & vertex_list);
 
+  /// Get intersected edge endpoints in large neighborhood.
+  /// Version which reuses subgrids and lists in buffer.
+  void get_ie_endpoints_in_large_neighborhood
+	(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const GRADIENT_GRID_BASE & gradient_grid,
+   const SCALAR_TYPE isovalue,
+   const VERTEX_INDEX cube_index,
+   const GET_GRADIENTS_PARAM & gradient_param,
+   std::vector<VERTEX_INDEX> & vertex_list,
+   GET_GRADIENTS_BUFFER & buffer);
+
   // **************************************************
   // SORT VERTICES
   // **************************************************
@@ -600,6 +646,27 @@ namespace SHARPISO {
     void SetDimension(const int dimension);
   };
 
+  /// Storage reused by get_gradients() in processing each cube.
+  /// Avoids allocating and freeing memory for each cube.
+  /// Memory is only reallocated when a larger list or subgrid is needed.
+  /// Not thread safe.  Each thread needs its own GET_GRADIENTS_BUFFER.
+  class GET_GRADIENTS_BUFFER {
+
+  public:
+    std::vector<VERTEX_INDEX> vertex_list;
+
+    // Storage for get_ie_endpoints_in_large_neighborhood().
+    std::vector<VERTEX_INDEX> vlist2;
+    SHARPISO_INDEX_GRID subgrid;
+    SHARPISO_BOOL_GRID visited;
+    SHARPISO_SCALAR_GRID scalar_subgrid;
+
+    // Gradients, for use by routines which call get_gradients().
+    std::vector<COORD_TYPE> point_coord;
+    std::vector<GRADIENT_COORD_TYPE> gradient_coord;
+    std::vector<SCALAR_TYPE> scalar;
+  };
+
   /// 3D grid voxel and offset.
   class OFFSET_VOXEL : public VOXEL {
 
@@ -21,8 +21,13 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <cstring>
+#include <fstream>
+#include <limits>
+
 #include "sharpiso_intersect.h"
 
+#include "ijk.txx"
 #include "ijkcoord.txx"
 #include "ijkinterpolate.txx"
 
@@ -70,6 +75,38 @@ void SHARPISO::compute_all_edgeI
 }
 
 
+// Compute intersections of isosurface and all grid edges.
+// Version which also returns the grid edge containing each intersection.
+void SHARPISO::compute_all_edgeI
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const SCALAR_TYPE isovalue,
+ const GRADIENT_COORD_TYPE max_small_magnitude,
+ std::vector<COORD_TYPE> & edgeI_coord,
+ std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+ std::vector<EDGE_KEY_TYPE> & edgeI_edge_key)
+{
+  IJK_FOR_EACH_GRID_EDGE(iv0, edge_dir, scalar_grid, VERTEX_INDEX) {
+
+    VERTEX_INDEX iv1 = scalar_grid.NextVertex(iv0, edge_dir);
+    if (is_gt_min_le_max(scalar_grid, iv0, iv1, isovalue)) {
+
+      NUM_TYPE num_coord = edgeI_coord.size();
+      edgeI_coord.resize(num_coord+DIM3);
+      edgeI_normal_coord.resize(num_coord+DIM3);
+
+      compute_isosurface_grid_edge_intersection
+        (scalar_grid, gradient_grid, isovalue,
+         iv0, iv1, edge_dir, max_small_magnitude, 
+         &(edgeI_coord.front())+num_coord,
+         &(edgeI_normal_coord.front())+num_coord);
+
+      edgeI_edge_key.push_back(EDGE_KEY_TYPE(iv0)*DIM3 + edge_dir);
+    }
+  }
+}
+
+
 // Compute intersections of isosurface and cube edges.
 void SHARPISO::compute_cube_edgeI
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
@@ -306,6 +343,38 @@ void SHARPISO::compute_all_edgeI_linear_interpolate
   }
 }
 
+// Compute intersections of isosurface and all grid edges 
+//   using linear interpolation.
+// Version which also returns the grid edge containing each intersection.
+void SHARPISO::compute_all_edgeI_linear_interpolate
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const SCALAR_TYPE isovalue,
+ const GRADIENT_COORD_TYPE max_small_magnitude,
+ std::vector<COORD_TYPE> & edgeI_coord,
+ std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+ std::vector<EDGE_KEY_TYPE> & edgeI_edge_key)
+{
+  IJK_FOR_EACH_GRID_EDGE(iend0, edge_dir, scalar_grid, VERTEX_INDEX) {
+
+    VERTEX_INDEX iend1 = scalar_grid.NextVertex(iend0, edge_dir);
+    if (is_gt_min_le_max(scalar_grid, iend0, iend1, isovalue)) {
+
+      NUM_TYPE num_coord = edgeI_coord.size();
+      edgeI_coord.resize(num_coord+DIM3);
+      edgeI_normal_coord.resize(num_coord+DIM3);
+
+      compute_edgeI_linear_interpolate
+        (scalar_grid, gradient_grid, isovalue,
+         iend0, iend1, edge_dir, max_small_magnitude, 
+         &(edgeI_coord.front())+num_coord,
+         &(edgeI_normal_coord.front())+num_coord);
+
+      edgeI_edge_key.push_back(EDGE_KEY_TYPE(iend0)*DIM3 + edge_dir);
+    }
+  }
+}
+
 // Compute intersections of isosurface and cube edges
 //   using linear interpolation.
 // Note: This is NOT the recommended method for computing intersections
@@ -376,6 +445,325 @@ void SHARPISO::compute_edgeI_linear_interpolate
 }
 
 
+// *****************************************************************
+// BINARY HERMITE FILE
+// *****************************************************************
+
+namespace {
+
+  using namespace SHARPISO;
+
+  const char HERMITE_FILE_MAGIC[8] = "IJKHRMT";
+  const int32_t HERMITE_FILE_BYTE_ORDER = 0x01020304;
+  const int32_t HERMITE_FILE_VERSION = 1;
+
+  // Return number of bytes in binary hermite file.
+  size_t hermite_file_size
+  (const int64_t num_edgeI, const bool flag_quantized_normals)
+  {
+    size_t normal_size = sizeof(float);
+    if (flag_quantized_normals) { normal_size = sizeof(int16_t); }
+
+    return(sizeof(HERMITE_FILE_HEADER) + 
+           size_t(num_edgeI)*(sizeof(int64_t)+sizeof(float)+DIM3*normal_size));
+  }
+
+  // Write array to binary file.
+  template <typename ETYPE>
+  void write_binary_array(std::ostream & out, const std::vector<ETYPE> & x)
+  {
+    if (x.size() > 0) 
+      { out.write((const char *) &(x.front()), x.size()*sizeof(ETYPE)); }
+  }
+}
+
+// Return true if filename starts with the binary hermite file magic.
+bool SHARPISO::is_hermite_file(const char * filename)
+{
+  char magic[sizeof(HERMITE_FILE_MAGIC)];
+
+  std::ifstream in(filename, std::ios::in | std::ios::binary);
+  if (!in.good()) { return(false); }
+
+  in.read(magic, sizeof(magic));
+  if (in.gcount() != sizeof(magic)) { return(false); }
+
+  return(std::memcmp(magic, HERMITE_FILE_MAGIC, sizeof(magic)) == 0);
+}
+
+// Write binary hermite file.
+void SHARPISO::write_hermite_file
+(const char * filename, const SHARPISO_GRID & grid,
+ const std::vector<EDGE_KEY_TYPE> & edgeI_edge_key,
+ const std::vector<COORD_TYPE> & edgeI_coord,
+ const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+ const bool flag_quantize_normals)
+{
+  const size_t num_edgeI = edgeI_edge_key.size();
+  HERMITE_FILE_HEADER header;
+  GRID_COORD_TYPE coord0[DIM3];
+  IJK::PROCEDURE_ERROR error("write_hermite_file");
+
+  if (grid.Dimension() != DIM3) {
+    error.AddMessage("Programming error.  Grid has dimension ",
+                     grid.Dimension(), ".");
+    error.AddMessage("  Binary hermite files require dimension ", 
+                     DIM3, ".");
+    throw error;
+  }
+
+  if (edgeI_coord.size() != num_edgeI*DIM3 ||
+      edgeI_normal_coord.size() != num_edgeI*DIM3) {
+    error.AddMessage
+      ("Programming error.  Number of edge-isosurface intersection");
+    error.AddMessage
+      ("  or normal coordinates does not match number of edge keys.");
+    throw error;
+  }
+
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, HERMITE_FILE_MAGIC, sizeof(header.magic));
+  header.byte_order = HERMITE_FILE_BYTE_ORDER;
+  header.version = HERMITE_FILE_VERSION;
+  if (flag_quantize_normals) { header.flags |= HERMITE_QUANTIZED_NORMALS; }
+  header.dimension = DIM3;
+  for (int d = 0; d < DIM3; d++) 
+    { header.axis_size[d] = grid.AxisSize(d); }
+  header.num_edgeI = num_edgeI;
+
+  std::vector<int64_t> edge_key(num_edgeI);
+  std::vector<float> t(num_edgeI);
+  for (size_t i = 0; i < num_edgeI; i++) {
+    const VERTEX_INDEX iv0 = edgeI_edge_key[i]/DIM3;
+    const int edge_dir = edgeI_edge_key[i]%DIM3;
+
+    grid.ComputeCoord(iv0, coord0);
+    edge_key[i] = edgeI_edge_key[i];
+    t[i] = edgeI_coord[i*DIM3+edge_dir] - coord0[edge_dir];
+  }
+
+  std::ofstream out(filename, std::ios::out | std::ios::binary);
+  if (!out.good()) {
+    error.AddMessage("Unable to open file ", filename, ".");
+    throw error;
+  }
+
+  out.write((const char *) &header, sizeof(header));
+  write_binary_array(out, edge_key);
+  write_binary_array(out, t);
+
+  if (flag_quantize_normals) {
+    std::vector<int16_t> quantized_normal(edgeI_normal_coord.size());
+    for (size_t j = 0; j < edgeI_normal_coord.size(); j++) {
+      GRADIENT_COORD_TYPE x = edgeI_normal_coord[j];
+      if (x < -1) { x = -1; }
+      if (x > 1) { x = 1; }
+      quantized_normal[j] = 
+        int16_t(std::floor(x*HERMITE_NORMAL_SCALE + 0.5));
+    }
+    write_binary_array(out, quantized_normal);
+  }
+  else {
+    std::vector<float> normal
+      (edgeI_normal_coord.begin(), edgeI_normal_coord.end());
+    write_binary_array(out, normal);
+  }
+
+  if (!out.good()) {
+    error.AddMessage("Error writing file ", filename, ".");
+    throw error;
+  }
+
+  out.close();
+}
+
+void SHARPISO::HERMITE_FILE_READER::Close()
+{
+  mapped_file.Unmap();
+  file_data.clear();
+  file_ptr = NULL;
+  file_length = 0;
+  header = NULL;
+}
+
+// Read entire file into file_data.
+// Array file_data[] has type int64_t so that every array 
+//   in the file is aligned in memory.
+bool SHARPISO::HERMITE_FILE_READER::ReadFile(const char * filename)
+{
+  std::ifstream in(filename, std::ios::in | std::ios::binary);
+  if (!in.good()) { return(false); }
+
+  in.seekg(0, std::ios::end);
+  const std::streamoff length = in.tellg();
+  if (length <= 0) { return(false); }
+  in.seekg(0, std::ios::beg);
+
+  file_data.resize((length+sizeof(int64_t)-1)/sizeof(int64_t));
+  in.read((char *) &(file_data[0]), length);
+  if (in.gcount() != length) {
+    file_data.clear();
+    return(false);
+  }
+
+  file_ptr = (const char *) &(file_data[0]);
+  file_length = length;
+  return(true);
+}
+
+// Open binary hermite file and check its header.
+void SHARPISO::HERMITE_FILE_READER::Open(const char * filename)
+{
+  IJK::PROCEDURE_ERROR error("HERMITE_FILE_READER::Open");
+
+  Close();
+
+  if (mapped_file.Map(filename)) {
+    file_ptr = mapped_file.PtrConst();
+    file_length = mapped_file.Length();
+  }
+  else if (!ReadFile(filename)) {
+    error.AddMessage("Unable to read file ", filename, ".");
+    throw error;
+  }
+
+  error.AddMessage("Error reading binary hermite file ", filename, ".");
+  if (file_length < sizeof(HERMITE_FILE_HEADER)) {
+    Close();
+    error.AddMessage("  File is too short.");
+    throw error;
+  }
+
+  header = (const HERMITE_FILE_HEADER *) file_ptr;
+
+  if (std::memcmp(header->magic, HERMITE_FILE_MAGIC, 
+                  sizeof(header->magic)) != 0) {
+    Close();
+    error.AddMessage("  File is not a binary hermite file.");
+    throw error;
+  }
+
+  if (header->byte_order != HERMITE_FILE_BYTE_ORDER) {
+    Close();
+    error.AddMessage("  File byte order does not match machine byte order.");
+    throw error;
+  }
+
+  if (header->version != HERMITE_FILE_VERSION) {
+    const int32_t version = header->version;
+    Close();
+    error.AddMessage("  Unsupported file version ", version, ".");
+    throw error;
+  }
+
+  if (header->dimension != DIM3) {
+    const int32_t dimension = header->dimension;
+    Close();
+    error.AddMessage("  Illegal grid dimension ", dimension, ".");
+    throw error;
+  }
+
+  int64_t num_grid_vertices = 1;
+  for (int d = 0; d < DIM3; d++) {
+    const int32_t axis_size = header->axis_size[d];
+    if (axis_size < 1) {
+      Close();
+      error.AddMessage("  Illegal axis size ", axis_size, ".");
+      throw error;
+    }
+    num_grid_vertices *= axis_size;
+  }
+
+  if (num_grid_vertices > std::numeric_limits<VERTEX_INDEX>::max()) {
+    Close();
+    error.AddMessage("  Too many grid vertices.");
+    throw error;
+  }
+
+  const int64_t num_edgeI = header->num_edgeI;
+  if (num_edgeI < 0 || 
+      num_edgeI > std::numeric_limits<NUM_TYPE>::max()/DIM3) {
+    Close();
+    error.AddMessage
+      ("  Illegal number of edge-isosurface intersections ", num_edgeI, ".");
+    throw error;
+  }
+
+  if (hermite_file_size(num_edgeI, AreNormalsQuantized()) != file_length) {
+    Close();
+    error.AddMessage
+      ("  File size does not match number of edge-isosurface intersections.");
+    throw error;
+  }
+
+  edge_key = (const int64_t *) (file_ptr + sizeof(HERMITE_FILE_HEADER));
+  t = (const float *) (edge_key + num_edgeI);
+  normal = (const void *) (t + num_edgeI);
+}
+
+// Read binary hermite file.
+void SHARPISO::read_hermite_file
+(const char * filename, SHARPISO_GRID & grid,
+ std::vector<EDGE_KEY_TYPE> & edgeI_edge_key,
+ std::vector<COORD_TYPE> & edgeI_coord,
+ std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord)
+{
+  HERMITE_FILE_READER reader;
+  GRID_COORD_TYPE coord0[DIM3];
+  IJK::PROCEDURE_ERROR error("read_hermite_file");
+
+  reader.Open(filename);
+
+  const NUM_TYPE num_edgeI = reader.NumEdgeI();
+  AXIS_SIZE_TYPE axis_size[DIM3];
+  for (int d = 0; d < DIM3; d++) 
+    { axis_size[d] = reader.AxisSize()[d]; }
+  grid.SetSize(DIM3, axis_size);
+
+  const int64_t num_grid_vertices = grid.NumVertices();
+
+  edgeI_edge_key.resize(num_edgeI);
+  edgeI_coord.resize(num_edgeI*DIM3);
+  edgeI_normal_coord.resize(num_edgeI*DIM3);
+
+  for (NUM_TYPE i = 0; i < num_edgeI; i++) {
+    const int64_t key = reader.EdgeKey(i);
+
+    if (key < 0 || key/DIM3 >= num_grid_vertices) {
+      error.AddMessage("Error reading binary hermite file ", filename, ".");
+      error.AddMessage("  Illegal edge key ", key, ".");
+      throw error;
+    }
+
+    const VERTEX_INDEX iv0 = VERTEX_INDEX(key/DIM3);
+    const int edge_dir = int(key%DIM3);
+
+    grid.ComputeCoord(iv0, coord0);
+    if (coord0[edge_dir]+1 >= grid.AxisSize(edge_dir)) {
+      error.AddMessage("Error reading binary hermite file ", filename, ".");
+      error.AddMessage("  Edge with key ", key, " is not in the grid.");
+      throw error;
+    }
+
+    const COORD_TYPE t = reader.T(i);
+    if (!(t >= 0 && t <= 1)) {
+      error.AddMessage("Error reading binary hermite file ", filename, ".");
+      error.AddMessage("  Illegal location ", t, " on edge with key ",
+                       key, ".");
+      error.AddMessage("  Location should be in range [0,1].");
+      throw error;
+    }
+
+    for (int d = 0; d < DIM3; d++) {
+      edgeI_coord[i*DIM3+d] = coord0[d];
+      edgeI_normal_coord[i*DIM3+d] = reader.NormalCoord(i, d);
+    }
+    edgeI_coord[i*DIM3+edge_dir] += t;
+    edgeI_edge_key[i] = EDGE_KEY_TYPE(key);
+  }
+}
+
+
 // *****************************************************************
 // LOCAL ROUTINES
 // *****************************************************************
@@ -24,6 +24,11 @@
 #ifndef _SHARPISO_INTERSECT_
 #define _SHARPISO_INTERSECT_
 
+#include <stdint.h>
+#include <vector>
+
+#include "ijkmmap.h"
+
 #include "sharpiso_types.h"
 #include "sharpiso_grids.h"
 
@@ -45,6 +50,19 @@ namespace SHARPISO {
    std::vector<COORD_TYPE> & edgeI_coord,
    std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord);
 
+  /// Compute intersections of isosurface and all grid edges.
+  /// Version which also returns the grid edge containing each intersection.
+  /// @param[out] edgeI_edge_key[] Edge key (iv0*DIM3 + edge_dir)
+  ///             of the grid edge containing each location in edgeI_coord[].
+  void compute_all_edgeI
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const GRADIENT_GRID_BASE & gradient_grid,
+   const SCALAR_TYPE isovalue,
+   const GRADIENT_COORD_TYPE max_small_magnitude,
+   std::vector<COORD_TYPE> & edgeI_coord,
+   std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+   std::vector<EDGE_KEY_TYPE> & edgeI_edge_key);
+
   /// Compute intersection of isosurface and grid edge using sharp formula.
   void compute_isosurface_grid_edge_intersection
   (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
@@ -98,6 +116,18 @@ namespace SHARPISO {
    std::vector<COORD_TYPE> & edgeI_coord,
    std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord);
 
+  /// Compute intersections of isosurface and all grid edges 
+  ///   using linear interpolation.
+  /// Version which also returns the grid edge containing each intersection.
+  void compute_all_edgeI_linear_interpolate
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const GRADIENT_GRID_BASE & gradient_grid,
+   const SCALAR_TYPE isovalue,
+   const GRADIENT_COORD_TYPE max_small_magnitude,
+   std::vector<COORD_TYPE> & edgeI_coord,
+   std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+   std::vector<EDGE_KEY_TYPE> & edgeI_edge_key);
+
   /// Compute intersections of isosurface and cube edges
   ///   using linear interpolation.
   /// Note: This is NOT the recommended method for computing intersections
@@ -124,6 +154,134 @@ namespace SHARPISO {
    COORD_TYPE p[DIM3],
    GRADIENT_COORD_TYPE normal[DIM3]);
 
+  // *****************************************************************
+  // BINARY HERMITE FILE
+  // *****************************************************************
+
+  /// Flag bits of binary hermite file.
+  const int32_t HERMITE_QUANTIZED_NORMALS = 1;
+
+  /// Scale of quantized normal coordinates.
+  /// Quantized normal coordinate q represents q/HERMITE_NORMAL_SCALE.
+  const int32_t HERMITE_NORMAL_SCALE = 32767;
+
+  /// Header of binary hermite file.
+  /// The header is followed by three arrays:
+  ///   edge_key[num_edgeI] (int64), t[num_edgeI] (float)
+  ///   and normal[num_edgeI*DIM3] (float or, if normals are quantized, int16).
+  /// Intersection i is on grid edge (iv0, edge_dir) 
+  ///   where edge_key[i] = iv0*DIM3 + edge_dir,
+  ///   at distance t[i] from grid vertex iv0.
+  /// Every array starts at a multiple of its element size,
+  ///   so a memory mapped file can be read in place.
+  /// All values are in the byte order of the writing machine.
+  class HERMITE_FILE_HEADER {
+  public:
+    char magic[8];           ///< "IJKHRMT" followed by '\0'.
+    int32_t byte_order;      ///< 0x01020304 in writer byte order.
+    int32_t version;         ///< File format version.
+    int32_t flags;           ///< Flag bits, e.g. HERMITE_QUANTIZED_NORMALS.
+    int32_t dimension;       ///< Grid dimension.  Always DIM3.
+    int32_t axis_size[DIM3]; ///< Grid axis sizes.
+    int32_t reserved;        ///< Pads num_edgeI to an 8 byte boundary.
+    int64_t num_edgeI;       ///< Number of edge-isosurface intersections.
+  };
+
+  /// Return true if filename starts with the binary hermite file magic.
+  bool is_hermite_file(const char * filename);
+
+  /// Write binary hermite file.
+  /// @param edgeI_edge_key[] Grid edges containing edgeI_coord[],
+  ///   as returned by compute_all_edgeI.
+  /// @param flag_quantize_normals If true, store normal coordinates
+  ///   as 16 bit integers.
+  void write_hermite_file
+  (const char * filename, const SHARPISO_GRID & grid,
+   const std::vector<EDGE_KEY_TYPE> & edgeI_edge_key,
+   const std::vector<COORD_TYPE> & edgeI_coord,
+   const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+   const bool flag_quantize_normals);
+
+  /// Reader of binary hermite file.
+  /// The file is memory mapped, if memory mapping is supported,
+  ///   and edge keys, locations and normals are read in place.
+  /// Otherwise, the file is read into memory.
+  class HERMITE_FILE_READER {
+
+  protected:
+    IJK::MEMORY_MAPPED_FILE mapped_file;
+    std::vector<int64_t> file_data;     ///< File data if file is not mapped.
+    const char * file_ptr;              ///< Start of file.
+    size_t file_length;                 ///< Number of bytes in file.
+    const HERMITE_FILE_HEADER * header;
+    const int64_t * edge_key;
+    const float * t;
+    const void * normal;
+
+    /// Read entire file into file_data.
+    /// Return false if file cannot be read.
+    bool ReadFile(const char * filename);
+
+    // copy constructor and assignment: NOT IMPLEMENTED
+    HERMITE_FILE_READER(const HERMITE_FILE_READER &);
+    const HERMITE_FILE_READER & operator = (const HERMITE_FILE_READER &);
+
+  public:
+    HERMITE_FILE_READER()
+    { file_ptr = NULL; file_length = 0; header = NULL; };
+    ~HERMITE_FILE_READER() { Close(); };
+
+    /// Open binary hermite file and check its header.
+    void Open(const char * filename);
+
+    /// Close file.
+    void Close();
+
+    /// Return number of edge-isosurface intersections.
+    /// Open() checks that num_edgeI*DIM3 fits in NUM_TYPE.
+    NUM_TYPE NumEdgeI() const
+    { return(NUM_TYPE(header->num_edgeI)); }
+
+    /// Return true if normal coordinates are quantized.
+    bool AreNormalsQuantized() const
+    { return((header->flags & HERMITE_QUANTIZED_NORMALS) != 0); }
+
+    /// Return axis sizes of grid.
+    const int32_t * AxisSize() const
+    { return(header->axis_size); }
+
+    /// Return key of grid edge containing intersection i.
+    /// Key is not checked.
+    int64_t EdgeKey(const NUM_TYPE i) const
+    { return(edge_key[i]); }
+
+    /// Return location of intersection i on its grid edge.
+    COORD_TYPE T(const NUM_TYPE i) const
+    { return(t[i]); }
+
+    /// Return coordinate d of normal at intersection i.
+    GRADIENT_COORD_TYPE NormalCoord(const NUM_TYPE i, const int d) const
+    {
+      if (AreNormalsQuantized()) {
+        return(GRADIENT_COORD_TYPE
+               (((const int16_t *) normal)[i*DIM3+d])/HERMITE_NORMAL_SCALE);
+      }
+      else
+        { return(((const float *) normal)[i*DIM3+d]); }
+    }
+  };
+
+  /// Read binary hermite file.
+  /// Check that every intersection is on a grid edge
+  ///   and at distance at most 1 from the edge's lower endpoint.
+  /// @param[out] grid Grid whose edges contain the intersections.
+  /// @param[out] edgeI_edge_key[] Grid edges containing edgeI_coord[].
+  void read_hermite_file
+  (const char * filename, SHARPISO_GRID & grid,
+   std::vector<EDGE_KEY_TYPE> & edgeI_edge_key,
+   std::vector<COORD_TYPE> & edgeI_coord,
+   std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord);
+
 };
 
 #endif
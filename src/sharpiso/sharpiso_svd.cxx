@@ -24,6 +24,7 @@
 #include<iostream>
 #include<vector>
 #include <cmath>
+#include <limits>
 #include <Eigen/Core>
 #include <Eigen/SVD>
 using namespace Eigen;
@@ -136,7 +137,160 @@ void compute_edge_direction
   edge_dir = M.row(index);
 }
 
+/// Compute edge direction.
+/// Fixed size version.  Avoids allocation of dynamic matrices.
+void compute_edge_direction
+(const Matrix3f & A_pseudo_inverse, const Matrix3f & A, 
+ RowVector3f & edge_dir) 
+{
+  Matrix3f M;
+  Vector3f magnitude_squared;
+
+  M = (Matrix3f::Identity() - A_pseudo_inverse*A);
+  for (int i = 0; i < DIM3; i++) {
+    magnitude_squared[i] = (M.row(i)).squaredNorm();
+  }
+
+  int index = 0;
+  for (int i = 1; i < DIM3; i++) 
+    if (magnitude_squared[i] > magnitude_squared[index])
+      { index = i; }
+
+  edge_dir = M.row(index);
+}
+
+// Jacobi eigen decomposition parameters.
+// Shared by compute_eigen_symmetric_3x3 and LINDSTROM_BATCH
+//   so that both return identical results.
+const int JACOBI_MAX_NUM_SWEEPS = 16;
+const float JACOBI_EPSILON = std::numeric_limits<float>::epsilon();
+
+/// Sort eigenvalues diag[] and eigenvectors (columns of v) 
+///   in decreasing order of eigenvalue.
+/// Negative eigenvalues (caused by roundoff error) are set to zero.
+/// @param[out] num_nonzero Number of non-zero eigenvalues.
+void sort_eigen_symmetric_3x3
+(const float diag[DIM3], const float v[DIM3][DIM3],
+ Vector3f & eigenvalues, Matrix3f & eigenvectors, int & num_nonzero)
+{
+  int index[DIM3] = { 0, 1, 2 };
+  if (diag[index[0]] < diag[index[1]]) 
+    { std::swap(index[0], index[1]); }
+  if (diag[index[1]] < diag[index[2]]) 
+    { std::swap(index[1], index[2]); }
+  if (diag[index[0]] < diag[index[1]]) 
+    { std::swap(index[0], index[1]); }
+
+  num_nonzero = 0;
+  for (int i = 0; i < DIM3; i++) {
+    const int j = index[i];
+    float x = diag[j];
+    if (x < 0) { x = 0; }
+
+    eigenvalues[i] = x;
+    for (int k = 0; k < DIM3; k++) 
+      { eigenvectors(k,i) = v[k][j]; }
+    if (eigenvalues[i] > 0) { num_nonzero++; }
+  }
+}
+
+/// Compute eigenvalues and eigenvectors of symmetric 3x3 matrix A.
+/// Use cyclic Jacobi rotations with a fixed maximum number of sweeps.
+/// Much faster than general (two-sided) JacobiSVD with full U and V.
+/// @param[out] eigenvalues Eigenvalues in decreasing order.
+///   Negative eigenvalues (caused by roundoff error) are set to zero.
+/// @param[out] eigenvectors Column i is the eigenvector 
+///   corresponding to eigenvalues[i].
+/// @param[out] num_nonzero Number of non-zero eigenvalues.
+void compute_eigen_symmetric_3x3
+(const Matrix3f & A, Vector3f & eigenvalues, Matrix3f & eigenvectors,
+ int & num_nonzero)
+{
+  const int MAX_NUM_SWEEPS = JACOBI_MAX_NUM_SWEEPS;
+  const float EPSILON = JACOBI_EPSILON;
+  float a[DIM3][DIM3];
+  float v[DIM3][DIM3];
+
+  for (int i = 0; i < DIM3; i++) {
+    for (int j = 0; j < DIM3; j++) {
+      a[i][j] = A(i,j);
+      v[i][j] = (i == j) ? 1 : 0;
+    }
+  }
+
+  for (int isweep = 0; isweep < MAX_NUM_SWEEPS; isweep++) {
+
+    const float off_diag = 
+      a[0][1]*a[0][1] + a[0][2]*a[0][2] + a[1][2]*a[1][2];
+    const float diag = 
+      a[0][0]*a[0][0] + a[1][1]*a[1][1] + a[2][2]*a[2][2];
+    if (off_diag <= EPSILON*EPSILON*diag) { break; }
+
+    for (int p = 0; p < DIM3-1; p++) {
+      for (int q = p+1; q < DIM3; q++) {
+
+        const float apq = a[p][q];
+        if (apq == 0) { continue; }
+
+        // Compute rotation which zeroes a[p][q].
+        const float theta = (a[q][q]-a[p][p])/(2*apq);
+        float t = 1/(std::abs(theta) + std::sqrt(theta*theta+1));
+        if (theta < 0) { t = -t; }
+        const float c = 1/std::sqrt(t*t+1);
+        const float s = t*c;
+
+        a[p][p] -= t*apq;
+        a[q][q] += t*apq;
+        a[p][q] = a[q][p] = 0;
+
+        const int r = DIM3-p-q;    // Third index.
+        const float arp = a[r][p];
+        const float arq = a[r][q];
+        a[r][p] = a[p][r] = c*arp - s*arq;
+        a[r][q] = a[q][r] = s*arp + c*arq;
+
+        for (int k = 0; k < DIM3; k++) {
+          const float vkp = v[k][p];
+          const float vkq = v[k][q];
+          v[k][p] = c*vkp - s*vkq;
+          v[k][q] = s*vkp + c*vkq;
+        }
+      }
+    }
+  }
+
+  const float diag[DIM3] = { a[0][0], a[1][1], a[2][2] };
+  sort_eigen_symmetric_3x3(diag, v, eigenvalues, eigenvectors, num_nonzero);
+}
+
+/// Compute pseudo inverse of symmetric, positive semi-definite matrix A.
+/// Set small eigenvalues to zero.
+/// @param[out] eigenvectors Column i is the eigenvector 
+///   corresponding to singular_vals[i].
+void compute_pseudo_inverse_symmetric_3x3
+(const Matrix3f & A,
+ const EIGENVALUE_TYPE err_tolerance,
+ NUM_TYPE & num_singular_vals,
+ EIGENVALUE_TYPE singular_vals[DIM3],
+ Matrix3f & eigenvectors,
+ Matrix3f & A_pseudo_inv)
+{
+  Vector3f eigenvalues;
+  Matrix3f pseudo_inv_sigma;
+  int num_nonzero;
+
+  compute_eigen_symmetric_3x3(A, eigenvalues, eigenvectors, num_nonzero);
+
+  compute_pseudo_inverse_sigma
+    (eigenvalues, num_nonzero, err_tolerance,
+     singular_vals, pseudo_inv_sigma, num_singular_vals);
+
+  // A is symmetric, positive semi-definite, so U = V.
+  A_pseudo_inv = eigenvectors*pseudo_inv_sigma*(eigenvectors.transpose());
+}
+
 /// @param pointX Compute sharp point closest to pointX.
+/// @pre A is symmetric, positive semi-definite.
 void compute_sharp_point_lindstrom_3x3
 (		SCALAR_TYPE * A,
 		const SCALAR_TYPE _b[3],
@@ -149,30 +303,164 @@ void compute_sharp_point_lindstrom_3x3
 	Map<const Matrix3f> eigenA(A);
 	Map<const RowVector3f> eigen_pX(pointX);
 	Map<const RowVector3f> b(_b);
-	Matrix3f pseudo_inv_sigma;
-	JacobiSVD<Matrix3f> svd(eigenA, ComputeFullU | ComputeFullV);
+	Matrix3f eigenvectors;
+	Matrix3f A_pseudo_inv;
 
-	// compute the singular values
-	Vector3f singVals = svd.singularValues();
+  compute_pseudo_inverse_symmetric_3x3
+    (eigenA, err_tolerance, num_singular_vals, singular_vals,
+     eigenvectors, A_pseudo_inv);
+
+  // FORMULA CORRECTED: 12-11-2014 by R.W.
+	Vector3f sharpCoord = eigen_pX.transpose() +
+    A_pseudo_inv*(b.transpose() - eigenA*eigen_pX.transpose());
+
+	// set isoVertCoords
+	for (int d=0; d<DIM3; d++) 
+    { isoVertCoords[d] = sharpCoord[d]; }
+}
+
+/// Set edge_direction[] and orth_direction[].
+/// @param U Matrix whose first column is the direction 
+///   of the largest singular value.
+void set_edge_orth_direction
+(const Matrix3f & A, const Matrix3f & A_pseudo_inv, const Matrix3f & U,
+ const NUM_TYPE num_singular_vals,
+ COORD_TYPE edge_direction[DIM3],
+ COORD_TYPE orth_direction[DIM3])
+{
+  if (num_singular_vals == 1) {
+    
+    for (int d = 0; d < DIM3; d++) 
+      { orth_direction[d] = U(d,0); }
+		normalize(orth_direction, orth_direction);
+
+    IJK::set_coord_3D(0, edge_direction);
+  }
+  else if (num_singular_vals == 2) {
+    RowVector3f edge_dir;
+    compute_edge_direction(A_pseudo_inv, A, edge_dir);
+
+    for (int d = 0; d < DIM3; d++)
+      { edge_direction[d] = edge_dir[d]; }
+
+		normalize(edge_direction, edge_direction);
+    IJK::set_coord_3D(0, orth_direction);
+  }
+  else {
+    IJK::set_coord_3D(0, edge_direction);
+    IJK::set_coord_3D(0, orth_direction);
+  }
+}
+
+/// Compute sharp point from eigen decomposition of A.
+/// @param eigenvalues Eigenvalues of A in decreasing order.
+/// @param eigenvectors Column i is the eigenvector 
+///   corresponding to eigenvalues[i].
+/// @param num_nonzero Number of non-zero eigenvalues.
+/// @pre A is symmetric, positive semi-definite.
+void compute_sharp_point_lindstrom_from_eigen
+(const Matrix3f & eigenA,
+ const Vector3f & eigenvalues,
+ const Matrix3f & eigenvectors,
+ const int num_nonzero,
+ const SCALAR_TYPE _b[3],
+ const EIGENVALUE_TYPE err_tolerance,
+ const COORD_TYPE pointX[DIM3],
+ NUM_TYPE & num_singular_vals,
+ EIGENVALUE_TYPE singular_vals[DIM3],
+ COORD_TYPE isoVertCoords[DIM3],
+ COORD_TYPE edge_direction[DIM3],
+ COORD_TYPE orth_direction[DIM3])
+{
+	Map<const RowVector3f> eigen_pX(pointX);
+	Map<const RowVector3f> b(_b);
+  Matrix3f pseudo_inv_sigma;
 
   compute_pseudo_inverse_sigma
-    (singVals, svd.nonzeroSingularValues(), err_tolerance,
+    (eigenvalues, num_nonzero, err_tolerance,
      singular_vals, pseudo_inv_sigma, num_singular_vals);
 
+  // A is symmetric, positive semi-definite, so U = V.
+  const Matrix3f A_pseudo_inv = 
+    eigenvectors*pseudo_inv_sigma*(eigenvectors.transpose());
+
   // FORMULA CORRECTED: 12-11-2014 by R.W.
-	Vector3f sharpCoord = eigen_pX.transpose() +
-				svd.matrixV()*pseudo_inv_sigma*(svd.matrixU().transpose())*
-				(b.transpose() - eigenA*eigen_pX.transpose());
+	Vector3f sharpCoord = 
+    eigen_pX.transpose() + 
+    A_pseudo_inv*(b.transpose() - eigenA*eigen_pX.transpose());
 
 	// set isoVertCoords
 	for (int d=0; d<DIM3; d++) 
     { isoVertCoords[d] = sharpCoord[d]; }
+
+  if (num_singular_vals == 1) {
+    
+    for (int d = 0; d < DIM3; d++) 
+      { orth_direction[d] = eigenvectors(d,0); }
+		normalize(orth_direction, orth_direction);
+
+    IJK::set_coord_3D(0, edge_direction);
+  }
+  else if (num_singular_vals == 2) {
+
+    // Edge direction is the eigenvector of the (zeroed) third eigenvalue.
+    // (I - A_pseudo_inv*A) = v*v^T where v is the third eigenvector.
+    // Orient v so that its largest magnitude coordinate is positive,
+    //   matching the direction returned by compute_edge_direction().
+    int index = 0;
+    for (int d = 1; d < DIM3; d++) {
+      if (std::abs(eigenvectors(d,2)) > std::abs(eigenvectors(index,2)))
+        { index = d; }
+    }
+
+    const float sign = (eigenvectors(index,2) < 0) ? -1 : 1;
+    for (int d = 0; d < DIM3; d++)
+      { edge_direction[d] = sign*eigenvectors(d,2); }
+
+		normalize(edge_direction, edge_direction);
+    IJK::set_coord_3D(0, orth_direction);
+  }
+  else {
+    IJK::set_coord_3D(0, edge_direction);
+    IJK::set_coord_3D(0, orth_direction);
+  }
 }
 
 /// @param pointX Compute sharp point closest to pointX.
 /// @param edge_direction[] If num_singular_vals = 2, return sharp edge direction.
 /// @param orth_direction[] If num_singular_vals = 1, return direction orthogonal to surface.
+/// @pre A is symmetric, positive semi-definite.
 void compute_sharp_point_lindstrom_3x3
+(		SCALAR_TYPE * A,
+		const SCALAR_TYPE _b[3],
+		const EIGENVALUE_TYPE err_tolerance,
+		const COORD_TYPE pointX[DIM3],
+		NUM_TYPE & num_singular_vals,
+		EIGENVALUE_TYPE singular_vals[DIM3],
+		COORD_TYPE isoVertCoords[DIM3],
+    COORD_TYPE edge_direction[DIM3],
+    COORD_TYPE orth_direction[DIM3])
+{
+	Map<const Matrix3f> eigenA(A);
+  Vector3f eigenvalues;
+	Matrix3f eigenvectors;
+  int num_nonzero;
+
+  compute_eigen_symmetric_3x3(eigenA, eigenvalues, eigenvectors, num_nonzero);
+
+  compute_sharp_point_lindstrom_from_eigen
+    (eigenA, eigenvalues, eigenvectors, num_nonzero, _b, err_tolerance,
+     pointX, num_singular_vals, singular_vals, isoVertCoords,
+     edge_direction, orth_direction);
+}
+
+/// Compute sharp point using Eigen JacobiSVD.
+/// Slower than compute_sharp_point_lindstrom_3x3 but does not require
+///   A to be symmetric.
+/// @param pointX Compute sharp point closest to pointX.
+/// @param edge_direction[] If num_singular_vals = 2, return sharp edge direction.
+/// @param orth_direction[] If num_singular_vals = 1, return direction orthogonal to surface.
+void compute_sharp_point_lindstrom_3x3_jacobi
 (		SCALAR_TYPE * A,
 		const SCALAR_TYPE _b[3],
 		const EIGENVALUE_TYPE err_tolerance,
@@ -208,28 +496,9 @@ void compute_sharp_point_lindstrom_3x3
 	for (int d=0; d<DIM3; d++) 
     { isoVertCoords[d] = sharpCoord[d]; }
 
-  if (num_singular_vals == 1) {
-    
-    for (int d = 0; d < DIM3; d++) 
-      { orth_direction[d] = svd.matrixU()(d,0); }
-		normalize(orth_direction, orth_direction);
-
-    IJK::set_coord_3D(0, edge_direction);
-  }
-  else if (num_singular_vals == 2) {
-    RowVector3f edge_dir;
-    compute_edge_direction(A_pseudo_inv, eigenA, edge_dir);
-
-    for (int d = 0; d < DIM3; d++)
-      { edge_direction[d] = edge_dir[d]; }
-
-		normalize(edge_direction, edge_direction);
-    IJK::set_coord_3D(0, orth_direction);
-  }
-  else {
-    IJK::set_coord_3D(0, edge_direction);
-    IJK::set_coord_3D(0, orth_direction);
-  }
+  set_edge_orth_direction
+    (eigenA, A_pseudo_inv, svd.matrixU(), num_singular_vals,
+     edge_direction, orth_direction);
 }
 
 
@@ -294,9 +563,8 @@ void compute_A_B
  COORD_TYPE A[DIM3*DIM3],
  COORD_TYPE B[DIM3])
 {
-	IJK::PROCEDURE_ERROR error("compute_A_B");
-
 	if (num_vert < 1) {
+		IJK::PROCEDURE_ERROR error("compute_A_B");
 		error.AddMessage("Programming error. Number of gradients is 0.");
 		throw error;
 	}
@@ -1088,3 +1356,291 @@ void svd_calculate_sharpiso_vertex(const COORD_TYPE * vert_coords,
 
 }
 
+
+
+// **************************************************
+// CLASS LINDSTROM_BATCH MEMBER FUNCTIONS
+// **************************************************
+
+LINDSTROM_BATCH::LINDSTROM_BATCH(const NUM_TYPE max_num_cubes)
+{
+  this->max_num_cubes = max_num_cubes;
+  num_cubes = 0;
+  num_slots = 0;
+  max_num_vert = 0;
+
+  for (int d = 0; d < DIM3; d++) { 
+    pointX_coord[d].resize(max_num_cubes); 
+    B[d].resize(max_num_cubes);
+    for (int j = 0; j < DIM3; j++) {
+      v[d][j].resize(max_num_cubes);
+      if (d <= j) {
+        A[d][j].resize(max_num_cubes);
+        a[d][j].resize(max_num_cubes);
+      }
+    }
+  }
+  flag_converged.resize(max_num_cubes);
+
+  sharp_coord.resize(DIM3*max_num_cubes);
+  edge_direction.resize(DIM3*max_num_cubes);
+  orth_direction.resize(DIM3*max_num_cubes);
+  eigenvalues.resize(DIM3*max_num_cubes);
+  num_large_eigenvalues.resize(max_num_cubes);
+}
+
+// Allocate slots for at least num_vert vertices per cube.
+// New slots have zero gradients.
+void LINDSTROM_BATCH::AllocateSlots(const NUM_TYPE num_vert)
+{
+  if (num_vert <= num_slots) { return; }
+
+  const NUM_TYPE n = num_vert*max_num_cubes;
+  for (int d = 0; d < DIM3; d++) {
+    vert_coord[d].resize(n, 0);
+    vert_grad[d].resize(n, 0);
+  }
+  vert_scalar.resize(n, 0);
+  num_slots = num_vert;
+}
+
+void LINDSTROM_BATCH::Clear()
+{
+  // Reset gradients so that unused slots contribute nothing to A and B.
+  const NUM_TYPE n = max_num_vert*max_num_cubes;
+  for (int d = 0; d < DIM3; d++) 
+    { std::fill(vert_grad[d].begin(), vert_grad[d].begin()+n, 0); }
+
+  num_cubes = 0;
+  max_num_vert = 0;
+}
+
+void LINDSTROM_BATCH::AddCube
+(const NUM_TYPE num_vert,
+ const SCALAR_TYPE * vert_scalars,
+ const COORD_TYPE * vert_coords,
+ const GRADIENT_COORD_TYPE * vert_grads,
+ const COORD_TYPE pointX[DIM3])
+{
+  const NUM_TYPE i = num_cubes;
+
+  AllocateSlots(num_vert);
+  if (num_vert > max_num_vert) { max_num_vert = num_vert; }
+
+  for (NUM_TYPE k = 0; k < num_vert; k++) {
+    const NUM_TYPE j = k*max_num_cubes+i;
+    for (int d = 0; d < DIM3; d++) {
+      vert_coord[d][j] = vert_coords[k*DIM3+d];
+      vert_grad[d][j] = vert_grads[k*DIM3+d];
+    }
+    vert_scalar[j] = vert_scalars[k];
+  }
+
+  for (int d = 0; d < DIM3; d++)
+    { pointX_coord[d][i] = pointX[d]; }
+
+  num_cubes++;
+}
+
+// Compute A and B for all cubes.
+// Same operations in the same order as compute_A_B.
+void LINDSTROM_BATCH::ComputeAB(const SCALAR_TYPE isovalue)
+{
+  COORD_TYPE * A00 = &(A[0][0][0]);
+  COORD_TYPE * A01 = &(A[0][1][0]);
+  COORD_TYPE * A02 = &(A[0][2][0]);
+  COORD_TYPE * A11 = &(A[1][1][0]);
+  COORD_TYPE * A12 = &(A[1][2][0]);
+  COORD_TYPE * A22 = &(A[2][2][0]);
+  COORD_TYPE * B0 = &(B[0][0]);
+  COORD_TYPE * B1 = &(B[1][0]);
+  COORD_TYPE * B2 = &(B[2][0]);
+
+  for (int d = 0; d < DIM3; d++) {
+    std::fill(B[d].begin(), B[d].begin()+num_cubes, 0);
+    for (int j = d; j < DIM3; j++) 
+      { std::fill(A[d][j].begin(), A[d][j].begin()+num_cubes, 0); }
+  }
+
+  for (NUM_TYPE k = 0; k < max_num_vert; k++) {
+
+    const NUM_TYPE j0 = k*max_num_cubes;
+    const GRADIENT_COORD_TYPE * gx = &(vert_grad[0][j0]);
+    const GRADIENT_COORD_TYPE * gy = &(vert_grad[1][j0]);
+    const GRADIENT_COORD_TYPE * gz = &(vert_grad[2][j0]);
+    const COORD_TYPE * px = &(vert_coord[0][j0]);
+    const COORD_TYPE * py = &(vert_coord[1][j0]);
+    const COORD_TYPE * pz = &(vert_coord[2][j0]);
+    const SCALAR_TYPE * s = &(vert_scalar[j0]);
+
+    for (NUM_TYPE i = 0; i < num_cubes; i++) {
+
+      // Normalize gradient, as in normalize().
+      const double sum = ((0.0 + gx[i]*gx[i]) + gy[i]*gy[i]) + gz[i]*gz[i];
+      const bool flag_nonzero = (sum > 0);
+      const double mag = flag_nonzero ? std::sqrt(sum) : 1;
+      const GRADIENT_COORD_TYPE nx = gx[i]/mag;
+      const GRADIENT_COORD_TYPE ny = gy[i]/mag;
+      const GRADIENT_COORD_TYPE nz = gz[i]/mag;
+
+      A00[i] += nx*nx;
+      A11[i] += ny*ny;
+      A22[i] += nz*nz;
+      A01[i] += nx*ny;
+      A02[i] += nx*nz;
+      A12[i] += ny*nz;
+
+      const SCALAR_TYPE iprod = ((0 + nx*px[i]) + ny*py[i]) + nz*pz[i];
+      const SCALAR_TYPE grad_mag_squared = 
+        ((0 + gx[i]*gx[i]) + gy[i]*gy[i]) + gz[i]*gz[i];
+      const SCALAR_TYPE gradient_magnitude = 
+        flag_nonzero ? std::sqrt(grad_mag_squared) : 1;
+
+      const SCALAR_TYPE x = flag_nonzero ? 
+        SCALAR_TYPE(-1.0*iprod + (s[i] - isovalue)/gradient_magnitude) : 0;
+
+      B0[i] += (-x)*nx;
+      B1[i] += (-x)*ny;
+      B2[i] += (-x)*nz;
+    }
+  }
+}
+
+namespace {
+
+  // Replace (x,y) by (c*x - s*y, s*x + c*y).
+  inline void rotate(const float c, const float s, float & x, float & y)
+  {
+    const float x0 = x;
+    const float y0 = y;
+    x = c*x0 - s*y0;
+    y = s*x0 + c*y0;
+  }
+
+}
+
+// Apply Jacobi rotation zeroing a[p][q] to all cubes 
+//   which have not converged.
+// Same operations as compute_eigen_symmetric_3x3.
+void LINDSTROM_BATCH::RotateJacobi(const int p, const int q)
+{
+  const int r = DIM3-p-q;    // Third index.
+  float * app = &(SymEntry(p,p)[0]);
+  float * aqq = &(SymEntry(q,q)[0]);
+  float * apq = &(SymEntry(p,q)[0]);
+  float * arp = &(SymEntry(r,p)[0]);
+  float * arq = &(SymEntry(r,q)[0]);
+  const unsigned char * flag_done = &(flag_converged[0]);
+  float * v0p = &(v[0][p][0]);
+  float * v0q = &(v[0][q][0]);
+  float * v1p = &(v[1][p][0]);
+  float * v1q = &(v[1][q][0]);
+  float * v2p = &(v[2][p][0]);
+  float * v2q = &(v[2][q][0]);
+
+  for (NUM_TYPE i = 0; i < num_cubes; i++) {
+
+    const float x = apq[i];
+    const bool flag_rotate = (!flag_done[i] && x != 0);
+    const float theta = (aqq[i]-app[i])/(2*(flag_rotate ? x : 1));
+    float t = 1/(std::abs(theta) + std::sqrt(theta*theta+1));
+    t = (theta < 0) ? -t : t;
+    t = flag_rotate ? t : 0;
+
+    // If flag_rotate is false, then t = 0, c = 1 and s = 0
+    //   and the rotation does not change any entry.
+    const float c = 1/std::sqrt(t*t+1);
+    const float s = t*c;
+
+    app[i] -= t*x;
+    aqq[i] += t*x;
+    apq[i] = flag_rotate ? 0 : x;
+
+    rotate(c, s, arp[i], arq[i]);
+    rotate(c, s, v0p[i], v0q[i]);
+    rotate(c, s, v1p[i], v1q[i]);
+    rotate(c, s, v2p[i], v2q[i]);
+  }
+}
+
+// Compute eigen decomposition of A for all cubes.
+// Jacobi rotations are applied to all cubes which have not converged.
+// Same result as compute_eigen_symmetric_3x3.
+void LINDSTROM_BATCH::ComputeEigen()
+{
+  const float EPSILON = JACOBI_EPSILON;
+
+  for (int i = 0; i < DIM3; i++) {
+    for (int j = 0; j < DIM3; j++) {
+      if (i <= j) 
+        { std::copy(A[i][j].begin(), A[i][j].begin()+num_cubes, 
+                    a[i][j].begin()); }
+      std::fill(v[i][j].begin(), v[i][j].begin()+num_cubes, 
+                ((i == j) ? 1 : 0));
+    }
+  }
+  std::fill(flag_converged.begin(), flag_converged.begin()+num_cubes, 0);
+
+  const float * a00 = &(a[0][0][0]);
+  const float * a01 = &(a[0][1][0]);
+  const float * a02 = &(a[0][2][0]);
+  const float * a11 = &(a[1][1][0]);
+  const float * a12 = &(a[1][2][0]);
+  const float * a22 = &(a[2][2][0]);
+  unsigned char * flag_done = &(flag_converged[0]);
+
+  for (int isweep = 0; isweep < JACOBI_MAX_NUM_SWEEPS; isweep++) {
+
+    NUM_TYPE num_converged = 0;
+    for (NUM_TYPE i = 0; i < num_cubes; i++) {
+      const float off_diag = 
+        a01[i]*a01[i] + a02[i]*a02[i] + a12[i]*a12[i];
+      const float diag = 
+        a00[i]*a00[i] + a11[i]*a11[i] + a22[i]*a22[i];
+      if (off_diag <= EPSILON*EPSILON*diag) { flag_done[i] = 1; }
+      num_converged += flag_done[i];
+    }
+
+    if (num_converged == num_cubes) { break; }
+
+    for (int p = 0; p < DIM3-1; p++) {
+      for (int q = p+1; q < DIM3; q++) 
+        { RotateJacobi(p, q); }
+    }
+  }
+}
+
+void LINDSTROM_BATCH::ComputeSharpPoints
+(const SCALAR_TYPE isovalue, const EIGENVALUE_TYPE err_tolerance)
+{
+  ComputeAB(isovalue);
+  ComputeEigen();
+
+  for (NUM_TYPE i = 0; i < num_cubes; i++) {
+    Matrix3f eigenA;
+    Vector3f eigen_values;
+    Matrix3f eigenvectors;
+    COORD_TYPE b[DIM3], pX[DIM3];
+    float diag[DIM3], v3x3[DIM3][DIM3];
+    int num_nonzero;
+
+    for (int d = 0; d < DIM3; d++) {
+      for (int j = 0; j < DIM3; j++) {
+        eigenA(d,j) = (d <= j) ? A[d][j][i] : A[j][d][i]; 
+        v3x3[d][j] = v[d][j][i];
+      }
+      diag[d] = a[d][d][i];
+      b[d] = B[d][i];
+      pX[d] = pointX_coord[d][i];
+    }
+
+    sort_eigen_symmetric_3x3(diag, v3x3, eigen_values, eigenvectors, 
+                             num_nonzero);
+
+    compute_sharp_point_lindstrom_from_eigen
+      (eigenA, eigen_values, eigenvectors, num_nonzero, b, err_tolerance,
+       pX, num_large_eigenvalues[i], &(eigenvalues[i*DIM3]), 
+       &(sharp_coord[i*DIM3]), &(edge_direction[i*DIM3]), 
+       &(orth_direction[i*DIM3]));
+  }
+}
@@ -20,8 +20,11 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#ifndef _SHARPISO_SVD_
+#define _SHARPISO_SVD_
 
 #include<iostream>
+#include<vector>
 #include <Eigen/Dense>
 #include "sharpiso_types.h"
 #include "sharpiso_eigen.h"
@@ -140,6 +143,45 @@ void svd_calculate_sharpiso_vertex_using_lindstrom_fast(
     COORD_TYPE edge_direction[DIM3],
 		COORD_TYPE orth_direction[DIM3]);
 
+/// Compute 3x3 matrix A and vector B from normalized gradients.
+/// A is symmetric, positive semi-definite.
+void compute_A_B
+(const NUM_TYPE num_vert,
+ const EIGENVALUE_TYPE err_tolerance,
+ const SCALAR_TYPE isovalue,
+ const SCALAR_TYPE * vert_scalars,
+ const COORD_TYPE * vert_coords,
+ const GRADIENT_COORD_TYPE * vert_grads,
+ COORD_TYPE A[DIM3*DIM3],
+ COORD_TYPE B[DIM3]);
+
+/// Compute sharp point closest to pointX using Lindstrom's formula.
+/// Use symmetric (one-sided) Jacobi eigen decomposition of 3x3 matrix A.
+/// @pre A is symmetric, positive semi-definite.
+void compute_sharp_point_lindstrom_3x3
+(SCALAR_TYPE * A,
+ const SCALAR_TYPE _b[3],
+ const EIGENVALUE_TYPE err_tolerance,
+ const COORD_TYPE pointX[DIM3],
+ NUM_TYPE & num_singular_vals,
+ EIGENVALUE_TYPE singular_vals[DIM3],
+ COORD_TYPE isoVertCoords[DIM3],
+ COORD_TYPE edge_direction[DIM3],
+ COORD_TYPE orth_direction[DIM3]);
+
+/// Compute sharp point closest to pointX using Lindstrom's formula.
+/// Use Eigen JacobiSVD.  Slower than compute_sharp_point_lindstrom_3x3.
+void compute_sharp_point_lindstrom_3x3_jacobi
+(SCALAR_TYPE * A,
+ const SCALAR_TYPE _b[3],
+ const EIGENVALUE_TYPE err_tolerance,
+ const COORD_TYPE pointX[DIM3],
+ NUM_TYPE & num_singular_vals,
+ EIGENVALUE_TYPE singular_vals[DIM3],
+ COORD_TYPE isoVertCoords[DIM3],
+ COORD_TYPE edge_direction[DIM3],
+ COORD_TYPE orth_direction[DIM3]);
+
 /// Calculate the sharp vertex using svd and the faster garland heckbert way
 /// of storing normals.
 /// If num_singular_vals is 2, position isovert_coords on plane.
@@ -213,3 +255,93 @@ void svd_calculate_sharpiso_vertex_edge_based
 		EIGENVALUE_TYPE * singular_vals,
 		COORD_TYPE * isoVertcoords,
 		GRADIENT_COORD_TYPE *ray_direction);
+
+
+// **************************************************
+// CLASS LINDSTROM_BATCH
+// **************************************************
+
+/// Lindstrom sharp point computation for a batch of cubes.
+/// Gradients, matrices A and B, and eigen decompositions are stored
+///   in structure-of-arrays form, one array entry per cube,
+///   so that the inner loops over cubes can be vectorized.
+/// Results are identical to svd_calculate_sharpiso_vertex_using_lindstrom_fast.
+class LINDSTROM_BATCH {
+
+protected:
+  NUM_TYPE max_num_cubes;    ///< Maximum number of cubes in the batch.
+  NUM_TYPE num_cubes;        ///< Number of cubes in the batch.
+  NUM_TYPE num_slots;        ///< Number of allocated vertex slots per cube.
+  NUM_TYPE max_num_vert;     ///< Maximum number of vertices in any cube.
+
+  /// Vertex k of cube i is stored at location k*max_num_cubes+i.
+  /// Vertices past the last vertex of a cube have zero gradient.
+  std::vector<COORD_TYPE> vert_coord[DIM3];
+  std::vector<GRADIENT_COORD_TYPE> vert_grad[DIM3];
+  std::vector<SCALAR_TYPE> vert_scalar;
+
+  std::vector<COORD_TYPE> pointX_coord[DIM3];
+
+  /// Symmetric matrix A.  Only A[i][j] with i <= j is stored.
+  std::vector<COORD_TYPE> A[DIM3][DIM3];
+  std::vector<COORD_TYPE> B[DIM3];
+
+  /// Jacobi rotations.  Only a[i][j] with i <= j is stored.
+  std::vector<float> a[DIM3][DIM3];
+  std::vector<float> v[DIM3][DIM3];
+  std::vector<unsigned char> flag_converged;
+
+  // Output.
+  std::vector<COORD_TYPE> sharp_coord;
+  std::vector<COORD_TYPE> edge_direction;
+  std::vector<COORD_TYPE> orth_direction;
+  std::vector<EIGENVALUE_TYPE> eigenvalues;
+  std::vector<NUM_TYPE> num_large_eigenvalues;
+
+  void AllocateSlots(const NUM_TYPE num_vert);
+  void ComputeAB(const SCALAR_TYPE isovalue);
+  void ComputeEigen();
+  void RotateJacobi(const int p, const int q);
+  std::vector<float> & SymEntry(const int i, const int j)
+  { return((i <= j) ? a[i][j] : a[j][i]); }
+
+public:
+  LINDSTROM_BATCH(const NUM_TYPE max_num_cubes);
+
+  // get functions
+  NUM_TYPE NumCubes() const { return(num_cubes); }
+  NUM_TYPE MaxNumCubes() const { return(max_num_cubes); }
+  bool IsFull() const { return(num_cubes >= max_num_cubes); }
+
+  /// Sharp point of i'th cube in batch.
+  const COORD_TYPE * SharpCoord(const NUM_TYPE i) const
+  { return(&(sharp_coord[i*DIM3])); }
+  const COORD_TYPE * EdgeDirection(const NUM_TYPE i) const
+  { return(&(edge_direction[i*DIM3])); }
+  const COORD_TYPE * OrthDirection(const NUM_TYPE i) const
+  { return(&(orth_direction[i*DIM3])); }
+  const EIGENVALUE_TYPE * Eigenvalues(const NUM_TYPE i) const
+  { return(&(eigenvalues[i*DIM3])); }
+  NUM_TYPE NumLargeEigenvalues(const NUM_TYPE i) const
+  { return(num_large_eigenvalues[i]); }
+
+  /// Remove all cubes from the batch.  Does not free memory.
+  void Clear();
+
+  /// Add cube to batch.
+  /// @param pointX Compute sharp point closest to pointX.
+  /// @pre num_vert > 0.
+  /// @pre Batch is not full.
+  void AddCube
+  (const NUM_TYPE num_vert,
+   const SCALAR_TYPE * vert_scalars,
+   const COORD_TYPE * vert_coords,
+   const GRADIENT_COORD_TYPE * vert_grads,
+   const COORD_TYPE pointX[DIM3]);
+
+  /// Compute sharp points for all cubes in batch.
+  void ComputeSharpPoints
+  (const SCALAR_TYPE isovalue, const EIGENVALUE_TYPE err_tolerance);
+};
+
+#endif
@@ -57,8 +57,9 @@ void SHREC::dual_contouring
 	const int dimension = shrec_data.ScalarGrid().Dimension();
 	const AXIS_SIZE_TYPE * axis_size = shrec_data.ScalarGrid().AxisSize();
 	PROCEDURE_ERROR error("dual_contouring");
+	SCOPED_STAGE stage(shrec_data.stage_profiler, "dual_contouring");
 
-	clock_t t_start = clock();
+	WALL_TIME_POINT t_start = wall_clock();
 
 	if (!shrec_data.Check(error)) { throw error; };
 
@@ -74,20 +75,24 @@ void SHREC::dual_contouring
 
 			std::vector<COORD_TYPE> edgeI_coord;
 			std::vector<GRADIENT_COORD_TYPE> edgeI_normal_coord;
+			std::vector<EDGE_KEY_TYPE> edgeI_edge_key;
 
 			if (shrec_data.flag_grad2hermiteI) {
 				compute_all_edgeI_linear_interpolate
 					(shrec_data.ScalarGrid(), shrec_data.GradientGrid(),
-					isovalue, max_small_magnitude, edgeI_coord, edgeI_normal_coord);
+					isovalue, max_small_magnitude, edgeI_coord, edgeI_normal_coord,
+					edgeI_edge_key);
 			}
 			else {
 				compute_all_edgeI
 					(shrec_data.ScalarGrid(), shrec_data.GradientGrid(),
-					isovalue, max_small_magnitude, edgeI_coord, edgeI_normal_coord);
+					isovalue, max_small_magnitude, edgeI_coord, edgeI_normal_coord,
+					edgeI_edge_key);
 			}
 
 			dual_contouring_merge_sharp_from_hermite
-				(shrec_data.ScalarGrid(), edgeI_coord, edgeI_normal_coord,
+				(shrec_data.ScalarGrid(), shrec_data.MinMaxPyramid(),
+				edgeI_coord, edgeI_normal_coord, edgeI_edge_key,
 				isovalue, shrec_data, dual_isosurface, isovert,
 				shrec_info);
 	}
@@ -98,13 +103,15 @@ void SHREC::dual_contouring
 
 			if (shrec_data.flag_merge) {
 				dual_contouring_merge_sharp_from_grad
-					(shrec_data.ScalarGrid(), shrec_data.GradientGrid(),
+					(shrec_data.ScalarGrid(), shrec_data.MinMaxPyramid(),
+					shrec_data.GradientGrid(),
 					isovalue, shrec_data, dual_isosurface, isovert,
 					shrec_info);
 			}
 			else {
 				dual_contouring_sharp_from_grad
-					(shrec_data.ScalarGrid(), shrec_data.GradientGrid(),
+					(shrec_data.ScalarGrid(), shrec_data.MinMaxPyramid(),
+					shrec_data.GradientGrid(),
 					isovalue, shrec_data, dual_isosurface,
 					isovert, shrec_info);
 			}
@@ -113,9 +120,9 @@ void SHREC::dual_contouring
 		shrec_data.VertexPositionMethod() == EDGEI_INPUT_DATA) {
 
 			dual_contouring_merge_sharp_from_hermite
-				(shrec_data.ScalarGrid(), 
+				(shrec_data.ScalarGrid(), shrec_data.MinMaxPyramid(),
 				shrec_data.EdgeICoord(), shrec_data.EdgeINormalCoord(),
-				isovalue, shrec_data, dual_isosurface, isovert,
+				shrec_data.EdgeIEdgeKey(), isovalue, shrec_data, dual_isosurface, isovert,
 				shrec_info);
 	}
 	else {
@@ -126,7 +133,7 @@ void SHREC::dual_contouring
 	}
 
 	// store times
-	clock_t t_end = clock();
+	WALL_TIME_POINT t_end = wall_clock();
 	clock2seconds(t_end-t_start, shrec_info.time.total);
 }
 
@@ -199,7 +206,7 @@ void SHREC::dual_contouring_cube_center
 {
 	PROCEDURE_ERROR error("dual_contouring");
 
-	clock_t t0 = clock();
+	WALL_TIME_POINT t0 = wall_clock();
 
 	isoquad_vert.clear();
 	vertex_coord.clear();
@@ -208,16 +215,16 @@ void SHREC::dual_contouring_cube_center
 	std::vector<ISO_VERTEX_INDEX> isoquad_vert2;
 	extract_dual_isopoly
 		(scalar_grid, isovalue, isoquad_vert2, shrec_info);
-	clock_t t1 = clock();
+	WALL_TIME_POINT t1 = wall_clock();
 
 	std::vector<ISO_VERTEX_INDEX> iso_vlist;
 	merge_identical(isoquad_vert2, iso_vlist, isoquad_vert, merge_data);
-	clock_t t2 = clock();
+	WALL_TIME_POINT t2 = wall_clock();
 
 	position_dual_isovertices_cube_center
 		(scalar_grid, iso_vlist, vertex_coord);
 
-	clock_t t3 = clock();
+	WALL_TIME_POINT t3 = wall_clock();
 
 	// store times
 	clock2seconds(t1-t0, shrec_info.time.extract);
@@ -238,7 +245,7 @@ void SHREC::dual_contouring_centroid
 {
 	PROCEDURE_ERROR error("dual_contouring");
 
-	clock_t t0 = clock();
+	WALL_TIME_POINT t0 = wall_clock();
 
 	isoquad_vert.clear();
 	vertex_coord.clear();
@@ -248,16 +255,16 @@ void SHREC::dual_contouring_centroid
 
 	extract_dual_isopoly
 		(scalar_grid, isovalue, isoquad_vert2, shrec_info);
-	clock_t t1 = clock();
+	WALL_TIME_POINT t1 = wall_clock();
 
 	std::vector<ISO_VERTEX_INDEX> iso_vlist;
 	merge_identical(isoquad_vert2, iso_vlist, isoquad_vert, merge_data);
-	clock_t t2 = clock();
+	WALL_TIME_POINT t2 = wall_clock();
 
 	position_dual_isovertices_centroid
 		(scalar_grid, isovalue, iso_vlist, vertex_coord);
 
-	clock_t t3 = clock();
+	WALL_TIME_POINT t3 = wall_clock();
 
 	// store times
 	clock2seconds(t1-t0, shrec_info.time.extract);
@@ -281,7 +288,7 @@ void SHREC::dual_contouring_centroid_multiv
 	const int dimension = scalar_grid.Dimension();
 	PROCEDURE_ERROR error("dual_contouring");
 
-	clock_t t0 = clock();
+	WALL_TIME_POINT t0 = wall_clock();
 
 	isoquad_vert.clear();
 	vertex_coord.clear();
@@ -298,7 +305,7 @@ void SHREC::dual_contouring_centroid_multiv
 	extract_dual_isopoly
 		(scalar_grid, isovalue, isoquad_vert2, facet_vertex, shrec_info);
 
-	clock_t t1 = clock();
+	WALL_TIME_POINT t1 = wall_clock();
 
 	std::vector<ISO_VERTEX_INDEX> cube_list;
 	std::vector<ISO_VERTEX_INDEX> isoquad_cube;      
@@ -316,11 +323,11 @@ void SHREC::dual_contouring_centroid_multiv
 	shrec_info.sharpiso.num_cube_single_isov = cube_list.size() - num_split;
 
 
-	clock_t t2 = clock();
+	WALL_TIME_POINT t2 = wall_clock();
 	position_dual_isovertices_centroid_multi
 		(scalar_grid, isodual_table, isovalue, iso_vlist, vertex_coord);
 
-	clock_t t3 = clock();
+	WALL_TIME_POINT t3 = wall_clock();
 
 	// store times
 	clock2seconds(t1-t0, shrec_info.time.extract);
@@ -340,6 +347,7 @@ void SHREC::dual_contouring_centroid_multiv
 // Use gradients to place isosurface vertices on sharp features. 
 void SHREC::dual_contouring_sharp_from_grad
 	(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+	const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
 	const GRADIENT_GRID_BASE & gradient_grid,
 	const SCALAR_TYPE isovalue,
 	const SHREC_PARAM & shrec_param,
@@ -354,20 +362,20 @@ void SHREC::dual_contouring_sharp_from_grad
 		(scalar_grid, "gradient grid", "scalar grid", error))
 	{ throw error; }
 
-	clock_t t0, t1, t2, t3, t4;
+	WALL_TIME_POINT t0, t1, t2, t3, t4;
 
 	dual_isosurface.Clear();
 	shrec_info.time.Clear();
 
-	t0 = clock();
+	t0 = wall_clock();
 
 	compute_dual_isovert
-		(scalar_grid, gradient_grid, isovalue, shrec_param, 
+		(scalar_grid, minmax_pyramid, gradient_grid, isovalue, shrec_param, 
      shrec_param.vertex_position_method, isovert);
 
 	select_non_smooth(isovert);
 
-	t1 = clock();
+	t1 = wall_clock();
 
 	if (shrec_param.allow_multiple_iso_vertices) {
 
@@ -397,7 +405,7 @@ void SHREC::dual_contouring_sharp_from_grad
 			shrec_info, isovert_info);
 	}
 
-	t2 = clock();
+	t2 = wall_clock();
 
 	// Set shrec_info
 	count_vertices(isovert, isovert_info);
@@ -424,23 +432,23 @@ void SHREC::dual_contouring_extract_isopoly
 	ISOVERT_INFO & isovert_info)
 {
 	const int dimension = scalar_grid.Dimension();
-	clock_t t0, t1, t2;
+	WALL_TIME_POINT t0, t1, t2;
 
-	t0 = clock();
+	t0 = wall_clock();
 
 	std::vector<DUAL_ISOVERT> iso_vlist;
 
-	extract_dual_isopoly(scalar_grid, isovalue, 
-		dual_isosurface.quad_vert, shrec_info);
+	extract_dual_isopoly(scalar_grid, isovalue, isovert,
+		shrec_param.num_threads, dual_isosurface.quad_vert, shrec_info);
 
 	map_isopoly_vert(isovert, dual_isosurface.quad_vert);
 
-	t1 = clock();
+	t1 = wall_clock();
 
 	copy_isovert_positions
 		(isovert.gcube_list, dual_isosurface.vertex_coord);
 
-	t2 = clock();
+	t2 = wall_clock();
 
 	if (shrec_param.flag_store_isovert_info) {
 		set_isovert_info(iso_vlist, isovert.gcube_list, 
@@ -469,9 +477,9 @@ void SHREC::dual_contouring_extract_isopoly_multi
 {
 	const int dimension = scalar_grid.Dimension();
 	const bool flag_separate_neg = shrec_param.flag_separate_neg;
-	clock_t t0, t1, t2;
+	WALL_TIME_POINT t0, t1, t2;
 
-	t0 = clock();
+	t0 = wall_clock();
 
 	std::vector<DUAL_ISOVERT> iso_vlist;
 
@@ -483,7 +491,8 @@ void SHREC::dual_contouring_extract_isopoly_multi
 	std::vector<FACET_VERTEX_INDEX> facet_vertex;
 
 	extract_dual_isopoly
-		(scalar_grid, isovalue, isoquad_cube, facet_vertex, shrec_info);
+		(scalar_grid, isovalue, isovert, shrec_param.num_threads,
+		isoquad_cube, facet_vertex, shrec_info);
 
 	map_isopoly_vert(isovert, isoquad_cube);
 
@@ -492,13 +501,13 @@ void SHREC::dual_contouring_extract_isopoly_multi
 		isovert, isoquad_cube, facet_vertex, shrec_param,
 		iso_vlist, dual_isosurface.quad_vert, shrec_info.sharpiso);
 
-	t1 = clock();
+	t1 = wall_clock();
 
 	position_dual_isovertices_multi
 		(scalar_grid, isodual_table, isovalue, isovert,
 		iso_vlist, dual_isosurface.vertex_coord);
 
-	t2 = clock();
+	t2 = wall_clock();
 
 	if (shrec_param.flag_store_isovert_info) {
 		set_isovert_info(iso_vlist, isovert.gcube_list, 
@@ -530,9 +539,9 @@ void SHREC::dual_contouring_extract_isopoly_multi
 {
 	const int dimension = scalar_grid.Dimension();
 	const bool flag_separate_neg = shrec_param.flag_separate_neg;
-	clock_t t0, t1, t2;
+	WALL_TIME_POINT t0, t1, t2;
 
-	t0 = clock();
+	t0 = wall_clock();
 
 	std::vector<DUAL_ISOVERT> iso_vlist;
 
@@ -545,7 +554,8 @@ void SHREC::dual_contouring_extract_isopoly_multi
 	std::vector<VERTEX_INDEX> cube_list;
 
 	extract_dual_isopoly
-		(scalar_grid, isovalue, isoquad_cube, facet_vertex, shrec_info);
+		(scalar_grid, isovalue, isovert, shrec_param.num_threads,
+		isoquad_cube, facet_vertex, shrec_info);
 
 	map_isopoly_vert(isovert, isoquad_cube);
 
@@ -559,13 +569,13 @@ void SHREC::dual_contouring_extract_isopoly_multi
 	shrec_info.sharpiso.num_cube_multi_isov = num_split;
 	shrec_info.sharpiso.num_cube_single_isov = cube_list.size() - num_split;
 
-	t1 = clock();
+	t1 = wall_clock();
 
 	position_dual_isovertices_multi
 		(scalar_grid, isodual_table, isovalue, isovert,
 		iso_vlist, dual_isosurface.vertex_coord);
 
-	t2 = clock();
+	t2 = wall_clock();
 
 	if (shrec_param.flag_store_isovert_info) {
 		set_isovert_info(iso_vlist, isovert.gcube_list, 
@@ -592,6 +602,7 @@ void SHREC::dual_contouring_extract_isopoly_multi
 */
 void SHREC::dual_contouring_merge_sharp_from_grad
 	(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+	const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
 	const GRADIENT_GRID_BASE & gradient_grid,
 	const SCALAR_TYPE isovalue,
 	const SHREC_PARAM & shrec_param,
@@ -606,49 +617,56 @@ void SHREC::dual_contouring_merge_sharp_from_grad
 		(scalar_grid, "gradient grid", "scalar grid", error))
 	{ throw error; }
 
-	clock_t t0, t1, t2, t3, t4;
+	WALL_TIME_POINT t0, t1, t2, t3, t4;
 
 	dual_isosurface.Clear();
 	shrec_info.time.Clear();
 
-	t0 = clock();
+	t0 = wall_clock();
 
-	compute_dual_isovert
-		(scalar_grid, gradient_grid, isovalue, shrec_param, 
-     shrec_param.vertex_position_method, isovert);
+	{
+		SCOPED_STAGE stage(shrec_param.stage_profiler, "compute_isovert");
+		compute_dual_isovert
+			(scalar_grid, minmax_pyramid, gradient_grid, isovalue, shrec_param, 
+			shrec_param.vertex_position_method, isovert);
+	}
 
-	t1 = clock();
+	t1 = wall_clock();
 
-  if (shrec_param.flag_select_mod6) {
-    select_sharp_isovert_mod6
-      (scalar_grid, gradient_grid, isovalue, shrec_param, isovert);
-  }
-  else if (shrec_param.flag_select_mod3) {
-    select_sharp_isovert_mod3
-      (scalar_grid, gradient_grid, isovalue, shrec_param, isovert);
-  }
-  else {
-    select_sharp_isovert
-      (scalar_grid, gradient_grid, isovalue, shrec_param, isovert);
-  }
+	{
+		SCOPED_STAGE stage(shrec_param.stage_profiler, "select");
+		if (shrec_param.flag_select_mod6) {
+			select_sharp_isovert_mod6
+				(scalar_grid, gradient_grid, isovalue, shrec_param, isovert);
+		}
+		else if (shrec_param.flag_select_mod3) {
+			select_sharp_isovert_mod3
+				(scalar_grid, gradient_grid, isovalue, shrec_param, isovert);
+		}
+		else {
+			select_sharp_isovert
+				(scalar_grid, gradient_grid, isovalue, shrec_param, isovert);
+		}
+	}
 
-	t2 = clock();
+	t2 = wall_clock();
 
 	if (shrec_param.flag_recompute_isovert) {
+		SCOPED_STAGE stage(shrec_param.stage_profiler, "recompute");
 		recompute_isovert_positions
 			(scalar_grid, gradient_grid, isovalue, shrec_param, isovert);
 	}
 
 	count_vertices(isovert, isovert_info);
 
-	t3 = clock();
+	t3 = wall_clock();
 
 	shrec_info.time.merge_sharp = 0;
 	dual_contouring_merge_sharp
 		(scalar_grid, isovalue, shrec_param, dual_isosurface, isovert,
 		shrec_info, isovert_info);
 
-	t4 = clock();
+	t4 = wall_clock();
 
 	// store times
 	float seconds;
@@ -667,8 +685,10 @@ void SHREC::dual_contouring_merge_sharp_from_grad
 //   to place isosurface vertices on sharp features. 
 void SHREC::dual_contouring_merge_sharp_from_hermite
 	(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+	const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
 	const std::vector<COORD_TYPE> & edgeI_coord,
 	const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+	const std::vector<EDGE_KEY_TYPE> & edgeI_edge_key,
 	const SCALAR_TYPE isovalue,
 	const SHREC_PARAM & shrec_param,
 	DUAL_ISOSURFACE & dual_isosurface,
@@ -676,40 +696,53 @@ void SHREC::dual_contouring_merge_sharp_from_hermite
 	SHREC_INFO & shrec_info)
 {
 	ISOVERT_INFO isovert_info;
+	SHARPISO_EDGE_INDEX_TABLE edge_index;
 	PROCEDURE_ERROR error("dual_contouring");
 
-	clock_t t0, t1, t2, t3, t4;
+	WALL_TIME_POINT t0, t1, t2, t3, t4;
 
 	dual_isosurface.Clear();
 	shrec_info.time.Clear();
 
-	t0 = clock();
+	t0 = wall_clock();
 
-	compute_dual_isovert
-		(scalar_grid, edgeI_coord, edgeI_normal_coord, 
-		isovalue, shrec_param, isovert);
+	{
+		SCOPED_STAGE stage(shrec_param.stage_profiler, "compute_isovert");
 
-	t1 = clock();
+		// Table is used by compute_dual_isovert and recompute_isovert_positions.
+		edge_index.SetSize(scalar_grid);
+		set_edge_index(edgeI_coord, edgeI_edge_key, edge_index);
 
-	select_sharp_isovert(scalar_grid, isovalue, shrec_param, isovert);
+		compute_dual_isovert
+			(scalar_grid, minmax_pyramid, edgeI_coord, edgeI_normal_coord, 
+			edge_index, isovalue, shrec_param, isovert);
+	}
 
-	t2 = clock();
+	t1 = wall_clock();
+
+	{
+		SCOPED_STAGE stage(shrec_param.stage_profiler, "select");
+		select_sharp_isovert(scalar_grid, isovalue, shrec_param, isovert);
+	}
+
+	t2 = wall_clock();
 
 	if (shrec_param.flag_recompute_isovert) {
+		SCOPED_STAGE stage(shrec_param.stage_profiler, "recompute");
 		recompute_isovert_positions
-			(scalar_grid, edgeI_coord, isovalue, shrec_param, isovert);
+			(scalar_grid, edgeI_coord, edge_index, isovalue, shrec_param, isovert);
 	}
 
 	count_vertices(isovert, isovert_info);
 
-	t3 = clock();
+	t3 = wall_clock();
 
 	shrec_info.time.merge_sharp = 0;
 	dual_contouring_merge_sharp
 		(scalar_grid, isovalue, shrec_param, dual_isosurface, isovert,
 		shrec_info, isovert_info);
 
-	t4 = clock();
+	t4 = wall_clock();
 
 	// store times
 	float seconds;
@@ -739,10 +772,11 @@ void SHREC::dual_contouring_merge_sharp
 	const bool flag_select_split = shrec_param.flag_select_split;
 	const bool allow_multiple_iso_vertices =
 		shrec_param.allow_multiple_iso_vertices;
+	IJK::STAGE_PROFILER * stage_profiler = shrec_param.stage_profiler;
 	std::vector<VERTEX_INDEX> quad_vert;
-	clock_t t0, t1, t2;
+	WALL_TIME_POINT t0, t1, t2;
 
-	t0 = clock();
+	t0 = wall_clock();
 
 	std::vector<DUAL_ISOVERT> iso_vlist;
 	std::vector<NUM_TYPE> new_isovert_index;
@@ -765,48 +799,61 @@ void SHREC::dual_contouring_merge_sharp
 		std::vector<ISO_VERTEX_INDEX> isoquad_cube;
 		std::vector<FACET_VERTEX_INDEX> facet_vertex;
 
-		extract_dual_isopoly
-			(scalar_grid, isovalue, isoquad_cube, facet_vertex, shrec_info);
-
-		map_isopoly_vert(isovert, isoquad_cube);
-		t1 = clock();
-
-		compute_cube_isotable_index
-			(scalar_grid, isodual_table, isovalue, cube_list, table_index);
+		{
+			SCOPED_STAGE stage(stage_profiler, "extract");
+			extract_dual_isopoly
+				(scalar_grid, isovalue, isovert, shrec_param.num_threads,
+				isoquad_cube, facet_vertex, shrec_info);
 
-		if (flag_split_non_manifold || flag_select_split) {
-
-			if (flag_split_non_manifold) {
-				int num_non_manifold_split;
-				IJK::split_non_manifold_isov_pairs
-					(scalar_grid, isodual_table, ambig_info, cube_list,
-					table_index, num_non_manifold_split);
-				shrec_info.sharpiso.num_non_manifold_split = 
-					num_non_manifold_split;
+			map_isopoly_vert(isovert, isoquad_cube);
+		}
+		t1 = wall_clock();
+
+		{
+			SCOPED_STAGE stage(stage_profiler, "split");
+
+			compute_cube_isotable_index
+				(scalar_grid, isodual_table, isovalue, cube_list, table_index);
+
+			if (flag_split_non_manifold || flag_select_split) {
+
+				if (flag_split_non_manifold) {
+					int num_non_manifold_split;
+					IJK::split_non_manifold_isov_pairs
+						(scalar_grid, isodual_table, ambig_info, cube_list,
+						table_index, num_non_manifold_split);
+					shrec_info.sharpiso.num_non_manifold_split = 
+						num_non_manifold_split;
+				}
+
+				if (flag_select_split) {
+					int num_1_2_change;
+					IJK::select_split_1_2_ambig
+						(scalar_grid, isodual_table, ambig_info, isovalue, cube_list,
+						table_index, num_1_2_change);
+					shrec_info.sharpiso.num_1_2_change =  num_1_2_change;
+				}
 			}
 
-			if (flag_select_split) {
-				int num_1_2_change;
-				IJK::select_split_1_2_ambig
-					(scalar_grid, isodual_table, ambig_info, isovalue, cube_list,
-					table_index, num_1_2_change);
-				shrec_info.sharpiso.num_1_2_change =  num_1_2_change;
-			}
-		}
+			int num_split;
+			split_dual_isovert
+				(isodual_table, cube_list, table_index, 
+				isoquad_cube, facet_vertex, iso_vlist, quad_vert, num_split);
 
-		int num_split;
-		split_dual_isovert
-			(isodual_table, cube_list, table_index, 
-			isoquad_cube, facet_vertex, iso_vlist, quad_vert, num_split);
+			shrec_info.sharpiso.num_cube_multi_isov = num_split;
+			shrec_info.sharpiso.num_cube_single_isov = num_gcube - num_split;
 
-		shrec_info.sharpiso.num_cube_multi_isov = num_split;
-		shrec_info.sharpiso.num_cube_single_isov = num_gcube - num_split;
+			store_table_index(table_index, isovert.gcube_list);
+		}
 
-		store_table_index(table_index, isovert.gcube_list);
+		{
+			SCOPED_STAGE stage(stage_profiler, "merge");
+			merge_sharp_iso_vertices_multi
+				(scalar_grid, isodual_table, ambig_info, isovalue, iso_vlist, 
+				isovert, shrec_param, quad_vert, shrec_info.sharpiso);
+		}
 
-		merge_sharp_iso_vertices_multi
-			(scalar_grid, isodual_table, ambig_info, isovalue, iso_vlist, isovert, 
-			shrec_param, quad_vert, shrec_info.sharpiso);
+		SCOPED_STAGE stage(stage_profiler, "position");
 
 		IJK::get_non_degenerate_quad_btlr
 			(quad_vert, dual_isosurface.tri_vert, dual_isosurface.quad_vert);
@@ -821,14 +868,23 @@ void SHREC::dual_contouring_merge_sharp
 	}
 	else {
 
-		extract_dual_isopoly(scalar_grid, isovalue, quad_vert, shrec_info);
+		{
+			SCOPED_STAGE stage(stage_profiler, "extract");
+			extract_dual_isopoly(scalar_grid, isovalue, isovert,
+				shrec_param.num_threads, quad_vert, shrec_info);
 
-		map_isopoly_vert(isovert, quad_vert);
-		t1 = clock();
+			map_isopoly_vert(isovert, quad_vert);
+		}
+		t1 = wall_clock();
+
+		{
+			SCOPED_STAGE stage(stage_profiler, "merge");
+			merge_sharp_iso_vertices
+				(scalar_grid, isovalue, isovert, shrec_param,
+				quad_vert, shrec_info.sharpiso);
+		}
 
-		merge_sharp_iso_vertices
-			(scalar_grid, isovalue, isovert, shrec_param,
-			quad_vert, shrec_info.sharpiso);
+		SCOPED_STAGE stage(stage_profiler, "position");
 
 		IJK::get_non_degenerate_quad_btlr
 			(quad_vert, dual_isosurface.tri_vert, dual_isosurface.quad_vert);
@@ -839,13 +895,14 @@ void SHREC::dual_contouring_merge_sharp
 	}
 
 	if (shrec_param.flag_delete_isolated_vertices) {
+		SCOPED_STAGE stage(stage_profiler, "delete_isolated");
 		IJK::delete_unreferenced_vertices_two_lists
 			(dimension, dual_isosurface.vertex_coord,
 			dual_isosurface.tri_vert, dual_isosurface.quad_vert,
 			new_isovert_index, flag_keep);
 	}
 
-	t2 = clock();
+	t2 = wall_clock();
 
 	// Set shrec_info
 	shrec_info.sharpiso.num_sharp_corners = isovert_info.num_sharp_corners;
@@ -125,6 +125,7 @@ namespace SHREC {
   /// Use gradients to place isosurface vertices on sharp features. 
   void dual_contouring_sharp_from_grad
   (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
    const GRADIENT_GRID_BASE & gradient_grid,
    const SCALAR_TYPE isovalue,
    const SHREC_PARAM & shrec_param,
@@ -192,6 +193,7 @@ namespace SHREC {
   /// Use gradients to place isosurface vertices on sharp features. 
   void dual_contouring_merge_sharp_from_grad
     (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+     const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
      const GRADIENT_GRID_BASE & gradient_grid,
      const SCALAR_TYPE isovalue,
      const SHREC_PARAM & shrec_param,
@@ -205,10 +207,14 @@ namespace SHREC {
   ///   and list of isosurface vertex coordinates.
   /// Use input edge-isosurface intersections and normals (hermite data)
   ///   to position isosurface vertices on sharp features.
+  /// @param edgeI_edge_key[] Grid edges containing edgeI_coord[].
+  ///   If empty, compute grid edges from edgeI_coord[].
   void dual_contouring_merge_sharp_from_hermite
   (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
    const std::vector<COORD_TYPE> & edgeI_coord,
    const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+   const std::vector<EDGE_KEY_TYPE> & edgeI_edge_key,
    const SCALAR_TYPE isovalue,
    const SHREC_PARAM & shrec_param,
    DUAL_ISOSURFACE & dual_isosurface,
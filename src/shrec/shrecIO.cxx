@@ -20,7 +20,9 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <algorithm>
 #include <assert.h>
+#include <cmath>
 #include <time.h>
 #include <fstream>
 #include <iomanip>
@@ -39,6 +41,7 @@
 #include "sharpiso_get_gradients.h"
 
 #include "shrecIO.h"
+#include "shrec_slab.h"
 
 using namespace IJK;
 using namespace SHREC;
@@ -53,7 +56,8 @@ using namespace std;
 namespace {
 
   typedef enum {
-    SUBSAMPLE_PARAM,
+    SUBSAMPLE_PARAM, NUM_THREADS_PARAM, NUM_ISOVALUE_THREADS_PARAM,
+    SLAB_PARAM, SLAB_HALO_PARAM,
     GRADIENT_PARAM, NORMAL_PARAM, POSITION_PARAM, POS_PARAM, 
     TRIMESH_PARAM, UNIFORM_TRIMESH_PARAM,
     GRAD2HERMITE_PARAM, GRAD2HERMITE_INTERPOLATE_PARAM,
@@ -72,6 +76,8 @@ namespace {
     CHECK_TRIANGLE_ANGLE, NO_CHECK_TRIANGLE_ANGLE,
     DIST2CENTER_PARAM, DIST2CENTROID_PARAM,
     LINF_PARAM, NO_LINF_PARAM,
+    SPARSE_ISOVERT_INDEX_PARAM,
+    MMAP_PARAM, NO_MMAP_PARAM, COMPUTE_GRADIENTS_PARAM,
 
     // DEPRECATED
     USE_LINDSTROM_PARAM,
@@ -92,7 +98,7 @@ namespace {
     SELECT_MOD3_PARAM, SELECT_MOD6_PARAM, SELECT_BY_DIST_PARAM,
     VERSION_PARAM, HELP_PARAM, HELP_OUTPUT_PARAM, HELP_TESTING_PARAM,
     LIST_ALL_OPTIONS_PARAM,
-    OFF_PARAM, IV_PARAM,
+    OFF_PARAM, IV_PARAM, PLY_PARAM, RAW_PARAM,
     OUTPUT_FILENAME_PARAM, STDOUT_PARAM, NOWRITE_PARAM, 
     USEV_IN_OUTFNAME_PARAM,
     OUTPUT_PARAM_PARAM, OUTPUT_INFO_PARAM, 
@@ -100,10 +106,11 @@ namespace {
     OUTPUT_MAP_TO_SELF_PARAM, OUTPUT_COVERED_MAP_TO_SELF_PARAM,
     OUTPUT_MAP_TO_PARAM, OUTPUT_NEIGHBORS_PARAM,
     OUTPUT_ISOVERT_PARAM,
-    WRITE_ISOV_INFO_PARAM, SILENT_PARAM, TIME_PARAM, 
+    WRITE_ISOV_INFO_PARAM, SILENT_PARAM, TIME_PARAM, TRACE_PARAM,
     UNKNOWN_PARAM} PARAMETER;
   const char * parameter_string[] =
-    { "-subsample",
+    { "-subsample", "-num_threads", "-num_isovalue_threads",
+      "-slab", "-slab_halo",
       "-gradient", "-normal", "-position", "-pos", 
       "-trimesh", "-uniform_trimesh",
       "-grad2hermite", "-grad2hermiteI",
@@ -119,6 +126,8 @@ namespace {
       "-check_triangle_angle", "-no_check_triangle_angle",
       "-dist2center", "-dist2centroid",
       "-Linf", "-no_Linf",
+      "-sparse_isovert_index",
+      "-mmap", "-no_mmap", "-compute_gradients",
 
       // DEPRECATED
       "-lindstrom", "-lindstrom2","-lindstrom_fast", "-no_lindstrom",
@@ -134,12 +143,12 @@ namespace {
       "-collapse_triangles", "-no_collapse_triangles",
       "-select_mod3", "-select_mod6", "-select_by_dist",
       "-version", "-help", "-help_output", "-help_testing",
-      "-list_all_options", "-off", "-iv", 
+      "-list_all_options", "-off", "-iv", "-ply", "-raw",
       "-o", "-stdout", "-nowrite", "-usev_in_outfname",
       "-out_param", "-info", "-out_selected", "-out_sharp", "-out_active",
       "-out_map_to_self", "-out_covered_map_to_self",
       "-out_map_to", "-out_neighbors", "-out_isovert",
-      "-write_isov_info", "-s", "-time", "-unknown"};
+      "-write_isov_info", "-s", "-time", "-trace", "-unknown"};
 
   PARAMETER get_parameter_token(const char * s)
   // convert string s into parameter token
@@ -395,6 +404,22 @@ namespace {
       input_info.use_Linf_dist = false;
       break;
 
+    case SPARSE_ISOVERT_INDEX_PARAM:
+      input_info.use_sparse_isovert_index = true;
+      break;
+
+    case MMAP_PARAM:
+      input_info.flag_mmap = true;
+      break;
+
+    case NO_MMAP_PARAM:
+      input_info.flag_mmap = false;
+      break;
+
+    case COMPUTE_GRADIENTS_PARAM:
+      input_info.flag_compute_gradients = true;
+      break;
+
     case USE_LINDSTROM_PARAM:
       input_info.use_lindstrom =true;
       lindstrom_deprecated();
@@ -573,6 +598,14 @@ namespace {
       input_info.output_format = IV;
       break;
 
+    case PLY_PARAM:
+      input_info.output_format = PLY;
+      break;
+
+    case RAW_PARAM:
+      input_info.output_format = RAW;
+      break;
+
     case KEEPV_PARAM:
       input_info.flag_delete_isolated_vertices = false;
       break;
@@ -660,6 +693,26 @@ namespace {
       input_info.flag_subsample = true;
       break;
 
+    case NUM_THREADS_PARAM:
+      input_info.num_threads = 
+        get_option_int(option_string, value_string);
+      break;
+
+    case NUM_ISOVALUE_THREADS_PARAM:
+      input_info.num_isovalue_threads = 
+        get_option_int(option_string, value_string);
+      break;
+
+    case SLAB_PARAM:
+      input_info.slab_thickness = 
+        get_option_int(option_string, value_string);
+      break;
+
+    case SLAB_HALO_PARAM:
+      input_info.slab_halo = 
+        get_option_int(option_string, value_string);
+      break;
+
     case GRADIENT_PARAM:
       input_info.gradient_filename = value_string;
       break;
@@ -764,6 +817,10 @@ namespace {
       input_info.output_filename = value_string;
       break;
 
+    case TRACE_PARAM:
+      input_info.trace_filename = value_string;
+      break;
+
     default:
       return(false);
     }
@@ -1057,6 +1114,77 @@ void SHREC::check_input_info(const INPUT_INFO & input_info)
       exit(560);
     }
   }
+
+  if (input_info.num_threads < 0) {
+    cerr << "Error.  Illegal -num_threads <n> parameter. Integer <n> must be non-negative." << endl;
+    exit(561);
+  }
+
+  if (input_info.num_isovalue_threads < 0) {
+    cerr << "Error.  Illegal -num_isovalue_threads <n> parameter. Integer <n> must be non-negative." << endl;
+    exit(562);
+  }
+
+  if (input_info.flag_compute_gradients &&
+      input_info.gradient_filename != NULL) {
+    cerr << "Error.  Can't use both -gradient and -compute_gradients parameters."
+         << endl;
+    exit(569);
+  }
+
+  if (input_info.slab_thickness < 0) {
+    cerr << "Error.  Illegal -slab <n> parameter. Integer <n> must be non-negative." << endl;
+    exit(563);
+  }
+
+  if (input_info.slab_halo < 0) {
+    cerr << "Error.  Illegal -slab_halo <n> parameter. Integer <n> must be non-negative." << endl;
+    exit(564);
+  }
+
+  if (input_info.slab_thickness > 0) {
+    if (input_info.flag_subsample || input_info.flag_supersample) {
+      cerr << "Error.  Can't use -slab with -subsample or -supersample."
+           << endl;
+      exit(565);
+    }
+
+    if (input_info.NormalsRequired()) {
+      cerr << "Error.  Can't use -slab with -normal." << endl;
+      exit(566);
+    }
+
+    if (input_info.flag_compute_gradients) {
+      cerr << "Error.  Can't use -slab with -compute_gradients." << endl;
+      exit(568);
+    }
+
+    IJK::ERROR error;
+    if (!check_slab_size(input_info.slab_thickness, input_info.slab_halo,
+                         error)) {
+      cerr << "Error.  Illegal -slab or -slab_halo parameter." << endl;
+      error.Print(cerr);
+      exit(570);
+    }
+
+    if (!can_construct_by_slabs(input_info, error)) {
+      cerr << "Error.  Can't use -slab with these options." << endl;
+      error.Print(cerr);
+      exit(571);
+    }
+
+    if (input_info.flag_output_alg_info || input_info.flag_output_selected ||
+        input_info.flag_output_sharp || input_info.flag_output_active ||
+        input_info.flag_output_map_to_self || 
+        input_info.flag_output_covered_map_to_self ||
+        input_info.flag_output_map_to || input_info.flag_output_neighbors ||
+        input_info.flag_output_isovert || input_info.flag_store_isovert_info) {
+      cerr << "Error.  Can't use -slab with -info or options which output"
+           << endl
+           << "  information about isosurface vertices." << endl;
+      exit(567);
+    }
+  }
 }
 
 // Parse the command line.
@@ -1201,6 +1329,509 @@ void SHREC::read_nrrd_file
   io_time.read_nrrd_time = wall_time.getElapsed();
 }
 
+void SHREC::map_nrrd_file
+(const char * input_filename, MAPPED_SCALAR_GRID & scalar_grid,
+ NRRD_INFO & nrrd_info, IO_TIME & io_time)
+{
+  ELAPSED_TIME wall_time;
+
+  scalar_grid.Map(input_filename);
+
+  nrrd_info.dimension = scalar_grid.Dimension();
+  for (int d = 0; d < scalar_grid.Dimension(); d++) 
+    { nrrd_info.grid_spacing.push_back(scalar_grid.Spacing(d)); }
+
+  io_time.read_nrrd_time = wall_time.getElapsed();
+}
+
+void SHREC::map_nrrd_file
+(const char * input_filename, MAPPED_GRADIENT_GRID & gradient_grid,
+ NRRD_INFO & nrrd_info)
+{
+  gradient_grid.Map(input_filename);
+
+  nrrd_info.dimension = gradient_grid.Dimension();
+  for (int d = 0; d < gradient_grid.Dimension(); d++) 
+    { nrrd_info.grid_spacing.push_back(gradient_grid.Spacing(d)); }
+}
+
+// **************************************************
+// READ NRRD FILE BY SLABS
+// **************************************************
+
+namespace {
+
+  /// Return number of bytes in nrrd type or 0 if type is not supported.
+  int get_nrrd_type_size(const std::string & type)
+  {
+    if (type == "float") { return(sizeof(float)); }
+    if (type == "double") { return(sizeof(double)); }
+    if (type == "uchar" || type == "unsigned char" || 
+        type == "uint8" || type == "uint8_t") 
+      { return(1); }
+    if (type == "signed char" || type == "int8" || type == "int8_t")
+      { return(1); }
+    if (type == "short" || type == "short int" || type == "signed short" ||
+        type == "signed short int" || type == "int16" || type == "int16_t")
+      { return(2); }
+    if (type == "ushort" || type == "unsigned short" || 
+        type == "unsigned short int" || type == "uint16" || 
+        type == "uint16_t")
+      { return(2); }
+    if (type == "int" || type == "signed int" || 
+        type == "int32" || type == "int32_t")
+      { return(4); }
+    if (type == "uint" || type == "unsigned int" || 
+        type == "uint32" || type == "uint32_t")
+      { return(4); }
+    return(0);
+  }
+
+  template <typename T>
+  void convert_nrrd_values
+  (const char * buffer, const long num_values, float * value)
+  {
+    for (long i = 0; i < num_values; i++) {
+      T x;
+      std::copy(buffer+i*sizeof(T), buffer+(i+1)*sizeof(T), (char *) &x);
+      value[i] = float(x);
+    }
+  }
+
+  /// Convert num_values values of nrrd type to float.
+  void convert_nrrd_values
+  (const std::string & type, const char * buffer, const long num_values,
+   float * value)
+  {
+    const int size = get_nrrd_type_size(type);
+
+    if (type == "float") 
+      { convert_nrrd_values<float>(buffer, num_values, value); }
+    else if (type == "double") 
+      { convert_nrrd_values<double>(buffer, num_values, value); }
+    else if (size == 1) {
+      if (type == "signed char" || type == "int8" || type == "int8_t")
+        { convert_nrrd_values<signed char>(buffer, num_values, value); }
+      else
+        { convert_nrrd_values<unsigned char>(buffer, num_values, value); }
+    }
+    else if (size == 2) {
+      if (type.find("u") == 0)
+        { convert_nrrd_values<unsigned short>(buffer, num_values, value); }
+      else
+        { convert_nrrd_values<short>(buffer, num_values, value); }
+    }
+    else {
+      if (type.find("u") == 0)
+        { convert_nrrd_values<unsigned int>(buffer, num_values, value); }
+      else
+        { convert_nrrd_values<int>(buffer, num_values, value); }
+    }
+  }
+
+  bool is_host_little_endian()
+  {
+    const int x = 1;
+    return(*((const char *) &x) == 1);
+  }
+
+}
+
+void SHREC::NRRD_SLAB_READER::Init()
+{
+  data_offset = 0;
+  line_skip = 0;
+  byte_skip = 0;
+  vector_length = 1;
+  element_size = 0;
+  flag_swap_bytes = false;
+  for (int d = 0; d < DIM3; d++) {
+    axis_size[d] = 0;
+    spacing[d] = 1;
+  }
+}
+
+void SHREC::NRRD_SLAB_READER::ReadHeader(const char * filename)
+{
+  IJK::PROCEDURE_ERROR error("NRRD_SLAB_READER::ReadHeader");
+  std::vector<AXIS_SIZE_TYPE> sizes;
+  std::vector<std::string> spacings;
+  std::vector<std::string> space_directions;
+  std::string endian = "little";
+  std::string detached_filename;
+  int dimension = 0;
+  string line;
+
+  encoding = "raw";
+  line_skip = 0;
+  byte_skip = 0;
+
+  ifstream in(filename, ios::in | ios::binary);
+  if (!in.good()) {
+    error.AddMessage("Unable to open file ", filename, ".");
+    throw error;
+  }
+
+  getline(in, line);
+  if (line.compare(0, 4, "NRRD") != 0) {
+    error.AddMessage("File ", filename, " is not a nrrd file.");
+    throw error;
+  }
+
+  // Header ends at first empty line or at end of file (detached header).
+  while (getline(in, line)) {
+
+    if (line.size() > 0 && line[line.size()-1] == '\r') 
+      { line.erase(line.size()-1); }
+    if (line.empty()) { break; }
+    if (line[0] == '#') { continue; }
+    if (line.find(":=") != string::npos) { continue; }
+
+    const size_t icolon = line.find(": ");
+    if (icolon == string::npos) { continue; }
+
+    const string field = line.substr(0, icolon);
+    const string value = line.substr(icolon+2);
+    istringstream value_stream(value);
+
+    if (field == "type") { type = value; }
+    else if (field == "dimension") { value_stream >> dimension; }
+    else if (field == "sizes") {
+      AXIS_SIZE_TYPE x;
+      while (value_stream >> x) { sizes.push_back(x); }
+    }
+    else if (field == "spacings") {
+      string x;
+      while (value_stream >> x) { spacings.push_back(x); }
+    }
+    else if (field == "space directions") {
+      string x;
+      while (value_stream >> x) { space_directions.push_back(x); }
+    }
+    else if (field == "endian") { endian = value; }
+    else if (field == "encoding") { encoding = value; }
+    else if (field == "data file" || field == "datafile") 
+      { detached_filename = value; }
+    else if (field == "line skip" || field == "lineskip") 
+      { value_stream >> line_skip; }
+    else if (field == "byte skip" || field == "byteskip") 
+      { value_stream >> byte_skip; }
+  }
+
+  element_size = get_nrrd_type_size(type);
+  if (element_size == 0) {
+    error.AddMessage("Nrrd type \"", type, "\" is not supported.");
+    throw error;
+  }
+
+  if (dimension != DIM3 && dimension != DIM3+1) {
+    error.AddMessage("Nrrd file ", filename, " has dimension ", 
+                     dimension, ".");
+    error.AddMessage("  Expected dimension 3 or 4.");
+    throw error;
+  }
+
+  if (sizes.size() != size_t(dimension)) {
+    error.AddMessage("Nrrd file ", filename, " has ", sizes.size(), 
+                     " sizes.  Expected ", dimension, " sizes.");
+    throw error;
+  }
+
+  // First axis of a 4D file is the vector axis.
+  const int ioffset = dimension-DIM3;
+  vector_length = 1;
+  if (ioffset > 0) { vector_length = sizes[0]; }
+  for (int d = 0; d < DIM3; d++) {
+    axis_size[d] = sizes[d+ioffset];
+    spacing[d] = 1;
+    if (size_t(d+ioffset) < spacings.size()) {
+      const COORD_TYPE x = atof(spacings[d+ioffset].c_str());
+      if (x > 0) { spacing[d] = x; }
+    }
+  }
+
+  if (spacings.empty() && !space_directions.empty()) {
+    // Spacing is the length of the space direction vector of each axis.
+    // The vector axis has space direction "none".
+    if (space_directions.size() != size_t(dimension)) {
+      error.AddMessage("Nrrd file ", filename, " has ", 
+                       space_directions.size(), " space directions.  Expected ",
+                       dimension, " space directions.");
+      throw error;
+    }
+
+    for (int d = 0; d < DIM3; d++) {
+      std::string v = space_directions[d+ioffset];
+      std::replace(v.begin(), v.end(), '(', ' ');
+      std::replace(v.begin(), v.end(), ')', ' ');
+      std::replace(v.begin(), v.end(), ',', ' ');
+      istringstream v_stream(v);
+      COORD_TYPE x, sum = 0;
+      while (v_stream >> x) { sum += x*x; }
+      if (sum > 0) { spacing[d] = std::sqrt(sum); }
+    }
+  }
+
+  flag_swap_bytes = false;
+  if (element_size > 1) {
+    if ((endian == "little") != is_host_little_endian()) 
+      { flag_swap_bytes = true; }
+  }
+
+  if (detached_filename == "") {
+    data_filename = filename;
+    data_offset = in.tellg();
+  }
+  else {
+    // Detached data file names are relative to the header directory.
+    data_filename = detached_filename;
+    const string header_filename = filename;
+    const size_t islash = header_filename.rfind('/');
+    if (detached_filename[0] != '/' && islash != string::npos) 
+      { data_filename = header_filename.substr(0, islash+1) + data_filename; }
+    data_offset = 0;
+  }
+}
+
+void SHREC::NRRD_SLAB_READER::OpenDataFile()
+{
+  IJK::PROCEDURE_ERROR error("NRRD_SLAB_READER::OpenDataFile");
+  string line;
+
+  if (encoding != "raw") {
+    error.AddMessage
+      ("Nrrd file has encoding \"", encoding, "\".");
+    error.AddMessage("  Only raw encoding is supported.");
+    throw error;
+  }
+
+  data_file.close();
+  data_file.clear();
+  data_file.open(data_filename.c_str(), ios::in | ios::binary);
+  if (!data_file.good()) {
+    error.AddMessage("Unable to open data file ", data_filename, ".");
+    throw error;
+  }
+
+  if (byte_skip == -1) {
+    // Data is at the end of the file.  Line skip is ignored.
+    const std::streamoff num_data_bytes = 
+      std::streamoff(NumValues())*element_size;
+    data_file.seekg(0, ios::end);
+    data_offset = std::streamoff(data_file.tellg()) - num_data_bytes;
+    if (data_offset < 0) {
+      error.AddMessage("Error reading nrrd data.  File is too short.");
+      throw error;
+    }
+  }
+  else if (byte_skip < 0) {
+    error.AddMessage("Illegal nrrd byte skip ", byte_skip, ".");
+    error.AddMessage("  Byte skip must be non-negative or -1.");
+    throw error;
+  }
+  else {
+    for (long i = 0; i < line_skip; i++) {
+      data_file.seekg(data_offset);
+      getline(data_file, line);
+      data_offset = data_file.tellg();
+    }
+    data_offset += byte_skip;
+  }
+  byte_skip = 0;
+  line_skip = 0;
+}
+
+void SHREC::NRRD_SLAB_READER::Open(const char * filename)
+{
+  ReadHeader(filename);
+  OpenDataFile();
+}
+
+void SHREC::NRRD_SLAB_READER::ReadSlabValues
+(const AXIS_SIZE_TYPE z0, const AXIS_SIZE_TYPE z1, float * value)
+{
+  const long num_values_per_layer = 
+    long(vector_length)*long(axis_size[0])*long(axis_size[1]);
+  const long num_values = num_values_per_layer*long(z1-z0+1);
+  std::vector<char> buffer(num_values*element_size);
+  IJK::PROCEDURE_ERROR error("NRRD_SLAB_READER::ReadSlabValues");
+
+  if (z0 > z1 || z1 >= axis_size[DIM3-1]) {
+    error.AddMessage("Programming error.  Illegal slab [", z0, ",", z1, "].");
+    throw error;
+  }
+
+  data_file.clear();
+  data_file.seekg
+    (data_offset + std::streamoff(num_values_per_layer*z0*element_size));
+  data_file.read(&(buffer[0]), buffer.size());
+  if (data_file.gcount() != std::streamsize(buffer.size())) {
+    error.AddMessage("Error reading nrrd data.  File is too short.");
+    throw error;
+  }
+
+  if (flag_swap_bytes) {
+    for (long i = 0; i < num_values; i++) 
+      { std::reverse(&(buffer[i*element_size]), 
+                     &(buffer[(i+1)*element_size])); }
+  }
+
+  convert_nrrd_values(type, &(buffer[0]), num_values, value);
+}
+
+void SHREC::NRRD_SLAB_READER::ReadScalarSlab
+(const AXIS_SIZE_TYPE z0, const AXIS_SIZE_TYPE z1,
+ SHARPISO_SCALAR_GRID & scalar_grid)
+{
+  const AXIS_SIZE_TYPE slab_axis_size[DIM3] = 
+    { axis_size[0], axis_size[1], z1-z0+1 };
+  IJK::PROCEDURE_ERROR error("NRRD_SLAB_READER::ReadScalarSlab");
+
+  if (vector_length != 1) {
+    error.AddMessage("Nrrd file contains vectors, not scalars.");
+    throw error;
+  }
+
+  scalar_grid.SetSize(DIM3, slab_axis_size);
+  ReadSlabValues(z0, z1, scalar_grid.ScalarPtr());
+  for (int d = 0; d < DIM3; d++) 
+    { scalar_grid.SetSpacing(d, spacing[d]); }
+}
+
+void SHREC::NRRD_SLAB_READER::ReadGradientSlab
+(const AXIS_SIZE_TYPE z0, const AXIS_SIZE_TYPE z1,
+ GRADIENT_GRID & gradient_grid)
+{
+  const AXIS_SIZE_TYPE slab_axis_size[DIM3] = 
+    { axis_size[0], axis_size[1], z1-z0+1 };
+  IJK::PROCEDURE_ERROR error("NRRD_SLAB_READER::ReadGradientSlab");
+
+  if (vector_length != DIM3) {
+    error.AddMessage("Gradient nrrd file has vector length ", 
+                     vector_length, ".  Expected ", DIM3, ".");
+    throw error;
+  }
+
+  gradient_grid.SetSize(DIM3, slab_axis_size, vector_length);
+  ReadSlabValues(z0, z1, gradient_grid.VectorPtr());
+  for (int d = 0; d < DIM3; d++) 
+    { gradient_grid.SetSpacing(d, spacing[d]); }
+}
+
+
+
+// **************************************************
+// MEMORY MAPPED NRRD FILE
+// **************************************************
+
+bool SHREC::can_map_nrrd_file(const char * filename)
+{
+  NRRD_SLAB_READER reader;
+
+  if (!IJK::MEMORY_MAPPED_FILE::IsSupported()) { return(false); }
+
+  try {
+    reader.ReadHeader(filename);
+  }
+  catch (IJK::ERROR &) {
+    return(false);
+  }
+
+  return(reader.Encoding() == "raw");
+}
+
+void SHREC::NRRD_MMAP_READER::Unmap()
+{
+  mapped_file.Unmap();
+  value = NULL;
+  converted_value.clear();
+}
+
+void SHREC::NRRD_MMAP_READER::Map(const char * filename)
+{
+  IJK::PROCEDURE_ERROR error("NRRD_MMAP_READER::Map");
+
+  Unmap();
+  ReadHeader(filename);
+  OpenDataFile();
+  data_file.close();
+
+  const long num_values = NumValues();
+  const size_t num_data_bytes = size_t(num_values)*element_size;
+  if (num_values <= 0) {
+    error.AddMessage("Nrrd file ", filename, " is empty.");
+    throw error;
+  }
+
+  // File is mapped privately, so grid values can be modified
+  //   without changing the file.
+  if (!mapped_file.Map(data_filename.c_str())) {
+    error.AddMessage("Unable to memory map data file ", data_filename, ".");
+    throw error;
+  }
+
+  if (mapped_file.Length() < size_t(data_offset)+num_data_bytes) {
+    mapped_file.Unmap();
+    error.AddMessage("Error reading nrrd data.  File is too short.");
+    throw error;
+  }
+
+  char * data = mapped_file.Ptr() + data_offset;
+  if (type == "float" && !flag_swap_bytes && 
+      (size_t(data) % sizeof(float)) == 0) {
+    value = (float *) data;
+    return;
+  }
+
+  // Convert to float in host byte order and release mapping.
+  if (flag_swap_bytes) {
+    for (long i = 0; i < num_values; i++) 
+      { std::reverse(data+i*element_size, data+(i+1)*element_size); }
+  }
+  converted_value.resize(num_values);
+  convert_nrrd_values(type, data, num_values, &(converted_value[0]));
+  mapped_file.Unmap();
+  value = &(converted_value[0]);
+}
+
+void SHREC::MAPPED_SCALAR_GRID::Map(const char * filename)
+{
+  IJK::PROCEDURE_ERROR error("MAPPED_SCALAR_GRID::Map");
+
+  this->scalar = NULL;
+  reader.Map(filename);
+
+  if (reader.VectorLength() != 1) {
+    error.AddMessage("Nrrd file ", filename, 
+                     " contains vectors, not scalars.");
+    throw error;
+  }
+
+  SetSize(DIM3, reader.AxisSizePtrConst());
+  this->scalar = reader.Values();
+  for (int d = 0; d < DIM3; d++) 
+    { SetSpacing(d, reader.Spacing(d)); }
+}
+
+void SHREC::MAPPED_GRADIENT_GRID::Map(const char * filename)
+{
+  IJK::PROCEDURE_ERROR error("MAPPED_GRADIENT_GRID::Map");
+
+  this->vec = NULL;
+  reader.Map(filename);
+
+  if (reader.VectorLength() != DIM3) {
+    error.AddMessage("Gradient nrrd file has vector length ", 
+                     reader.VectorLength(), ".  Expected ", DIM3, ".");
+    throw error;
+  }
+
+  SetSize(DIM3, reader.AxisSizePtrConst(), reader.VectorLength());
+  this->vec = reader.Values();
+  for (int d = 0; d < DIM3; d++) 
+    { SetSpacing(d, reader.Spacing(d)); }
+}
+
 // **************************************************
 // READ OFF FILE
 // **************************************************
@@ -1304,13 +1935,28 @@ void SHREC::write_dual_mesh3D
     throw error;
   }
 
-  output_file.open(output_filename.c_str(), ios::out);
+  if (output_info.output_format == PLY || output_info.output_format == RAW)
+    { output_file.open(output_filename.c_str(), ios::out | ios::binary); }
+  else
+    { output_file.open(output_filename.c_str(), ios::out); }
+
   if (!output_file.good()) {
     cerr << "Unable to open output file " << output_filename << "." << endl;
     exit(65);
   };
 
-  if (flag_reorder_quad_vertices) {
+  if (output_info.output_format == PLY) {
+    // Reorder quad vertices while writing.  Do not copy quad_vert.
+    ijkoutPLYbinary(output_file, DIM3, vertex_coord, 
+                    tri_vert, NUM_VERT_PER_TRI, quad_vert, NUM_VERT_PER_QUAD,
+                    flag_reorder_quad_vertices);
+  }
+  else if (output_info.output_format == RAW) {
+    ijkoutRAW(output_file, DIM3, vertex_coord, 
+              tri_vert, NUM_VERT_PER_TRI, quad_vert, NUM_VERT_PER_QUAD,
+              flag_reorder_quad_vertices);
+  }
+  else if (flag_reorder_quad_vertices) {
     std::vector<VERTEX_INDEX> quad_vert2(quad_vert);
     IJK::reorder_quad_vertices(quad_vert2);
     ijkoutOFF(output_file, DIM3, vertex_coord, 
@@ -1929,6 +2575,16 @@ void SHREC::report_shrec_param
       cout << "Using Lindstrom formula." << endl;
     }
 
+    if (shrec_param.num_threads != 1) {
+      cout << "Number of threads: ";
+      if (shrec_param.num_threads == 0) { cout << "all" << endl; }
+      else { cout << shrec_param.num_threads << endl; }
+    }
+
+    if (shrec_param.use_sparse_isovert_index) {
+      cout << "Using sparse isosurface vertex index." << endl;
+    }
+
     if (shrec_param.flag_dist2centroid) {
       cout << "Using distance to centroid." << endl;
     }
@@ -2125,6 +2781,8 @@ void SHREC::report_iso_info3D
         if (output_info.flag_check_disk) {
           cout << "  # of merges blocked by non-disk isosurface patches: "
                << shrec_info.sharpiso.num_non_disk_isopatches << endl;
+          cout << "  # of disk checks skipped on unchanged isosurface patches: "
+               << shrec_info.sharpiso.num_skipped_disk_checks << endl;
         }
       }
 
@@ -2166,7 +2824,7 @@ void report_isovert_cube_info
   if (gcube_index == ISOVERT::NO_INDEX) { return; }
 
   cout << "Cube " << cube_index << ": ";
-  ijkgrid_output_vertex_coord(cout, isovert.index_grid, cube_index);
+  ijkgrid_output_vertex_coord(cout, isovert.grid, cube_index);
 
   if (!grid.IsUnitSpacing()) {
     COORD_TYPE scaled_cube_coord[DIM3];
@@ -2390,7 +3048,7 @@ void SHREC::report_shrec_time
 (const INPUT_INFO & input_info, const SHREC_TIME & shrec_time,
  const char * mesh_type_string)
 {
-  cout << "CPU time to run Marching Cubes: "
+  cout << "Time to run Marching Cubes: "
        << shrec_time.total << " seconds." << endl;
 
   if ((input_info.VertexPositionMethod() != CUBECENTER &&
@@ -2422,6 +3080,11 @@ void SHREC::report_shrec_time
          << shrec_time.position << " seconds." << endl;
   }
 
+  if (input_info.stage_profiler != NULL) {
+    cout << "  Stage wall times (summed over threads):" << endl;
+    input_info.stage_profiler->PrintTable(cout, "    ");
+  }
+
 }
 
 
@@ -2451,6 +3114,30 @@ void SHREC::report_time
        << " seconds." << endl;
 }
 
+
+void SHREC::write_stage_trace(const INPUT_INFO & input_info)
+{
+  ofstream trace_file;
+
+  if (input_info.trace_filename == NULL ||
+      input_info.stage_profiler == NULL) { return; }
+
+  trace_file.open(input_info.trace_filename, ios::out);
+  if (!trace_file.good()) {
+    cerr << "Unable to open trace file " << input_info.trace_filename 
+         << "." << endl;
+    exit(95);
+  };
+
+  input_info.stage_profiler->WriteChromeTrace(trace_file);
+  trace_file.close();
+
+  if (!input_info.flag_silent) {
+    cout << "Wrote stage trace to file: " << input_info.trace_filename 
+         << endl;
+  }
+}
+
 // **************************************************
 // WRITE ISOSURFACE VERTEX INFORMATION TO FILE
 // **************************************************
@@ -2534,11 +3221,15 @@ namespace {
          << endl;
     cerr << "  [-gradient {gradient_nrrd_filename}]"
          << " [-normal {normal_off_filename}]" << endl;
-    cerr << "  [-subsample S] [-max_eigen {max}]" << endl;
+    cerr << "  [-compute_gradients]" << endl;
+    cerr << "  [-subsample S] [-max_eigen {max}] [-num_threads {N}]" << endl;
+    cerr << "  [-num_isovalue_threads {N}] [-sparse_isovert_index]" << endl;
+    cerr << "  [-slab {T}] [-slab_halo {H}] [-mmap | -no_mmap]" << endl;
     cerr << "  [-trimesh] [-keepv] [-o {output_filename}] [-usev_in_outfname] [-stdout]"
          << endl;
+    cerr << "  [-off | -ply | -raw]" << endl;
     cerr << "  [-s] [-out_param] [-info] [-nowrite] [-time]"
-         << endl;
+         << " [-trace {trace_filename}]" << endl;
     cerr << "  [-help] [-version] [-list_all_options]"
          << endl;
   }
@@ -2628,11 +3319,47 @@ void help_main_options()
        << "     in a 3x3x3, 5x5x5, 7x7x7 or 9x9x9 subgrid around cube."
        << endl;
   cout << "  -gradient {gradient_nrrd_filename}: Read gradients from gradient nrrd file." << endl;
+  cout << "  -compute_gradients: Compute central difference gradients"
+       << endl
+       << "      of grid vertices near the isosurface instead of reading"
+       << endl
+       << "      a gradient nrrd file." << endl
+       << "      With -subsample, gradients are computed from the subsampled grid."
+       << endl;
   cout << "  -normal {normal_off_filename}: Read edge-isosurface intersections"
        << endl
-       << "      and normals from OFF file normal_off_filename." << endl;
+       << "      and normals from OFF file normal_off_filename" << endl
+       << "      or from binary hermite file written by grad2hermite -binary."
+       << endl;
   cout << "  -subsample S: Subsample grid at every S vertices." << endl;
   cout << "                S must be an integer greater than 1." << endl;
+  cout << "  -num_threads {N}: Use N threads to compute isosurface vertex positions."
+       << endl;
+  cout << "                N = 0: Use all hardware threads.  (Default 1.)" 
+       << endl;
+  cout << "  -num_isovalue_threads {N}: Construct isosurfaces for up to N isovalues"
+       << endl
+       << "                concurrently.  Isosurfaces are output in order." << endl
+       << "                N = 0: Use all hardware threads.  (Default 1.)" 
+       << endl;
+  cout << "  -slab {T}:   Read and process the grid in z-slabs of T cube layers."
+       << endl
+       << "                Reduces memory for grids larger than RAM." << endl
+       << "                Requires nrrd files with raw encoding," << endl
+       << "                a gradient file, multi-vertex merging" << endl
+       << "                and mod 6 selection (default)." << endl
+       << "                T must be a multiple of 6." << endl;
+  cout << "  -slab_halo {H}: Add H cube layers on each side of each slab."
+       << endl
+       << "                H must be at least 8.  (Default 8.)" << endl;
+  cout << "  -sparse_isovert_index: Store isosurface vertex indices of active cubes"
+       << endl
+       << "                in a hash table instead of a full size grid." << endl
+       << "                Reduces memory for large grids." << endl;
+  cout << "  -mmap:       Memory map nrrd files with raw encoding"
+       << endl
+       << "                instead of reading them.  (Default.)" << endl;
+  cout << "  -no_mmap:    Read nrrd files using the nrrd library." << endl;
   cout << "  -max_eigen {E}: Set maximum small eigenvalue to E."
        << "  (Default: " << shrec_defaults.max_small_eigenvalue << ".)"
        << endl;
@@ -2646,11 +3373,29 @@ void help_main_options()
   cout << "  -usev_in_outfname: Include isovalue in output filename." << endl
        << "     (Ignored if -o option is used.)" << endl;
   cout << "  -stdout: Write isosurface to standard output." << endl;
+  cout << "  -off: Write isosurface in Geomview .off format.  (Default.)"
+       << endl;
+  cout << "  -ply: Write isosurface in binary little endian .ply format."
+       << endl;
+  cout << "  -raw: Write isosurface as raw binary mesh:" << endl
+       << "        32 byte header (\"IJKRAW1\", dimension, number of vertices,"
+       << endl
+       << "        vertices per tri, number of tri, vertices per quad,"
+       << endl
+       << "        number of quads), float vertex coordinates,"
+       << endl
+       << "        int triangle vertices, int quad vertices." << endl;
   cout << "  -s: Silent mode." << endl;
   cout << "  -out_param: Print shrec parameters." << endl;
   cout << "  -info: Print algorithm information." << endl;
   cout << "  -nowrite: Don't write isosurface." << endl;
   cout << "  -time: Output running time." << endl;
+  cout << "  -trace {trace_filename}: Write running times of algorithm stages"
+       << endl
+       << "        to {trace_filename} in Chrome trace event format (JSON)."
+       << endl
+       << "        View with chrome://tracing or https://ui.perfetto.dev."
+       << endl;
   cout << "  -help:    Print this help message." << endl;
   cout << "  -version: Print program version." << endl;
   cout << "  -list_all_options: List all options." << endl;
@@ -2753,7 +3498,9 @@ void help_testing_options()
   cout << "  -gradient {gradient_nrrd_filename}: Read gradients from gradient nrrd file." << endl;
   cout << "  -normal {normal_off_filename}: Read edge-isosurface intersections"
        << endl
-       << "      and normals from OFF file normal_off_filename." << endl;
+       << "      and normals from OFF file normal_off_filename" << endl
+       << "      or from binary hermite file written by grad2hermite -binary."
+       << endl;
   cout << "  -merge:    Allow cube merging." << endl;
   cout << "  -no_merge: No cube merging." << endl;
   cout << "  -grad2hermite:  Convert gradient to hermite data." << endl;
@@ -2888,6 +3635,7 @@ void SHREC::IO_INFO::Init()
   output_filename = NULL;
   output_format = OFF;
   report_time_flag = false;
+  trace_filename = NULL;
   use_stdout = false;
   nowrite_flag = false;
   flag_output_alg_info = false;
@@ -2956,6 +3704,12 @@ void SHREC::INPUT_INFO::Clear()
   flag_output_help = false;
   flag_list_all_options = false;
 
+  num_isovalue_threads = 1;
+  slab_thickness = 0;
+  slab_halo = 8;
+  flag_mmap = true;
+  flag_compute_gradients = false;
+
   isovalue.clear();
   isovalue_string.clear();
   isotable_directory = "";
@@ -2996,6 +3750,14 @@ namespace {
     case IV:
       ofilename += ".iv";
       break;
+
+    case PLY:
+      ofilename += ".ply";
+      break;
+
+    case RAW:
+      ofilename += ".raw";
+      break;
     }
 
     return(ofilename);
@@ -22,10 +22,13 @@
 #ifndef _SHRECIO_
 #define _SHRECIO_
 
+#include <chrono>
 #include <ctime>
+#include <fstream>
 #include <string>
 
 #include "ijk.txx"
+#include "ijkmmap.h"
 #include "shrec.h"
 #include "shrec_types.h"
 #include "shrec_datastruct.h"
@@ -63,7 +66,9 @@ namespace SHREC {
   // **************************************************
 
   ///  Output format.
-  typedef enum { OFF, IV } OUTPUT_FORMAT;
+  ///  - PLY: Binary little endian PLY.
+  ///  - RAW: Raw binary mesh.  See ijkoutRAW() in ijkIO.txx.
+  typedef enum { OFF, IV, PLY, RAW } OUTPUT_FORMAT;
 
   typedef enum { SELECTED_ISOVERT, UNCOVERED_ISOVERT, ACTIVE_ISOVERT }
     MSHARP_ISOVERT_TYPE;
@@ -91,6 +96,11 @@ namespace SHREC {
     const char * output_filename;
     OUTPUT_FORMAT output_format;
     bool report_time_flag;
+
+    /// If not NULL, write stage times to trace_filename
+    ///   in Chrome trace event format.
+    const char * trace_filename;
+
     bool use_stdout;
     bool nowrite_flag;
     bool flag_output_alg_info;    ///< Print algorithm information.
@@ -173,6 +183,24 @@ namespace SHREC {
     bool flag_list_all_options;
 
     SCALAR_ARRAY isovalue;        ///< List of isovalues.
+
+    /// Number of isovalues processed concurrently.
+    /// If num_isovalue_threads is 0, use all hardware threads.
+    int num_isovalue_threads;
+
+    /// If slab_thickness > 0, process grid in z-slabs 
+    ///   containing slab_thickness layers of cubes.
+    int slab_thickness;
+
+    /// Number of additional cube layers on each side of each slab.
+    int slab_halo;
+
+    /// If true, memory map nrrd files with raw encoding.
+    bool flag_mmap;
+
+    /// If true, compute gradients from the scalar grid
+    ///   instead of reading a gradient file.
+    bool flag_compute_gradients;
     std::vector<std::string> isovalue_string;
     std::string isotable_directory;
 
@@ -236,18 +264,20 @@ namespace SHREC {
   };
 
   /// Elapsed wall time.
+  /// Uses a steady clock, so times shorter than a second are measured.
   class ELAPSED_TIME {
 
   protected:
-    time_t t;
+    std::chrono::steady_clock::time_point t;
 
   public:
-    ELAPSED_TIME() { time(&t);  };
+    ELAPSED_TIME() { t = std::chrono::steady_clock::now();  };
 
+    /// Return seconds since construction or since last call to getElapsed().
     double getElapsed() {
-      time_t old_t = t;
-      time(&t);
-      return(difftime(t,old_t));
+      std::chrono::steady_clock::time_point old_t = t;
+      t = std::chrono::steady_clock::now();
+      return(std::chrono::duration<double>(t-old_t).count());
     };
   };
 
@@ -309,6 +339,162 @@ namespace SHREC {
   (const char * input_filename, GRADIENT_GRID & gradient_grid, 
    NRRD_INFO & nrrd_info);
 
+  // **************************************************
+  // READ NRRD FILE BY SLABS
+  // **************************************************
+
+  /// Read z-slabs of a three dimensional nrrd file
+  ///   without reading the entire file.
+  /// Only raw encoding is supported.
+  /// Scalar files have sizes {nx} {ny} {nz}.
+  /// Gradient files have sizes {v} {nx} {ny} {nz} where v is vector length.
+  class NRRD_SLAB_READER {
+
+  protected:
+    std::ifstream data_file;          ///< Stream containing raw data.
+    std::streamoff data_offset;       ///< Offset of first data byte.
+    AXIS_SIZE_TYPE axis_size[DIM3];   ///< Grid axis sizes.
+    COORD_TYPE spacing[DIM3];         ///< Grid spacing.
+    int vector_length;                ///< Number of values per grid vertex.
+    std::string type;                 ///< Nrrd type, e.g., "float".
+    int element_size;                 ///< Number of bytes per value.
+    bool flag_swap_bytes;             ///< Data endian differs from host.
+    std::string encoding;             ///< Nrrd encoding, e.g., "raw".
+    std::string data_filename;        ///< File containing raw data.
+    long line_skip;                   ///< Lines to skip before data.
+    long byte_skip;                   ///< Bytes to skip before data.
+
+    void Init();
+
+    /// Open data file and skip to first data byte.
+    /// @pre ReadHeader() has been called.
+    void OpenDataFile();
+
+    /// Read values of grid vertices with z-coordinates in [z0,z1].
+    void ReadSlabValues
+    (const AXIS_SIZE_TYPE z0, const AXIS_SIZE_TYPE z1, float * value);
+
+  public:
+    NRRD_SLAB_READER() { Init(); };
+
+    /// Read nrrd header.  Does not open data file.
+    void ReadHeader(const char * filename);
+
+    /// Read nrrd header and open data file.
+    void Open(const char * filename);
+
+    // Get functions.
+    AXIS_SIZE_TYPE AxisSize(const int d) const
+    { return(axis_size[d]); }
+    COORD_TYPE Spacing(const int d) const
+    { return(spacing[d]); }
+    int VectorLength() const
+    { return(vector_length); }
+    const std::string & Encoding() const
+    { return(encoding); }
+    const AXIS_SIZE_TYPE * AxisSizePtrConst() const
+    { return(axis_size); }
+
+    /// Return number of values (scalars or vector coordinates) in file.
+    long NumValues() const
+    { return(long(vector_length)*long(axis_size[0])*
+             long(axis_size[1])*long(axis_size[2])); }
+
+    /// Read grid vertices with z-coordinates in [z0,z1] into scalar_grid.
+    void ReadScalarSlab
+    (const AXIS_SIZE_TYPE z0, const AXIS_SIZE_TYPE z1,
+     SHARPISO_SCALAR_GRID & scalar_grid);
+
+    /// Read grid vertices with z-coordinates in [z0,z1] into gradient_grid.
+    void ReadGradientSlab
+    (const AXIS_SIZE_TYPE z0, const AXIS_SIZE_TYPE z1,
+     GRADIENT_GRID & gradient_grid);
+  };
+
+  // **************************************************
+  // MEMORY MAPPED NRRD FILE
+  // **************************************************
+
+  /// Return true if filename can be memory mapped.
+  /// File must be a three or four dimensional nrrd file with raw encoding.
+  /// Return false if memory mapping is not supported.
+  bool can_map_nrrd_file(const char * filename);
+
+  /// Memory map the data of a three or four dimensional raw nrrd file.
+  /// Float data in host byte order and aligned to a float boundary
+  ///   is used in place without copying.
+  /// Other data is converted to float when the file is mapped.
+  class NRRD_MMAP_READER:public NRRD_SLAB_READER {
+
+  protected:
+    IJK::MEMORY_MAPPED_FILE mapped_file;
+    std::vector<float> converted_value; ///< Values converted to float.
+    float * value;                      ///< Values of grid vertices.
+
+    void Unmap();
+
+  public:
+    NRRD_MMAP_READER() { value = NULL; };
+    ~NRRD_MMAP_READER() { Unmap(); };
+
+    /// Read nrrd header and map data file.
+    void Map(const char * filename);
+
+    /// Return true if values are read directly from the mapped file.
+    bool IsZeroCopy() const
+    { return(value != NULL && converted_value.empty()); }
+
+    /// Return pointer to values.
+    /// Values are writable.  Changes are not written to the file.
+    float * Values() { return(value); }
+  };
+
+  /// Scalar grid whose values are in a memory mapped nrrd file.
+  class MAPPED_SCALAR_GRID:public SHARPISO_SCALAR_GRID_BASE {
+
+  protected:
+    NRRD_MMAP_READER reader;
+
+  public:
+    MAPPED_SCALAR_GRID() {};
+    ~MAPPED_SCALAR_GRID() { this->scalar = NULL; };
+
+    /// Map scalar nrrd file.
+    void Map(const char * filename);
+
+    /// Return true if scalar values are read directly from the file.
+    bool IsZeroCopy() const
+    { return(reader.IsZeroCopy()); }
+  };
+
+  /// Gradient grid whose values are in a memory mapped nrrd file.
+  class MAPPED_GRADIENT_GRID:public GRADIENT_GRID_BASE {
+
+  protected:
+    NRRD_MMAP_READER reader;
+
+  public:
+    MAPPED_GRADIENT_GRID() {};
+    ~MAPPED_GRADIENT_GRID() { this->vec = NULL; };
+
+    /// Map gradient nrrd file.
+    void Map(const char * filename);
+
+    /// Return true if gradients are read directly from the file.
+    bool IsZeroCopy() const
+    { return(reader.IsZeroCopy()); }
+  };
+
+  /// Memory map a raw nrrd scalar file.
+  void map_nrrd_file
+  (const char * input_filename, MAPPED_SCALAR_GRID & scalar_grid, 
+   NRRD_INFO & nrrd_info, IO_TIME & io_time);
+
+  /// Memory map a raw nrrd gradient file.
+  void map_nrrd_file
+  (const char * input_filename, MAPPED_GRADIENT_GRID & gradient_grid, 
+   NRRD_INFO & nrrd_info);
+
   // **************************************************
   // READ OFF FILE
   // **************************************************
@@ -483,6 +669,10 @@ namespace SHREC {
   (const INPUT_INFO & input_info, const IO_TIME & io_time, 
    const SHREC_TIME & shrec_time, const double total_elapsed_time);
 
+  /// Write stage times in input_info.stage_profiler to 
+  ///   input_info.trace_filename in Chrome trace event format.
+  void write_stage_trace(const INPUT_INFO & input_info);
+
   // **************************************************
   // WRITE ISOSURFACE VERTICES OR VERTEX INFORMATION TO FILE
   // **************************************************
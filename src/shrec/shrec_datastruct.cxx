@@ -19,6 +19,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <algorithm>
 #include <assert.h>
 #include <cmath>
 #include <cstddef>
@@ -27,6 +28,8 @@
 #include <string>
 #include <vector>
 
+#include "ijkgradient.txx"
+
 #include "shrec_types.h"
 #include "shrec_datastruct.h"
 
@@ -34,6 +37,15 @@ using namespace IJK;
 using namespace SHREC;
 
 
+// local routines
+namespace {
+
+  void compute_boundary_gradient
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid, const VERTEX_INDEX iv,
+   GRADIENT_COORD_TYPE * gradient);
+}
+
+
 // **************************************************
 // DUAL CONTOURING ISOSURFACE CLASS
 // **************************************************
@@ -142,6 +154,8 @@ bool SHREC_PARAM::NormalsRequired() const
 // Initialize SHREC_DATA
 void SHREC_DATA::Init()
 {
+  scalar_grid_ptr = &scalar_grid;
+  gradient_grid_ptr = &gradient_grid;
   is_scalar_grid_set = false;
   is_gradient_grid_set = false;
   are_edgeI_set = false;
@@ -149,6 +163,8 @@ void SHREC_DATA::Init()
 
 void SHREC_DATA::FreeAll()
 {
+  scalar_grid_ptr = &scalar_grid;
+  gradient_grid_ptr = &gradient_grid;
   is_scalar_grid_set = false;
   is_gradient_grid_set = false;
 }
@@ -160,7 +176,38 @@ void SHREC_DATA::CopyScalarGrid
 {
   scalar_grid.Copy(scalar_grid2);
   scalar_grid.SetSpacing(scalar_grid2.SpacingPtrConst());
+  scalar_grid.SetCoordOffset(scalar_grid2.CoordOffsetPtrConst());
+  scalar_grid_ptr = &scalar_grid;
+  is_scalar_grid_set = true;
+  ComputeMinMaxPyramid();
+}
+
+// Reference scalar grid
+void SHREC_DATA::ReferenceScalarGrid
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid2)
+{
+  scalar_grid_ptr = &scalar_grid2;
   is_scalar_grid_set = true;
+  ComputeMinMaxPyramid();
+}
+
+// Reference scalar and gradient grids
+void SHREC_DATA::ReferenceGrids
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid2,
+ const GRADIENT_GRID_BASE & gradient_grid2)
+{
+  ReferenceScalarGrid(scalar_grid2);
+  gradient_grid_ptr = &gradient_grid2;
+  is_gradient_grid_set = true;
+}
+
+// Compute min and max of scalar grid regions.
+void SHREC_DATA::ComputeMinMaxPyramid()
+{
+  // Number of grid edges along each edge of the smallest region.
+  const AXIS_SIZE_TYPE MINMAX_REGION_EDGE_LENGTH = 4;
+
+  minmax_pyramid.ComputeMinMax(ScalarGrid(), MINMAX_REGION_EDGE_LENGTH);
 }
 
 // Copy gradient grid
@@ -169,6 +216,8 @@ void SHREC_DATA::CopyGradientGrid
 {
   gradient_grid.Copy(gradient_grid2);
   gradient_grid.SetSpacing(gradient_grid2.SpacingPtrConst());
+  gradient_grid.SetCoordOffset(gradient_grid2.CoordOffsetPtrConst());
+  gradient_grid_ptr = &gradient_grid;
   is_gradient_grid_set = true;
 }
 
@@ -178,7 +227,9 @@ void SHREC_DATA::SubsampleScalarGrid
 {
   scalar_grid.Subsample(scalar_grid2, subsample_resolution);
   scalar_grid.SetSpacing(subsample_resolution, scalar_grid2.SpacingPtrConst());
+  scalar_grid_ptr = &scalar_grid;
   is_scalar_grid_set = true;
+  ComputeMinMaxPyramid();
 }
 
 // Supersample scalar grid
@@ -187,9 +238,11 @@ void SHREC_DATA::SupersampleScalarGrid
  const int supersample_resolution)
 {
   scalar_grid.Supersample(scalar_grid2, supersample_resolution);
+  scalar_grid_ptr = &scalar_grid;
   scalar_grid.SetSpacing(float(1.0/supersample_resolution),
                          scalar_grid2.SpacingPtrConst());
  is_scalar_grid_set = true;
+  ComputeMinMaxPyramid();
 }
 
 /// Subsample gradient grid
@@ -199,6 +252,7 @@ void SHREC_DATA::SubsampleGradientGrid
 {
   gradient_grid.Subsample(gradient_grid2, subsample_resolution);
   gradient_grid.ScalarMultiply(subsample_resolution);
+  gradient_grid_ptr = &gradient_grid;
   gradient_grid.SetSpacing(subsample_resolution,
                            gradient_grid2.SpacingPtrConst());
   is_gradient_grid_set = true;
@@ -283,10 +337,72 @@ void SHREC_DATA::SetEdgeI
   std::copy(edgeI_coord.begin(), edgeI_coord.end(), this->edgeI_coord.begin());
   std::copy(edgeI_normal_coord.begin(), edgeI_normal_coord.end(), 
             this->edgeI_normal_coord.begin());
+  this->edgeI_edge_key.clear();
 
   are_edgeI_set = true;
 }
 
+/// Set edge-isosurface intersections, normals 
+///   and grid edges containing the intersections.
+/// If edgeI_edge_key[] is empty, grid edges are computed from edgeI_coord[].
+void SHREC_DATA::SetEdgeI
+(const std::vector<COORD_TYPE> & edgeI_coord,
+ const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+ const std::vector<EDGE_KEY_TYPE> & edgeI_edge_key)
+{
+  IJK::PROCEDURE_ERROR error("SHREC_DATA::SetEdgeI");
+
+  if (edgeI_edge_key.size() > 0 &&
+      edgeI_coord.size() != edgeI_edge_key.size()*DIM3) {
+    error.AddMessage
+      ("Programming error.  Number of grid edges does not");
+    error.AddMessage
+      ("  match number of edge-isosurface intersections.");
+    throw error;
+  }
+
+  SetEdgeI(edgeI_coord, edgeI_normal_coord);
+  this->edgeI_edge_key = edgeI_edge_key;
+}
+
+// Compute gradients at vertices near isosurfaces.
+void SHREC_DATA::ComputeGradients(const std::vector<SCALAR_TYPE> & isovalue)
+{
+  const SHARPISO_SCALAR_GRID_BASE & scalar_grid = ScalarGrid();
+  const int dimension = scalar_grid.Dimension();
+  // Gradients are selected from vertices within max_grad_dist of the cube.
+  // Add one layer for isosurface vertices recomputed from neighboring cubes.
+  const NUM_TYPE dist2cube = std::max(max_grad_dist, NUM_TYPE(1)) + 1;
+  std::vector<VERTEX_INDEX> active_cube;
+  PROCEDURE_ERROR error("SHREC_DATA::ComputeGradients");
+
+  if (!IsScalarGridSet()) {
+    error.AddMessage("Programming error.  Scalar grid is not set.");
+    throw error;
+  }
+
+  if (dimension != DIM3) {
+    error.AddMessage
+      ("Programming error.  Gradients can only be computed for 3D grids.");
+    throw error;
+  }
+
+  band_gradient_grid.SetSize(scalar_grid);
+  gradient_grid_ptr = &band_gradient_grid;
+
+  for (size_t i = 0; i < isovalue.size(); i++) {
+
+    minmax_pyramid.GetActiveCubes(scalar_grid, isovalue[i], active_cube);
+
+    for (size_t j = 0; j < active_cube.size(); j++) {
+      band_gradient_grid.ComputeGradientsAroundCube
+        (scalar_grid, active_cube[j], dist2cube);
+    }
+  }
+
+  is_gradient_grid_set = true;
+}
+
 /// Check data structure
 bool SHREC_DATA::Check(IJK::ERROR & error) const
 {
@@ -301,6 +417,152 @@ bool SHREC_DATA::Check(IJK::ERROR & error) const
 }
 
 
+// **************************************************
+// CLASS BAND_GRADIENT_GRID
+// **************************************************
+
+// Set size and spacing.  Set all gradients to zero.
+void BAND_GRADIENT_GRID::SetSize
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid)
+{
+  PROCEDURE_ERROR error("BAND_GRADIENT_GRID::SetSize");
+
+  if (scalar_grid.Dimension() != DIM3) {
+    error.AddMessage("Programming error.  Grid dimension must be 3.");
+    throw error;
+  }
+
+  FreeAll();
+
+  GRADIENT_GRID_BASE::SetSize
+    (scalar_grid.Dimension(), scalar_grid.AxisSize(), DIM3);
+  SetSpacing(scalar_grid.SpacingPtrConst());
+  SetCoordOffset(scalar_grid.CoordOffsetPtrConst());
+  ComputeNumBlocksAlongAxis();
+
+  block.assign(NumBlocks(), NULL);
+  block_gradient_ptr.assign(NumBlocks(), NULL);
+  if (NumBlocks() > 0) 
+    { SetBlockGradient(&(block_gradient_ptr.front())); }
+}
+
+// Free memory.
+void BAND_GRADIENT_GRID::FreeAll()
+{
+  for (size_t ib = 0; ib < block.size(); ib++) {
+    delete block[ib];
+    block[ib] = NULL;
+  }
+  block.clear();
+  block_gradient_ptr.clear();
+  SetBlockGradient(NULL);
+}
+
+// Return block ib.  Allocate block ib if not allocated.
+BAND_GRADIENT_GRID::GRADIENT_BLOCK * BAND_GRADIENT_GRID::GetBlock
+(const VERTEX_INDEX ib)
+{
+  if (block[ib] == NULL) {
+    // Value initialization sets gradients to zero.
+    block[ib] = new GRADIENT_BLOCK();
+    block_gradient_ptr[ib] = block[ib]->gradient;
+  }
+
+  return(block[ib]);
+}
+
+// Return true if gradient at vertex iv is computed.
+bool BAND_GRADIENT_GRID::IsComputed(const VERTEX_INDEX iv) const
+{
+  VERTEX_INDEX ib;
+  NUM_TYPE k;
+
+  ComputeBlockLocation(iv, ib, k);
+  if (block[ib] == NULL) { return(false); }
+  return(block[ib]->is_computed[k]);
+}
+
+// Return number of allocated blocks.
+NUM_TYPE BAND_GRADIENT_GRID::NumAllocatedBlocks() const
+{
+  NUM_TYPE num_allocated = 0;
+
+  for (size_t ib = 0; ib < block.size(); ib++) 
+    { if (block[ib] != NULL) { num_allocated++; } }
+
+  return(num_allocated);
+}
+
+// Compute gradients at vertices within distance dist2cube of cube_index.
+void BAND_GRADIENT_GRID::ComputeGradientsAroundCube
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const VERTEX_INDEX cube_index, const NUM_TYPE dist2cube)
+{
+  // Same divisors as cgradient.
+  const GRADIENT_COORD_TYPE dist[DIM3] = { 2, 2, 2 };
+  const AXIS_SIZE_TYPE bwidth = GRADIENT_BLOCK_WIDTH;
+  GRADIENT_COORD_TYPE * magnitude = NULL;
+  std::ptrdiff_t axis_size[DIM3];
+  VERTEX_INDEX region_iv0;
+  AXIS_SIZE_TYPE region_axis_size[DIM3];
+  GRID_COORD_TYPE region_coord0[DIM3];
+
+  for (int d = 0; d < DIM3; d++)
+    { axis_size[d] = scalar_grid.AxisSize(d); }
+
+  compute_region_around_cube
+    (cube_index, DIM3, scalar_grid.AxisSize(), dist2cube, 
+     region_iv0, region_axis_size);
+  scalar_grid.ComputeCoord(region_iv0, region_coord0);
+
+  const AXIS_SIZE_TYPE xmin = region_coord0[0];
+  const AXIS_SIZE_TYPE xmax = xmin + region_axis_size[0];
+
+  for (AXIS_SIZE_TYPE z = region_coord0[2]; 
+       z < region_coord0[2]+region_axis_size[2]; z++) {
+    for (AXIS_SIZE_TYPE y = region_coord0[1]; 
+         y < region_coord0[1]+region_axis_size[1]; y++) {
+
+      // Split the row at block boundaries.
+      // Within a block, gradients of a row are contiguous.
+      AXIS_SIZE_TYPE xs = xmin;
+      while (xs < xmax) {
+        const AXIS_SIZE_TYPE xe = std::min(xmax, (xs/bwidth+1)*bwidth);
+        const VERTEX_INDEX ivs = xs + axis_size[0]*(y + axis_size[1]*z);
+        VERTEX_INDEX ib;
+        NUM_TYPE k0;
+
+        ComputeBlockLocation(ivs, ib, k0);
+        GRADIENT_BLOCK * gblock = GetBlock(ib);
+
+        // Compute each run of vertices whose gradients are not computed.
+        AXIS_SIZE_TYPE x0 = xs;
+        while (x0 < xe) {
+          if (gblock->is_computed[k0+x0-xs]) { x0++; continue; }
+
+          AXIS_SIZE_TYPE x1 = x0;
+          while (x1 < xe && !gblock->is_computed[k0+x1-xs]) {
+            gblock->is_computed[k0+x1-xs] = true;
+            x1++;
+          }
+
+          IJK::compute_gradient_central_difference_3D_row_segment
+            (scalar_grid.ScalarPtrConst(), axis_size, dist, false,
+             GRADIENT_COORD_TYPE(0), false,
+             [&](const VERTEX_INDEX iv, GRADIENT_COORD_TYPE * gradient)
+             { compute_boundary_gradient(scalar_grid, iv, gradient); },
+             x0, x1, y, z, gblock->gradient+DIM3*(k0+x0-xs), magnitude);
+
+          x0 = x1;
+        }
+
+        xs = xe;
+      }
+    }
+  }
+}
+
+
 // **************************************************
 // SHREC TIME
 // **************************************************
@@ -423,6 +685,7 @@ void SHREC::SHARPISO_INFO::Clear()
   num_cube_single_isov = 0;
   num_cube_multi_isov = 0;
   num_non_disk_isopatches = 0;
+  num_skipped_disk_checks = 0;
   num_non_manifold_split = 0;
   num_1_2_change = 0;
 
@@ -575,3 +838,43 @@ bool SHREC::MERGE_DATA::Check(ERROR & error) const
   return(true);
 }
 
+
+// **************************************************
+// LOCAL ROUTINES
+// **************************************************
+
+namespace {
+
+  // Compute gradient at boundary vertex iv.
+  // Use one-sided differences along axes where iv is on the grid boundary.
+  // Same formulas as cgradient, so gradients match cgradient output.
+  void compute_boundary_gradient
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid, const VERTEX_INDEX iv,
+   GRADIENT_COORD_TYPE * gradient)
+  {
+    GRID_COORD_TYPE coord[DIM3];
+
+    scalar_grid.ComputeCoord(iv, coord);
+
+    for (int d = 0; d < DIM3; d++) {
+      if (coord[d] > 0) {
+        const VERTEX_INDEX iv0 = scalar_grid.PrevVertex(iv, d);
+        if (coord[d]+1 < scalar_grid.AxisSize(d)) {
+          const VERTEX_INDEX iv2 = scalar_grid.NextVertex(iv, d);
+          gradient[d] = (scalar_grid.Scalar(iv2) - scalar_grid.Scalar(iv0))/2;
+        }
+        else {
+          gradient[d] = scalar_grid.Scalar(iv) - scalar_grid.Scalar(iv0);
+        }
+      }
+      else if (coord[d]+1 < scalar_grid.AxisSize(d)) {
+        const VERTEX_INDEX iv2 = scalar_grid.NextVertex(iv, d);
+        gradient[d] = scalar_grid.Scalar(iv2) - scalar_grid.Scalar(iv);
+      }
+      else {
+        gradient[d] = 0;
+      }
+    }
+  }
+
+}
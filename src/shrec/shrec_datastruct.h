@@ -22,6 +22,7 @@
 #ifndef _SHREC_DATASTRUCT_
 #define _SHREC_DATASTRUCT_
 
+#include <bitset>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -109,6 +110,68 @@ namespace SHREC {
     void Clear();
   };
 
+  // **************************************************
+  // BAND GRADIENT GRID
+  // **************************************************
+
+  /// Gradient grid which stores gradients computed near isosurfaces.
+  /// Gradients are stored in blocks of GRADIENT_BLOCK_WIDTH^3 vertices.
+  /// Blocks are allocated when a gradient in the block is first computed.
+  /// Gradients which are not computed are zero.
+  class BAND_GRADIENT_GRID:public GRADIENT_GRID_BASE {
+
+  protected:
+
+    /// Gradients and computed flags of a block.
+    class GRADIENT_BLOCK {
+    public:
+      GRADIENT_COORD_TYPE gradient[GRADIENT_BLOCK_NUM_VERTICES*DIM3];
+
+      /// is_computed[k] is true if the gradient at location k is computed.
+      std::bitset<GRADIENT_BLOCK_NUM_VERTICES> is_computed;
+    };
+
+    /// block[ib] is block ib or NULL if block ib is not allocated.
+    std::vector<GRADIENT_BLOCK *> block;
+
+    /// block_gradient_ptr[ib] is block[ib]->gradient
+    ///   or NULL if block ib is not allocated.
+    std::vector<GRADIENT_COORD_TYPE *> block_gradient_ptr;
+
+    /// Return block ib.  Allocate block ib if not allocated.
+    GRADIENT_BLOCK * GetBlock(const VERTEX_INDEX ib);
+
+    // copy constructor and assignment: NOT IMPLEMENTED
+    BAND_GRADIENT_GRID(const BAND_GRADIENT_GRID &);
+    const BAND_GRADIENT_GRID & operator = (const BAND_GRADIENT_GRID &);
+
+  public:
+    BAND_GRADIENT_GRID() {};
+    ~BAND_GRADIENT_GRID() { FreeAll(); };
+
+    /// Set size and spacing to size and spacing of scalar_grid.
+    /// Set all gradients to zero.
+    /// @pre scalar_grid.Dimension() = 3.
+    void SetSize(const SHARPISO_SCALAR_GRID_BASE & scalar_grid);
+
+    /// Free memory.
+    void FreeAll();
+
+    /// Compute central difference gradients of scalar_grid
+    ///   at vertices within distance dist2cube of cube cube_index.
+    /// Gradients which are already computed are not recomputed.
+    /// @pre Grid has the same size as scalar_grid.
+    void ComputeGradientsAroundCube
+      (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+       const VERTEX_INDEX cube_index, const NUM_TYPE dist2cube);
+
+    /// Return true if gradient at vertex iv is computed.
+    bool IsComputed(const VERTEX_INDEX iv) const;
+
+    /// Return number of allocated blocks.
+    NUM_TYPE NumAllocatedBlocks() const;
+  };
+
   // **************************************************
   // DUAL CONTOURING INPUT DATA AND DATA STRUCTURES
   // **************************************************
@@ -220,12 +283,30 @@ namespace SHREC {
   protected:
     SHARPISO_SCALAR_GRID scalar_grid;  ///< Regular grid of scalar values.
     GRADIENT_GRID gradient_grid;       ///< Regular grid of vertex gradients.
+    BAND_GRADIENT_GRID band_gradient_grid;  ///< Gradients near isosurfaces.
+
+    /// Scalar grid used by isosurface construction.
+    /// Points to scalar_grid or to a grid set by ReferenceScalarGrid().
+    const SHARPISO_SCALAR_GRID_BASE * scalar_grid_ptr;
+
+    /// Gradient grid used by isosurface construction.
+    /// Points to gradient_grid, to band_gradient_grid 
+    ///   or to a grid set by ReferenceGrids().
+    const GRADIENT_GRID_BASE * gradient_grid_ptr;
+
+    /// Min and max of scalar_grid regions.
+    /// Computed once when scalar_grid is set and reused for all isovalues.
+    SHARPISO_MINMAX_PYRAMID minmax_pyramid;
 
     /// Coordinate of edge-isosurface intersections
     std::vector<COORD_TYPE> edgeI_coord;  
 
     /// Coordinates of normal vectors at edge-isosurface intersections.
     std::vector<GRADIENT_COORD_TYPE> edgeI_normal_coord;
+
+    /// Grid edges containing edge-isosurface intersections.
+    /// Empty if grid edges are not known.
+    std::vector<EDGE_KEY_TYPE> edgeI_edge_key;
     
 
     // flags
@@ -235,6 +316,7 @@ namespace SHREC {
 
     void Init();
     void FreeAll();
+    void ComputeMinMaxPyramid();
 
   public:
     SHREC_DATA() { Init(); };
@@ -271,10 +353,38 @@ namespace SHREC {
        const bool flag_subsample, const int subsample_resolution,
        const bool flag_supersample, const int supersample_resolution);
 
+    /// Use scalar_grid2 without copying.
+    /// @pre scalar_grid2 is not deleted or modified while SHREC_DATA is used.
+    void ReferenceScalarGrid
+      (const SHARPISO_SCALAR_GRID_BASE & scalar_grid2);
+
+    /// Use scalar_grid2 and gradient_grid2 without copying.
+    /// @pre Grids are not deleted or modified while SHREC_DATA is used.
+    void ReferenceGrids
+      (const SHARPISO_SCALAR_GRID_BASE & scalar_grid2,
+       const GRADIENT_GRID_BASE & gradient_grid2);
+
     /// Set edge-isosurface intersections and normals.
     void SetEdgeI(const std::vector<COORD_TYPE> & edgeI_coord,
                   const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord);
 
+    /// Set edge-isosurface intersections, normals 
+    ///   and grid edges containing the intersections.
+    /// If edgeI_edge_key[] is empty, grid edges are computed 
+    ///   from edgeI_coord[] when needed.
+    void SetEdgeI(const std::vector<COORD_TYPE> & edgeI_coord,
+                  const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+                  const std::vector<EDGE_KEY_TYPE> & edgeI_edge_key);
+
+    /// Compute central difference gradients of ScalarGrid()
+    ///   at vertices near the isosurfaces with the given isovalues.
+    /// Computes gradients at vertices within distance max_grad_dist+1
+    ///   of active cubes, using the same formulas as cgradient.
+    /// Gradients of all other vertices are zero.
+    /// @pre Scalar grid is set and has dimension 3.
+    /// @pre Parameter max_grad_dist is set.
+    void ComputeGradients(const std::vector<SCALAR_TYPE> & isovalue);
+
     // Get functions
     bool IsScalarGridSet() const     /// Return true if scalar grid is set.
       { return(is_scalar_grid_set); };
@@ -287,11 +397,15 @@ namespace SHREC {
 
     /// Return scalar_grid.
     const SHARPISO_SCALAR_GRID_BASE & ScalarGrid() const
-      { return(scalar_grid); };
+      { return(*scalar_grid_ptr); };
+
+    /// Return min and max of scalar_grid regions.
+    const SHARPISO_MINMAX_PYRAMID & MinMaxPyramid() const
+      { return(minmax_pyramid); };
 
     /// Return gradient_grid.
     const GRADIENT_GRID_BASE & GradientGrid() const     
-      { return(gradient_grid); };
+      { return(*gradient_grid_ptr); };
 
     /// Return edgeI coordinates.
     const std::vector<COORD_TYPE> & EdgeICoord() const
@@ -301,6 +415,11 @@ namespace SHREC {
     const std::vector<GRADIENT_COORD_TYPE> & EdgeINormalCoord() const  
       { return(edgeI_normal_coord); }
 
+    /// Return grid edges containing edge-isosurface intersections.
+    /// Return empty list if grid edges are not known.
+    const std::vector<EDGE_KEY_TYPE> & EdgeIEdgeKey() const
+      { return(edgeI_edge_key); }
+
     /// Check data structure
     bool Check(IJK::ERROR & error) const;
   };
@@ -421,6 +540,10 @@ namespace SHREC {
     /// Number of merges blocked by non-disk isosurface patches.
     int num_non_disk_isopatches;
 
+    /// Number of disk checks skipped since the isosurface patch
+    ///   could not have changed since its last check.
+    int num_skipped_disk_checks;
+
     /// Number of splits to avoid non-manifold edges.
     int num_non_manifold_split;
 
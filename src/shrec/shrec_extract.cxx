@@ -19,6 +19,10 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <algorithm>
+#include <utility>
+
+#include "ijkgradient.txx"
 #include "ijkgrid_macros.h"
 #include "ijkisopoly.txx"
 #include "ijktime.txx"
@@ -29,6 +33,105 @@ using namespace IJK;
 using namespace SHREC;
 
 
+// **************************************************
+// LOCAL ROUTINES
+// **************************************************
+
+namespace {
+
+  /// Minimum number of edges processed by each thread.
+  const NUM_TYPE MIN_EDGES_PER_THREAD = 4096;
+
+  /// Append isosurface polytopes dual to edges 
+  ///   edge_list[ibegin..iend-1] to iso_poly and facet_vertex.
+  void extract_dual_isopoly_from_list_range
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const SCALAR_TYPE isovalue,
+   const std::vector<EDGE_INDEX> & edge_list,
+   const NUM_TYPE ibegin, const NUM_TYPE iend,
+   std::vector<ISO_VERTEX_INDEX> & iso_poly,
+   std::vector<FACET_VERTEX_INDEX> & facet_vertex)
+  {
+    const int dimension = scalar_grid.Dimension();
+
+    for (NUM_TYPE i = ibegin; i < iend; i++) {
+      const EDGE_INDEX edge_index = edge_list[i];
+      const VERTEX_INDEX iend0 = edge_index/dimension;
+      const int edge_dir = edge_index%dimension;
+
+      extract_dual_isopoly_around_bipolar_edge
+        (scalar_grid, isovalue, iend0, edge_dir, iso_poly, facet_vertex);
+    }
+  }
+
+  /// Extract isosurface polytopes dual to edges in edge_list.
+  /// Partition edge_list into contiguous blocks, one block per thread.
+  /// Concatenate output of each block in block order,
+  ///   so output does not depend on the number of threads.
+  void extract_dual_isopoly_from_list_parallel
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const SCALAR_TYPE isovalue,
+   const std::vector<EDGE_INDEX> & edge_list,
+   const int num_threads,
+   std::vector<ISO_VERTEX_INDEX> & iso_poly,
+   std::vector<FACET_VERTEX_INDEX> & facet_vertex)
+  {
+    const NUM_TYPE num_edges = edge_list.size();
+    int num_blocks = IJK::get_num_threads(num_threads);
+    if (num_blocks > num_edges/MIN_EDGES_PER_THREAD)
+      { num_blocks = num_edges/MIN_EDGES_PER_THREAD; }
+
+    iso_poly.clear();
+    facet_vertex.clear();
+
+    if (num_blocks <= 1) {
+      extract_dual_isopoly_from_list_range
+        (scalar_grid, isovalue, edge_list, 0, num_edges, 
+         iso_poly, facet_vertex);
+      return;
+    }
+
+    std::vector< std::vector<ISO_VERTEX_INDEX> > block_poly(num_blocks);
+    std::vector< std::vector<FACET_VERTEX_INDEX> > 
+      block_facet_vertex(num_blocks);
+
+    IJK::for_each_block_in_parallel
+      (num_blocks, num_blocks,
+       [&](const int k0, const int k1)
+       {
+         for (int k = k0; k < k1; k++) {
+           const NUM_TYPE ibegin = 
+             NUM_TYPE((long(num_edges)*k)/num_blocks);
+           const NUM_TYPE iend = 
+             NUM_TYPE((long(num_edges)*(k+1))/num_blocks);
+
+           extract_dual_isopoly_from_list_range
+             (scalar_grid, isovalue, edge_list, ibegin, iend,
+              block_poly[k], block_facet_vertex[k]);
+         }
+       });
+
+    NUM_TYPE num_poly_vert = 0;
+    NUM_TYPE num_facet_vert = 0;
+    for (int k = 0; k < num_blocks; k++) {
+      num_poly_vert += block_poly[k].size();
+      num_facet_vert += block_facet_vertex[k].size();
+    }
+
+    iso_poly.reserve(num_poly_vert);
+    facet_vertex.reserve(num_facet_vert);
+    for (int k = 0; k < num_blocks; k++) {
+      iso_poly.insert(iso_poly.end(), 
+                      block_poly[k].begin(), block_poly[k].end());
+      facet_vertex.insert
+        (facet_vertex.end(), block_facet_vertex[k].begin(), 
+         block_facet_vertex[k].end());
+    }
+  }
+
+}
+
+
 // **************************************************
 // EXTRACT ISOPOLY
 // **************************************************
@@ -47,7 +150,7 @@ void SHREC::extract_dual_isopoly
 {
   shrec_info.time.extract = 0;
 
-  clock_t t0 = std::clock();
+  WALL_TIME_POINT t0 = wall_clock();
 
   // initialize output
   iso_poly.clear();
@@ -60,7 +163,7 @@ void SHREC::extract_dual_isopoly
       (scalar_grid, isovalue, iend0, edge_dir, iso_poly);
   }
 
-  clock_t t1 = clock();
+  WALL_TIME_POINT t1 = wall_clock();
   clock2seconds(t1-t0, shrec_info.time.extract);
 }
 
@@ -81,7 +184,7 @@ void SHREC::extract_dual_isopoly
 {
   shrec_info.time.extract = 0;
 
-  clock_t t0 = clock();
+  WALL_TIME_POINT t0 = wall_clock();
 
   // initialize output
   iso_poly.clear();
@@ -94,10 +197,68 @@ void SHREC::extract_dual_isopoly
       (scalar_grid, isovalue, iend0, edge_dir, iso_poly, facet_vertex);
   }
 
-  clock_t t1 = clock();
+  WALL_TIME_POINT t1 = wall_clock();
+  clock2seconds(t1-t0, shrec_info.time.extract);
+}
+
+/// Extract dual isosurface polytopes from edges of active cubes.
+/// Returns list of isosurface polytope vertices.
+/// Visits only edges of cubes in isovert.gcube_list,
+///   not every grid edge.
+/// @param isovert = Active cubes.
+///   isovert.gcube_list contains all active cubes of scalar_grid.
+/// @param num_threads = Number of threads.
+///   If num_threads is 0, use all hardware threads.
+/// @param iso_poly[] = vector of isosurface polytope vertices
+///   iso_poly[numv_per_poly*ip+k] = 
+///     cube containing k'th vertex of polytope ip.
+void SHREC::extract_dual_isopoly
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const SCALAR_TYPE isovalue, const ISOVERT & isovert, const int num_threads,
+ std::vector<ISO_VERTEX_INDEX> & iso_poly,
+ SHREC_INFO & shrec_info)
+{
+  std::vector<FACET_VERTEX_INDEX> facet_vertex;
+
+  extract_dual_isopoly
+    (scalar_grid, isovalue, isovert, num_threads, iso_poly, facet_vertex,
+     shrec_info);
+}
+
+
+/// Extract dual isosurface polytopes from edges of active cubes.
+/// Returns list of isosurface polytope vertices.
+/// Return locations of isosurface vertices on each facet.
+/// Output is identical to extract_dual_isopoly() on the full grid.
+void SHREC::extract_dual_isopoly
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const SCALAR_TYPE isovalue, const ISOVERT & isovert, const int num_threads,
+ std::vector<ISO_VERTEX_INDEX> & iso_poly,
+ std::vector<FACET_VERTEX_INDEX> & facet_vertex,
+ SHREC_INFO & shrec_info)
+{
+  std::vector<EDGE_INDEX> edge_list;
+
+  shrec_info.time.extract = 0;
+
+  WALL_TIME_POINT t0 = wall_clock();
+
+  // initialize output
+  iso_poly.clear();
+  facet_vertex.clear();
+
+  if (scalar_grid.NumCubeVertices() < 1) { return; }
+
+  get_active_cube_edges(scalar_grid, isovert, edge_list);
+
+  extract_dual_isopoly_from_list_parallel
+    (scalar_grid, isovalue, edge_list, num_threads, iso_poly, facet_vertex);
+
+  WALL_TIME_POINT t1 = wall_clock();
   clock2seconds(t1-t0, shrec_info.time.extract);
 }
 
+
 /// Extract dual isosurface polytopes from list of edges.
 /// Returns list of isosurface polytope vertices.
 /// Return locations of isosurface vertices on each facet.
@@ -116,7 +277,7 @@ void SHREC::extract_dual_isopoly_from_list
   iso_poly.clear();
   facet_vertex.clear();
 
-  for (NUM_TYPE i = 0; i < edge_list.size(); i++) {
+  for (size_t i = 0; i < edge_list.size(); i++) {
     EDGE_INDEX edge_index = edge_list[i];
     VERTEX_INDEX iend0 = edge_index/dimension;
     int edge_dir = edge_index%dimension;
@@ -127,6 +288,64 @@ void SHREC::extract_dual_isopoly_from_list
 }
 
 
+// **************************************************
+// GET ACTIVE CUBE EDGES
+// **************************************************
+
+/// Get interior grid edges which are edges of active cubes.
+/// Each edge is assigned to the cube containing the edge
+///   whose lowest vertex is the lowest edge endpoint.
+///   That cube is active for every bipolar interior edge,
+///   so edge_list contains every bipolar interior edge exactly once.
+/// Edges are listed in the order visited by 
+///   IJK_FOR_EACH_INTERIOR_GRID_EDGE.
+/// @param[out] edge_list = List of edges.
+///   Edge (iend0,edge_dir) has index iend0*dimension+edge_dir.
+void SHREC::get_active_cube_edges
+(const SHARPISO_GRID & grid, const ISOVERT & isovert,
+ std::vector<EDGE_INDEX> & edge_list)
+{
+  const int dimension = grid.Dimension();
+  const NUM_TYPE num_gcube = isovert.gcube_list.size();
+  // Pairs (iend0 - coord[edge_dir]*axis_increment[edge_dir], iend0).
+  // Sorting the pairs orders edges as IJK_FOR_EACH_INTERIOR_GRID_EDGE.
+  std::vector< std::pair<VERTEX_INDEX,VERTEX_INDEX> > facet_edge;
+
+  edge_list.clear();
+  edge_list.reserve(dimension*num_gcube);
+  facet_edge.reserve(num_gcube);
+
+  for (int edge_dir = 0; edge_dir < dimension; edge_dir++) {
+
+    const VERTEX_INDEX axis_increment = grid.AxisIncrement(edge_dir);
+
+    facet_edge.clear();
+    for (NUM_TYPE i = 0; i < num_gcube; i++) {
+      const GRID_CUBE_DATA & gcube = isovert.gcube_list[i];
+
+      // Skip edges on the lower grid boundary.
+      bool is_interior = true;
+      for (int d = 0; d < dimension; d++) {
+        if (d != edge_dir && gcube.cube_coord[d] == 0) 
+          { is_interior = false; }
+      }
+
+      if (is_interior) {
+        const VERTEX_INDEX iend0 = gcube.cube_index;
+        facet_edge.push_back
+          (std::make_pair
+           (iend0 - gcube.cube_coord[edge_dir]*axis_increment, iend0));
+      }
+    }
+
+    std::sort(facet_edge.begin(), facet_edge.end());
+
+    for (size_t j = 0; j < facet_edge.size(); j++) 
+      { edge_list.push_back(facet_edge[j].second*dimension + edge_dir); }
+  }
+}
+
+
 // **************************************************
 // MAP TO ISOPOLY VERTICES
 // **************************************************
@@ -136,7 +355,7 @@ void SHREC::extract_dual_isopoly_from_list
 void SHREC::map_isopoly_vert
 (const ISOVERT & isovert, std::vector<ISO_VERTEX_INDEX> & iso_poly_vert)
 {
-  for (VERTEX_INDEX i = 0; i < iso_poly_vert.size(); i++) {
+  for (size_t i = 0; i < iso_poly_vert.size(); i++) {
     VERTEX_INDEX icube = iso_poly_vert[i];
     VERTEX_INDEX gcube_index = isovert.GCubeIndex(icube);
     iso_poly_vert[i] = gcube_index;
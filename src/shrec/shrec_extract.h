@@ -56,6 +56,35 @@ namespace SHREC {
    std::vector<FACET_VERTEX_INDEX> & facet_vertex,
    SHREC_INFO & shrec_info);
 
+  /// Extract dual isosurface polytopes from edges of active cubes.
+  /// Returns list of isosurface polytope vertices.
+  /// Visits only edges of cubes in isovert.gcube_list,
+  ///   not every grid edge.
+  /// @param isovert = Active cubes.
+  ///   isovert.gcube_list contains all active cubes of scalar_grid.
+  /// @param num_threads = Number of threads.
+  ///   If num_threads is 0, use all hardware threads.
+  /// @param iso_poly[] = vector of isosurface polytope vertices
+  ///   iso_poly[numv_per_poly*ip+k] = 
+  ///     cube containing k'th vertex of polytope ip.
+  void extract_dual_isopoly
+    (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+     const SCALAR_TYPE isovalue, const ISOVERT & isovert, 
+     const int num_threads, std::vector<ISO_VERTEX_INDEX> & iso_poly,
+     SHREC_INFO & shrec_info);
+
+  /// Extract dual isosurface polytopes from edges of active cubes.
+  /// Returns list of isosurface polytope vertices.
+  /// Return locations of isosurface vertices on each facet.
+  /// Output is identical to extract_dual_isopoly() on the full grid.
+  /// @param facet_vertex = Location of iso vertex on facet.
+  void extract_dual_isopoly
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const SCALAR_TYPE isovalue, const ISOVERT & isovert, 
+   const int num_threads, std::vector<ISO_VERTEX_INDEX> & iso_cube,
+   std::vector<FACET_VERTEX_INDEX> & facet_vertex,
+   SHREC_INFO & shrec_info);
+
   /// Extract dual isosurface polytopes from list of edges.
   /// Returns list of isosurface polytope vertices.
   /// Return locations of isosurface vertices on each facet.
@@ -74,6 +103,19 @@ namespace SHREC {
    std::vector<ISO_VERTEX_INDEX> & iso_cube,
    std::vector<FACET_VERTEX_INDEX> & facet_vertex);
 
+  // **************************************************
+  // GET ACTIVE CUBE EDGES
+  // **************************************************
+
+  /// Get interior grid edges which are edges of active cubes.
+  /// Each bipolar interior edge is listed exactly once,
+  ///   in the order visited by IJK_FOR_EACH_INTERIOR_GRID_EDGE.
+  /// @param[out] edge_list = List of edges.
+  ///   Edge (iend0,edge_dir) has index iend0*dimension+edge_dir.
+  void get_active_cube_edges
+  (const SHARPISO_GRID & grid, const ISOVERT & isovert,
+   std::vector<EDGE_INDEX> & edge_list);
+
   // **************************************************
   // MAP TO ISOPOLY VERTICES
   // **************************************************
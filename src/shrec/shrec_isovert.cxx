@@ -29,6 +29,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <stdio.h>
 
 #include "ijkcoord.txx"
+#include "ijkgradient.txx"
 #include "ijkgrid.txx"
 #include "ijkgrid_macros.h"
 #include "ijkscalar_grid.txx"
@@ -40,6 +41,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "shrec_position.h"
 
 #include "sharpiso_closest.h"
+#include "sharpiso_svd.h"
 
 #include "shrec_debug.h"
 
@@ -51,7 +53,7 @@ using namespace IJK;
 
 // *** DEBUG ***
 #include "ijkprint.txx"
-bool flag_debug(false);
+thread_local bool flag_debug(false);
 
 
 namespace {
@@ -147,19 +149,19 @@ namespace {
 
   // *** MOVED TO shrec_select ***
   bool check_covered_point
-  (const SHARPISO_BOOL_GRID & covered_grid,
+  (const GCUBE_FLAG_GRID & covered_grid,
    const ISOVERT & isovert,
    const VERTEX_INDEX & gcube0_index);
 
   // *** MOVED TO shrec_select ***
   void check_and_set_covered_point
-  (const SHARPISO_BOOL_GRID & covered_grid,
+  (const GCUBE_FLAG_GRID & covered_grid,
    ISOVERT & isovert,
    const VERTEX_INDEX & gcube_index);
 
   void check_covered_and_substitute
   (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
-   const SHARPISO_BOOL_GRID & covered_grid,
+   const GCUBE_FLAG_GRID & covered_grid,
    const SCALAR_TYPE isovalue,
    const NUM_TYPE gcube_index,
    ISOVERT & isovert);
@@ -170,7 +172,7 @@ namespace {
    ISOVERT & isovert);
 
   void set_covered_grid
-  (const ISOVERT & isovert, SHARPISO_BOOL_GRID & covered_grid);
+  (const ISOVERT & isovert, GCUBE_FLAG_GRID & covered_grid);
 }
 
 void replace_with_substitute_coord
@@ -191,6 +193,17 @@ void set_isovert_position_from_other_cube
  const COORD_TYPE * new_coord, const NUM_TYPE num_eigenvalues,
  ISOVERT & isovert);
 
+void set_isovert_direction_and_coordB
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const SHARP_ISOVERT_PARAM & isovert_param,
+ const VERTEX_INDEX cube_index,
+ const NUM_TYPE gcube_index,
+ const COORD_TYPE edge_dir[DIM3],
+ const COORD_TYPE orth_dir[DIM3],
+ const NUM_TYPE num_large_eigenvalues,
+ const SVD_INFO & svd_info,
+ ISOVERT & isovert);
+
 
 // **************************************************
 // ISOVERT ROUTINES
@@ -200,6 +213,7 @@ void set_isovert_position_from_other_cube
 ///   using lindstrom algorithm.
 /// Use voxel for gradient cube offset, 
 ///   not isovert_param.grad_selection_cube_offset.
+/// @param buffer Storage reused for each cube.
 void compute_isovert_position_lindstrom
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
@@ -207,11 +221,10 @@ void compute_isovert_position_lindstrom
  const SHARP_ISOVERT_PARAM & isovert_param,
  const OFFSET_VOXEL & voxel,
  const VERTEX_INDEX & cube_index,
- ISOVERT & isovert)
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer)
 {
   const INDEX_DIFF_TYPE gcube_index = isovert.GCubeIndex(cube_index);
-  const GRADIENT_COORD_TYPE max_small_magnitude =
-    isovert_param.max_small_magnitude;
 	SVD_INFO svd_info;
 
   if (gcube_index != ISOVERT::NO_INDEX) {
@@ -222,74 +235,97 @@ void compute_isovert_position_lindstrom
     // compute the sharp vertex for this cube
     EIGENVALUE_TYPE eigenvalues[DIM3]={0.0};
     COORD_TYPE edge_dir[DIM3], orth_dir[DIM3];
-    NUM_TYPE num_large_eigenvalues;
+    NUM_TYPE num_large_eigenvalues = 0;
 
     svd_compute_sharp_vertex_for_cube_lindstrom
       (scalar_grid, gradient_grid, cube_index, isovalue, isovert_param, 
        voxel, isovert.gcube_list[gcube_index].isovert_coord,
-       edge_dir, orth_dir, eigenvalues, num_large_eigenvalues, svd_info);
+       edge_dir, orth_dir, eigenvalues, num_large_eigenvalues, svd_info,
+       buffer);
 
-    if (num_large_eigenvalues == 1) {
-      IJK::copy_coord_3D(orth_dir, isovert.gcube_list[gcube_index].direction);
-    }
-    else if (num_large_eigenvalues == 2) {
-      IJK::copy_coord_3D(edge_dir, isovert.gcube_list[gcube_index].direction);
-    }
-    else {
-      IJK::set_coord_3D(0, isovert.gcube_list[gcube_index].direction);
-    }
+    set_isovert_direction_and_coordB
+      (scalar_grid, isovert_param, cube_index, gcube_index, 
+       edge_dir, orth_dir, num_large_eigenvalues, svd_info, isovert);
+  }
+}
 
-    const COORD_TYPE * isovert_coord =
-      isovert.gcube_list[gcube_index].isovert_coord;
-    const COORD_TYPE * direction =
-      isovert.gcube_list[gcube_index].direction;
+/// Set isovert direction and isovert_coordB from the sharp vertex 
+///   computed by Lindstrom's algorithm and store svd information.
+/// @pre isovert.gcube_list[gcube_index].isovert_coord is set.
+void set_isovert_direction_and_coordB
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const SHARP_ISOVERT_PARAM & isovert_param,
+ const VERTEX_INDEX cube_index,
+ const NUM_TYPE gcube_index,
+ const COORD_TYPE edge_dir[DIM3],
+ const COORD_TYPE orth_dir[DIM3],
+ const NUM_TYPE num_large_eigenvalues,
+ const SVD_INFO & svd_info,
+ ISOVERT & isovert)
+{
+  const GRADIENT_COORD_TYPE max_small_magnitude =
+    isovert_param.max_small_magnitude;
 
-    if (num_large_eigenvalues > 2 ||
-        cube_contains_point(scalar_grid, cube_index, isovert_coord)) {
+  if (num_large_eigenvalues == 1) {
+    IJK::copy_coord_3D(orth_dir, isovert.gcube_list[gcube_index].direction);
+  }
+  else if (num_large_eigenvalues == 2) {
+    IJK::copy_coord_3D(edge_dir, isovert.gcube_list[gcube_index].direction);
+  }
+  else {
+    IJK::set_coord_3D(0, isovert.gcube_list[gcube_index].direction);
+  }
 
-      IJK::copy_coord_3D
-        (isovert_coord, isovert.gcube_list[gcube_index].isovert_coordB);
-    }
-    else if (num_large_eigenvalues == 2) {
-      COORD_TYPE cube_center_coord[DIM3];
-      COORD_TYPE closest_point[DIM3];
+  const COORD_TYPE * isovert_coord =
+    isovert.gcube_list[gcube_index].isovert_coord;
+  const COORD_TYPE * direction =
+    isovert.gcube_list[gcube_index].direction;
 
-      scalar_grid.ComputeCubeCenterScaledCoord
-        (cube_index, cube_center_coord);
+  if (num_large_eigenvalues > 2 ||
+      cube_contains_point(scalar_grid, cube_index, isovert_coord)) {
 
-      // Compute point on line closest (L2) to cube center.
-      compute_closest_point_on_line
-        (cube_center_coord, isovert_coord, direction, max_small_magnitude, 
-         closest_point);
+    IJK::copy_coord_3D
+      (isovert_coord, isovert.gcube_list[gcube_index].isovert_coordB);
+  }
+  else if (num_large_eigenvalues == 2) {
+    COORD_TYPE cube_center_coord[DIM3];
+    COORD_TYPE closest_point[DIM3];
 
-      if (cube_contains_point(scalar_grid, cube_index, isovert_coord)) {
-        IJK::copy_coord_3D
-          (closest_point, isovert.gcube_list[gcube_index].isovert_coordB);
-      }
-      else {
+    scalar_grid.ComputeCubeCenterScaledCoord
+      (cube_index, cube_center_coord);
 
-        // Compute point on line closest (Linf) to cube center.
-        compute_closest_point_on_line_unscaled_linf
-          (cube_center_coord, isovert_coord,  direction, max_small_magnitude,
-           scalar_grid.SpacingPtrConst(),
-           isovert.gcube_list[gcube_index].isovert_coordB);
-      }
-    }
-    else if (num_large_eigenvalues == 1) {
-      COORD_TYPE cube_center_coord[DIM3];
+    // Compute point on line closest (L2) to cube center.
+    compute_closest_point_on_line
+      (cube_center_coord, isovert_coord, direction, max_small_magnitude, 
+       closest_point);
 
-      scalar_grid.ComputeCubeCenterScaledCoord
-        (cube_index, cube_center_coord);
+    if (cube_contains_point(scalar_grid, cube_index, isovert_coord)) {
+      IJK::copy_coord_3D
+        (closest_point, isovert.gcube_list[gcube_index].isovert_coordB);
+    }
+    else {
 
-      // Compute point on plane closest (L2) to cube center.
-      compute_closest_point_on_plane
-        (cube_center_coord, isovert_coord, direction, 
+      // Compute point on line closest (Linf) to cube center.
+      compute_closest_point_on_line_unscaled_linf
+        (cube_center_coord, isovert_coord,  direction, max_small_magnitude,
+         scalar_grid.SpacingPtrConst(),
          isovert.gcube_list[gcube_index].isovert_coordB);
     }
+  }
+  else if (num_large_eigenvalues == 1) {
+    COORD_TYPE cube_center_coord[DIM3];
+
+    scalar_grid.ComputeCubeCenterScaledCoord
+      (cube_index, cube_center_coord);
 
-    store_svd_info(scalar_grid, cube_index, gcube_index, 
-                   num_large_eigenvalues, svd_info, isovert);
+    // Compute point on plane closest (L2) to cube center.
+    compute_closest_point_on_plane
+      (cube_center_coord, isovert_coord, direction, 
+       isovert.gcube_list[gcube_index].isovert_coordB);
   }
+
+  store_svd_info(scalar_grid, cube_index, gcube_index, 
+                 num_large_eigenvalues, svd_info, isovert);
 }
 
 /// Compute isosurface vertex positions from gradients.
@@ -302,18 +338,58 @@ void compute_all_isovert_positions
 {
   const SIGNED_COORD_TYPE grad_selection_cube_offset =
     isovert_param.grad_selection_cube_offset;
-  OFFSET_VOXEL voxel;
-  SVD_INFO svd_info;
-
-  voxel.SetVertexCoord
-    (scalar_grid.SpacingPtrConst(), grad_selection_cube_offset);
 
-  IJK_FOR_EACH_GRID_CUBE(cube_index, scalar_grid, VERTEX_INDEX) {
-
-    compute_isovert_position_lindstrom
-      (scalar_grid, gradient_grid, isovalue, isovert_param, voxel,
-       cube_index, isovert);
-  }
+  // Number of cubes whose Lindstrom matrices are solved in one batch.
+  const NUM_TYPE BATCH_SIZE = 256;
+
+  // Each block of gcube_list is processed by a single thread.
+  // Each batch modifies only gcube_list[i] for i in the batch,
+  //   so the output does not depend on the number of threads.
+  IJK::for_each_block_in_parallel
+    (NUM_TYPE(isovert.gcube_list.size()), isovert_param.num_threads,
+     [&](const NUM_TYPE ibegin, const NUM_TYPE iend)
+     {
+       OFFSET_VOXEL voxel;
+       VERTEX_INDEX cube_index[BATCH_SIZE];
+       COORD_TYPE isovert_coord[DIM3*BATCH_SIZE];
+       COORD_TYPE edge_dir[DIM3*BATCH_SIZE], orth_dir[DIM3*BATCH_SIZE];
+       EIGENVALUE_TYPE eigenvalues[DIM3*BATCH_SIZE];
+       NUM_TYPE num_large_eigenvalues[BATCH_SIZE];
+       std::vector<SVD_INFO> svd_info(BATCH_SIZE);
+       // Gradient storage and batch reused for all cubes in the block.
+       GET_GRADIENTS_BUFFER buffer;
+       LINDSTROM_BATCH batch(BATCH_SIZE);
+
+       voxel.SetVertexCoord
+         (scalar_grid.SpacingPtrConst(), grad_selection_cube_offset);
+
+       for (NUM_TYPE i0 = ibegin; i0 < iend; i0 += BATCH_SIZE) {
+         const NUM_TYPE num_cubes = std::min(iend-i0, BATCH_SIZE);
+
+         for (NUM_TYPE k = 0; k < num_cubes; k++) { 
+           cube_index[k] = isovert.gcube_list[i0+k].cube_index; 
+           svd_info[k] = SVD_INFO();
+         }
+
+         svd_compute_sharp_vertex_for_cubes_lindstrom
+           (scalar_grid, gradient_grid, cube_index, num_cubes, isovalue,
+            isovert_param, voxel, isovert_coord, edge_dir, orth_dir,
+            eigenvalues, num_large_eigenvalues, &(svd_info[0]), buffer,
+            batch);
+
+         for (NUM_TYPE k = 0; k < num_cubes; k++) {
+           const NUM_TYPE gcube_index = i0+k;
+
+           IJK::copy_coord_3D
+             (isovert_coord+DIM3*k, 
+              isovert.gcube_list[gcube_index].isovert_coord);
+           set_isovert_direction_and_coordB
+             (scalar_grid, isovert_param, cube_index[k], gcube_index,
+              edge_dir+DIM3*k, orth_dir+DIM3*k, num_large_eigenvalues[k],
+              svd_info[k], isovert);
+         }
+       }
+     });
 
   store_boundary_bits(scalar_grid, isovert.gcube_list);
   set_cube_containing_isovert(scalar_grid, isovalue, isovert);
@@ -328,59 +404,43 @@ void compute_all_isovert_positions_edgeI
  const VERTEX_POSITION_METHOD vertex_position_method,
  ISOVERT & isovert)
 {
-  const SIGNED_COORD_TYPE grad_selection_cube_offset =
-    isovert_param.grad_selection_cube_offset;
-  SVD_INFO svd_info;
-
-  if (vertex_position_method == EDGEI_GRADIENT) {
-
-    IJK_FOR_EACH_GRID_CUBE(iv, scalar_grid, VERTEX_INDEX) {
-      NUM_TYPE index = isovert.GCubeIndex(iv);
-
-      if (index != ISOVERT::NO_INDEX) {
-        // this is an active cube
-        isovert.gcube_list[index].flag_centroid_location = false;
-
-        // compute the sharp vertex for this cube
-        EIGENVALUE_TYPE eigenvalues[DIM3]={0.0};
-        NUM_TYPE num_large_eigenvalues;
-
-        svd_compute_sharp_vertex_edgeI_sharp_gradient
-          (scalar_grid, gradient_grid, iv, isovalue, isovert_param,
-           isovert.gcube_list[index].isovert_coord,
-           eigenvalues, num_large_eigenvalues, svd_info);
-
-
-        store_svd_info(scalar_grid, iv, index, num_large_eigenvalues,
-                       svd_info, isovert);
-      }
-    }
-  }
-  else {
-    // vertex_position_method == EDGEI_INTERPOLATE
-
-    IJK_FOR_EACH_GRID_CUBE(iv, scalar_grid, VERTEX_INDEX) {
-      NUM_TYPE index = isovert.GCubeIndex(iv);
-
-      if (index != ISOVERT::NO_INDEX) {
-        // this is an active cube
-        isovert.gcube_list[index].flag_centroid_location = false;
-
-        // compute the sharp vertex for this cube
-        EIGENVALUE_TYPE eigenvalues[DIM3]={0.0};
-        NUM_TYPE num_large_eigenvalues;
-
-        svd_compute_sharp_vertex_edgeI_interpolate_gradients
-          (scalar_grid, gradient_grid, iv, isovalue, isovert_param,
-           isovert.gcube_list[index].isovert_coord,
-           eigenvalues, num_large_eigenvalues, svd_info);
-
-        store_svd_info(scalar_grid, iv, index, num_large_eigenvalues,
-                       svd_info, isovert);
-
-      }
-    }
-  }
+  // Each block of gcube_list is processed by a single thread.
+  IJK::for_each_block_in_parallel
+    (NUM_TYPE(isovert.gcube_list.size()), isovert_param.num_threads,
+     [&](const NUM_TYPE ibegin, const NUM_TYPE iend)
+     {
+       for (NUM_TYPE index = ibegin; index < iend; index++) {
+         const VERTEX_INDEX iv = isovert.gcube_list[index].cube_index;
+
+         // Note: Use new svd_info for each cube so that flags
+         //   from one cube are not carried to the next cube.
+         SVD_INFO svd_info;
+
+         // this is an active cube
+         isovert.gcube_list[index].flag_centroid_location = false;
+
+         // compute the sharp vertex for this cube
+         EIGENVALUE_TYPE eigenvalues[DIM3]={0.0};
+         NUM_TYPE num_large_eigenvalues;
+
+         if (vertex_position_method == EDGEI_GRADIENT) {
+           svd_compute_sharp_vertex_edgeI_sharp_gradient
+             (scalar_grid, gradient_grid, iv, isovalue, isovert_param,
+              isovert.gcube_list[index].isovert_coord,
+              eigenvalues, num_large_eigenvalues, svd_info);
+         }
+         else {
+           // vertex_position_method == EDGEI_INTERPOLATE
+           svd_compute_sharp_vertex_edgeI_interpolate_gradients
+             (scalar_grid, gradient_grid, iv, isovalue, isovert_param,
+              isovert.gcube_list[index].isovert_coord,
+              eigenvalues, num_large_eigenvalues, svd_info);
+         }
+
+         store_svd_info(scalar_grid, iv, index, num_large_eigenvalues,
+                        svd_info, isovert);
+       }
+     });
 
   store_boundary_bits(scalar_grid, isovert.gcube_list);
 }
@@ -402,7 +462,8 @@ void recompute_isovert_position_lindstrom
  const OFFSET_VOXEL & voxel,
  const bool flag_min_offset,
  const NUM_TYPE gcube_index,
- ISOVERT & isovert)
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer)
 {
   VERTEX_INDEX cube_index = isovert.CubeIndex(gcube_index);
 
@@ -428,7 +489,7 @@ void recompute_isovert_position_lindstrom
 
   compute_isovert_position_lindstrom
     (scalar_grid, gradient_grid, isovalue, isovert_param, voxel,
-     cube_index, isovert);
+     cube_index, isovert, buffer);
 
   isovert.gcube_list[gcube_index].flag_recomputed_coord = true;
   isovert.gcube_list[gcube_index].flag_recomputed_coord_min_offset = 
@@ -462,7 +523,8 @@ void recompute_far_points
  const SHARP_ISOVERT_PARAM & isovert_param,
  const OFFSET_VOXEL & voxel,
  const bool flag_min_offset,
- ISOVERT & isovert)
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer)
 {
   for (NUM_TYPE i = 0; i < isovert.gcube_list.size(); i++) {
 
@@ -474,7 +536,7 @@ void recompute_far_points
 
         recompute_isovert_position_lindstrom
           (scalar_grid, gradient_grid, isovalue,
-           isovert_param, voxel, flag_min_offset, i, isovert);
+           isovert_param, voxel, flag_min_offset, i, isovert, buffer);
       }
     }
   }
@@ -492,6 +554,7 @@ void recompute_far_points
   const SIGNED_COORD_TYPE grad_selection_cube_offset =
     isovert_param.grad_selection_cube_offset;
   OFFSET_VOXEL voxel;
+  GET_GRADIENTS_BUFFER buffer;
 
   if (grad_selection_cube_offset > 0.5) {
 
@@ -501,7 +564,7 @@ void recompute_far_points
 
       recompute_far_points
         (scalar_grid, gradient_grid, isovalue, isovert_param, 
-         voxel, false, isovert);
+         voxel, false, isovert, buffer);
     }
   }
 
@@ -511,7 +574,7 @@ void recompute_far_points
 
     recompute_far_points
       (scalar_grid, gradient_grid, isovalue, isovert_param, 
-       voxel, true, isovert);
+       voxel, true, isovert, buffer);
   }
 }
 
@@ -523,12 +586,13 @@ void recompute_far_points
 void SHREC::recompute_covered_point_positions
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
- const SHARPISO_BOOL_GRID & covered_grid,
+ const GCUBE_FLAG_GRID & covered_grid,
  const SCALAR_TYPE isovalue,
  const SHARP_ISOVERT_PARAM & isovert_param,
  const OFFSET_VOXEL & voxel,
  const bool flag_min_offset,
- ISOVERT & isovert)
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer)
 {
   for (NUM_TYPE i = 0; i < isovert.gcube_list.size(); i++) {
 
@@ -540,7 +604,7 @@ void SHREC::recompute_covered_point_positions
 
         recompute_isovert_position_lindstrom
           (scalar_grid, gradient_grid, isovalue,
-           isovert_param, voxel, flag_min_offset, i, isovert);
+           isovert_param, voxel, flag_min_offset, i, isovert, buffer);
 
         check_covered_and_substitute
           (scalar_grid, covered_grid, isovalue, i, isovert);
@@ -559,13 +623,14 @@ void SHREC::recompute_covered_point_positions
 void SHREC::recompute_covered_point_positions
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
- const SHARPISO_BOOL_GRID & covered_grid,
+ const GCUBE_FLAG_GRID & covered_grid,
  const SCALAR_TYPE isovalue,
- const std::vector<NUM_TYPE> gcube_index_list,
+ const std::vector<NUM_TYPE> & gcube_index_list,
  const SHARP_ISOVERT_PARAM & isovert_param,
  const OFFSET_VOXEL & voxel,
  const bool flag_min_offset,
- ISOVERT & isovert)
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer)
 {
   for (NUM_TYPE i = 0; i < gcube_index_list.size(); i++) {
 
@@ -578,7 +643,8 @@ void SHREC::recompute_covered_point_positions
 
         recompute_isovert_position_lindstrom
           (scalar_grid, gradient_grid, isovalue,
-           isovert_param, voxel, flag_min_offset, gcube_index, isovert);
+           isovert_param, voxel, flag_min_offset, gcube_index, isovert,
+           buffer);
 
         check_covered_and_substitute
           (scalar_grid, covered_grid, isovalue, gcube_index, isovert);
@@ -593,10 +659,11 @@ void SHREC::recompute_covered_point_positions
 void SHREC::recompute_covered_point_positions
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
- const SHARPISO_BOOL_GRID & covered_grid,
+ const GCUBE_FLAG_GRID & covered_grid,
  const SCALAR_TYPE isovalue,
  const SHARP_ISOVERT_PARAM & isovert_param,
- ISOVERT & isovert)
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer)
 {
   const SIGNED_COORD_TYPE grad_selection_cube_offset =
     isovert_param.grad_selection_cube_offset;
@@ -610,7 +677,7 @@ void SHREC::recompute_covered_point_positions
 
       recompute_covered_point_positions
         (scalar_grid, gradient_grid, covered_grid, isovalue, isovert_param, 
-         voxel, false, isovert);
+         voxel, false, isovert, buffer);
     }
   }
 
@@ -620,7 +687,7 @@ void SHREC::recompute_covered_point_positions
 
     recompute_covered_point_positions
       (scalar_grid, gradient_grid, covered_grid, isovalue, isovert_param, 
-       voxel, true, isovert);
+       voxel, true, isovert, buffer);
   }
 }
 
@@ -629,11 +696,12 @@ void SHREC::recompute_covered_point_positions
 void SHREC::recompute_covered_point_positions
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
- const SHARPISO_BOOL_GRID & covered_grid,
+ const GCUBE_FLAG_GRID & covered_grid,
  const SCALAR_TYPE isovalue,
- const std::vector<NUM_TYPE> gcube_index_list,
+ const std::vector<NUM_TYPE> & gcube_index_list,
  const SHARP_ISOVERT_PARAM & isovert_param,
- ISOVERT & isovert)
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer)
 {
   const SIGNED_COORD_TYPE grad_selection_cube_offset =
     isovert_param.grad_selection_cube_offset;
@@ -647,7 +715,7 @@ void SHREC::recompute_covered_point_positions
 
       recompute_covered_point_positions
         (scalar_grid, gradient_grid, covered_grid, isovalue, 
-         gcube_index_list, isovert_param, voxel, false, isovert);
+         gcube_index_list, isovert_param, voxel, false, isovert, buffer);
     }
   }
 
@@ -657,7 +725,7 @@ void SHREC::recompute_covered_point_positions
 
     recompute_covered_point_positions
       (scalar_grid, gradient_grid, covered_grid, isovalue, 
-       gcube_index_list, isovert_param, voxel, true, isovert);
+       gcube_index_list, isovert_param, voxel, true, isovert, buffer);
   }
 }
 
@@ -669,12 +737,13 @@ void SHREC::recompute_covered_point_positions
 void recompute_unselected_uncovered_lindstrom
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
- const SHARPISO_BOOL_GRID & covered_grid,
+ const GCUBE_FLAG_GRID & covered_grid,
  const SCALAR_TYPE isovalue,
  const SHARP_ISOVERT_PARAM & isovert_param,
  const OFFSET_VOXEL & voxel,
  const bool flag_min_offset,
- ISOVERT & isovert)
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer)
 {
   for (NUM_TYPE i = 0; i < isovert.gcube_list.size(); i++) {
     GRID_CUBE_FLAG cube_flag = isovert.gcube_list[i].flag;
@@ -689,7 +758,7 @@ void recompute_unselected_uncovered_lindstrom
 
           recompute_isovert_position_lindstrom
             (scalar_grid, gradient_grid, isovalue, isovert_param,
-             voxel, flag_min_offset, i, isovert);
+             voxel, flag_min_offset, i, isovert, buffer);
 
           check_not_contained_and_substitute(scalar_grid, i, isovert);
 
@@ -707,7 +776,7 @@ void recompute_unselected_uncovered_lindstrom
 void recompute_unselected_uncovered_lindstrom
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
- const SHARPISO_BOOL_GRID & covered_grid,
+ const GCUBE_FLAG_GRID & covered_grid,
  const SCALAR_TYPE isovalue,
  const SHARP_ISOVERT_PARAM & isovert_param,
  ISOVERT & isovert)
@@ -715,6 +784,7 @@ void recompute_unselected_uncovered_lindstrom
   const SIGNED_COORD_TYPE grad_selection_cube_offset =
     isovert_param.grad_selection_cube_offset;
   OFFSET_VOXEL voxel;
+  GET_GRADIENTS_BUFFER buffer;
 
   if (grad_selection_cube_offset > 0.5) {
 
@@ -722,7 +792,7 @@ void recompute_unselected_uncovered_lindstrom
 
     recompute_unselected_uncovered_lindstrom
       (scalar_grid, gradient_grid, covered_grid, isovalue, isovert_param, 
-       voxel, false, isovert);
+       voxel, false, isovert, buffer);
   }
 
   voxel.SetVertexCoord
@@ -730,7 +800,7 @@ void recompute_unselected_uncovered_lindstrom
 
   recompute_unselected_uncovered_lindstrom
     (scalar_grid, gradient_grid, covered_grid, isovalue, isovert_param, 
-     voxel, true, isovert);
+     voxel, true, isovert, buffer);
 }
 
 /// Recompute isosurface vertex positions for cubes 
@@ -746,8 +816,10 @@ void SHREC::recompute_isovert_positions
     isovert_param.linf_dist_thresh_merge_sharp;
 
   // covered_grid.Scalar(iv) == true, if iv is covered (or selected).
-  SHARPISO_BOOL_GRID covered_grid;
-  covered_grid.SetSize(scalar_grid);
+  GCUBE_FLAG_BITS covered_bits;
+  GCUBE_FLAG_GRID covered_grid;
+  covered_bits.Init(isovert);
+  covered_grid.SetFlagBits(scalar_grid, covered_bits, 0);
   set_covered_grid(isovert, covered_grid);
 
   if (isovert_param.use_lindstrom) {
@@ -806,10 +878,27 @@ void SHREC::recompute_isovert_positions
  const SHARP_ISOVERT_PARAM & isovert_param,
  ISOVERT & isovert)
 {
-  SHARPISO_EDGE_INDEX_GRID edge_index(DIM3, scalar_grid.AxisSize(), DIM3);
+  SHARPISO_EDGE_INDEX_TABLE edge_index;
 
+  edge_index.SetSize(scalar_grid);
   set_edge_index(edgeI_coord, edge_index);
 
+  recompute_isovert_positions
+    (scalar_grid, edgeI_coord, edge_index, isovalue, isovert_param, isovert);
+}
+
+
+/// Recompute isosurface vertex positions for cubes 
+/// which are not selected or covered.
+/// Version with table of edges containing edgeI_coord[].
+void SHREC::recompute_isovert_positions 
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const std::vector<COORD_TYPE> & edgeI_coord,
+ const SHARPISO_EDGE_INDEX_TABLE & edge_index,
+ const SCALAR_TYPE isovalue,
+ const SHARP_ISOVERT_PARAM & isovert_param,
+ ISOVERT & isovert)
+{
   for (NUM_TYPE i = 0; i < isovert.gcube_list.size(); i++) {
     GRID_CUBE_FLAG cube_flag = isovert.gcube_list[i].flag;
 
@@ -1749,49 +1838,81 @@ void round_down(const COORD_TYPE * coord, GRID_COORD_TYPE min_coord[DIM3])
 	{ min_coord[d] = int(std::floor(coord[d])); }
 }
 
+/// Set sparse table of edges in edgeI_coord[] in one pass.
+/// Intersection i lies on edge (iv0, edge_dir) where iv0 is edgeI_coord[i]
+///   rounded down and edge_dir is the last direction where
+///   edgeI_coord[i] is not rounded down.
+/// If two intersections lie on the same edge, use the last one.
+/// Intersections on grid vertices also set incident edges which are
+///   not otherwise set, using the first such intersection.
 void SHREC::set_edge_index
 (const std::vector<COORD_TYPE> & edgeI_coord,
- SHARPISO_EDGE_INDEX_GRID & edge_index)
+ SHARPISO_EDGE_INDEX_TABLE & edge_index)
 {
+  const NUM_TYPE num_edgeI = edgeI_coord.size()/DIM3;
   GRID_COORD_TYPE min_coord[DIM3];
 
-  edge_index.SetAllCoord(ISOVERT::NO_INDEX);
+  // (iv, edge_dir, i) for edges incident on edgeI_coord[] 
+  //   which are on grid vertices.
+  std::vector<VERTEX_INDEX> vertex_edge;
 
-  for (NUM_TYPE i = 0; i < edgeI_coord.size()/DIM3; i++) {
-    round_down(&(edgeI_coord[i*DIM3]), min_coord);
+  edge_index.Clear();
+  edge_index.Reserve(num_edgeI);
+
+  // SHARPISO_EDGE_INDEX_TABLE keeps the first index added to an edge.
+  // Add intersections in reverse order so that the last one is kept.
+  for (NUM_TYPE i = num_edgeI-1; i >= 0; i--) {
+    const COORD_TYPE * coord = &(edgeI_coord[i*DIM3]);
+    round_down(coord, min_coord);
 
     int edge_dir = 0;
     for (int d = 1; d < DIM3; d++) {
-      if (edgeI_coord[i*DIM3+d] != min_coord[d]) { edge_dir = d; }
+      if (coord[d] != min_coord[d]) { edge_dir = d; }
     }
 
-    VERTEX_INDEX iv0 = edge_index.ComputeVertexIndex(min_coord);
-
-    edge_index.Set(iv0, edge_dir, i);
-  }
-
-  // Set edge index from edgeI_coord[] which are on grid vertices.
-  for (NUM_TYPE i = 0; i < edgeI_coord.size()/DIM3; i++) {
-    round_down(&(edgeI_coord[i*DIM3]), min_coord);
-
-    if (is_coord_equal_3D(&(edgeI_coord[i*DIM3]), min_coord)) {
+    const VERTEX_INDEX iv0 = edge_index.ComputeVertexIndex(min_coord);
+    edge_index.Add(iv0, edge_dir, i);
 
-      VERTEX_INDEX iv0 = edge_index.ComputeVertexIndex(min_coord);
+    if (is_coord_equal_3D(coord, min_coord)) {
       for (int edge_dir = 0; edge_dir < DIM3; edge_dir++) {
-        if (edge_index.Vector(iv0, edge_dir) == ISOVERT::NO_INDEX)
-          { edge_index.Set(iv0, edge_dir, i); }
+        vertex_edge.push_back(iv0);
+        vertex_edge.push_back(edge_dir);
+        vertex_edge.push_back(i);
 
         if (min_coord[edge_dir] > 0) {
-          VERTEX_INDEX iv1 = edge_index.PrevVertex(iv0, edge_dir);
-          if (edge_index.Vector(iv1, edge_dir) == ISOVERT::NO_INDEX)
-            { edge_index.Set(iv1, edge_dir, i); }
+          vertex_edge.push_back(edge_index.PrevVertex(iv0, edge_dir));
+          vertex_edge.push_back(edge_dir);
+          vertex_edge.push_back(i);
         }
       }
     }
+  }
 
-
+  // Set edges incident on edgeI_coord[] which are on grid vertices,
+  //   after all other edges and in increasing order of i.
+  for (NUM_TYPE k = NUM_TYPE(vertex_edge.size())-3; k >= 0; k -= 3) {
+    edge_index.Add(vertex_edge[k], vertex_edge[k+1], vertex_edge[k+2]);
   }
 
+  edge_index.Sort();
+}
+
+/// Set table of edges containing edgeI_coord[].
+/// Use edgeI_edge_key[] if it lists the edge of each intersection.
+/// Otherwise, compute the edges from edgeI_coord[].
+void SHREC::set_edge_index
+(const std::vector<COORD_TYPE> & edgeI_coord,
+ const std::vector<EDGE_KEY_TYPE> & edgeI_edge_key,
+ SHARPISO_EDGE_INDEX_TABLE & edge_index)
+{
+  const NUM_TYPE num_edgeI = edgeI_coord.size()/DIM3;
+
+  if (num_edgeI > 0 && edgeI_edge_key.size() == size_t(num_edgeI)) {
+    edge_index.SetKeys(&(edgeI_edge_key.front()), num_edgeI);
+  }
+  else {
+    set_edge_index(edgeI_coord, edge_index);
+  }
 }
 
 // Compute isosurface vertex positions using hermite data.
@@ -1799,17 +1920,15 @@ void compute_all_isovert_positions
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const std::vector<COORD_TYPE> & edgeI_coord,
  const std::vector<COORD_TYPE> & edgeI_normal_coord,
+ const SHARPISO_EDGE_INDEX_TABLE & edge_index,
  const SCALAR_TYPE isovalue,
  const SHARP_ISOVERT_PARAM & isovert_param,
  ISOVERT & isovert)
 {
   const SIGNED_COORD_TYPE grad_selection_cube_offset =
     isovert_param.grad_selection_cube_offset;
-  SHARPISO_EDGE_INDEX_GRID edge_index(DIM3, scalar_grid.AxisSize(), DIM3);
   SVD_INFO svd_info;
 
-  set_edge_index(edgeI_coord, edge_index);
-
   IJK_FOR_EACH_GRID_CUBE(iv, scalar_grid, VERTEX_INDEX) {
     NUM_TYPE index = isovert.GCubeIndex(iv);
     if (index!=ISOVERT::NO_INDEX) {
@@ -2226,8 +2345,17 @@ void SHREC::get_corner_or_edge_cubes
 (const std::vector<GRID_CUBE_DATA> & gcube_list,
  std::vector<NUM_TYPE> & gcube_index_list)
 {
-  GCUBE_COMPARE gcube_compare(gcube_list);
+  std::vector<GCUBE_SORT_KEY> sort_key;
 
+  get_corner_or_edge_cubes(gcube_list, gcube_index_list, sort_key);
+}
+
+/// Get corner or edge cubes.  Store sort keys.
+void SHREC::get_corner_or_edge_cubes
+(const std::vector<GRID_CUBE_DATA> & gcube_list,
+ std::vector<NUM_TYPE> & gcube_index_list,
+ std::vector<GCUBE_SORT_KEY> & sort_key)
+{
   for (int i=0;i<gcube_list.size();i++)
     {
       // *** SHOULD CHECK THAT POINT IS NOT COMPUTED USING CENTROID ***
@@ -2235,7 +2363,7 @@ void SHREC::get_corner_or_edge_cubes
         { gcube_index_list.push_back(i); }
     }
 
-  sort(gcube_index_list.begin(), gcube_index_list.end(), gcube_compare);
+  sort_gcube_index_list(gcube_list, gcube_index_list, sort_key);
 }
 
 /// Get selected cubes.
@@ -2248,15 +2376,13 @@ void SHREC::get_selected_cubes
 (const std::vector<GRID_CUBE_DATA> & gcube_list,
  std::vector<NUM_TYPE> & gcube_index_list)
 {
-  GCUBE_COMPARE gcube_compare(gcube_list);
-
   for (int i=0;i<gcube_list.size();i++)
     {
       if (gcube_list[i].flag == SELECTED_GCUBE)
         { gcube_index_list.push_back(i); }
     }
 
-  sort(gcube_index_list.begin(), gcube_index_list.end(), gcube_compare);
+  sort_gcube_index_list(gcube_list, gcube_index_list);
 }
 
 /// Get selected corner cubes.
@@ -2268,8 +2394,6 @@ void SHREC::get_selected_corner_cubes
 (const std::vector<GRID_CUBE_DATA> & gcube_list,
  std::vector<NUM_TYPE> & gcube_index_list)
 {
-  GCUBE_COMPARE gcube_compare(gcube_list);
-
   for (int i=0;i<gcube_list.size();i++) {
     if (gcube_list[i].flag == SELECTED_GCUBE) {
       if (gcube_list[i].num_eigenvalues == 3) 
@@ -2277,7 +2401,108 @@ void SHREC::get_selected_corner_cubes
     }
   }
 
-  sort(gcube_index_list.begin(), gcube_index_list.end(), gcube_compare);
+  sort_gcube_index_list(gcube_list, gcube_index_list);
+}
+
+namespace {
+
+  /// Same comparison as GCUBE_COMPARE.
+  inline bool gcube_sort_key_less
+  (const GCUBE_SORT_KEY & a, const GCUBE_SORT_KEY & b)
+  {
+    if (a.num_eigenvalues == b.num_eigenvalues)
+      { return(a.dist < b.dist); }
+    else
+      { return(a.num_eigenvalues > b.num_eigenvalues); }
+  }
+
+  /// Return true if each key is strictly less than the next key.
+  bool are_gcube_sort_keys_distinct
+  (const std::vector<GCUBE_SORT_KEY> & sort_key)
+  {
+    for (size_t i = 1; i < sort_key.size(); i++) {
+      if (!gcube_sort_key_less(sort_key[i-1], sort_key[i]))
+        { return(false); }
+    }
+
+    return(true);
+  }
+
+}
+
+// Sort gcube_index_list in the order given by GCUBE_COMPARE.
+void SHREC::sort_gcube_index_list
+(const std::vector<GRID_CUBE_DATA> & gcube_list,
+ std::vector<NUM_TYPE> & gcube_index_list)
+{
+  std::vector<GCUBE_SORT_KEY> sort_key;
+
+  sort_gcube_index_list(gcube_list, gcube_index_list, sort_key);
+}
+
+// Sort gcube_index_list in the order given by GCUBE_COMPARE.
+// Comparisons have the same outcomes as with GCUBE_COMPARE,
+//   so std::sort produces the same permutation.
+void SHREC::sort_gcube_index_list
+(const std::vector<GRID_CUBE_DATA> & gcube_list,
+ std::vector<NUM_TYPE> & gcube_index_list,
+ std::vector<GCUBE_SORT_KEY> & sort_key)
+{
+  sort_key.resize(gcube_index_list.size());
+
+  for (size_t i = 0; i < gcube_index_list.size(); i++)
+    { sort_key[i].Set(gcube_list, gcube_index_list[i]); }
+
+  sort(sort_key.begin(), sort_key.end(), gcube_sort_key_less);
+
+  for (size_t i = 0; i < gcube_index_list.size(); i++)
+    { gcube_index_list[i] = sort_key[i].gcube_index; }
+}
+
+// Resort gcube_index_list after some cubes changed their sort keys.
+void SHREC::resort_gcube_index_list
+(const std::vector<GRID_CUBE_DATA> & gcube_list,
+ std::vector<NUM_TYPE> & gcube_index_list,
+ std::vector<GCUBE_SORT_KEY> & sort_key)
+{
+  const size_t list_length = gcube_index_list.size();
+  std::vector<GCUBE_SORT_KEY> unchanged_key, changed_key;
+  GCUBE_SORT_KEY key;
+
+  if (sort_key.size() != list_length) {
+    sort_gcube_index_list(gcube_list, gcube_index_list, sort_key);
+    return;
+  }
+
+  unchanged_key.reserve(list_length);
+  for (size_t i = 0; i < list_length; i++) {
+
+    if (sort_key[i].gcube_index != gcube_index_list[i]) {
+      // List changed since last sort.
+      sort_gcube_index_list(gcube_list, gcube_index_list, sort_key);
+      return;
+    }
+
+    key.Set(gcube_list, gcube_index_list[i]);
+    if (key.IsKeyEqual(sort_key[i]))
+      { unchanged_key.push_back(key); }
+    else
+      { changed_key.push_back(key); }
+  }
+
+  sort(changed_key.begin(), changed_key.end(), gcube_sort_key_less);
+  merge(unchanged_key.begin(), unchanged_key.end(),
+        changed_key.begin(), changed_key.end(),
+        sort_key.begin(), gcube_sort_key_less);
+
+  if (!are_gcube_sort_keys_distinct(sort_key)) {
+    // Order of equal keys depends on the input order to std::sort.
+    sort_gcube_index_list(gcube_list, gcube_index_list, sort_key);
+    return;
+  }
+
+  for (size_t i = 0; i < list_length; i++)
+    { gcube_index_list[i] = sort_key[i].gcube_index; }
 }
 
 void SHREC::store_boundary_bits
@@ -2386,6 +2611,8 @@ bool SHREC::does_sharp_edge_point_to_cube_linf
      grid.SpacingPtrConst(), closest_point);
 
   grid.ComputeCubeCenterCoord(cube1_index, cube1_center_coord);
+  for (int d = 0; d < DIM3; d++)
+    { cube1_center_coord[d] += grid.CoordOffset(d); }
 
   compute_rescaled_Linf_distance
     (cube1_center_coord, closest_point, grid.SpacingPtrConst(), linf_distance);
@@ -2568,6 +2795,8 @@ void create_active_cubes
 {
   NUM_TYPE index = 0;
 
+  isovert.use_sparse_index = false;
+
   // Set the size and spacing of index_grid and grid.
   isovert.index_grid.SetSize(scalar_grid);
   isovert.grid.SetSize(scalar_grid);
@@ -2590,6 +2819,49 @@ void create_active_cubes
 	}
 }
 
+/// Set the index_grid, grid and gcube_list.
+/// Use minmax_pyramid to visit only regions containing active cubes.
+/// If use_sparse_index is true, set isovert.sparse_index
+///   and do not allocate isovert.index_grid.
+/// Creates the same gcube_list as create_active_cubes(scalar_grid,...).
+void create_active_cubes
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
+ const SCALAR_TYPE isovalue,
+ const bool use_sparse_index,
+ ISOVERT &isovert)
+{
+  std::vector<VERTEX_INDEX> cube_list;
+
+  minmax_pyramid.GetActiveCubes(scalar_grid, isovalue, cube_list);
+
+  // Set the size and spacing of grid.
+  isovert.grid.SetSize(scalar_grid);
+  isovert.grid.SetSpacing(scalar_grid.SpacingPtrConst());
+
+  isovert.use_sparse_index = use_sparse_index;
+  if (use_sparse_index) {
+    // Only store indices of active cubes.
+    isovert.sparse_index.Clear();
+    isovert.sparse_index.Reserve(isovert.gcube_list.size()+cube_list.size());
+  }
+  else {
+    isovert.index_grid.SetSize(scalar_grid);
+    isovert.index_grid.SetSpacing(scalar_grid.SpacingPtrConst());
+    isovert.index_grid.SetAll(ISOVERT::NO_INDEX);
+  }
+
+  isovert.gcube_list.reserve(isovert.gcube_list.size()+cube_list.size());
+  for (size_t i = 0; i < cube_list.size(); i++) {
+    const VERTEX_INDEX icube = cube_list[i];
+    isovert.SetGCubeIndex(icube, isovert.gcube_list.size());
+    GRID_CUBE_DATA gc;
+    gc.cube_index = icube;
+    scalar_grid.ComputeCoord(icube, gc.cube_coord);
+    isovert.gcube_list.push_back(gc);
+  }
+}
+
 /// process edge called from are connected
 void process_edge
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
@@ -2606,6 +2878,7 @@ void process_edge
  */
 void SHREC::compute_dual_isovert
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
  const GRADIENT_GRID_BASE & gradient_grid,
  const SCALAR_TYPE isovalue,
  const SHARP_ISOVERT_PARAM & isovert_param,
@@ -2620,7 +2893,9 @@ void SHREC::compute_dual_isovert
       (scalar_grid, "gradient grid", "scalar grid", error))
 	{ throw error; }
 
-  create_active_cubes(scalar_grid, isovalue, isovert);
+  create_active_cubes
+    (scalar_grid, minmax_pyramid, isovalue, 
+     isovert_param.use_sparse_isovert_index, isovert);
 
   MSDEBUG();
   flag_debug = false;
@@ -2652,16 +2927,39 @@ void SHREC::compute_dual_isovert
 
 void SHREC::compute_dual_isovert
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
+ const std::vector<COORD_TYPE> & edgeI_coord,
+ const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+ const SCALAR_TYPE isovalue,
+ const SHARP_ISOVERT_PARAM & isovert_param,
+ ISOVERT &isovert)
+{
+  SHARPISO_EDGE_INDEX_TABLE edge_index;
+
+  edge_index.SetSize(scalar_grid);
+  set_edge_index(edgeI_coord, edge_index);
+
+  compute_dual_isovert
+    (scalar_grid, minmax_pyramid, edgeI_coord, edgeI_normal_coord,
+     edge_index, isovalue, isovert_param, isovert);
+}
+
+void SHREC::compute_dual_isovert
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
  const std::vector<COORD_TYPE> & edgeI_coord,
  const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+ const SHARPISO_EDGE_INDEX_TABLE & edge_index,
  const SCALAR_TYPE isovalue,
  const SHARP_ISOVERT_PARAM & isovert_param,
  ISOVERT &isovert)
 {
-  create_active_cubes(scalar_grid, isovalue, isovert);
+  create_active_cubes
+    (scalar_grid, minmax_pyramid, isovalue, 
+     isovert_param.use_sparse_isovert_index, isovert);
 
   compute_all_isovert_positions 
-    (scalar_grid, edgeI_coord, edgeI_normal_coord,
+    (scalar_grid, edgeI_coord, edgeI_normal_coord, edge_index,
      isovalue, isovert_param, isovert);
 }
 
@@ -3075,6 +3373,97 @@ bool GRID_CUBE_DATA::IsCoveredOrSelected() const
     { return false; }
 }
 
+// **************************************************
+// SPARSE_GCUBE_INDEX member functions
+// **************************************************
+
+void SPARSE_GCUBE_INDEX::Clear()
+{
+  for (size_t k = 0; k < table.size(); k++)
+    { table[k].gcube_index = NO_INDEX; }
+  num_entries = 0;
+}
+
+void SPARSE_GCUBE_INDEX::Rehash(const int nbits)
+{
+  std::vector<ENTRY> old_table;
+
+  old_table.swap(table);
+  num_bits = nbits;
+  num_entries = 0;
+  table.resize(NUM_TYPE(1) << nbits);
+  Clear();
+
+  for (size_t k = 0; k < old_table.size(); k++) {
+    if (old_table[k].gcube_index != NO_INDEX)
+      { Insert(old_table[k].cube_index, old_table[k].gcube_index); }
+  }
+}
+
+void SPARSE_GCUBE_INDEX::Reserve(const NUM_TYPE n)
+{
+  // Keep load factor at most 1/2.
+  int nbits = 4;
+  while ((NUM_TYPE(1) << nbits) < 2*n) { nbits++; }
+
+  if (nbits > num_bits) { Rehash(nbits); }
+}
+
+void SPARSE_GCUBE_INDEX::Insert
+(const VERTEX_INDEX cube_index, const INDEX_DIFF_TYPE gcube_index)
+{
+  if (2*(num_entries+1) > NUM_TYPE(table.size())) 
+    { Reserve(num_entries+1); }
+
+  const NUM_TYPE mask = NUM_TYPE(table.size())-1;
+  NUM_TYPE k = Hash(cube_index);
+  while (table[k].gcube_index != NO_INDEX) {
+    if (table[k].cube_index == cube_index) {
+      table[k].gcube_index = gcube_index;
+      return;
+    }
+    k = ((k+1) & mask);
+  }
+
+  table[k].cube_index = cube_index;
+  table[k].gcube_index = gcube_index;
+  num_entries++;
+}
+
+
+// **************************************************
+// GCUBE_FLAG_BITS member functions
+// **************************************************
+
+void GCUBE_FLAG_BITS::Init(const ISOVERT & isovert)
+{
+  this->isovert = &isovert;
+  gcube_bits.assign(isovert.gcube_list.size(), 0);
+  other_index.Clear();
+  other_bits.clear();
+}
+
+void GCUBE_FLAG_BITS::SetOtherBits
+(const VERTEX_INDEX cube_index, const FLAG_BITS_TYPE mask)
+{
+  const INDEX_DIFF_TYPE k = other_index.Find(cube_index);
+  if (k != SPARSE_GCUBE_INDEX::NO_INDEX) 
+    { other_bits[k] |= mask; }
+  else {
+    other_index.Insert(cube_index, other_bits.size());
+    other_bits.push_back(mask);
+  }
+}
+
+void GCUBE_FLAG_BITS::ClearAllBits(const FLAG_BITS_TYPE mask)
+{
+  for (size_t i = 0; i < gcube_bits.size(); i++)
+    { gcube_bits[i] &= FLAG_BITS_TYPE(~mask); }
+  for (size_t k = 0; k < other_bits.size(); k++)
+    { other_bits[k] &= FLAG_BITS_TYPE(~mask); }
+}
+
+
 // **************************************************
 // ISOVERT member functions
 // **************************************************
@@ -3082,7 +3471,7 @@ bool GRID_CUBE_DATA::IsCoveredOrSelected() const
 bool ISOVERT::isFlag(const int cube_index,  GRID_CUBE_FLAG _flag) const
 {
   if (isActive(cube_index)){
-    if (gcube_list[index_grid.Scalar(cube_index)].flag == _flag)
+    if (gcube_list[GCubeIndex(cube_index)].flag == _flag)
       return true;
     else
       return false;
@@ -3093,7 +3482,7 @@ bool ISOVERT::isFlag(const int cube_index,  GRID_CUBE_FLAG _flag) const
 
 bool ISOVERT::isActive(const int cube_index) const
 {
-  if (index_grid.Scalar(cube_index) != NO_INDEX)
+  if (GCubeIndex(cube_index) != NO_INDEX)
     return true;
   else
     return false;
@@ -3228,7 +3617,7 @@ void SHREC::bin_grid_insert
 (const SHARPISO_GRID & grid, const AXIS_SIZE_TYPE bin_width,
  const VERTEX_INDEX cube_index, BIN_GRID<int> & bin_grid)
 {
-  static GRID_COORD_TYPE coord[DIM3];
+  GRID_COORD_TYPE coord[DIM3];
 
   grid.ComputeCoord(cube_index, coord);
   divide_coord_3D(bin_width, coord);
@@ -3240,7 +3629,7 @@ void SHREC::bin_grid_remove
 (const SHARPISO_GRID & grid, const AXIS_SIZE_TYPE bin_width,
  const VERTEX_INDEX cube_index, BIN_GRID<int> & bin_grid)
 {
-  static GRID_COORD_TYPE coord[DIM3];
+  GRID_COORD_TYPE coord[DIM3];
 
   grid.ComputeCoord(cube_index, coord);
   divide_coord_3D(bin_width, coord);
@@ -3257,9 +3646,9 @@ void SHREC::get_selected
  std::vector<VERTEX_INDEX> & selected_list)
 {
   const int dimension = grid.Dimension();
-  static GRID_COORD_TYPE coord[DIM3];
-  static GRID_COORD_TYPE min_coord[DIM3];
-  static GRID_COORD_TYPE max_coord[DIM3];
+  GRID_COORD_TYPE coord[DIM3];
+  GRID_COORD_TYPE min_coord[DIM3];
+  GRID_COORD_TYPE max_coord[DIM3];
 
   long boundary_bits;
 
@@ -3525,9 +3914,9 @@ namespace {
     VERTEX_INDEX gcube_list_index_v2;
     VERTEX_INDEX gcube_list_index_v3;
 
-    gcube_list_index_v1=isovert.index_grid.Scalar(v1);
-    gcube_list_index_v2=isovert.index_grid.Scalar(v2);
-    gcube_list_index_v3=isovert.index_grid.Scalar(iv);
+    gcube_list_index_v1=isovert.GCubeIndex(v1);
+    gcube_list_index_v2=isovert.GCubeIndex(v2);
+    gcube_list_index_v3=isovert.GCubeIndex(iv);
 
 
     compute_cos_angle(isovert, gcube_list_index_v1,
@@ -3557,7 +3946,7 @@ namespace {
     for (NUM_TYPE j = 0; j < grid.NumCubeNeighborsF(); j++) {
       VERTEX_INDEX icube = grid.CubeNeighborF(cube_index0, j);
 
-      VERTEX_INDEX index_gcube = isovert.index_grid.Scalar(icube);
+      VERTEX_INDEX index_gcube = isovert.GCubeIndex(icube);
 
       if (index_gcube != ISOVERT::NO_INDEX) {
         if (isovert.gcube_list[index_gcube].covered_by != icube) {
@@ -3583,7 +3972,7 @@ namespace {
     for (NUM_TYPE j = 0; j < grid.NumCubeNeighborsF(); j++) {
       VERTEX_INDEX icube = grid.CubeNeighborF(cube_index0, j);
 
-      VERTEX_INDEX index_gcube = isovert.index_grid.Scalar(icube);
+      VERTEX_INDEX index_gcube = isovert.GCubeIndex(icube);
 
       if (index_gcube != ISOVERT::NO_INDEX) {
         VERTEX_INDEX covered_by = isovert.gcube_list[index_gcube].covered_by;
@@ -3598,7 +3987,7 @@ namespace {
     for (NUM_TYPE j = 0; j < grid.NumCubeNeighborsE(); j++) {
       VERTEX_INDEX icube = grid.CubeNeighborE(cube_index0, j);
 
-      VERTEX_INDEX index_gcube = isovert.index_grid.Scalar(icube);
+      VERTEX_INDEX index_gcube = isovert.GCubeIndex(icube);
 
       if (index_gcube != ISOVERT::NO_INDEX) {
         VERTEX_INDEX covered_by = isovert.gcube_list[index_gcube].covered_by;
@@ -3623,7 +4012,7 @@ namespace {
     for (NUM_TYPE j = 0; j < grid.NumVertexNeighborsC(); j++) {
       VERTEX_INDEX icube = grid.VertexNeighborC(cube_index0, j);
 
-      VERTEX_INDEX index_gcube = isovert.index_grid.Scalar(icube);
+      VERTEX_INDEX index_gcube = isovert.GCubeIndex(icube);
 
       if (index_gcube != ISOVERT::NO_INDEX) {
         VERTEX_INDEX covered_by = isovert.gcube_list[index_gcube].covered_by;
@@ -3644,7 +4033,7 @@ namespace {
   {
     VERTEX_INDEX gcube_index;
 
-    gcube_index = isovert.index_grid.Scalar(cube_index0);
+    gcube_index = isovert.GCubeIndex(cube_index0);
     if (gcube_index != ISOVERT::NO_INDEX) {
       VERTEX_INDEX covered_by = isovert.gcube_list[gcube_index].covered_by;
       if (covered_by == cube_index1) { return(true); }
@@ -3655,7 +4044,7 @@ namespace {
       for (NUM_TYPE j = 0; j < grid.NumVertexNeighborsC(); j++) {
         VERTEX_INDEX icube = grid.VertexNeighborC(cube_index0, j);
 
-        gcube_index = isovert.index_grid.Scalar(icube);
+        gcube_index = isovert.GCubeIndex(icube);
 
         if (gcube_index != ISOVERT::NO_INDEX) {
           VERTEX_INDEX covered_by = isovert.gcube_list[gcube_index].covered_by;
@@ -3894,7 +4283,7 @@ namespace {
   ///   replace with substitute coord isovert_coordB.
   void check_covered_and_substitute
   (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
-   const SHARPISO_BOOL_GRID & covered_grid,
+   const GCUBE_FLAG_GRID & covered_grid,
    const SCALAR_TYPE isovalue,
    const NUM_TYPE gcube_index,
    ISOVERT & isovert)
@@ -3911,7 +4300,7 @@ namespace {
   // *** MOVED TO shrec_select
   /// Return true if sharp vertex is in a cube which is covered.
   bool check_covered_point
-  (const SHARPISO_BOOL_GRID & covered_grid,
+  (const GCUBE_FLAG_GRID & covered_grid,
    const ISOVERT & isovert,
    const VERTEX_INDEX & gcube0_index)
   {
@@ -3936,7 +4325,7 @@ namespace {
 
   /// If sharp vertex is in covered cube, set cube to COVERED_POINT.
   void check_and_set_covered_point
-  (const SHARPISO_BOOL_GRID & covered_grid,
+  (const GCUBE_FLAG_GRID & covered_grid,
    ISOVERT & isovert,
    const VERTEX_INDEX & gcube_index)
   {
@@ -3955,7 +4344,7 @@ namespace {
   }
 
   void set_covered_grid
-  (const ISOVERT & isovert, SHARPISO_BOOL_GRID & covered_grid)
+  (const ISOVERT & isovert, GCUBE_FLAG_GRID & covered_grid)
   {
     SHARPISO_GRID_NEIGHBORS grid;
     BOUNDARY_BITS_TYPE mask[2*DIM3];
@@ -3965,7 +4354,7 @@ namespace {
     for (int i = 0; i < 2*DIM3; i++) 
       { mask[i] = (BOUNDARY_BITS_TYPE(1) << i); }
 
-    covered_grid.SetAll(false);
+    covered_grid.ClearAll();
     for (NUM_TYPE i = 0; i < isovert.gcube_list.size(); i++) {
 
       const VERTEX_INDEX cube_index = isovert.CubeIndex(i);
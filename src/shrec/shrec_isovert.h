@@ -66,74 +66,81 @@ protected:
   void Init();
 
 public:
-  GRID_COORD_TYPE cube_coord[DIM3];  ///< Cube coordinates (unscaled).
-  COORD_TYPE isovert_coord[DIM3];    ///< Location of the sharp isovertex.
-  COORD_TYPE isovert_coordB[DIM3];   ///< Substitute location.
-  unsigned char num_eigenvalues;     ///< Number of eigenvalues.
-  GRID_CUBE_FLAG flag;               ///< Type for this cube.
-  BOUNDARY_BITS_TYPE boundary_bits;  ///< Boundary bits for the cube
-  VERTEX_INDEX cube_index;           ///< Index of cube in scalar grid.
 
-  /// Type of cube cover.
-  CUBE_ADJACENCY_TYPE cover_type;
+  // Fields read by selection and by GCUBE_COMPARE are stored first
+  //   so that they share a cache line.
 
-  /// If num_eigenvalues == 2, then direction = direction of isosurface edge.
-  /// If num_eigenvalues == 1, then 
-  ///   direction = direction orthogonal to isosurface.
-  COORD_TYPE direction[DIM3];         
-
-  /// Linf-dist from isovert_coord[] to cube-center.
-  COORD_TYPE linf_dist;
-
-  /// L1-dist from isovert_coord[] to cube.
-  COORD_TYPE L1_dist_to_cube;
+  VERTEX_INDEX cube_index;           ///< Index of cube in scalar grid.
+  GRID_CUBE_FLAG flag;               ///< Type for this cube.
+  unsigned char num_eigenvalues;     ///< Number of eigenvalues.
 
   /// If true, location is centroid of (grid edge)-isosurface intersections.
-  bool flag_centroid_location;
+  bool flag_centroid_location:1;
 
   /// If true, some other non-empty cube contains the isovert coord.
-  bool flag_conflict;
+  bool flag_conflict:1;
 
   /// If true, cube is near corner cube.
-  bool flag_near_corner;
-
-  /// Grid index of cube containing the isovert_coord.
-  VERTEX_INDEX cube_containing_isovert;
+  bool flag_near_corner:1;
 
   /// If true, isovert_coord[] determined by an adjacent cube.
-  bool flag_coord_from_other_cube;
+  bool flag_coord_from_other_cube:1;
 
   /// If true, isovert_coord[] determined by a grid vertex.
-  bool flag_coord_from_vertex;
+  bool flag_coord_from_vertex:1;
 
   /// If true, isovert_coord[] determined by a grid edge.
-  bool flag_coord_from_edge;
+  bool flag_coord_from_edge:1;
 
   /// If true, using replacement coordinate.
-  bool flag_using_substitute_coord;
+  bool flag_using_substitute_coord:1;
 
   /// If true, coordinates have been recomputed.
-  bool flag_recomputed_coord;
+  bool flag_recomputed_coord:1;
 
   /// If true, coordinates have been recomputed
   ///   with min gradient cube offset.
-  bool flag_recomputed_coord_min_offset;
+  bool flag_recomputed_coord_min_offset:1;
 
   /// If true, location is recomputed from location of adjacent vertices.
-  bool flag_recomputed_using_adjacent;
+  bool flag_recomputed_using_adjacent:1;
 
   /// If true, svd coord were farther than max_dist.
-  bool flag_far;
+  bool flag_far:1;
 
   /// If true, cube is selected despite mismatch.
-  bool flag_ignore_mismatch;
+  bool flag_ignore_mismatch:1;
 
-  /// Index of cube configuration is isosurface lookup table.
-  IJKDUALTABLE::TABLE_INDEX table_index;
+  BOUNDARY_BITS_TYPE boundary_bits;  ///< Boundary bits for the cube
+
+  /// Linf-dist from isovert_coord[] to cube-center.
+  COORD_TYPE linf_dist;
+
+  /// L1-dist from isovert_coord[] to cube.
+  COORD_TYPE L1_dist_to_cube;
 
   /// Grid index of cube which covered this cube.
   VERTEX_INDEX covered_by;
 
+  /// Grid index of cube containing the isovert_coord.
+  VERTEX_INDEX cube_containing_isovert;
+
+  COORD_TYPE isovert_coord[DIM3];    ///< Location of the sharp isovertex.
+  GRID_COORD_TYPE cube_coord[DIM3];  ///< Cube coordinates (unscaled).
+
+  /// Type of cube cover.
+  CUBE_ADJACENCY_TYPE cover_type;
+
+  /// Index of cube configuration is isosurface lookup table.
+  IJKDUALTABLE::TABLE_INDEX table_index;
+
+  COORD_TYPE isovert_coordB[DIM3];   ///< Substitute location.
+
+  /// If num_eigenvalues == 2, then direction = direction of isosurface edge.
+  /// If num_eigenvalues == 1, then 
+  ///   direction = direction orthogonal to isosurface.
+  COORD_TYPE direction[DIM3];         
+
   /// Grid index of cube which this cube maps to.
   /// Currently, only used for output information.
   VERTEX_INDEX maps_to_cube;
@@ -161,15 +168,15 @@ public:
 
   bool operator () (int i,int j)
   {
-    int num_eigen_i = gcube_list->at(i).num_eigenvalues;
-    int num_eigen_j = gcube_list->at(j).num_eigenvalues;
+    int num_eigen_i = (*gcube_list)[i].num_eigenvalues;
+    int num_eigen_j = (*gcube_list)[j].num_eigenvalues;
 
     if (num_eigen_i == num_eigen_j) {
 
       COORD_TYPE d_i = 
-        gcube_list->at(i).linf_dist + gcube_list->at(i).L1_dist_to_cube;
+        (*gcube_list)[i].linf_dist + (*gcube_list)[i].L1_dist_to_cube;
       COORD_TYPE d_j = 
-        gcube_list->at(j).linf_dist + gcube_list->at(j).L1_dist_to_cube;
+        (*gcube_list)[j].linf_dist + (*gcube_list)[j].L1_dist_to_cube;
 
       return ((d_i < d_j));
     }
@@ -180,6 +187,144 @@ public:
 };
 
 
+/// Sort key of a grid cube.  Same order as GCUBE_COMPARE.
+class GCUBE_SORT_KEY {
+
+public:
+  int num_eigenvalues;
+  COORD_TYPE dist;
+  NUM_TYPE gcube_index;
+
+  /// Set key from gcube_list[gcube_index].
+  void Set(const std::vector<GRID_CUBE_DATA> & gcube_list,
+           const NUM_TYPE gcube_index)
+  {
+    const GRID_CUBE_DATA & gcube = gcube_list[gcube_index];
+    num_eigenvalues = gcube.num_eigenvalues;
+    dist = gcube.linf_dist + gcube.L1_dist_to_cube;
+    this->gcube_index = gcube_index;
+  }
+
+  /// Return true if key has the same number of eigenvalues and distance.
+  bool IsKeyEqual(const GCUBE_SORT_KEY & key) const
+  { return(num_eigenvalues == key.num_eigenvalues && dist == key.dist); }
+};
+
+
+/// Sort gcube_index_list in the order given by GCUBE_COMPARE.
+/// Copies the sort keys of the listed cubes into a contiguous array
+///   before sorting, so comparisons do not access gcube_list.
+void sort_gcube_index_list
+(const std::vector<GRID_CUBE_DATA> & gcube_list,
+ std::vector<NUM_TYPE> & gcube_index_list);
+
+/// Sort gcube_index_list in the order given by GCUBE_COMPARE.
+/// @param[out] sort_key[] Sort keys in sorted order.
+///   sort_key[i].gcube_index = gcube_index_list[i].
+void sort_gcube_index_list
+(const std::vector<GRID_CUBE_DATA> & gcube_list,
+ std::vector<NUM_TYPE> & gcube_index_list,
+ std::vector<GCUBE_SORT_KEY> & sort_key);
+
+/// Resort gcube_index_list after some cubes changed their sort keys.
+/// Cubes whose keys did not change stay in sorted order.
+///   Only cubes whose keys changed are sorted and merged back.
+/// Returns the same list as sort_gcube_index_list():
+///   If all keys are distinct, the sorted order is unique.
+///   If some keys are equal, std::sort could order them differently,
+///   so the whole list is sorted as in sort_gcube_index_list().
+/// @param sort_key[] Sort keys from the last sort.  Updated.
+/// @pre gcube_index_list has not changed since the last sort
+///   which set sort_key[].
+void resort_gcube_index_list
+(const std::vector<GRID_CUBE_DATA> & gcube_list,
+ std::vector<NUM_TYPE> & gcube_index_list,
+ std::vector<GCUBE_SORT_KEY> & sort_key);
+
+
+// **************************************************
+// SPARSE GCUBE INDEX
+// **************************************************
+
+/// Hash table mapping active cube indices to gcube_list indices.
+/// Open addressing with linear probing.
+/// Memory is proportional to the number of active cubes,
+///   not the number of grid cubes.
+class SPARSE_GCUBE_INDEX {
+
+protected:
+
+  /// Hash table entry.
+  typedef struct {
+    VERTEX_INDEX cube_index;
+    INDEX_DIFF_TYPE gcube_index;
+  } ENTRY;
+
+  /// Hash table.  Size is a power of two.
+  std::vector<ENTRY> table;
+
+  /// Number of entries stored in table.
+  NUM_TYPE num_entries;
+
+  /// Number of bits in table index.
+  int num_bits;
+
+  /// Return table location of cube_index.
+  /// Fibonacci hashing on the high bits of cube_index*2654435769.
+  NUM_TYPE Hash(const VERTEX_INDEX cube_index) const
+  {
+    const unsigned int h = (unsigned int)(cube_index) * 2654435769u;
+    return(NUM_TYPE(h >> (32-num_bits)));
+  }
+
+  void Init()
+  { num_entries = 0; num_bits = 0; }
+
+  /// Resize table to 2^nbits locations and reinsert all entries.
+  void Rehash(const int nbits);
+
+public:
+
+  static const INDEX_DIFF_TYPE NO_INDEX = -1;  ///< Flag for no index.
+
+  SPARSE_GCUBE_INDEX() { Init(); }
+
+  /// Remove all entries.  Keep table size.
+  void Clear();
+
+  /// Reserve table locations for at least n entries.
+  void Reserve(const NUM_TYPE n);
+
+  /// Set gcube index of cube_index.
+  /// @pre gcube_index != NO_INDEX.
+  void Insert(const VERTEX_INDEX cube_index, 
+              const INDEX_DIFF_TYPE gcube_index);
+
+  /// Return gcube index of cube_index or NO_INDEX.
+  INDEX_DIFF_TYPE Find(const VERTEX_INDEX cube_index) const
+  {
+    if (num_entries == 0) { return(NO_INDEX); }
+
+    const NUM_TYPE mask = NUM_TYPE(table.size())-1;
+    NUM_TYPE k = Hash(cube_index);
+    while (table[k].gcube_index != NO_INDEX) {
+      if (table[k].cube_index == cube_index) 
+        { return(table[k].gcube_index); }
+      k = ((k+1) & mask);
+    }
+    return(NO_INDEX);
+  }
+
+  /// Return number of entries.
+  NUM_TYPE NumEntries() const
+  { return(num_entries); }
+
+  /// Return number of bytes used by the hash table.
+  long NumBytes() const
+  { return(long(table.capacity())*long(sizeof(ENTRY))); }
+};
+
+
 // **************************************************
 // ISOSURFACE VERTEX DATA
 // **************************************************
@@ -194,11 +339,30 @@ public:
 
 	/// Grid containing the index to the gcube_list.
 	/// If cube is not active, then it is defined as NO_INDEX.
+	/// Not allocated if use_sparse_index is true.
 	SHARPISO_INDEX_GRID index_grid;
 
+  /// Hash table containing the index to the gcube_list.
+  /// Used in place of index_grid if use_sparse_index is true.
+  SPARSE_GCUBE_INDEX sparse_index;
+
+  /// If true, use sparse_index in place of index_grid.
+  bool use_sparse_index;
+
   /// Grid neighbor information.
   SHARPISO_GRID_NEIGHBORS grid;
 
+  /// Constructor.
+  ISOVERT() { use_sparse_index = false; }
+
+  /// Set gcube index of cube_index.
+  void SetGCubeIndex
+  (const VERTEX_INDEX cube_index, const INDEX_DIFF_TYPE gcube_index)
+  {
+    if (use_sparse_index) { sparse_index.Insert(cube_index, gcube_index); }
+    else { index_grid.Set(cube_index, gcube_index); }
+  }
+
   /// Return true if cube is active.
 	bool isActive(const int cube_index) const;
 
@@ -211,7 +375,10 @@ public:
 
   /// Return gcube index or NO_INDEX.
   INDEX_DIFF_TYPE GCubeIndex(const int cube_index) const
-  { return(index_grid.Scalar(cube_index)); }
+  {
+    if (use_sparse_index) { return(sparse_index.Find(cube_index)); }
+    else { return(index_grid.Scalar(cube_index)); }
+  }
 
   /// Return gcube index or NO_INDEX.
   /// Set error message if cube not active (gcube_index = NO_INDEX).
@@ -227,6 +394,137 @@ public:
 };
 
 
+// **************************************************
+// GCUBE FLAG GRID
+// **************************************************
+
+typedef unsigned char FLAG_BITS_TYPE;   ///< Up to 8 flags per cube.
+
+/// Flag bits of grid cubes.
+/// Bits of active cubes are stored by gcube index,
+///   found with isovert.GCubeIndex().
+/// Bits of cubes which are not active (neighbors of active cubes)
+///   are stored in a hash table when first set.
+/// Memory is proportional to the number of cubes with stored bits,
+///   not to the number of grid cubes.
+class GCUBE_FLAG_BITS {
+
+protected:
+  const ISOVERT * isovert;
+
+  /// gcube_bits[gcube_index] = Flag bits of active cube.
+  std::vector<FLAG_BITS_TYPE> gcube_bits;
+
+  /// Location in other_bits[] of the bits of cubes which are not active.
+  SPARSE_GCUBE_INDEX other_index;
+
+  /// Flag bits of cubes which are not active.
+  std::vector<FLAG_BITS_TYPE> other_bits;
+
+  /// copy constructor and assignment: NOT IMPLEMENTED
+  GCUBE_FLAG_BITS(const GCUBE_FLAG_BITS &);
+  const GCUBE_FLAG_BITS & operator =(const GCUBE_FLAG_BITS &);
+
+public:
+  GCUBE_FLAG_BITS() { isovert = NULL; };
+
+  /// Store flag bits for the active cubes in isovert.gcube_list.
+  /// All bits are set to zero.
+  /// @pre isovert.gcube_list and the gcube indices do not change
+  ///   while the flag bits are in use.
+  void Init(const ISOVERT & isovert);
+
+  /// Return flag bits of cube_index.
+  FLAG_BITS_TYPE Bits(const VERTEX_INDEX cube_index) const
+  {
+    const INDEX_DIFF_TYPE gcube_index = isovert->GCubeIndex(cube_index);
+    if (gcube_index != ISOVERT::NO_INDEX)
+      { return(gcube_bits[gcube_index]); }
+
+    const INDEX_DIFF_TYPE k = other_index.Find(cube_index);
+    if (k != SPARSE_GCUBE_INDEX::NO_INDEX)
+      { return(other_bits[k]); }
+
+    return(0);
+  }
+
+  /// Set bits of cube_index which are set in mask.
+  void SetBits(const VERTEX_INDEX cube_index, const FLAG_BITS_TYPE mask)
+  {
+    const INDEX_DIFF_TYPE gcube_index = isovert->GCubeIndex(cube_index);
+    if (gcube_index != ISOVERT::NO_INDEX)
+      { gcube_bits[gcube_index] |= mask; }
+    else
+      { SetOtherBits(cube_index, mask); }
+  }
+
+  /// Clear bits of cube_index which are set in mask.
+  void ClearBits(const VERTEX_INDEX cube_index, const FLAG_BITS_TYPE mask)
+  {
+    const INDEX_DIFF_TYPE gcube_index = isovert->GCubeIndex(cube_index);
+    if (gcube_index != ISOVERT::NO_INDEX)
+      { gcube_bits[gcube_index] &= FLAG_BITS_TYPE(~mask); }
+    else {
+      const INDEX_DIFF_TYPE k = other_index.Find(cube_index);
+      if (k != SPARSE_GCUBE_INDEX::NO_INDEX)
+        { other_bits[k] &= FLAG_BITS_TYPE(~mask); }
+    }
+  }
+
+  /// Set bits of cube_index which is not active.
+  void SetOtherBits(const VERTEX_INDEX cube_index, const FLAG_BITS_TYPE mask);
+
+  /// Clear bits in mask for all cubes.
+  void ClearAllBits(const FLAG_BITS_TYPE mask);
+
+  /// Return number of cubes which are not active and have stored bits.
+  NUM_TYPE NumOtherCubes() const
+  { return(other_bits.size()); }
+};
+
+
+/// Boolean grid stored as one bit of GCUBE_FLAG_BITS.
+/// Up to 8 flag grids share one GCUBE_FLAG_BITS.
+/// Supports Scalar() and Set() like SHARPISO_BOOL_GRID.
+/// Does not allocate or free the flag bits.
+class GCUBE_FLAG_GRID:public SHARPISO_GRID {
+
+protected:
+  GCUBE_FLAG_BITS * flag_bits;
+  FLAG_BITS_TYPE mask;
+
+public:
+  GCUBE_FLAG_GRID() { flag_bits = NULL; mask = 0; };
+
+  /// Store flags in bit ibit of flag_bits.
+  /// @pre 0 <= ibit < 8.
+  template <typename GTYPE>
+  void SetFlagBits
+  (const GTYPE & grid, GCUBE_FLAG_BITS & flag_bits, const int ibit)
+  {
+    this->SetSize(grid);
+    this->SetCoordOffset(grid.CoordOffsetPtrConst());
+    this->flag_bits = &flag_bits;
+    mask = (FLAG_BITS_TYPE(1) << ibit);
+  }
+
+  /// Return flag of cube icube.
+  bool Scalar(const VERTEX_INDEX icube) const
+  { return((flag_bits->Bits(icube) & mask) != 0); }
+
+  /// Set flag of cube icube.
+  void Set(const VERTEX_INDEX icube, const bool flag)
+  {
+    if (flag) { flag_bits->SetBits(icube, mask); }
+    else { flag_bits->ClearBits(icube, mask); }
+  }
+
+  /// Set flags of all cubes to false.
+  void ClearAll()
+  { flag_bits->ClearAllBits(mask); }
+};
+
+
 // **************************************************
 // MERGE PARAMETERS
 // **************************************************
@@ -337,8 +635,11 @@ public:
 // **************************************************
 
 /// Compute dual isosurface vertices.
+/// @param minmax_pyramid Min and max of scalar_grid regions.
+///   Used to skip regions with no active cubes.
 void compute_dual_isovert
   (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
    const GRADIENT_GRID_BASE & gradient_grid,
    const SCALAR_TYPE isovalue,
    const SHARP_ISOVERT_PARAM & isovert_param,
@@ -346,14 +647,29 @@ void compute_dual_isovert
    ISOVERT & isovert);
 
 /// Compute dual isosurface vertices.
+/// @param minmax_pyramid Min and max of scalar_grid regions.
 void compute_dual_isovert
   (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
    const std::vector<COORD_TYPE> & edgeI_coord,
    const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
    const SCALAR_TYPE isovalue,
    const SHARP_ISOVERT_PARAM & isovert_param,
    ISOVERT & isovert);
 
+/// Compute dual isosurface vertices.
+/// Version with table of edges containing edgeI_coord[].
+/// @param edge_index Table of edges containing edgeI_coord[].
+void compute_dual_isovert
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
+   const std::vector<COORD_TYPE> & edgeI_coord,
+   const std::vector<GRADIENT_COORD_TYPE> & edgeI_normal_coord,
+   const SHARPISO_EDGE_INDEX_TABLE & edge_index,
+   const SCALAR_TYPE isovalue,
+   const SHARP_ISOVERT_PARAM & isovert_param,
+   ISOVERT & isovert);
+
 /// Recompute isosurface vertex positions for cubes 
 ///   which are not selected or covered.
 /// also takes isovert_info as parameter
@@ -385,14 +701,27 @@ void recompute_isovert_positions
  const SHARP_ISOVERT_PARAM & isovert_param,
  ISOVERT & isovert);
 
+/// Recompute isosurface vertex positions for cubes 
+///   which are not selected or covered.
+/// Version for hermite data with table of edges containing edgeI_coord[].
+void recompute_isovert_positions
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const std::vector<COORD_TYPE> & edgeI_coord,
+ const SHARPISO_EDGE_INDEX_TABLE & edge_index,
+ const SCALAR_TYPE isovalue,
+ const SHARP_ISOVERT_PARAM & isovert_param,
+ ISOVERT & isovert);
+
 /// Recompute isovert positions for cubes containing covered points.
+/// @param buffer Storage reused for each cube.
 void recompute_covered_point_positions
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
- const SHARPISO_BOOL_GRID & covered_grid,
+ const GCUBE_FLAG_GRID & covered_grid,
  const SCALAR_TYPE isovalue,
  const SHARP_ISOVERT_PARAM & isovert_param,
- ISOVERT & isovert);
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer);
 
 /// Recompute isovert positions for cubes containing covered points.
 /// Version which examines only cubes in gcube_index_list[].
@@ -400,11 +729,12 @@ void recompute_covered_point_positions
 void recompute_covered_point_positions
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
- const SHARPISO_BOOL_GRID & covered_grid,
+ const GCUBE_FLAG_GRID & covered_grid,
  const SCALAR_TYPE isovalue,
- const std::vector<NUM_TYPE> gcube_index_list,
+ const std::vector<NUM_TYPE> & gcube_index_list,
  const SHARP_ISOVERT_PARAM & isovert_param,
- ISOVERT & isovert);
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer);
 
 /// Recompute isovert positions for cubes containing covered points.
 /// Use voxel for gradient cube offset, 
@@ -413,12 +743,13 @@ void recompute_covered_point_positions
 void recompute_covered_point_positions
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
- const SHARPISO_BOOL_GRID & covered_grid,
+ const GCUBE_FLAG_GRID & covered_grid,
  const SCALAR_TYPE isovalue,
  const SHARP_ISOVERT_PARAM & isovert_param,
  const OFFSET_VOXEL & voxel,
  const bool flag_min_offset,
- ISOVERT & isovert);
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer);
 
 /// Recompute isovert positions for cubes containing covered points.
 /// Use voxel for gradient cube offset, 
@@ -429,13 +760,14 @@ void recompute_covered_point_positions
 void recompute_covered_point_positions
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
- const SHARPISO_BOOL_GRID & covered_grid,
+ const GCUBE_FLAG_GRID & covered_grid,
  const SCALAR_TYPE isovalue,
- const std::vector<NUM_TYPE> gcube_index_list,
+ const std::vector<NUM_TYPE> & gcube_index_list,
  const SHARP_ISOVERT_PARAM & isovert_param,
  const OFFSET_VOXEL & voxel,
  const bool flag_min_offset,
- ISOVERT & isovert);
+ ISOVERT & isovert,
+ GET_GRADIENTS_BUFFER & buffer);
 
 /// Recompute using adjacent isosurface vertex locations.
 void recompute_using_adjacent
@@ -451,9 +783,18 @@ void recompute_using_adjacent
 /// Set cover type of all covered cubes.
 void set_cover_type(ISOVERT & isovert);
 
-/// Set grid containing locations of edges in edgeI_coord[].
+/// Set table of locations of edges in edgeI_coord[].
+/// @pre edge_index.SetSize() has been called with the scalar grid.
 void set_edge_index(const std::vector<COORD_TYPE> & edgeI_coord,
-                    SHARPISO_EDGE_INDEX_GRID & edge_index);
+                    SHARPISO_EDGE_INDEX_TABLE & edge_index);
+
+/// Set table of edges containing edgeI_coord[].
+/// Use edgeI_edge_key[] if it has one edge key for each intersection.
+/// Otherwise, compute edges from edgeI_coord[].
+/// @pre edge_index.SetSize() has been called with the scalar grid.
+void set_edge_index(const std::vector<COORD_TYPE> & edgeI_coord,
+                    const std::vector<EDGE_KEY_TYPE> & edgeI_edge_key,
+                    SHARPISO_EDGE_INDEX_TABLE & edge_index);
 
 /// Count number of vertices on sharp corners or sharp edges.
 /// Count number of smooth vertices.
@@ -602,6 +943,13 @@ void get_corner_or_edge_cubes
 (const std::vector<GRID_CUBE_DATA> & gcube_list,
  std::vector<NUM_TYPE> & gcube_index_list);
 
+/// Get corner or edge cubes.  Store sort keys.
+/// @param[out] sort_key[] Sort keys for resort_gcube_index_list().
+void get_corner_or_edge_cubes
+(const std::vector<GRID_CUBE_DATA> & gcube_list,
+ std::vector<NUM_TYPE> & gcube_index_list,
+ std::vector<GCUBE_SORT_KEY> & sort_key);
+
 /// Get selected cubes.
 ///   Store references to cubes sorted by number of large eigenvalues
 ///     and then by increasing distance from isovert_coord to cube center.
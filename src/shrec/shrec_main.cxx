@@ -21,10 +21,20 @@
 */
 
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <unordered_map>
 
 #include "shrec.h"
 #include "shrecIO.h"
+#include "shrec_slab.h"
+
+#include "sharpiso_intersect.h"
 
 #include "ijkmesh.txx"
 #include "ijkmesh_cpp11.txx"
@@ -40,6 +50,10 @@ void memory_exhaustion();
 void construct_isosurface
 (const INPUT_INFO & input_info, const SHREC_DATA & shrec_data,
  SHREC_TIME & shrec_time, IO_TIME & io_time);
+void construct_isosurface_in_core
+(INPUT_INFO & input_info, SHREC_TIME & shrec_time, IO_TIME & io_time);
+void construct_isosurface_by_slabs
+(INPUT_INFO & input_info, SHREC_TIME & shrec_time, IO_TIME & io_time);
 
 
 // **************************************************
@@ -48,196 +62,505 @@ void construct_isosurface
 
 int main(int argc, char **argv)
 {
-  time_t start_time;
-  time(&start_time);
+  const IJK::WALL_TIME_POINT start_time = IJK::wall_clock();
 
   SHREC_TIME shrec_time;
   IO_TIME io_time = {0.0, 0.0, 0.0};
   INPUT_INFO input_info;
+  IJK::STAGE_PROFILER stage_profiler;
   IJK::ERROR error;
-  bool flag_gradient(false);
   try {
 
     std::set_new_handler(memory_exhaustion);
 
     parse_command_line(argc, argv, input_info);
 
-    SHARPISO_SCALAR_GRID full_scalar_grid;
-    NRRD_INFO nrrd_info;
+    if (input_info.report_time_flag || input_info.trace_filename != NULL) {
+      input_info.stage_profiler = &stage_profiler;
+      stage_profiler.SetTrace(input_info.trace_filename != NULL);
+    }
+
+    if (input_info.slab_thickness > 0) 
+      { construct_isosurface_by_slabs(input_info, shrec_time, io_time); }
+    else 
+      { construct_isosurface_in_core(input_info, shrec_time, io_time); }
+
+    if (input_info.report_time_flag) {
+
+      double total_elapsed_time;
+      IJK::clock2seconds(IJK::wall_clock()-start_time, total_elapsed_time);
+
+      cout << endl;
+      report_time(input_info, io_time, shrec_time, total_elapsed_time);
+    };
+
+    if (input_info.trace_filename != NULL)
+      { write_stage_trace(input_info); }
+
+  }
+  catch (ERROR error) {
+    if (error.NumMessages() == 0) {
+      cerr << "Unknown error." << endl;
+    }
+    else { error.Print(cerr); }
+    cerr << "Exiting." << endl;
+    exit(20);
+  }
+  catch (...) {
+    cerr << "Unknown error." << endl;
+    exit(50);
+  };
+
+}
+
+// **************************************************
+// READ GRIDS AND CONSTRUCT ISOSURFACE
+// **************************************************
+
+/// Read scalar and gradient grids and construct isosurface.
+void construct_isosurface_in_core
+(INPUT_INFO & input_info, SHREC_TIME & shrec_time, IO_TIME & io_time)
+{
+  IJK::ERROR error;
+  IJK::SCOPED_STAGE read_stage(input_info.stage_profiler, "read");
+  bool flag_gradient(false);
+
+  // Memory map raw nrrd files.  Read other files using the nrrd library.
+  SHARPISO_SCALAR_GRID read_scalar_grid;
+  MAPPED_SCALAR_GRID mapped_scalar_grid;
+  const SHARPISO_SCALAR_GRID_BASE * scalar_grid_ptr = &read_scalar_grid;
+  NRRD_INFO nrrd_info;
+  if (input_info.flag_mmap && can_map_nrrd_file(input_info.scalar_filename)) {
+    map_nrrd_file
+      (input_info.scalar_filename, mapped_scalar_grid, nrrd_info, io_time);
+    scalar_grid_ptr = &mapped_scalar_grid;
+  }
+  else {
     read_nrrd_file
-      (input_info.scalar_filename, full_scalar_grid,  nrrd_info, io_time);
+      (input_info.scalar_filename, read_scalar_grid,  nrrd_info, io_time);
+  }
+  const SHARPISO_SCALAR_GRID_BASE & full_scalar_grid = *scalar_grid_ptr;
 
-    GRADIENT_GRID full_gradient_grid;
-    NRRD_INFO nrrd_gradient_info;
-    std::vector<COORD_TYPE> edgeI_coord;
-    std::vector<GRADIENT_COORD_TYPE> edgeI_normal_coord;
+  GRADIENT_GRID read_gradient_grid;
+  MAPPED_GRADIENT_GRID mapped_gradient_grid;
+  const GRADIENT_GRID_BASE * gradient_grid_ptr = &read_gradient_grid;
+  NRRD_INFO nrrd_gradient_info;
+  std::vector<COORD_TYPE> edgeI_coord;
+  std::vector<GRADIENT_COORD_TYPE> edgeI_normal_coord;
+  std::vector<EDGE_KEY_TYPE> edgeI_edge_key;
 
-    if (input_info.GradientsRequired()) {
+  if (input_info.GradientsRequired() && !input_info.flag_compute_gradients) {
 
-      string gradient_filename;
+    string gradient_filename;
 
-      if (input_info.gradient_filename == NULL) {
-        construct_gradient_filename
-          (input_info.scalar_filename, gradient_filename);
-      }
-      else {
-        gradient_filename = string(input_info.gradient_filename);
-      }
+    if (input_info.gradient_filename == NULL) {
+      construct_gradient_filename
+        (input_info.scalar_filename, gradient_filename);
+    }
+    else {
+      gradient_filename = string(input_info.gradient_filename);
+    }
 
-      read_nrrd_file(gradient_filename.c_str(), full_gradient_grid,
+    if (input_info.flag_mmap && can_map_nrrd_file(gradient_filename.c_str())) {
+      map_nrrd_file(gradient_filename.c_str(), mapped_gradient_grid,
+                    nrrd_gradient_info);
+      gradient_grid_ptr = &mapped_gradient_grid;
+    }
+    else {
+      read_nrrd_file(gradient_filename.c_str(), read_gradient_grid,
                      nrrd_gradient_info);
-      flag_gradient = true;
+    }
+    flag_gradient = true;
 
-      if (!full_gradient_grid.CompareSize(full_scalar_grid)) {
+    if (!gradient_grid_ptr->CompareSize(full_scalar_grid)) {
+      error.AddMessage("Input error. Grid mismatch.");
+      error.AddMessage
+        ("  Dimension or axis sizes of gradient grid and scalar grid do not match.");
+      throw error;
+    }
+  }
+  else if (input_info.NormalsRequired()) {
+
+    if (input_info.normal_filename == NULL) {
+      error.AddMessage("Programming error.  Missing normal filename.");
+      throw error;
+    }
+
+    if (is_hermite_file(input_info.normal_filename)) {
+      SHARPISO_GRID hermite_grid;
+
+      read_hermite_file
+        (input_info.normal_filename, hermite_grid, 
+         edgeI_edge_key, edgeI_coord, edgeI_normal_coord);
+
+      if (!hermite_grid.CompareSize(full_scalar_grid)) {
         error.AddMessage("Input error. Grid mismatch.");
         error.AddMessage
-          ("  Dimension or axis sizes of gradient grid and scalar grid do not match.");
+          ("  Axis sizes of hermite file and scalar grid do not match.");
         throw error;
       }
     }
-    else if (input_info.NormalsRequired()) {
-
-      if (input_info.normal_filename == NULL) {
-        error.AddMessage("Programming error.  Missing normal filename.");
-        throw error;
-      }
-
+    else {
       read_off_file
         (input_info.normal_filename, edgeI_coord, edgeI_normal_coord);
     }
+  }
 
-    if (!check_input(input_info, full_scalar_grid, error))
-      { throw(error); };
+  read_stage.End();
 
-    // copy nrrd_info into input_info
-    set_input_info(nrrd_info, input_info);
+  if (!check_input(input_info, full_scalar_grid, error))
+    { throw(error); };
 
-    // set DUAL datastructures and flags
-    SHREC_DATA shrec_data;
-    shrec_data.grad_selection_cube_offset = 0.1;
+  // copy nrrd_info into input_info
+  set_input_info(nrrd_info, input_info);
 
-    if (flag_gradient) {
-      shrec_data.SetGrids
-        (full_scalar_grid, full_gradient_grid,
-         input_info.flag_subsample, input_info.subsample_resolution,
-         input_info.flag_supersample, input_info.supersample_resolution);
-    }
-    else
-    {
-      shrec_data.SetScalarGrid
-        (full_scalar_grid, 
-         input_info.flag_subsample, input_info.subsample_resolution,
-         input_info.flag_supersample, input_info.supersample_resolution);
-
-      if (input_info.NormalsRequired()) {
-        shrec_data.SetEdgeI(edgeI_coord, edgeI_normal_coord);
-      }
+  // set DUAL datastructures and flags
+  SHREC_DATA shrec_data;
+  shrec_data.grad_selection_cube_offset = 0.1;
+
+  // Use input grids in place unless they are subsampled or supersampled.
+  const bool flag_reference_grids =
+    !input_info.flag_subsample && !input_info.flag_supersample;
 
+  if (flag_reference_grids) {
+    if (flag_gradient) 
+      { shrec_data.ReferenceGrids(full_scalar_grid, *gradient_grid_ptr); }
+    else 
+      { shrec_data.ReferenceScalarGrid(full_scalar_grid); }
+
+    if (input_info.NormalsRequired()) {
+      shrec_data.SetEdgeI(edgeI_coord, edgeI_normal_coord, edgeI_edge_key);
+    }
+  }
+  else if (flag_gradient) {
+    shrec_data.SetGrids
+      (full_scalar_grid, *gradient_grid_ptr,
+       input_info.flag_subsample, input_info.subsample_resolution,
+       input_info.flag_supersample, input_info.supersample_resolution);
+  }
+  else
+  {
+    shrec_data.SetScalarGrid
+      (full_scalar_grid, 
+       input_info.flag_subsample, input_info.subsample_resolution,
+       input_info.flag_supersample, input_info.supersample_resolution);
+
+    if (input_info.NormalsRequired()) {
+      shrec_data.SetEdgeI(edgeI_coord, edgeI_normal_coord);
     }
-    // Note: shrec_data.SetScalarGrid or shrec_data.SetGrids
-    //       must be called before set_shrec_data.
-    set_shrec_data(input_info, shrec_data, shrec_time);
 
-    report_num_cubes(full_scalar_grid, input_info, shrec_data);
-    construct_isosurface(input_info, shrec_data, shrec_time, io_time);
+  }
+  // Note: shrec_data.SetScalarGrid, shrec_data.SetGrids
+  //       or shrec_data.Reference... must be called before set_shrec_data.
+  set_shrec_data(input_info, shrec_data, shrec_time);
+
+  if (input_info.GradientsRequired() && input_info.flag_compute_gradients) {
+    // Compute only gradients used by the isosurface constructions.
+    IJK::SCOPED_STAGE gradient_stage
+      (input_info.stage_profiler, "compute_gradients");
+    shrec_data.ComputeGradients(input_info.isovalue);
+  }
 
-    if (input_info.report_time_flag) {
+  report_num_cubes(full_scalar_grid, input_info, shrec_data);
+  construct_isosurface(input_info, shrec_data, shrec_time, io_time);
+}
 
-      time_t end_time;
-      time(&end_time);
-      double total_elapsed_time = difftime(end_time, start_time);
+// **************************************************
+// CONSTRUCT ISOSURFACE
+// **************************************************
 
-      cout << endl;
-      report_time(input_info, io_time, shrec_time, total_elapsed_time);
-    };
+namespace {
 
-  }
-  catch (ERROR error) {
-    if (error.NumMessages() == 0) {
-      cerr << "Unknown error." << endl;
+  /// Isosurface and isosurface vertices for one isovalue.
+  class ISOSURFACE_DATA {
+
+  public:
+    ISOVERT isovert;
+    DUAL_ISOSURFACE dual_isosurface;
+    SHREC_INFO shrec_info;
+
+    ISOSURFACE_DATA(const int dimension):shrec_info(dimension) {};
+  };
+
+  /// Return number of isovalues to process concurrently.
+  /// If num_isovalue_threads is 0, use number of hardware threads.
+  int get_num_isovalue_threads
+  (const int num_isovalue_threads, const int num_isovalues)
+  {
+    int n = num_isovalue_threads;
+
+    if (n <= 0) {
+      n = std::thread::hardware_concurrency();
+      if (n <= 0) { n = 1; }
     }
-    else { error.Print(cerr); }
-    cerr << "Exiting." << endl;
-    exit(20);
+
+    if (n > num_isovalues) { n = num_isovalues; }
+    if (n < 1) { n = 1; }
+
+    return(n);
   }
-  catch (...) {
-    cerr << "Unknown error." << endl;
-    exit(50);
-  };
 
 }
+
+/// Replace isosurface quadrilaterals by triangles.
+void convert_quad_to_tri
+(const SHREC_DATA & shrec_data, DUAL_ISOSURFACE & dual_isosurface)
+{
+  VERTEX_INDEX_ARRAY quad_vert(dual_isosurface.quad_vert);
+  VERTEX_INDEX_ARRAY quad_vert2;
+  DUAL_ISOSURFACE isosurface_tri_mesh;
+  isosurface_tri_mesh.vertex_coord = dual_isosurface.vertex_coord;
+  isosurface_tri_mesh.tri_vert = dual_isosurface.tri_vert;
+
+  IJK::reorder_quad_vertices(quad_vert);
+
+  triangulate_quad_sharing_multiple_edges
+    (quad_vert, isosurface_tri_mesh.tri_vert, quad_vert2);
+
+  if (shrec_data.quad_tri_method == SPLIT_MAX_ANGLE) {
+
+    // *** CREATE create_dual_tri IN shrec.cxx ***
+    triangulate_quad_split_max_angle
+      (DIM3, isosurface_tri_mesh.vertex_coord, quad_vert2,
+       shrec_data.max_small_magnitude, isosurface_tri_mesh.tri_vert);
+  }
+  else {
+    triangulate_quad(quad_vert2, isosurface_tri_mesh.tri_vert);
+  }
+
+  dual_isosurface = isosurface_tri_mesh;
+}
+
+/// Construct isosurface for isovalue input_info.isovalue[i].
+/// Reads shrec_data but does not modify it.
+/// If shrec_data.flag_convert_quad_to_tri, 
+///   replace isosurface quadrilaterals by triangles.
+void compute_isosurface
+(const INPUT_INFO & input_info, const SHREC_DATA & shrec_data,
+ const int i, ISOSURFACE_DATA & isosurface_data)
+{
+  const SCALAR_TYPE isovalue = input_info.isovalue[i];
+  const int num_cubes = shrec_data.ScalarGrid().ComputeNumCubes();
+  DUAL_ISOSURFACE & dual_isosurface = isosurface_data.dual_isosurface;
+
+  isosurface_data.shrec_info.grid.num_cubes = num_cubes;
+
+  dual_contouring
+    (shrec_data, isovalue, dual_isosurface, isosurface_data.isovert, 
+     isosurface_data.shrec_info);
+
+  if (shrec_data.flag_convert_quad_to_tri) 
+    { convert_quad_to_tri(shrec_data, dual_isosurface); }
+}
+
+/// Output isosurface for isovalue input_info.isovalue[i].
+void output_isosurface
+(const INPUT_INFO & input_info, const SHREC_DATA & shrec_data,
+ const int i, const ISOSURFACE_DATA & isosurface_data,
+ SHREC_TIME & shrec_time, IO_TIME & io_time)
+{
+  OUTPUT_INFO output_info;
+
+  shrec_time.Add(isosurface_data.shrec_info.time);
+
+  set_output_info(input_info, i, output_info);
+
+  IJK::SCOPED_STAGE stage(input_info.stage_profiler, "write");
+  output_dual_isosurface
+    (output_info, shrec_data, isosurface_data.dual_isosurface, 
+     isosurface_data.isovert, isosurface_data.shrec_info, io_time);
+}
+
 /**
 * Construct Isosurface 
 * Rescaling using spacing now done when ISO coordinated  are computed. 
+* Process up to input_info.num_isovalue_threads isovalues concurrently.
+* Isosurfaces are output in the order of input_info.isovalue[].
+* At most num_isovalue_threads isosurfaces are stored at any time.
 */
 void construct_isosurface
 (const INPUT_INFO & input_info, const SHREC_DATA & shrec_data,
  SHREC_TIME & shrec_time, IO_TIME & io_time)
 {
   const int dimension = shrec_data.ScalarGrid().Dimension();
-  const int num_cube_vertices = compute_num_cube_vertices(dimension);
-  const int num_cubes = shrec_data.ScalarGrid().ComputeNumCubes();
+  const int num_isovalues = input_info.isovalue.size();
+  const int num_threads = get_num_isovalue_threads
+    (input_info.num_isovalue_threads, num_isovalues);
 
   io_time.write_time = 0;
-  for (unsigned int i = 0; i < input_info.isovalue.size(); i++) {
+  for (int i0 = 0; i0 < num_isovalues; i0 += num_threads) {
+
+    const int n = std::min(num_threads, num_isovalues-i0);
+    std::vector< std::unique_ptr<ISOSURFACE_DATA> > isosurface_data(n);
+    std::vector<std::thread> thread_list;
+    std::vector<std::exception_ptr> error_list(n);
+
+    for (int k = 0; k < n; k++)
+      { isosurface_data[k].reset(new ISOSURFACE_DATA(dimension)); }
+
+    // Compute isosurface k and store any exception in error_list[k].
+    auto run_isovalue =
+      [&](const int k)
+      {
+        try 
+          { compute_isosurface
+              (input_info, shrec_data, i0+k, *isosurface_data[k]); }
+        catch (...)
+          { error_list[k] = std::current_exception(); }
+      };
+
+    for (int k = 1; k < n; k++) 
+      { thread_list.push_back(std::thread(run_isovalue, k)); }
+
+    run_isovalue(0);
+
+    for (size_t k = 0; k < thread_list.size(); k++)
+      { thread_list[k].join(); }
+
+    for (int k = 0; k < n; k++) {
+      if (error_list[k]) 
+        { std::rethrow_exception(error_list[k]); }
+
+      output_isosurface
+        (input_info, shrec_data, i0+k, *isosurface_data[k], 
+         shrec_time, io_time);
+    }
+  }
 
-    ISOVERT isovert;
+}
 
-    const SCALAR_TYPE isovalue = input_info.isovalue[i];
+// **************************************************
+// CONSTRUCT ISOSURFACE BY SLABS
+// **************************************************
 
-    DUAL_ISOSURFACE dual_isosurface;
-    SHREC_INFO shrec_info(dimension);
-    shrec_info.grid.num_cubes = num_cubes;
+/**
+* Construct isosurface processing the grid in z-slabs.
+* Only one slab of the scalar and gradient grids is in memory at a time.
+* Each slab contains input_info.slab_thickness layers of cubes
+*   plus input_info.slab_halo layers of cubes on each side.
+* Each slab selects and merges all the cubes in the slab and its halo.
+* Coordinates are global, so the cubes a slab owns get the same
+*   isosurface vertices as in the full grid.
+*/
+void construct_isosurface_by_slabs
+(INPUT_INFO & input_info, SHREC_TIME & shrec_time, IO_TIME & io_time)
+{
+  const int num_isovalues = input_info.isovalue.size();
+  const AXIS_SIZE_TYPE slab_thickness = input_info.slab_thickness;
+  const AXIS_SIZE_TYPE slab_halo = input_info.slab_halo;
+  const AXIS_SIZE_TYPE slab_alignment = 
+    get_slab_alignment(input_info.bin_width);
+
+  NRRD_SLAB_READER scalar_reader;
+  NRRD_SLAB_READER gradient_reader;
+  NRRD_INFO nrrd_info;
+  IJK::ERROR error;
 
-    dual_contouring
-      (shrec_data, isovalue, dual_isosurface, isovert, shrec_info);
-    shrec_time.Add(shrec_info.time);
+  ELAPSED_TIME wall_time;
+  scalar_reader.Open(input_info.scalar_filename);
 
-    OUTPUT_INFO output_info;
-    set_output_info(input_info, i, output_info);
+  string gradient_filename;
 
-    int grow_factor = 1;
-    int shrink_factor = 1;
-    if (input_info.flag_subsample)
-      { grow_factor = input_info.subsample_resolution; }
-    if (input_info.flag_supersample)
-      { shrink_factor = input_info.supersample_resolution; }
+  if (input_info.gradient_filename == NULL) {
+    construct_gradient_filename
+      (input_info.scalar_filename, gradient_filename);
+  }
+  else {
+    gradient_filename = string(input_info.gradient_filename);
+  }
 
-    if (shrec_data.flag_convert_quad_to_tri) {
+  gradient_reader.Open(gradient_filename.c_str());
 
-      VERTEX_INDEX_ARRAY quad_vert(dual_isosurface.quad_vert);
-      VERTEX_INDEX_ARRAY quad_vert2;
-      DUAL_ISOSURFACE isosurface_tri_mesh;
-      isosurface_tri_mesh.vertex_coord = dual_isosurface.vertex_coord;
-      isosurface_tri_mesh.tri_vert = dual_isosurface.tri_vert;
+  for (int d = 0; d < DIM3; d++) {
+    if (gradient_reader.AxisSize(d) != scalar_reader.AxisSize(d)) {
+      error.AddMessage("Input error. Grid mismatch.");
+      error.AddMessage
+        ("  Axis sizes of gradient grid and scalar grid do not match.");
+      throw error;
+    }
+  }
+  io_time.read_nrrd_time = wall_time.getElapsed();
+
+  // copy nrrd_info into input_info
+  nrrd_info.dimension = DIM3;
+  for (int d = 0; d < DIM3; d++) 
+    { nrrd_info.grid_spacing.push_back(scalar_reader.Spacing(d)); }
+  set_input_info(nrrd_info, input_info);
+
+  AXIS_SIZE_TYPE axis_size[DIM3];
+  for (int d = 0; d < DIM3; d++) 
+    { axis_size[d] = scalar_reader.AxisSize(d); }
+  const AXIS_SIZE_TYPE num_cube_layers = axis_size[DIM3-1]-1;
+  const int num_cubes = 
+    (axis_size[0]-1)*(axis_size[1]-1)*num_cube_layers;
+
+  if (!input_info.use_stdout && !input_info.flag_silent) {
+    const int num_slabs = 
+      (num_cube_layers+slab_thickness-1)/slab_thickness;
+    cout << num_cubes << " grid cubes.  " << num_slabs 
+         << " slabs of " << slab_thickness << " cube layers." << endl;
+  }
 
-      IJK::reorder_quad_vertices(quad_vert);
+  std::vector<SLAB_ISOSURFACE> slab_isosurface
+    (num_isovalues, SLAB_ISOSURFACE(axis_size));
+  std::vector<SHREC_TIME> isovalue_time(num_isovalues);
+  SHREC_DATA shrec_data;
+  int dimension = DIM3;
+
+  for (AXIS_SIZE_TYPE zc0 = 0; zc0 < num_cube_layers; 
+       zc0 += slab_thickness) {
+
+    const AXIS_SIZE_TYPE zc1 = 
+      std::min(zc0+slab_thickness, num_cube_layers);
+    AXIS_SIZE_TYPE zv0, zv1;
+    SHARPISO_SCALAR_GRID scalar_grid;
+    GRADIENT_GRID gradient_grid;
+
+    get_slab_vertex_layers
+      (zc0, zc1, slab_halo, slab_alignment, num_cube_layers, zv0, zv1);
+
+    wall_time.getElapsed();
+    scalar_reader.ReadScalarSlab(zv0, zv1, scalar_grid);
+    gradient_reader.ReadGradientSlab(zv0, zv1, gradient_grid);
+    io_time.read_nrrd_time += wall_time.getElapsed();
+
+    // Compute scaled coordinates in the full grid.
+    const GRID_COORD_TYPE coord_offset[DIM3] = { 0, 0, zv0 };
+    scalar_grid.SetCoordOffset(coord_offset);
+    gradient_grid.SetCoordOffset(coord_offset);
+
+    if (zc0 == 0) {
+      if (!check_input(input_info, scalar_grid, error))
+        { throw(error); };
+    }
 
-      triangulate_quad_sharing_multiple_edges
-        (quad_vert, isosurface_tri_mesh.tri_vert, quad_vert2);
+    shrec_data.grad_selection_cube_offset = 0.1;
+    shrec_data.SetGrids(scalar_grid, gradient_grid, false, 1, false, 1);
+    set_shrec_data(input_info, shrec_data, shrec_time);
 
-      if (shrec_data.quad_tri_method == SPLIT_MAX_ANGLE) {
+    for (int i = 0; i < num_isovalues; i++) {
+      SHREC_INFO shrec_info(dimension);
 
-        // *** CREATE create_dual_tri IN shrec.cxx ***
-        triangulate_quad_split_max_angle
-          (DIM3, isosurface_tri_mesh.vertex_coord, quad_vert2,
-           shrec_data.max_small_magnitude, isosurface_tri_mesh.tri_vert);
-      }
-      else {
-        triangulate_quad(quad_vert2, isosurface_tri_mesh.tri_vert);
-      }
-	   
-      output_dual_isosurface
-        (output_info, shrec_data, isosurface_tri_mesh, isovert,
-         shrec_info, io_time);
-    }
-    else {
-      output_dual_isosurface
-        (output_info, shrec_data, dual_isosurface, isovert,
-         shrec_info, io_time);
+      slab_isosurface[i].AddSlab
+        (shrec_data, input_info.isovalue[i], zv0, zc0, zc1, shrec_info);
+      isovalue_time[i].Add(shrec_info.time);
     }
   }
 
+  io_time.write_time = 0;
+  for (int i = 0; i < num_isovalues; i++) {
+    ISOSURFACE_DATA isosurface_data(dimension);
+
+    isosurface_data.shrec_info.grid.num_cubes = num_cubes;
+    isosurface_data.shrec_info.time = isovalue_time[i];
+    slab_isosurface[i].GetMesh(isosurface_data.dual_isosurface);
+
+    if (shrec_data.flag_convert_quad_to_tri) 
+      { convert_quad_to_tri(shrec_data, isosurface_data.dual_isosurface); }
+
+    output_isosurface
+      (input_info, shrec_data, i, isosurface_data, shrec_time, io_time);
+  }
 }
 
 void memory_exhaustion()
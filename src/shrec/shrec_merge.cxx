@@ -407,9 +407,14 @@ namespace {
 
 		get_selected_cubes(isovert.gcube_list, selected_gcube_list);
 
-		map_adjacent_cubes(scalar_grid, isovalue, isovert, gcube_map);
+		{
+			IJK::SCOPED_STAGE stage(merge_param.stage_profiler, "map_adjacent");
+			map_adjacent_cubes(scalar_grid, isovalue, isovert, gcube_map);
+		}
 
 		if (merge_param.flag_map_extended){
+			IJK::SCOPED_STAGE stage(merge_param.stage_profiler, "extend_map");
+
 			extend_mapping_corner_cube
         (scalar_grid, isovalue, merge_param, isovert, gcube_map);
 
@@ -418,6 +423,7 @@ namespace {
 		}
 
 		if (merge_param.flag_check_disk) {
+			IJK::SCOPED_STAGE stage(merge_param.stage_profiler, "check_disk");
 			unmap_non_disk_isopatches
 				(scalar_grid, isovalue, isovert, gcube_map, sharpiso_info);
 		}
@@ -512,11 +518,15 @@ namespace {
     MSDEBUG();
     flag_debug = false;
 
-		map_adjacent_cubes_multi
-      (scalar_grid, isodual_table, ambig_info, isovalue,
-       merge_param, isovert, gcube_map);
+		{
+			IJK::SCOPED_STAGE stage(merge_param.stage_profiler, "map_adjacent");
+			map_adjacent_cubes_multi
+				(scalar_grid, isodual_table, ambig_info, isovalue,
+				merge_param, isovert, gcube_map);
+		}
 
 		if (merge_param.flag_check_disk) {
+			IJK::SCOPED_STAGE stage(merge_param.stage_profiler, "check_disk");
 			unmap_non_disk_isopatches
 				(scalar_grid, isodual_table, isovalue, isovert, gcube_map, 
 				sharpiso_info);
@@ -1028,7 +1038,7 @@ namespace {
     const VERTEX_INDEX cube_index[2] = { cubeA_index, cubeB_index };
     const INDEX_DIFF_TYPE gcube_index[2] = { gcubeA_index, gcubeB_index };
     NUM_TYPE store_map[2];
-    static CUBE_CONNECTED_ARRAY connected_sharp;
+    CUBE_CONNECTED_ARRAY connected_sharp;
 
     if (gcubeA_index == ISOVERT::NO_INDEX) { throw error; }
     if (gcubeB_index == ISOVERT::NO_INDEX) { throw error; }
@@ -1076,7 +1086,7 @@ namespace {
       isovert.GCubeIndex(to_cube_index, error);
     INDEX_DIFF_TYPE gcube_index[3];
     NUM_TYPE store_map[3];
-    static CUBE_CONNECTED_ARRAY connected_sharp;
+    CUBE_CONNECTED_ARRAY connected_sharp;
 
     if (to_gcube_index == ISOVERT::NO_INDEX) { throw error; }
     for (int i = 0; i < 3; i++) {
@@ -1131,7 +1141,7 @@ namespace {
    const std::vector<SHARPISO::VERTEX_INDEX> & gcube_map,
    const bool flag_extended)
   {
-    static CUBE_CONNECTED_ARRAY connected_sharp;
+    CUBE_CONNECTED_ARRAY connected_sharp;
     INDEX_DIFF_TYPE to_gcube = isovert.GCubeIndex(to_cube);
     GRID_BOX region(DIM3);
 
@@ -2230,6 +2240,7 @@ namespace {
        selected_gcube_list, merge_param, gcube_map);
 
 		if (flag_map_extended) {
+      IJK::SCOPED_STAGE stage(merge_param.stage_profiler, "extend_map");
       MAP_PARAM_FLAGS param_flags;
 
       param_flags.extended = true;
@@ -2297,6 +2308,7 @@ namespace {
        merge_param, gcube_map);
 
     if (flag_map_extended) {
+      IJK::SCOPED_STAGE stage(merge_param.stage_profiler, "extend_map");
 
       extend_map_adjacent_pairs_covered
         (scalar_grid, isodual_table, ambig_info, isovalue, isovert, 
@@ -2315,6 +2327,9 @@ namespace {
     }
 
     if (merge_param.flag_collapse_triangles_with_small_angles) {
+      IJK::SCOPED_STAGE stage
+        (merge_param.stage_profiler, "collapse_triangles");
+
       // Try to remove some small angle triangles.
       collapse_triangles_with_small_angles
         (scalar_grid, isodual_table, isovalue, merge_param, isovert, gcube_map);
@@ -2453,7 +2468,8 @@ namespace {
           orth_dir = IJK::cube_facet_orth_dir(DIM3, jfacet);
           side = IJK::cube_facet_side(DIM3, jfacet);
 
-          BOUNDARY_BITS_TYPE mask = (BOUNDARY_BITS_TYPE(1) << jfacet);
+          BOUNDARY_BITS_TYPE mask = 
+            (BOUNDARY_BITS_TYPE(1) << (2*orth_dir+side));
           if (!(boundary_bits & mask)) { 
             VERTEX_INDEX adj_cube_index = 
               isovert.grid.AdjacentVertex(cube_index_i, orth_dir, side);
@@ -2716,7 +2732,8 @@ namespace {
         orth_dir = IJK::cube_facet_orth_dir(DIM3, jfacet);
         side = IJK::cube_facet_side(DIM3, jfacet);
 
-        BOUNDARY_BITS_TYPE mask = (BOUNDARY_BITS_TYPE(1) << jfacet);
+        BOUNDARY_BITS_TYPE mask = 
+          (BOUNDARY_BITS_TYPE(1) << (2*orth_dir+side));
         if (boundary_bits & mask) { 
           found_cube1 = false;
           return;
@@ -3021,9 +3038,10 @@ namespace {
     if (!does_region_contain_cube(region, from_cube, isovert))
       { return(false); }
 
-    check_map_ambig_pair
-      (scalar_grid, isodual_table, ambig_info, isovalue, from_cube, 
-       adjacent_cube, to_cube, isovert, param_flags, merge_param, gcube_map);
+    return(check_map_ambig_pair
+           (scalar_grid, isodual_table, ambig_info, isovalue, from_cube, 
+            adjacent_cube, to_cube, isovert, param_flags, merge_param, 
+            gcube_map));
   }
 
   void check_and_map_ambig_pair
@@ -4545,7 +4563,7 @@ namespace {
   {
     INDEX_DIFF_TYPE from_gcube = isovert.GCubeIndex(from_cube);
     INDEX_DIFF_TYPE to_gcube = isovert.GCubeIndex(to_cube);
-    static CUBE_CONNECTED_ARRAY connected_sharp;
+    CUBE_CONNECTED_ARRAY connected_sharp;
 
     flag_map = false;
 
@@ -6966,7 +6984,7 @@ namespace {
     INDEX_DIFF_TYPE from_gcube = isovert.GCubeIndex(from_cube);
     INDEX_DIFF_TYPE to_gcube = isovert.GCubeIndex(to_cube);
     VERTEX_INDEX cubeC_index;
-    static CUBE_CONNECTED_ARRAY connected_sharp;
+    CUBE_CONNECTED_ARRAY connected_sharp;
 
     if (from_gcube == ISOVERT::NO_INDEX ||
         to_gcube == ISOVERT::NO_INDEX) { return; }
@@ -7514,7 +7532,7 @@ namespace {
 
 		isovert.gcube_list[gcube_index0].flag = NON_DISK_GCUBE;
 
-		get_merged_cubes(isovert.index_grid, isovert, cube_index0,
+		get_merged_cubes(isovert.grid, isovert, cube_index0,
                      gcube_map, dist2cube,  merged_cube_list);
 		for (NUM_TYPE i = 0; i < merged_cube_list.size(); i++) {
 			VERTEX_INDEX cube_index1 = merged_cube_list[i];
@@ -7528,6 +7546,37 @@ namespace {
 		}
 	}
 
+	// Set flag_check[gcube_index] to true for every active cube
+	//   within Linf distance dist of cube_index0.
+	void set_flag_check_in_region
+		(const SHREC::ISOVERT & isovert, const VERTEX_INDEX cube_index0,
+		const AXIS_SIZE_TYPE dist, std::vector<bool> & flag_check)
+	{
+		const int dimension = isovert.grid.Dimension();
+		VERTEX_INDEX region_iv0;
+		IJK::ARRAY<AXIS_SIZE_TYPE> region_axis_size(dimension);
+
+		IJK::compute_region_around_cube
+			(cube_index0, dimension, isovert.grid.AxisSize(), dist, 
+			region_iv0, region_axis_size.Ptr());
+
+		NUM_TYPE num_region_cubes;
+		IJK::compute_num_grid_cubes
+			(dimension, region_axis_size.PtrConst(), num_region_cubes);
+
+		IJK::ARRAY<VERTEX_INDEX> region_cube_list(num_region_cubes);
+		IJK::get_subgrid_cubes
+			(dimension, isovert.grid.AxisSize(), region_iv0, 
+			region_axis_size.PtrConst(), region_cube_list.Ptr());
+
+		for (NUM_TYPE i = 0; i < num_region_cubes; i++) {
+			const INDEX_DIFF_TYPE gcube_index = 
+				isovert.GCubeIndex(region_cube_list[i]);
+			if (gcube_index != ISOVERT::NO_INDEX) 
+				{ flag_check[gcube_index] = true; }
+		}
+	}
+
 	// Reverse merges which create isopatches which are not disks.
 	void unmap_non_disk_isopatches
 		(const SHARPISO_SCALAR_GRID_BASE & scalar_grid, 
@@ -7542,6 +7591,15 @@ namespace {
 		std::vector<ISO_VERTEX_INDEX> tri_vert;
 		std::vector<ISO_VERTEX_INDEX> quad_vert;
 
+		// The disk check around cube c reads gcube_map of cubes 
+		//   within Linf distance dist2cube+1 of c.
+		// unmap_merged_cubes() around cube c0 changes gcube_map of cubes 
+		//   within Linf distance dist2cube of c0.
+		// Recheck only cubes within distance dist2recheck of some c0.
+		// Skipped checks would pass again, so gcube_map is unchanged.
+		const int dist2recheck = 2*dist2cube+1;
+		std::vector<bool> flag_check(num_gcube, true);
+
 		bool passed_all_disk_checks;
 		do {
 			passed_all_disk_checks = true;
@@ -7550,6 +7608,12 @@ namespace {
 				if (isovert.gcube_list[i].flag == SELECTED_GCUBE) {
 					VERTEX_INDEX cube_index = isovert.gcube_list[i].cube_index;
 
+					if (!flag_check[i]) {
+						sharpiso_info.num_skipped_disk_checks++;
+						continue;
+					}
+					flag_check[i] = false;
+
 					extract_dual_isopatch_incident_on
 						(scalar_grid, isovalue, isovert, cube_index,
 						gcube_map, dist2cube, tri_vert, quad_vert);
@@ -7558,6 +7622,8 @@ namespace {
 
 					if (!is_isopatch_disk3D(tri_vert, quad_vert)) {
 						unmap_merged_cubes(isovert, cube_index, dist2cube, gcube_map);
+						set_flag_check_in_region
+							(isovert, cube_index, dist2recheck, flag_check);
 						sharpiso_info.num_non_disk_isopatches++;
 						passed_all_disk_checks = false;
 					}
@@ -7604,6 +7670,10 @@ namespace {
 		std::vector<ISO_VERTEX_INDEX> tri_vert;
 		std::vector<ISO_VERTEX_INDEX> quad_vert;
 
+		// See unmap_non_disk_isopatches() above for dist2recheck.
+		const int dist2recheck = 2*dist2cube+1;
+		std::vector<bool> flag_check(num_gcube, true);
+
 		bool passed_all_disk_checks;
 		do {
 			passed_all_disk_checks = true;
@@ -7612,6 +7682,12 @@ namespace {
 				if (isovert.gcube_list[i].flag == SELECTED_GCUBE) {
 					VERTEX_INDEX cube_index = isovert.gcube_list[i].cube_index;
 
+					if (!flag_check[i]) {
+						sharpiso_info.num_skipped_disk_checks++;
+						continue;
+					}
+					flag_check[i] = false;
+
 					extract_dual_isopatch_incident_on_multi
 						(scalar_grid, isodual_table, isovalue, isovert, 
 						cube_index, gcube_map, dist2cube, tri_vert, quad_vert);
@@ -7619,6 +7695,8 @@ namespace {
 
 					if (!is_isopatch_disk3D(tri_vert, quad_vert)) {
 						unmap_merged_cubes(isovert, cube_index, dist2cube, gcube_map);
+						set_flag_check_in_region
+							(isovert, cube_index, dist2recheck, flag_check);
 						isovert.gcube_list[i].flag = NON_DISK_GCUBE;
 						sharpiso_info.num_non_disk_isopatches++;
 						passed_all_disk_checks = false;
@@ -7669,6 +7747,169 @@ void renumber_tri_quad_vertices
 void search_cycle
 	(const VERTEX_INDEX iv0, std::vector<CYCLE_VERTEX> & cycle_vertex);
 
+namespace {
+
+	// Capacities of the fixed size arrays used by is_small_isopatch_disk3D.
+	// Isosurface patches around a 3x3x3 region of merged cubes 
+	//   have far fewer vertices and polygon edges.
+	const int SMALL_PATCH_MAX_NUM_VERT = 256;
+	const int SMALL_PATCH_MAX_NUM_EDGES = 1024;
+	const int SMALL_PATCH_HASH_SIZE = 512;
+	const int SMALL_PATCH_HASH_SHIFT = 23;   // 32 - log2(hash size).
+
+	// Return number of vertex iv in order of first occurrence.
+	// Return -1 if there are more than SMALL_PATCH_MAX_NUM_VERT vertices.
+	inline int renumber_small_patch_vertex
+		(const ISO_VERTEX_INDEX iv, 
+		ISO_VERTEX_INDEX hash_key[SMALL_PATCH_HASH_SIZE],
+		int hash_value[SMALL_PATCH_HASH_SIZE],
+		int & num_vert)
+	{
+		unsigned int h = (unsigned int)(iv)*2654435769u;
+		h = h >> SMALL_PATCH_HASH_SHIFT;
+		while (hash_value[h] >= 0) {
+			if (hash_key[h] == iv) { return(hash_value[h]); }
+			h = (h+1) & (SMALL_PATCH_HASH_SIZE-1);
+		}
+
+		if (num_vert >= SMALL_PATCH_MAX_NUM_VERT) { return(-1); }
+		hash_key[h] = iv;
+		hash_value[h] = num_vert;
+		num_vert++;
+		return(hash_value[h]);
+	}
+
+	// Add edges of polygons in poly_vert to edge_key[].
+	// Edge (iv0,iv1) with iv0 <= iv1 has key (iv0 << 16) | iv1
+	//   where iv0 and iv1 are renumbered vertices.
+	// Return false if vertices or edges exceed array capacities.
+	bool add_small_patch_edges
+		(const std::vector<ISO_VERTEX_INDEX> & poly_vert, 
+		const int num_vert_per_poly,
+		ISO_VERTEX_INDEX hash_key[SMALL_PATCH_HASH_SIZE],
+		int hash_value[SMALL_PATCH_HASH_SIZE],
+		int & num_vert, 
+		unsigned int edge_key[SMALL_PATCH_MAX_NUM_EDGES],
+		int & num_edges)
+	{
+		const NUM_TYPE num_poly = poly_vert.size()/num_vert_per_poly;
+		int vlocal[NUM_VERT_PER_QUAD];
+
+		for (NUM_TYPE i = 0; i < num_poly; i++) {
+			const ISO_VERTEX_INDEX * vlist = &(poly_vert[i*num_vert_per_poly]);
+			for (int k = 0; k < num_vert_per_poly; k++) {
+				vlocal[k] = renumber_small_patch_vertex
+					(vlist[k], hash_key, hash_value, num_vert);
+				if (vlocal[k] < 0) { return(false); }
+			}
+
+			if (num_edges+num_vert_per_poly > SMALL_PATCH_MAX_NUM_EDGES)
+				{ return(false); }
+
+			for (int k0 = 0; k0 < num_vert_per_poly; k0++) {
+				int iv0 = vlocal[k0];
+				int iv1 = vlocal[(k0+1)%num_vert_per_poly];
+				if (iv0 > iv1) { std::swap(iv0, iv1); }
+				edge_key[num_edges] = (((unsigned int) iv0) << 16) | iv1;
+				num_edges++;
+			}
+		}
+
+		return(true);
+	}
+
+	// Set is_disk to true if isopatch incident on vertex is a disk.
+	// Uses fixed size arrays instead of hash tables.
+	// Return false if isopatch exceeds array capacities.
+	//   (is_disk is undefined.)
+	bool is_small_isopatch_disk3D
+		(const std::vector<ISO_VERTEX_INDEX> & tri_vert,
+		const std::vector<ISO_VERTEX_INDEX> & quad_vert,
+		bool & is_disk)
+	{
+		ISO_VERTEX_INDEX hash_key[SMALL_PATCH_HASH_SIZE];
+		int hash_value[SMALL_PATCH_HASH_SIZE];
+		unsigned int edge_key[SMALL_PATCH_MAX_NUM_EDGES];
+		int num_adjacent[SMALL_PATCH_MAX_NUM_VERT];
+		int adjacent[SMALL_PATCH_MAX_NUM_VERT][2];
+		bool is_visited[SMALL_PATCH_MAX_NUM_VERT];
+		int num_vert = 0;
+		int num_edges = 0;
+
+		is_disk = false;
+
+		if (tri_vert.size()+quad_vert.size() > SMALL_PATCH_MAX_NUM_EDGES)
+			{ return(false); }
+
+		std::fill(hash_value, hash_value+SMALL_PATCH_HASH_SIZE, -1);
+
+		// Renumber vertices in the same order as renumber_tri_quad_vertices.
+		if (!add_small_patch_edges
+			(tri_vert, NUM_VERT_PER_TRI, hash_key, hash_value, num_vert,
+			edge_key, num_edges))
+			{ return(false); }
+		if (!add_small_patch_edges
+			(quad_vert, NUM_VERT_PER_QUAD, hash_key, hash_value, num_vert,
+			edge_key, num_edges))
+			{ return(false); }
+
+		std::sort(edge_key, edge_key+num_edges);
+
+		// Check for edges in more than two isosurface polygons.
+		// Construct boundary from edges in exactly one isosurface polygon.
+		std::fill(num_adjacent, num_adjacent+num_vert, 0);
+		std::fill(is_visited, is_visited+num_vert, false);
+		for (int i = 0; i < num_edges; ) {
+			int j = i+1;
+			while (j < num_edges && edge_key[j] == edge_key[i]) { j++; }
+
+			if (j-i > 2) { return(true); }
+
+			if (j-i == 1) {
+				const int iv0 = edge_key[i] >> 16;
+				const int iv1 = edge_key[i] & 0xFFFF;
+				if (num_adjacent[iv0] < 2) 
+					{ adjacent[iv0][num_adjacent[iv0]] = iv1; }
+				num_adjacent[iv0]++;
+				if (num_adjacent[iv1] < 2) 
+					{ adjacent[iv1][num_adjacent[iv1]] = iv0; }
+				num_adjacent[iv1]++;
+			}
+			i = j;
+		}
+
+		// Check that boundary is a single cycle.
+		int num_boundary_vertices = 0;
+		int first_adjacent = 0;
+		for (int i = 0; i < num_vert; i++) {
+			if (num_adjacent[i] == 2) {
+				first_adjacent = i;
+				num_boundary_vertices++;
+			}
+			else if (num_adjacent[i] != 0) 
+				{ return(true); }
+		}
+
+		if (num_boundary_vertices < 3) { return(true); }
+
+		int iv = first_adjacent;
+		int ivprev = adjacent[first_adjacent][0];
+		int num_visited = 0;
+		while (!is_visited[iv]) {
+			is_visited[iv] = true;
+			num_visited++;
+			const int ivnext = 
+				(adjacent[iv][0] == ivprev) ? adjacent[iv][1] : adjacent[iv][0];
+			ivprev = iv;
+			iv = ivnext;
+		}
+
+		is_disk = (num_visited == num_boundary_vertices);
+		return(true);
+	}
+
+}
+
 // Return true if isopatch incident on vertex is a disk.
 // @param tri_vert Triangle vertices.
 // @param quad_vert Quadrilateral vertices in order around quadrilateral.
@@ -7676,6 +7917,20 @@ void search_cycle
 bool SHREC::is_isopatch_disk3D
 	(const std::vector<ISO_VERTEX_INDEX> & tri_vert,
 	const std::vector<ISO_VERTEX_INDEX> & quad_vert)
+{
+	bool is_disk;
+
+	if (is_small_isopatch_disk3D(tri_vert, quad_vert, is_disk))
+		{ return(is_disk); }
+
+	return(is_isopatch_disk3D_hash(tri_vert, quad_vert));
+}
+
+// Return true if isopatch incident on vertex is a disk.
+// Version using hash tables.  Handles isopatches of any size.
+bool SHREC::is_isopatch_disk3D_hash
+	(const std::vector<ISO_VERTEX_INDEX> & tri_vert,
+	const std::vector<ISO_VERTEX_INDEX> & quad_vert)
 {
 	const NUM_TYPE num_tri = tri_vert.size()/NUM_VERT_PER_TRI;
 	const NUM_TYPE num_quad = quad_vert.size()/NUM_VERT_PER_QUAD;
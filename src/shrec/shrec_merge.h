@@ -117,6 +117,14 @@ namespace SHREC {
   (const std::vector<ISO_VERTEX_INDEX> & tri_vert,
    const std::vector<ISO_VERTEX_INDEX> & quad_vert);
 
+  /// Return true if isopatch incident on vertex is a disk.
+  /// Version using hash tables.  Handles isopatches of any size.
+  /// is_isopatch_disk3D uses fixed size arrays 
+  ///   and calls this version only on large isopatches.
+  bool is_isopatch_disk3D_hash
+  (const std::vector<ISO_VERTEX_INDEX> & tri_vert,
+   const std::vector<ISO_VERTEX_INDEX> & quad_vert);
+
   /// Get list of cubes merged with icube.
   void get_merged_cubes
   (const SHARPISO_GRID & grid,
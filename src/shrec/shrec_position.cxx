@@ -611,10 +611,10 @@ void SHREC::compute_isosurface_grid_edge_centroid
  const SHREC_CUBE_FACE_INFO & cube,
  COORD_TYPE * coord)
 {
-  static COORD_TYPE vcoord[DIM3];
-  static COORD_TYPE coord0[DIM3];
-  static COORD_TYPE coord1[DIM3];
-  static COORD_TYPE coord2[DIM3];
+  COORD_TYPE vcoord[DIM3];
+  COORD_TYPE coord0[DIM3];
+  COORD_TYPE coord1[DIM3];
+  COORD_TYPE coord2[DIM3];
 
   int num_intersected_edges = 0;
   IJK::set_coord_3D(0.0, vcoord);
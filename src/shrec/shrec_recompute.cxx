@@ -50,7 +50,7 @@ using namespace IJK;
 
 // *** DEBUG ***
 #include "ijkprint.txx"
-bool flag_debug(false);
+thread_local bool flag_debug(false);
 
 inline bool is_uncovered_sharp(const GRID_CUBE_DATA & gcube_data)
 {
@@ -29,6 +29,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <stdio.h>
 
 #include "ijkcoord.txx"
+#include "ijkgradient.txx"
 
 #include "shrec_apply.txx"
 
@@ -49,33 +50,33 @@ using namespace IJK;
 namespace {
 
   void reset_covered_isovert_positions
-  (const SHARPISO_BOOL_GRID & covered_grid, ISOVERT & isovert);
+  (const GCUBE_FLAG_GRID & covered_grid, ISOVERT & isovert);
 
   void reset_covered_isovert_positions
-  (const SHARPISO_BOOL_GRID & covered_grid,
+  (const GCUBE_FLAG_GRID & covered_grid,
    const std::vector<NUM_TYPE> & gcube_index_list,
    ISOVERT & isovert);
 
   bool check_covered_point
-  (const SHARPISO_BOOL_GRID & covered_grid,
-   ISOVERT & isovert,
+  (const GCUBE_FLAG_GRID & covered_grid,
+   const ISOVERT & isovert,
    const VERTEX_INDEX & gcube0_index);
 
   void check_and_set_covered_point
-  (const SHARPISO_BOOL_GRID & covered_grid,
+  (SELECTION_DATA & selection_data,
    ISOVERT & isovert,
    const VERTEX_INDEX & gcube_index);
 
   bool is_some_facet_adjacent_true
-  (const SHARPISO_BOOL_GRID & bool_grid, 
+  (const GCUBE_FLAG_GRID & bool_grid, 
    const VERTEX_INDEX icubeA, const BOUNDARY_BITS_TYPE boundary_bits);
 
   bool is_some_edge_adjacent_true
-  (const SHARPISO_BOOL_GRID & bool_grid,
+  (const GCUBE_FLAG_GRID & bool_grid,
    const VERTEX_INDEX icubeA, const BOUNDARY_BITS_TYPE boundary_bits);
 
   bool is_some_dist2_neighbor_true
-  (const SHARPISO_BOOL_GRID & bool_grid, 
+  (const GCUBE_FLAG_GRID & bool_grid, 
    const VERTEX_INDEX cubeA_index, const GRID_COORD_TYPE cubeA_coord[DIM3],
    const BOUNDARY_BITS_TYPE boundary_bits);
 
@@ -88,7 +89,7 @@ namespace {
    const GRID_CUBE_FLAG flag, int & orth_dir, int & side);
 
   bool is_facet_on_corner_3x3x3
-  (const GRID_CUBE_DATA & c, const SHARPISO_BOOL_GRID & covered_grid,
+  (const GRID_CUBE_DATA & c, const GCUBE_FLAG_GRID & covered_grid,
    const ISOVERT & isovert, int & orth_dir, int & side,
    VERTEX_INDEX & corner_cube_index);
 
@@ -97,14 +98,14 @@ namespace {
    const GRID_CUBE_FLAG flag);
 
   bool is_near_corner_covered_cube
-  (const SHARPISO_BOOL_GRID & corner_covered_grid,
+  (const GCUBE_FLAG_GRID & corner_covered_grid,
    const GRID_CUBE_DATA & c);
 
   bool is_facet_neighbor_covered_B
-  (const SHARPISO_BOOL_GRID & covered_grid, const VERTEX_INDEX cube_index0);
+  (const GCUBE_FLAG_GRID & covered_grid, const VERTEX_INDEX cube_index0);
 
   bool is_edge_neighbor_covered_B
-  (const SHARPISO_BOOL_GRID & covered_grid, const VERTEX_INDEX cube_index0);
+  (const GCUBE_FLAG_GRID & covered_grid, const VERTEX_INDEX cube_index0);
 
   int get_index_smallest_abs(const COORD_TYPE coord[DIM3]);
 };
@@ -157,7 +158,7 @@ void select_cube
     if (flag == COVERED_CORNER_GCUBE)
       { selection_data.corner_covered_grid.Set(cube_index2, true); }
 
-    NUM_TYPE gcube_index2 = isovert.index_grid.Scalar(cube_index2);
+    NUM_TYPE gcube_index2 = isovert.GCubeIndex(cube_index2);
     if(gcube_index2 != ISOVERT::NO_INDEX) {
       isovert.gcube_list[gcube_index2].flag = flag;
 
@@ -197,7 +198,7 @@ void check_and_select_cube
 
   // Check if the sharp vertex is inside a covered cube.
   if (check_covered_point(selection_data.covered_grid, isovert, gcube_index)) {
-    isovert.gcube_list[gcube_index].flag = COVERED_POINT;
+    selection_data.SetCoveredPoint(gcube_index, isovert);
 
     // *** DEBUGXXX ***
     MSDEBUG();
@@ -412,8 +413,7 @@ void check_and_select_edge_cube
   const BOUNDARY_BITS_TYPE boundary_bits =
     isovert.gcube_list[gcube_index].boundary_bits;
 
-  check_and_set_covered_point
-    (selection_data.covered_grid, isovert, gcube_index);
+  check_and_set_covered_point(selection_data, isovert, gcube_index);
 
   // check boundary
   if (boundary_bits == 0) {
@@ -464,8 +464,7 @@ void check_and_select_edge_cube_no_conflict
   const BOUNDARY_BITS_TYPE boundary_bits =
     isovert.gcube_list[gcube_index].boundary_bits;
 
-  check_and_set_covered_point
-    (selection_data.covered_grid, isovert, gcube_index);
+  check_and_set_covered_point(selection_data, isovert, gcube_index);
 
   // check boundary
   if (boundary_bits == 0) {
@@ -501,7 +500,156 @@ void select_edge_cubes_no_conflict
   }
 }
 
+// **************************************************
+// SELECT EDGE CUBES IN PARALLEL
+// **************************************************
+
+namespace {
+
+  /// Action on an edge cube computed by get_edge_cube_action().
+  typedef enum {
+    KEEP_EDGE_CUBE,               ///< Do not change cube.
+    COVER_EDGE_CUBE_POINT,        ///< Cube isovert lies in covered cube.
+    SELECT_EDGE_CUBE,             ///< Select cube.
+    MAKE_EDGE_CUBE_UNAVAILABLE,   ///< Selecting cube creates a triangle.
+    CHECK_EDGE_CUBE_SEQUENTIALLY  ///< Isovert is far from cube.
+  } EDGE_CUBE_ACTION;
+
+  /// Minimum number of cubes processed by each thread.
+  const NUM_TYPE MIN_NUM_EDGE_CUBES_PER_THREAD = 64;
+
+  /// Maximum L-infinity distance from cube to cube containing isovert
+  ///   for get_edge_cube_action() to decide the cube action.
+  /// Selecting a cube changes flags within distance 1 of the cube
+  ///   and the mismatch grid within distance 5 of the cube.
+  /// Cubes in a mod 6 list are at least 6 apart, so selecting one cube
+  ///   does not change any data read for another cube in the list.
+  const GRID_COORD_TYPE MAX_DIST_TO_ISOVERT_CUBE = 4;
+
+  /// Return action check_and_select_edge_cube() would take on cube.
+  /// Does not modify isovert or selection_data.
+  /// Return CHECK_EDGE_CUBE_SEQUENTIALLY if the isovert is more than
+  ///   MAX_DIST_TO_ISOVERT_CUBE from the cube.
+  EDGE_CUBE_ACTION get_edge_cube_action
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const SCALAR_TYPE isovalue,
+   const SHARP_ISOVERT_PARAM & isovert_param,
+   const NUM_TYPE gcube_index,
+   const ISOVERT & isovert,
+   const SELECTION_DATA & selection_data)
+  {
+    const GRID_CUBE_DATA & gcube = isovert.gcube_list[gcube_index];
+    const VERTEX_INDEX cube_index = gcube.cube_index;
+    GRID_COORD_TYPE dist;
+    VERTEX_INDEX v1, v2;
+
+    IJK::compute_Linf_distance_between_grid_vertices
+      (isovert.grid, cube_index, gcube.cube_containing_isovert, dist);
+    if (dist > MAX_DIST_TO_ISOVERT_CUBE)
+      { return(CHECK_EDGE_CUBE_SEQUENTIALLY); }
+
+    if (gcube.flag == AVAILABLE_GCUBE &&
+        cube_index != gcube.cube_containing_isovert) {
+      if (check_covered_point
+          (selection_data.covered_grid, isovert, gcube_index))
+        { return(COVER_EDGE_CUBE_POINT); }
+    }
+
+    if (gcube.boundary_bits != 0 || gcube.flag != AVAILABLE_GCUBE ||
+        gcube.num_eigenvalues != 2 || gcube.flag_conflict)
+      { return(KEEP_EDGE_CUBE); }
+
+    if (gcube.linf_dist >= isovert_param.linf_dist_thresh_merge_sharp)
+      { return(KEEP_EDGE_CUBE); }
+
+    if (check_covered_point(selection_data.covered_grid, isovert, gcube_index))
+      { return(COVER_EDGE_CUBE_POINT); }
+
+    if (creates_triangle_new
+        (scalar_grid, isovert, cube_index, isovalue, 
+         selection_data.bin_grid, selection_data.BinWidth(), v1, v2))
+      { return(MAKE_EDGE_CUBE_UNAVAILABLE); }
+
+    return(SELECT_EDGE_CUBE);
+  }
+
+  /// Select edge cubes in sharp_gcube_list which satisfy is_candidate().
+  /// Compute cube actions in parallel and apply them in list order.
+  /// Same result as calling check_and_select_edge_cube() on each
+  ///   candidate in list order.
+  /// @pre Cubes in sharp_gcube_list are at least 6 apart 
+  ///   in L-infinity distance.
+  /// @pre is_candidate(gcube_index) reads only data at the cube
+  ///   and does not modify any data.
+  template <typename FTYPE>
+  void select_edge_cubes_mod6_list
+  (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+   const SCALAR_TYPE isovalue,
+   const SHARP_ISOVERT_PARAM & isovert_param,
+   const vector<NUM_TYPE> & sharp_gcube_list,
+   FTYPE is_candidate,
+   ISOVERT & isovert,
+   SELECTION_DATA & selection_data)
+  {
+    const NUM_TYPE num_gcube = sharp_gcube_list.size();
+    int num_threads = IJK::get_num_threads(isovert_param.num_threads);
+    if (num_threads > num_gcube/MIN_NUM_EDGE_CUBES_PER_THREAD)
+      { num_threads = num_gcube/MIN_NUM_EDGE_CUBES_PER_THREAD; }
+    if (num_threads < 1) { num_threads = 1; }
+    vector<EDGE_CUBE_ACTION> action(num_gcube, KEEP_EDGE_CUBE);
+
+    // Compute actions.  Does not modify isovert or selection_data.
+    IJK::for_each_block_in_parallel
+      (num_gcube, num_threads,
+       [&](const NUM_TYPE ibegin, const NUM_TYPE iend)
+       {
+         for (NUM_TYPE i = ibegin; i < iend; i++) {
+           const NUM_TYPE gcube_index = sharp_gcube_list[i];
+           if (is_candidate(gcube_index)) {
+             action[i] = get_edge_cube_action
+               (scalar_grid, isovalue, isovert_param, gcube_index, 
+                isovert, selection_data);
+           }
+         }
+       });
+
+    // Apply actions in list order.
+    for (NUM_TYPE i = 0; i < num_gcube; i++) {
+      const NUM_TYPE gcube_index = sharp_gcube_list[i];
+
+      switch(action[i]) {
+
+      case COVER_EDGE_CUBE_POINT:
+        selection_data.SetCoveredPoint(gcube_index, isovert);
+        break;
+
+      case SELECT_EDGE_CUBE:
+        select_cube
+          (scalar_grid, isovalue, isovert_param, gcube_index, 
+           COVERED_A_GCUBE, isovert, selection_data);
+        break;
+
+      case MAKE_EDGE_CUBE_UNAVAILABLE:
+        isovert.gcube_list[gcube_index].flag = UNAVAILABLE_GCUBE;
+        break;
+
+      case CHECK_EDGE_CUBE_SEQUENTIALLY:
+        check_and_select_edge_cube
+          (scalar_grid, isovalue, isovert_param, gcube_index, 
+           COVERED_A_GCUBE, isovert, selection_data);
+        break;
+
+      default:
+        break;
+      }
+    }
+  }
+
+}
+
+
 /// Select edge cubes (eigenvalue 2)
+/// @pre Cubes in sharp_gcube_list are at least 6 apart.
 void select_edge_cubes
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
@@ -511,30 +659,19 @@ void select_edge_cubes
  ISOVERT & isovert,
  SELECTION_DATA & selection_data)
 {
-  for (int i=0; i < sharp_gcube_list.size(); i++) {
-    NUM_TYPE gcube_index = sharp_gcube_list[i];
-    VERTEX_INDEX cube_index = isovert.CubeIndex(gcube_index);
-
-    if (selection_data.mismatch_grid.Scalar(cube_index)) { 
-
-      // *** DEBUG ***
-      if (flag_debug) {
-        MSDEBUG();
-        scalar_grid.PrintIndexAndCoord
-          (cerr, "Not selecting mismatched cube ", cube_index, "\n");
-      }
-
-      continue; 
-    }
-
-    check_and_select_edge_cube
-      (scalar_grid, isovalue, isovert_param, gcube_index, COVERED_A_GCUBE, 
-       isovert, selection_data);
-  }
+  select_edge_cubes_mod6_list
+    (scalar_grid, isovalue, isovert_param, sharp_gcube_list,
+     [&](const NUM_TYPE gcube_index)
+     {
+       const VERTEX_INDEX cube_index = isovert.CubeIndex(gcube_index);
+       return(!selection_data.mismatch_grid.Scalar(cube_index));
+     },
+     isovert, selection_data);
 }
 
 /// Select edge cubes (eigenvalue 2) with isovert within given distance
 ///   to cube center.
+/// @pre Cubes in sharp_gcube_list are at least 6 apart.
 void select_edge_cubes_within_dist
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
@@ -545,33 +682,23 @@ void select_edge_cubes_within_dist
  ISOVERT & isovert,
  SELECTION_DATA & selection_data)
 {
-  for (int i=0; i < sharp_gcube_list.size(); i++) {
-    NUM_TYPE gcube_index = sharp_gcube_list[i];
-    VERTEX_INDEX cube_index = isovert.CubeIndex(gcube_index);
+  select_edge_cubes_mod6_list
+    (scalar_grid, isovalue, isovert_param, sharp_gcube_list,
+     [&](const NUM_TYPE gcube_index)
+     {
+       const VERTEX_INDEX cube_index = isovert.CubeIndex(gcube_index);
 
-    if (isovert.gcube_list[gcube_index].linf_dist > max_distance)
-      { continue; }
+       if (isovert.gcube_list[gcube_index].linf_dist > max_distance)
+         { return(false); }
 
-    if (selection_data.mismatch_grid.Scalar(cube_index)) { 
-
-      // *** DEBUG ***
-      if (flag_debug) {
-        MSDEBUG();
-        scalar_grid.PrintIndexAndCoord
-          (cerr, "Not selecting mismatched cube ", cube_index, "\n");
-      }
-
-      continue; 
-    }
-
-    check_and_select_edge_cube
-      (scalar_grid, isovalue, isovert_param, gcube_index, COVERED_A_GCUBE, 
-       isovert, selection_data);
-  }
+       return(!selection_data.mismatch_grid.Scalar(cube_index));
+     },
+     isovert, selection_data);
 }
 
 
 /// Select edge cubes (eigenvalue 2) near corners
+/// @pre Cubes in sharp_gcube_list are at least 6 apart.
 void select_edge_cubes_near_corners
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
@@ -581,35 +708,26 @@ void select_edge_cubes_near_corners
  ISOVERT & isovert,
  SELECTION_DATA & selection_data)
 {
-  for (int i=0; i < sharp_gcube_list.size(); i++) {
-    NUM_TYPE gcube_index = sharp_gcube_list[i];
-    VERTEX_INDEX cube_index = isovert.CubeIndex(gcube_index);
-
-    if (selection_data.mismatch_grid.Scalar(cube_index)) { 
-
-      // *** DEBUG ***
-      if (flag_debug) {
-        MSDEBUG();
-        scalar_grid.PrintIndexAndCoord
-          (cerr, "Not selecting mismatched cube ", cube_index, "\n");
-      }
-
-      continue; 
-    }
-
-    if (is_near_corner_covered_cube
-        (selection_data.corner_covered_grid, isovert.gcube_list[gcube_index])) {
-      check_and_select_edge_cube
-        (scalar_grid, isovalue, isovert_param, gcube_index, COVERED_A_GCUBE, 
-         isovert, selection_data);
-    }
-
-  }
+  select_edge_cubes_mod6_list
+    (scalar_grid, isovalue, isovert_param, sharp_gcube_list,
+     [&](const NUM_TYPE gcube_index)
+     {
+       const VERTEX_INDEX cube_index = isovert.CubeIndex(gcube_index);
+
+       if (selection_data.mismatch_grid.Scalar(cube_index))
+         { return(false); }
+
+       return(is_near_corner_covered_cube
+              (selection_data.corner_covered_grid, 
+               isovert.gcube_list[gcube_index]));
+     },
+     isovert, selection_data);
 }
 
 
 /// Select edge cubes (eigenvalue 2) near corners within given distance
 ///   to cube centers.
+/// @pre Cubes in sharp_gcube_list are at least 6 apart.
 void select_edge_cubes_near_corners_within_dist
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
@@ -620,47 +738,23 @@ void select_edge_cubes_near_corners_within_dist
  ISOVERT & isovert,
  SELECTION_DATA & selection_data)
 {
-  for (int i=0; i < sharp_gcube_list.size(); i++) {
-    NUM_TYPE gcube_index = sharp_gcube_list[i];
-    VERTEX_INDEX cube_index = isovert.CubeIndex(gcube_index);
-
-    if (isovert.gcube_list[gcube_index].linf_dist > max_distance)
-      { continue; }
-
-    // *** DEBUGXXX ***
-    MSDEBUG();
-    if (flag_debug) {
-      scalar_grid.PrintIndexAndCoord
-        (cerr, "*** Processing cube ", cube_index, "\n");
-    }
-
-    if (selection_data.mismatch_grid.Scalar(cube_index)) { 
-
-      // *** DEBUG ***
-      if (flag_debug) {
-        MSDEBUG();
-        scalar_grid.PrintIndexAndCoord
-          (cerr, "Not selecting mismatched cube ", cube_index, "\n");
-      }
-
-      continue; 
-    }
-
-    if (is_near_corner_covered_cube
-        (selection_data.corner_covered_grid, isovert.gcube_list[gcube_index])) {
-
-      // *** DEBUGXXX ***
-      MSDEBUG();
-      if (flag_debug) {
-        scalar_grid.PrintIndexAndCoord
-          (cerr, "*** Checking near corner cube ", cube_index, "\n");
-      }
-
-      check_and_select_edge_cube
-        (scalar_grid, isovalue, isovert_param, gcube_index, COVERED_A_GCUBE, 
-         isovert, selection_data);
-    }
-  }
+  select_edge_cubes_mod6_list
+    (scalar_grid, isovalue, isovert_param, sharp_gcube_list,
+     [&](const NUM_TYPE gcube_index)
+     {
+       const VERTEX_INDEX cube_index = isovert.CubeIndex(gcube_index);
+
+       if (isovert.gcube_list[gcube_index].linf_dist > max_distance)
+         { return(false); }
+
+       if (selection_data.mismatch_grid.Scalar(cube_index))
+         { return(false); }
+
+       return(is_near_corner_covered_cube
+              (selection_data.corner_covered_grid, 
+               isovert.gcube_list[gcube_index]));
+     },
+     isovert, selection_data);
 }
 
 /// Select one edge cube (eigenvalue 2).
@@ -763,11 +857,10 @@ void reselect_two_edge_cubes
 {
   const int bin_width = isovert_param.bin_width;
   vector<NUM_TYPE> neighbor_list;
-  GCUBE_COMPARE gcube_compare(isovert.gcube_list);
 
   get_corner_or_edge_cubes_around_cube
     (isovert.grid, isovert, gcube_index, neighbor_list);
-  sort(neighbor_list.begin(), neighbor_list.end(), gcube_compare);
+  sort_gcube_index_list(isovert.gcube_list, neighbor_list);
 
   MSDEBUG();
   if (flag_debug) {
@@ -820,7 +913,6 @@ void reselect_edge_cubes
   GRID_COORD_TYPE cube_coord[DIM3], cubeB_coord[DIM3], cubeC_coord[DIM3];
   GRID_COORD_TYPE rmin[DIM3], rmax[DIM3];
   std::vector<NUM_TYPE> from_list;
-  GCUBE_COMPARE gcube_compare(isovert.gcube_list);
 
   scalar_grid.ComputeCoord(cube_index, cube_coord);
 
@@ -923,7 +1015,7 @@ void reselect_edge_cubes
       }
 
       if (from_list.size() > 0) {
-        sort(from_list.begin(), from_list.end(), gcube_compare);
+        sort_gcube_index_list(isovert.gcube_list, from_list);
 
         reselect_two_edge_cubes
           (scalar_grid, isovalue, isovert_param, gcube_index, from_list, 
@@ -986,12 +1078,13 @@ void SHREC::select_sharp_isovert
 {
   const int dimension = scalar_grid.Dimension();
   const int bin_width = isovert_param.bin_width;
-  GCUBE_COMPARE gcube_compare(isovert.gcube_list);
   std::vector<NUM_TYPE> sharp_gcube_list;
-  SELECTION_DATA selection_data(scalar_grid, isovert_param);
+  std::vector<GCUBE_SORT_KEY> sharp_gcube_sort_key;
+  SELECTION_DATA selection_data(scalar_grid, isovert, isovert_param);
 
   // get corner or edge cubes
-  get_corner_or_edge_cubes(isovert.gcube_list, sharp_gcube_list);
+  get_corner_or_edge_cubes
+    (isovert.gcube_list, sharp_gcube_list, sharp_gcube_sort_key);
 
   initialize_covered_by(isovert);
 
@@ -1008,7 +1101,8 @@ void SHREC::select_sharp_isovert
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 
   // Resort sharp gcube_list
-  sort(sharp_gcube_list.begin(), sharp_gcube_list.end(), gcube_compare);
+  resort_gcube_index_list
+    (isovert.gcube_list, sharp_gcube_list, sharp_gcube_sort_key);
 
   MSDEBUG();
   if (flag_debug) { 
@@ -1035,6 +1129,57 @@ void SHREC::select_sharp_isovert
 }
 
 
+/// Add cubes which are COVERED_POINT to selection_data.covered_point_list.
+void get_covered_point_cubes
+(const ISOVERT & isovert, SELECTION_DATA & selection_data)
+{
+  for (size_t i = 0; i < isovert.gcube_list.size(); i++) {
+    if (isovert.gcube_list[i].flag == COVERED_POINT)
+      { selection_data.covered_point_list.push_back(i); }
+  }
+}
+
+
+/// Recompute isovert positions for cubes in covered_point_list.
+/// Same as recompute_covered_point_positions() on all of gcube_list,
+///   since every COVERED_POINT cube which has not been recomputed
+///   with the minimum offset is in covered_point_list.
+/// Remove cubes which do not need to be recomputed again.
+void recompute_listed_covered_point_positions
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const SCALAR_TYPE isovalue,
+ const SHARP_ISOVERT_PARAM & isovert_param,
+ ISOVERT & isovert,
+ SELECTION_DATA & selection_data)
+{
+  std::vector<NUM_TYPE> & covered_point_list = 
+    selection_data.covered_point_list;
+
+  // Recompute in the same order as a scan of gcube_list.
+  sort(covered_point_list.begin(), covered_point_list.end());
+  covered_point_list.erase
+    (unique(covered_point_list.begin(), covered_point_list.end()),
+     covered_point_list.end());
+
+  recompute_covered_point_positions
+    (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
+     covered_point_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
+
+  NUM_TYPE k = 0;
+  for (size_t i = 0; i < covered_point_list.size(); i++) {
+    const NUM_TYPE gcube_index = covered_point_list[i];
+    if (isovert.gcube_list[gcube_index].flag == COVERED_POINT &&
+        !isovert.gcube_list[gcube_index].flag_recomputed_coord_min_offset) {
+      covered_point_list[k] = gcube_index;
+      k++;
+    }
+  }
+  covered_point_list.resize(k);
+}
+
+
 void SHREC::select_sharp_isovert
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const GRADIENT_GRID_BASE & gradient_grid,
@@ -1047,15 +1192,17 @@ void SHREC::select_sharp_isovert
   const bool flag_recompute = 
     isovert_param.flag_recompute_isovert &&
     isovert_param.flag_recompute_changing_gradS_offset;
-  GCUBE_COMPARE gcube_compare(isovert.gcube_list);
   std::vector<NUM_TYPE> sharp_gcube_list;
-  SELECTION_DATA selection_data(scalar_grid, isovert_param);
+  std::vector<GCUBE_SORT_KEY> sharp_gcube_sort_key;
+  SELECTION_DATA selection_data(scalar_grid, isovert, isovert_param);
 
 
   // get corner or edge cubes
-  get_corner_or_edge_cubes(isovert.gcube_list, sharp_gcube_list);
+  get_corner_or_edge_cubes
+    (isovert.gcube_list, sharp_gcube_list, sharp_gcube_sort_key);
 
   initialize_covered_by(isovert);
+  get_covered_point_cubes(isovert, selection_data);
 
   MSDEBUG();
   if (flag_debug) {
@@ -1069,15 +1216,16 @@ void SHREC::select_sharp_isovert
 
   if (flag_recompute) {
 
-    recompute_covered_point_positions
-      (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-       isovert_param, isovert);
+    recompute_listed_covered_point_positions
+      (scalar_grid, gradient_grid, isovalue, isovert_param, isovert,
+       selection_data);
 
     reset_covered_isovert_positions(selection_data.covered_grid, isovert);
   }
 
   // Resort sharp gcube_list
-  sort(sharp_gcube_list.begin(), sharp_gcube_list.end(), gcube_compare);
+  resort_gcube_index_list
+    (isovert.gcube_list, sharp_gcube_list, sharp_gcube_sort_key);
 
   MSDEBUG();
   if (flag_debug) { 
@@ -1091,15 +1239,16 @@ void SHREC::select_sharp_isovert
 
   if (flag_recompute) {
 
-    recompute_covered_point_positions
-      (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-       isovert_param, isovert);
+    recompute_listed_covered_point_positions
+      (scalar_grid, gradient_grid, isovalue, isovert_param, isovert,
+       selection_data);
 
     reset_covered_isovert_positions(selection_data.covered_grid, isovert);
   }
 
   // Resort sharp gcube_list
-  sort(sharp_gcube_list.begin(), sharp_gcube_list.end(), gcube_compare);
+  resort_gcube_index_list
+    (isovert.gcube_list, sharp_gcube_list, sharp_gcube_sort_key);
 
   MSDEBUG();
   if (flag_debug) { cerr << endl << "--- Selecting edge cubes." << endl; }
@@ -1115,9 +1264,9 @@ void SHREC::select_sharp_isovert
     if (flag_debug) 
       { cerr << endl << "--- Recomputing covered point positions." << endl; }
 
-    recompute_covered_point_positions
-      (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-       isovert_param, isovert);
+    recompute_listed_covered_point_positions
+      (scalar_grid, gradient_grid, isovalue, isovert_param, isovert,
+       selection_data);
 
     reset_covered_isovert_positions(selection_data.covered_grid, isovert);
   }
@@ -1134,7 +1283,8 @@ void SHREC::select_sharp_isovert
      isovert, selection_data);
 
   // Resort sharp gcube_list
-  sort(sharp_gcube_list.begin(), sharp_gcube_list.end(), gcube_compare);
+  resort_gcube_index_list
+    (isovert.gcube_list, sharp_gcube_list, sharp_gcube_sort_key);
 
   MSDEBUG();
   if (flag_debug) 
@@ -1161,9 +1311,9 @@ void SHREC::select_sharp_isovert
     if (flag_debug) 
       { cerr << endl << "--- Recomputing covered point positions." << endl; }
 
-    recompute_covered_point_positions
-      (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-       isovert_param, isovert);
+    recompute_listed_covered_point_positions
+      (scalar_grid, gradient_grid, isovalue, isovert_param, isovert,
+       selection_data);
   }
 
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
@@ -1179,7 +1329,7 @@ void SHREC::select_sharp_isovert
 /// Set mismatch flags for cubes near corners.
 void set_mismatch_near_corner
 (const ISOVERT & isovert, const GRID_CUBE_DATA & gcubeA, 
- const SELECTION_DATA & selection_data, SHARPISO_BOOL_GRID & mismatch_grid)
+ const SELECTION_DATA & selection_data, GCUBE_FLAG_GRID & mismatch_grid)
 {
   int orth_dir, side;
   GRID_COORD_TYPE distance2boundary;
@@ -1254,7 +1404,7 @@ void set_mismatch_near_corner
 /// Set mismatch flags for cubes near corners.
 void set_mismatch_near_corner
 (const ISOVERT & isovert,  const vector<NUM_TYPE> & sharp_gcube_list,
- const SELECTION_DATA & selection_data, SHARPISO_BOOL_GRID & mismatch_grid)
+ const SELECTION_DATA & selection_data, GCUBE_FLAG_GRID & mismatch_grid)
 {
   MSDEBUG();
   if (flag_debug)
@@ -1284,9 +1434,9 @@ void set_mismatch_near_corner
 /// Compute mismatch grid.
 void compute_mismatch_grid
 (const ISOVERT & isovert,  const vector<NUM_TYPE> & sharp_gcube_list,
- const SELECTION_DATA & selection_data, SHARPISO_BOOL_GRID & mismatch_grid)
+ const SELECTION_DATA & selection_data, GCUBE_FLAG_GRID & mismatch_grid)
 {
-  mismatch_grid.SetAll(false);
+  mismatch_grid.ClearAll();
 
   MSDEBUG();
   if (flag_debug)
@@ -1458,7 +1608,7 @@ void select_cubes_with_k_coord_cong2zero
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 }
 
@@ -1792,7 +1942,7 @@ void select_cubes_not_cong_zero_mod3_A
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 }
 
@@ -1875,7 +2025,7 @@ void select_cubes_not_cong_zero_mod3_fadj2covered
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 }
 
@@ -1951,7 +2101,7 @@ void select_cubes_with_one_coord_cong_zero_mod3_A
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 }
 
@@ -2074,7 +2224,7 @@ void select_cubes_with_one_coord_cong_zero_mod3_fadj2covered
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 }
 
@@ -2280,7 +2430,7 @@ void select_cubes_with_two_coord_cong_zero_mod3_C
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 }
 
@@ -2387,7 +2537,7 @@ void select_edge_cubes_mod3
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 
   MSDEBUG();
@@ -2423,7 +2573,7 @@ void select_edge_cubes_mod3
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 
   // Select edge cubes with one coord congruent to 0 mod 3
@@ -2458,7 +2608,7 @@ void select_edge_cubes_mod3
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 
   MSDEBUG();
@@ -2487,9 +2637,8 @@ void SHREC::select_sharp_isovert_mod3
 {
   const int dimension = scalar_grid.Dimension();
   const int bin_width = isovert_param.bin_width;
-  GCUBE_COMPARE gcube_compare(isovert.gcube_list);
   std::vector<NUM_TYPE> sharp_gcube_list;
-  SELECTION_DATA selection_data(scalar_grid, isovert_param);
+  SELECTION_DATA selection_data(scalar_grid, isovert, isovert_param);
 
 
   // get corner or edge cubes
@@ -2508,12 +2657,12 @@ void SHREC::select_sharp_isovert_mod3
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
 
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 
   // Resort sharp gcube_list
-  sort(sharp_gcube_list.begin(), sharp_gcube_list.end(), gcube_compare);
+  sort_gcube_index_list(isovert.gcube_list, sharp_gcube_list);
 
   MSDEBUG();
   if (flag_debug) {
@@ -2532,12 +2681,12 @@ void SHREC::select_sharp_isovert_mod3
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
 
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 
   // Resort sharp gcube_list
-  sort(sharp_gcube_list.begin(), sharp_gcube_list.end(), gcube_compare);
+  sort_gcube_index_list(isovert.gcube_list, sharp_gcube_list);
 
   // Select edge cubes (again)
   select_edge_cubes_mod3
@@ -2546,7 +2695,7 @@ void SHREC::select_sharp_isovert_mod3
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     isovert_param, isovert);
+     isovert_param, isovert, selection_data.gradients_buffer);
 
   reset_covered_isovert_positions(selection_data.covered_grid, isovert);
 }
@@ -2581,7 +2730,8 @@ void select_edge_cubes_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 
@@ -2595,7 +2745,8 @@ void select_edge_cubes_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 
@@ -2610,7 +2761,8 @@ void select_edge_cubes_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 }
@@ -2644,7 +2796,8 @@ void select_edge_cubes_within_dist_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 
@@ -2659,7 +2812,8 @@ void select_edge_cubes_within_dist_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 
@@ -2675,7 +2829,8 @@ void select_edge_cubes_within_dist_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 }
@@ -2716,7 +2871,8 @@ void select_cubes_near_corners_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 
@@ -2730,7 +2886,8 @@ void select_cubes_near_corners_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 
@@ -2745,7 +2902,8 @@ void select_cubes_near_corners_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 }
@@ -2789,7 +2947,8 @@ void select_cubes_near_corners_within_dist_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 
@@ -2804,7 +2963,8 @@ void select_cubes_near_corners_within_dist_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 
@@ -2820,7 +2980,8 @@ void select_cubes_near_corners_within_dist_mod6
   // Recomputing covered point positions
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, isovalue, 
-     gcube_index_list, isovert_param, isovert);
+     gcube_index_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, gcube_index_list, isovert);
 }
@@ -2854,9 +3015,8 @@ void SHREC::select_sharp_isovert_mod6
   const int bin_width = isovert_param.bin_width;
   const COORD_TYPE half_cube_distance = 0.51;
   COORD_TYPE max_distance;
-  GCUBE_COMPARE gcube_compare(isovert.gcube_list);
   std::vector<NUM_TYPE> sharp_gcube_list;
-  SELECTION_DATA_MOD6 selection_data(scalar_grid, isovert_param);
+  SELECTION_DATA_MOD6 selection_data(scalar_grid, isovert, isovert_param);
 
 
   // Set mismatch table entries.  Do not include 5XX entries.
@@ -2881,7 +3041,8 @@ void SHREC::select_sharp_isovert_mod6
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, 
-     isovalue, sharp_gcube_list, isovert_param, isovert);
+     isovalue, sharp_gcube_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
   reset_covered_isovert_positions
     (selection_data.covered_grid, sharp_gcube_list, isovert);
 
@@ -2931,7 +3092,8 @@ void SHREC::select_sharp_isovert_mod6
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, 
-     isovalue, sharp_gcube_list, isovert_param, isovert);
+     isovalue, sharp_gcube_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
 
   reset_covered_isovert_positions
     (selection_data.covered_grid, sharp_gcube_list, isovert);
@@ -2972,7 +3134,8 @@ void SHREC::select_sharp_isovert_mod6
 
   recompute_covered_point_positions
     (scalar_grid, gradient_grid, selection_data.covered_grid, 
-     isovalue, sharp_gcube_list, isovert_param, isovert);
+     isovalue, sharp_gcube_list, isovert_param, isovert,
+     selection_data.gradients_buffer);
 
   reset_covered_isovert_positions
     (selection_data.covered_grid, sharp_gcube_list, isovert);
@@ -3004,7 +3167,7 @@ namespace {
   // Change isovert positions which lie in covered cubes.
   // @param gcube_index_list Examine only cubes in gcube_index_list.
   void reset_covered_isovert_positions
-  (const SHARPISO_BOOL_GRID & covered_grid,
+  (const GCUBE_FLAG_GRID & covered_grid,
    const std::vector<NUM_TYPE> & gcube_index_list,
    ISOVERT & isovert)
   {
@@ -3046,7 +3209,8 @@ namespace {
                   cerr << endl;
                 }
 
-                copy_isovert_position(isovert.grid, gcubeA_index, gcubeB_index, isovert);
+                copy_isovert_position
+                  (covered_grid, gcubeA_index, gcubeB_index, isovert);
               }
             }
           }
@@ -3067,7 +3231,7 @@ namespace {
 
   // Change isovert positions which lie in covered cubes.
   void reset_covered_isovert_positions
-  (const SHARPISO_BOOL_GRID & covered_grid,
+  (const GCUBE_FLAG_GRID & covered_grid,
    ISOVERT & isovert)
   {
     std::vector<NUM_TYPE> gcube_sharp_list;
@@ -3087,8 +3251,8 @@ namespace {
 
   /// Return true if sharp vertex is in a cube which is covered.
   bool check_covered_point
-  (const SHARPISO_BOOL_GRID & covered_grid,
-   ISOVERT & isovert,
+  (const GCUBE_FLAG_GRID & covered_grid,
+   const ISOVERT & isovert,
    const VERTEX_INDEX & gcube0_index)
   {
     const VERTEX_INDEX cube1_index =
@@ -3111,7 +3275,7 @@ namespace {
 
   /// If sharp vertex is in covered cube, set cube to COVERED_POINT.
   void check_and_set_covered_point
-  (const SHARPISO_BOOL_GRID & covered_grid,
+  (SELECTION_DATA & selection_data,
    ISOVERT & isovert,
    const VERTEX_INDEX & gcube_index)
   {
@@ -3121,9 +3285,9 @@ namespace {
           isovert.gcube_list[gcube_index].cube_containing_isovert) {
 
         if (check_covered_point
-            (covered_grid, isovert, gcube_index)) {
+            (selection_data.covered_grid, isovert, gcube_index)) {
 
-          isovert.gcube_list[gcube_index].flag = COVERED_POINT;
+          selection_data.SetCoveredPoint(gcube_index, isovert);
         }
       }
     }
@@ -3142,7 +3306,7 @@ namespace {
       // *** SHOULD CHECK boundary_bits
       neighbor_cube_index = isovert.grid.CubeNeighborF(c.cube_index, j);
       INDEX_DIFF_TYPE neighbor_gcube_index
-        = isovert.index_grid.Scalar(neighbor_cube_index);
+        = isovert.GCubeIndex(neighbor_cube_index);
 
       if(neighbor_gcube_index == ISOVERT::NO_INDEX) { continue; }
 
@@ -3155,7 +3319,7 @@ namespace {
 
       neighbor_cube_index = isovert.grid.CubeNeighborE(c.cube_index, j);
       INDEX_DIFF_TYPE neighbor_gcube_index
-        = isovert.index_grid.Scalar(neighbor_cube_index);
+        = isovert.GCubeIndex(neighbor_cube_index);
 
       if (neighbor_gcube_index == ISOVERT::NO_INDEX) { continue; }
 
@@ -3171,7 +3335,7 @@ namespace {
 
       // neighbor_gcube_index is an entry into the gcube list 
       INDEX_DIFF_TYPE neighbor_gcube_index
-        = isovert.index_grid.Scalar(neighbor_cube_index);
+        = isovert.GCubeIndex(neighbor_cube_index);
 
       if (neighbor_gcube_index == ISOVERT::NO_INDEX)
         { continue; }
@@ -3214,7 +3378,7 @@ namespace {
 
   // Return true if cube facet lies on a 3x3x3 region around a corner cube.
   bool is_facet_on_corner_3x3x3
-  (const GRID_CUBE_DATA & c, const SHARPISO_BOOL_GRID & covered_grid,
+  (const GRID_CUBE_DATA & c, const GCUBE_FLAG_GRID & covered_grid,
    const ISOVERT & isovert, int & orth_dir, int & side,
    VERTEX_INDEX & corner_cube_index)
   {
@@ -3272,7 +3436,7 @@ namespace {
   ///   or if cube at (c0,c1,c2) +/- (a,0,0) or (0,a,0) or (0,0,a)
   //    for a = 1 or 2 is covered.
   bool is_near_corner_covered_cube
-  (const SHARPISO_BOOL_GRID & corner_covered_grid,
+  (const GCUBE_FLAG_GRID & corner_covered_grid,
    const GRID_CUBE_DATA & c)
   {
     if (is_some_edge_adjacent_true
@@ -3326,7 +3490,7 @@ namespace {
   /// Version based on covered_grid.
   /// @pre cube0 is an internal cube.
   bool is_facet_neighbor_covered_B
-  (const SHARPISO_BOOL_GRID & covered_grid, const VERTEX_INDEX cube_index0)
+  (const GCUBE_FLAG_GRID & covered_grid, const VERTEX_INDEX cube_index0)
   {
     for (int d = 0; d < DIM3; d++) {
       for (int iside = 0; iside < 2; iside++) {
@@ -3344,7 +3508,7 @@ namespace {
   /// Version based on covered_grid.
   /// @pre cube0 is an internal cube.
   bool is_edge_neighbor_covered_B
-  (const SHARPISO_BOOL_GRID & covered_grid, const VERTEX_INDEX cube_index0)
+  (const GCUBE_FLAG_GRID & covered_grid, const VERTEX_INDEX cube_index0)
   {
     for (int edge_dir = 0; edge_dir < DIM3; edge_dir++) {
       int d1 = (edge_dir+1)%DIM3;
@@ -3385,7 +3549,7 @@ namespace {
   /// Return true if bool_grid.Scalar(icubeB) is true for some cube
   ///   facet adjacent to icubeA
   bool is_some_facet_adjacent_true
-  (const SHARPISO_BOOL_GRID & bool_grid, 
+  (const GCUBE_FLAG_GRID & bool_grid, 
    const VERTEX_INDEX icubeA, const BOUNDARY_BITS_TYPE boundary_bits)
   {
     VERTEX_INDEX icubeB;
@@ -3423,7 +3587,7 @@ namespace {
   /// Return true if bool_grid.Scalar(icubeB) is true for some cube
   ///   edge adjacent to icubeA
   bool is_some_edge_adjacent_true
-  (const SHARPISO_BOOL_GRID & bool_grid, 
+  (const GCUBE_FLAG_GRID & bool_grid, 
    const VERTEX_INDEX icubeA, const BOUNDARY_BITS_TYPE boundary_bits)
   {
     if (boundary_bits == 0) {
@@ -3468,7 +3632,7 @@ namespace {
   /// Return true if bool_grid.Scalar(icube) is true for some cube
   ///   at (c0,c1,c2) +/- (a,0,0) or (0,a,0) or (0,0,a) where a = 1 or 2.
   bool is_some_dist2_neighbor_true
-  (const SHARPISO_BOOL_GRID & bool_grid, 
+  (const GCUBE_FLAG_GRID & bool_grid, 
    const VERTEX_INDEX cubeA_index, const GRID_COORD_TYPE cubeA_coord[DIM3],
    const BOUNDARY_BITS_TYPE boundary_bits)
   {
@@ -3575,6 +3739,7 @@ MISMATCH_TABLE::MISMATCH_TABLE(const SHARPISO_GRID & sharpiso_grid)
 {
   grid.SetSize(sharpiso_grid);
   grid.SetSpacing(sharpiso_grid.SpacingPtrConst());
+  grid.SetCoordOffset(sharpiso_grid.CoordOffsetPtrConst());
 }
 
 NUM_TYPE MISMATCH_TABLE::AddEntry
@@ -3718,7 +3883,7 @@ void MISMATCH_TABLE::AddSignedPermutations
 
 bool MISMATCH_TABLE::IsBlocked
 (const NUM_TYPE ientry, const VERTEX_INDEX cubeA_index,
- const SHARPISO_BOOL_GRID & selected_grid) const
+ const GCUBE_FLAG_GRID & selected_grid) const
 {
   for (NUM_TYPE j = 0; j < entry[ientry].NumBlockingLocations(); j++) {
 
@@ -3735,8 +3900,8 @@ bool MISMATCH_TABLE::IsBlocked
 void MISMATCH_TABLE::SetMismatchGrid
 (const GRID_CUBE_DATA & gcubeA,
  const ISOVERT & isovert,
- const SHARPISO_BOOL_GRID & selected_grid,
- SHARPISO_BOOL_GRID & mismatch_grid) const
+ const GCUBE_FLAG_GRID & selected_grid,
+ GCUBE_FLAG_GRID & mismatch_grid) const
 {
   const VERTEX_INDEX cubeA_index = gcubeA.cube_index;
   GRID_COORD_TYPE distance2boundary;
@@ -3877,32 +4042,28 @@ void MOD6_LIST::AddSignedPermutations
 
 // Constructor
 SELECTION_DATA::SELECTION_DATA
-(const SHARPISO_GRID & grid, const SHARP_ISOVERT_PARAM & isovert_param):
+(const SHARPISO_GRID & grid, const ISOVERT & isovert,
+ const SHARP_ISOVERT_PARAM & isovert_param):
   mismatch_table(grid)
 {
   // Initialize bin grid.
   bin_width = isovert_param.bin_width;
   init_bin_grid(grid, bin_width, bin_grid);
 
-  // Initialize covered grid and covered corner grid.
-  covered_grid.SetSize(grid);
-  corner_covered_grid.SetSize(grid);
-  covered_grid.SetAll(false);
-  corner_covered_grid.SetAll(false);
-
-  // Initialize selected grid.
-  selected_grid.SetSize(grid);
-  selected_grid.SetAll(false);
-
-  // Initialize mismatch grid.
-  mismatch_grid.SetSize(grid);
-  mismatch_grid.SetAll(false);
+  // Initialize selected, covered, corner covered and mismatch grids.
+  // All four grids share one byte per active cube, initialized to false.
+  flag_bits.Init(isovert);
+  selected_grid.SetFlagBits(grid, flag_bits, 0);
+  covered_grid.SetFlagBits(grid, flag_bits, 1);
+  corner_covered_grid.SetFlagBits(grid, flag_bits, 2);
+  mismatch_grid.SetFlagBits(grid, flag_bits, 3);
 }
 
 // Constructor
 SELECTION_DATA_MOD6::SELECTION_DATA_MOD6
-(const SHARPISO_GRID & grid, const SHARP_ISOVERT_PARAM & isovert_param):
-  SELECTION_DATA(grid, isovert_param)
+(const SHARPISO_GRID & grid, const ISOVERT & isovert,
+ const SHARP_ISOVERT_PARAM & isovert_param):
+  SELECTION_DATA(grid, isovert, isovert_param)
 {
   SetMod6Lists();
 }
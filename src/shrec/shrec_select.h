@@ -97,15 +97,15 @@ namespace SHREC {
     void SetMismatchGrid
     (const GRID_CUBE_DATA & gcubeA,
      const ISOVERT & isovert,
-     const SHARPISO_BOOL_GRID & selected_grid,
-     SHARPISO_BOOL_GRID & mismatch_grid) const;
+     const GCUBE_FLAG_GRID & selected_grid,
+     GCUBE_FLAG_GRID & mismatch_grid) const;
 
     /// Return true if (cubeA_index + entry offset) is blocked 
     ///   by some selected cube.
     /// @pre (cubeA_index + entry offset) is contained in the grid.
     bool IsBlocked
     (const NUM_TYPE ientry, const VERTEX_INDEX cubeA_index,
-     const SHARPISO_BOOL_GRID & selected_grid) const;
+     const GCUBE_FLAG_GRID & selected_grid) const;
   };
 
 
@@ -142,28 +142,54 @@ namespace SHREC {
   protected:
     int bin_width;
 
+    /// Selected, covered, corner covered and mismatch flags
+    ///   packed into one byte per active cube.
+    GCUBE_FLAG_BITS flag_bits;
+
+    /// Flag grids point into flag_bits[].  Do not copy.
+    SELECTION_DATA(const SELECTION_DATA &);
+    const SELECTION_DATA & operator =(const SELECTION_DATA &);
+
   public:
     BIN_GRID<VERTEX_INDEX> bin_grid;
-    SHARPISO_BOOL_GRID selected_grid;
+    GCUBE_FLAG_GRID selected_grid;
 
     /// covered_grid.Scalar(icube) = true if icube is covered.
-    SHARPISO_BOOL_GRID covered_grid;
+    GCUBE_FLAG_GRID covered_grid;
 
     /// corner_covered_grid.Scalar(icube) = true,
     ///   if icube is covered by a corner cube.
-    SHARPISO_BOOL_GRID corner_covered_grid;
+    GCUBE_FLAG_GRID corner_covered_grid;
 
     /// Cubes which should be avoided because of 3x3x3 region mismatches.
-    SHARPISO_BOOL_GRID mismatch_grid;
+    GCUBE_FLAG_GRID mismatch_grid;
 
     /// Table of offsets of cubes which do not match a given cube.
     MISMATCH_TABLE mismatch_table;
 
+    /// Cubes set to COVERED_POINT whose isovert positions
+    ///   may still need to be recomputed.
+    /// May contain duplicates and cubes which are no longer COVERED_POINT.
+    std::vector<NUM_TYPE> covered_point_list;
+
+    /// Storage reused when recomputing isovert positions.
+    GET_GRADIENTS_BUFFER gradients_buffer;
+
   public:
+    /// @pre isovert.gcube_list is set and does not change
+    ///   while selection data is in use.
     SELECTION_DATA
-    (const SHARPISO_GRID & grid, const SHARP_ISOVERT_PARAM & isovert_param);
+    (const SHARPISO_GRID & grid, const ISOVERT & isovert,
+     const SHARP_ISOVERT_PARAM & isovert_param);
 
     int BinWidth() const { return(bin_width); }
+
+    /// Set cube to COVERED_POINT and add it to covered_point_list.
+    void SetCoveredPoint(const NUM_TYPE gcube_index, ISOVERT & isovert)
+    {
+      isovert.gcube_list[gcube_index].flag = COVERED_POINT;
+      covered_point_list.push_back(gcube_index);
+    }
   };
 
   class SELECTION_DATA_MOD6:public SELECTION_DATA {
@@ -191,7 +217,8 @@ namespace SHREC {
 
   public:
     SELECTION_DATA_MOD6
-    (const SHARPISO_GRID & grid, const SHARP_ISOVERT_PARAM & isovert_param);
+    (const SHARPISO_GRID & grid, const ISOVERT & isovert,
+     const SHARP_ISOVERT_PARAM & isovert_param);
 
     int Modulus() const { return(6); }
 
@@ -0,0 +1,466 @@
+/// \file shrec_slab.cxx
+/// Construct isosurface from z-slabs of the grid.
+
+/*
+Copyright (C) 2012-2015 Arindam Bhattacharya and Rephael Wenger
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+(LGPL) as published by the Free Software Foundation; either
+version 2.1 of the License, or any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+
+#include <algorithm>
+
+#include "ijkisopoly.txx"
+#include "ijkmesh.txx"
+#include "ijktime.txx"
+
+#include "ijkdualtable.h"
+#include "ijkdualtable_ambig.h"
+
+#include "shrec_slab.h"
+#include "shrec_ambig.h"
+#include "shrec_select.h"
+#include "shrec_merge.h"
+#include "shrec_extract.h"
+#include "shrec_position.h"
+
+
+using namespace IJK;
+using namespace SHREC;
+
+
+namespace {
+
+  /// Upper bound on the number of isosurface vertices in a cube.
+  const int MAX_NUM_ISOV_PER_CUBE = 8;
+
+  /// Set first_gcube_isov[g] to the first isosurface vertex in gcube g.
+  void set_first_gcube_isov
+  (const ISOVERT & isovert,
+   const std::vector<SHREC::DUAL_ISOVERT> & iso_vlist,
+   std::vector<NUM_TYPE> & first_gcube_isov)
+  {
+    first_gcube_isov.assign(isovert.gcube_list.size(), 0);
+    for (NUM_TYPE i = iso_vlist.size(); i > 0; i--) {
+      const NUM_TYPE gcube_index =
+        isovert.GCubeIndex(iso_vlist[i-1].cube_index);
+      first_gcube_isov[gcube_index] = i-1;
+    }
+  }
+
+}
+
+
+// **************************************************
+// SLAB_ISOSURFACE MEMBER FUNCTIONS
+// **************************************************
+
+SLAB_ISOSURFACE::SLAB_ISOSURFACE
+(const AXIS_SIZE_TYPE * axis_size)
+{
+  num_vertices_in_layer = axis_size[0]*axis_size[1];
+}
+
+SLAB_ISOSURFACE::KEY_TYPE SLAB_ISOSURFACE::Key
+(const VERTEX_INDEX cube_index, const int ipatch) const
+{
+  return(KEY_TYPE(cube_index)*MAX_NUM_ISOV_PER_CUBE + ipatch);
+}
+
+VERTEX_INDEX SLAB_ISOSURFACE::MeshVertex
+(const SLAB_ISOV & isov, const bool flag_owner)
+{
+  std::unordered_map<KEY_TYPE, VERTEX_INDEX>::const_iterator pos =
+    mesh_vertex.find(isov.key);
+
+  if (pos != mesh_vertex.end()) {
+    const VERTEX_INDEX iv = pos->second;
+    if (flag_owner) {
+      for (int d = 0; d < DIM3; d++)
+        { vertex_coord[iv*DIM3+d] = isov.coord[d]; }
+    }
+    return(iv);
+  }
+
+  const VERTEX_INDEX iv = vertex_key.size();
+  mesh_vertex[isov.key] = iv;
+  vertex_key.push_back(isov.key);
+  for (int d = 0; d < DIM3; d++)
+    { vertex_coord.push_back(isov.coord[d]); }
+
+  return(iv);
+}
+
+void SLAB_ISOSURFACE::AddSlab
+(const SHREC_DATA & shrec_data, const SCALAR_TYPE isovalue,
+ const AXIS_SIZE_TYPE zv0,
+ const AXIS_SIZE_TYPE zc0, const AXIS_SIZE_TYPE zc1,
+ SHREC_INFO & shrec_info)
+{
+  const SHARPISO_SCALAR_GRID_BASE & scalar_grid = shrec_data.ScalarGrid();
+  const int dimension = scalar_grid.Dimension();
+  const VERTEX_INDEX offset = zv0*num_vertices_in_layer;
+  IJK::STAGE_PROFILER * stage_profiler = shrec_data.stage_profiler;
+  ISOVERT isovert;
+  WALL_TIME_POINT t0, t1, t2, t3, t4, t5;
+  IJK::ERROR error_param;
+  PROCEDURE_ERROR error("SLAB_ISOSURFACE::AddSlab");
+
+  if (!shrec_data.Check(error)) { throw error; }
+
+  if (!shrec_data.IsGradientGridSet()) {
+    error.AddMessage("Programming error.  Gradient grid is not set.");
+    throw error;
+  }
+
+  if (!can_construct_by_slabs(shrec_data, error_param)) {
+    error.AddMessage("Programming error.  Illegal parameters for slabs.");
+    throw error;
+  }
+
+  if (zc0 < zv0 || zc1 <= zc0 ||
+      zc1 > zv0 + scalar_grid.AxisSize(DIM3-1)-1) {
+    error.AddMessage
+      ("Programming error.  Illegal slab [", zc0, ",", zc1, ").");
+    throw error;
+  }
+
+  shrec_info.time.Clear();
+
+  t0 = wall_clock();
+
+  {
+    SCOPED_STAGE stage(stage_profiler, "compute_isovert");
+    compute_dual_isovert
+      (scalar_grid, shrec_data.MinMaxPyramid(), shrec_data.GradientGrid(),
+       isovalue, shrec_data, shrec_data.VertexPositionMethod(), isovert);
+  }
+
+  t1 = wall_clock();
+
+  {
+    SCOPED_STAGE stage(stage_profiler, "select");
+    select_sharp_isovert_mod6
+      (scalar_grid, shrec_data.GradientGrid(), isovalue, shrec_data,
+       isovert);
+  }
+
+  t2 = wall_clock();
+
+  if (shrec_data.flag_recompute_isovert) {
+    SCOPED_STAGE stage(stage_profiler, "recompute");
+    recompute_isovert_positions
+      (scalar_grid, shrec_data.GradientGrid(), isovalue, shrec_data, isovert);
+  }
+
+  t3 = wall_clock();
+
+  const NUM_TYPE num_gcube = isovert.gcube_list.size();
+  std::vector<IJKDUALTABLE::TABLE_INDEX> table_index(num_gcube);
+  std::vector<ISO_VERTEX_INDEX> cube_list(num_gcube);
+  std::vector<ISO_VERTEX_INDEX> isoquad_cube;
+  std::vector<FACET_VERTEX_INDEX> facet_vertex;
+  std::vector<SHREC::DUAL_ISOVERT> iso_vlist;
+  std::vector<VERTEX_INDEX> isoquad_vert;
+  std::vector<VERTEX_INDEX> merged_quad_vert;
+  std::vector<VERTEX_INDEX> gcube_map(num_gcube);
+  std::vector<NUM_TYPE> first_gcube_isov;
+  COORD_ARRAY isov_coord;
+
+  for (NUM_TYPE i = 0; i < num_gcube; i++)
+    { cube_list[i] = isovert.gcube_list[i].cube_index; }
+
+  bool flag_separate_opposite(true);
+  IJKDUALTABLE::ISODUAL_CUBE_TABLE
+    isodual_table(dimension, shrec_data.flag_separate_neg,
+                  flag_separate_opposite);
+  IJKDUALTABLE::ISODUAL_CUBE_TABLE_AMBIG_INFO ambig_info(dimension);
+
+  {
+    SCOPED_STAGE stage(stage_profiler, "extract");
+    extract_dual_isopoly
+      (scalar_grid, isovalue, isovert, shrec_data.num_threads,
+       isoquad_cube, facet_vertex, shrec_info);
+
+    map_isopoly_vert(isovert, isoquad_cube);
+  }
+
+  t4 = wall_clock();
+
+  {
+    SCOPED_STAGE stage(stage_profiler, "split");
+
+    IJK::compute_cube_isotable_index
+      (scalar_grid, isodual_table, isovalue, cube_list, table_index);
+
+    if (shrec_data.flag_split_non_manifold) {
+      int num_non_manifold_split;
+      IJK::split_non_manifold_isov_pairs
+        (scalar_grid, isodual_table, ambig_info, cube_list,
+         table_index, num_non_manifold_split);
+    }
+
+    if (shrec_data.flag_select_split) {
+      int num_1_2_change;
+      IJK::select_split_1_2_ambig
+        (scalar_grid, isodual_table, ambig_info, isovalue, cube_list,
+         table_index, num_1_2_change);
+    }
+
+    int num_split;
+    IJK::split_dual_isovert
+      (isodual_table, cube_list, table_index,
+       isoquad_cube, facet_vertex, iso_vlist, isoquad_vert, num_split);
+
+    store_table_index(table_index, isovert.gcube_list);
+  }
+
+  {
+    SCOPED_STAGE stage(stage_profiler, "merge");
+
+    // Merging overwrites merged_quad_vert.
+    // Slab quadrilaterals are mapped below using gcube_map.
+    merged_quad_vert = isoquad_vert;
+    merge_sharp_iso_vertices_multi
+      (scalar_grid, isodual_table, ambig_info, isovalue, iso_vlist,
+       isovert, shrec_data, merged_quad_vert, gcube_map,
+       shrec_info.sharpiso);
+  }
+
+  SCOPED_STAGE stage(stage_profiler, "position");
+
+  if (shrec_data.flag_recompute_using_adjacent)
+    { recompute_using_adjacent(scalar_grid, isovert); }
+
+  position_merged_dual_isovertices_multi
+    (scalar_grid, isodual_table, isovalue, isovert,
+     iso_vlist, isov_coord);
+
+  set_first_gcube_isov(isovert, iso_vlist, first_gcube_isov);
+
+  // Merged isosurface vertex of isosurface vertex k.
+  auto merged_isov =
+    [&](const NUM_TYPE k, SLAB_ISOV & isov)
+    {
+      const NUM_TYPE gcube_index0 =
+        isovert.GCubeIndex(iso_vlist[k].cube_index);
+      const NUM_TYPE gcube_index1 = gcube_map[gcube_index0];
+      NUM_TYPE k1 = k;
+      if (gcube_index0 != gcube_index1 ||
+          isovert.gcube_list[gcube_index1].flag == SELECTED_GCUBE)
+        { k1 = first_gcube_isov[gcube_index1]; }
+
+      isov.key = Key(iso_vlist[k1].cube_index+offset,
+                     iso_vlist[k1].patch_index);
+      for (int d = 0; d < DIM3; d++)
+        { isov.coord[d] = isov_coord[k1*DIM3+d]; }
+    };
+
+  // Return true if this slab owns the cube of isosurface vertex isov.
+  auto is_owner =
+    [&](const SLAB_ISOV & isov)
+    {
+      const AXIS_SIZE_TYPE z = CubeZ(isov.key/MAX_NUM_ISOV_PER_CUBE);
+      return(zc0 <= z && z < zc1);
+    };
+
+  // Add quadrilaterals dual to grid edges with lower endpoints
+  //   in cube layers [zc0,zc1).
+  for (size_t iq = 0; iq+NUM_VERT_PER_QUAD <= isoquad_vert.size();
+       iq += NUM_VERT_PER_QUAD) {
+
+    AXIS_SIZE_TYPE zmax = 0;
+    for (int j = 0; j < NUM_VERT_PER_QUAD; j++) {
+      const NUM_TYPE k = isoquad_vert[iq+j];
+      const AXIS_SIZE_TYPE z = CubeZ(iso_vlist[k].cube_index+offset);
+      zmax = std::max(zmax, z);
+    }
+
+    if (zmax < zc0 || zmax >= zc1) { continue; }
+
+    VERTEX_INDEX mesh_quad_vert[NUM_VERT_PER_QUAD];
+    for (int j = 0; j < NUM_VERT_PER_QUAD; j++) {
+      const NUM_TYPE k = isoquad_vert[iq+j];
+      const VERTEX_INDEX cube_index = iso_vlist[k].cube_index+offset;
+      SLAB_ISOV isov;
+
+      if (CubeZ(cube_index) < zc0) {
+        // Isosurface vertex belongs to previous slab.
+        std::unordered_map<KEY_TYPE, SLAB_ISOV>::const_iterator pos =
+          top_layer_isov.find(Key(cube_index, iso_vlist[k].patch_index));
+
+        if (pos == top_layer_isov.end()) {
+          error.AddMessage
+            ("Programming error.  Isosurface vertex in cube ", cube_index,
+             " is missing from previous slab.");
+          throw error;
+        }
+        isov = pos->second;
+      }
+      else
+        { merged_isov(k, isov); }
+
+      mesh_quad_vert[j] = MeshVertex(isov, is_owner(isov));
+    }
+
+    IJK::get_non_degenerate_quad_btlr(mesh_quad_vert, tri_vert, quad_vert);
+  }
+
+  // Store merged isosurface vertices in top cube layer.
+  top_layer_isov.clear();
+  for (size_t k = 0; k < iso_vlist.size(); k++) {
+    const VERTEX_INDEX cube_index = iso_vlist[k].cube_index+offset;
+    if (CubeZ(cube_index)+1 == zc1) {
+      SLAB_ISOV isov;
+      merged_isov(k, isov);
+      top_layer_isov[Key(cube_index, iso_vlist[k].patch_index)] = isov;
+    }
+  }
+
+  t5 = wall_clock();
+
+  // store times
+  clock2seconds(t1-t0+t3-t2, shrec_info.time.position);
+  clock2seconds(t4-t3, shrec_info.time.extract);
+  clock2seconds(t2-t1+t5-t4, shrec_info.time.merge_sharp);
+  clock2seconds(t5-t0, shrec_info.time.total);
+}
+
+void SLAB_ISOSURFACE::GetMesh(DUAL_ISOSURFACE & mesh) const
+{
+  const VERTEX_INDEX num_vertices = vertex_key.size();
+  std::vector<VERTEX_INDEX> sorted_vertex(num_vertices);
+  std::vector<VERTEX_INDEX> new_index(num_vertices);
+
+  for (VERTEX_INDEX iv = 0; iv < num_vertices; iv++)
+    { sorted_vertex[iv] = iv; }
+
+  std::sort(sorted_vertex.begin(), sorted_vertex.end(),
+            [&](const VERTEX_INDEX iv0, const VERTEX_INDEX iv1)
+            { return(vertex_key[iv0] < vertex_key[iv1]); });
+
+  mesh.Clear();
+  mesh.vertex_coord.resize(num_vertices*DIM3);
+  for (VERTEX_INDEX i = 0; i < num_vertices; i++) {
+    const VERTEX_INDEX iv = sorted_vertex[i];
+    new_index[iv] = i;
+    for (int d = 0; d < DIM3; d++)
+      { mesh.vertex_coord[i*DIM3+d] = vertex_coord[iv*DIM3+d]; }
+  }
+
+  mesh.tri_vert.resize(tri_vert.size());
+  for (size_t i = 0; i < tri_vert.size(); i++)
+    { mesh.tri_vert[i] = new_index[tri_vert[i]]; }
+
+  mesh.quad_vert.resize(quad_vert.size());
+  for (size_t i = 0; i < quad_vert.size(); i++)
+    { mesh.quad_vert[i] = new_index[quad_vert[i]]; }
+}
+
+
+// **************************************************
+// SLAB ROUTINES
+// **************************************************
+
+AXIS_SIZE_TYPE SHREC::get_slab_alignment(const int bin_width)
+{
+  AXIS_SIZE_TYPE alignment = 6;
+  if (bin_width > 1) {
+    while (alignment%bin_width != 0)
+      { alignment += 6; }
+  }
+
+  return(alignment);
+}
+
+void SHREC::get_slab_vertex_layers
+(const AXIS_SIZE_TYPE zc0, const AXIS_SIZE_TYPE zc1,
+ const AXIS_SIZE_TYPE halo, const AXIS_SIZE_TYPE alignment,
+ const AXIS_SIZE_TYPE num_cube_layers,
+ AXIS_SIZE_TYPE & zv0, AXIS_SIZE_TYPE & zv1)
+{
+  zv0 = (zc0 > halo) ? zc0-halo : 0;
+  zv0 = zv0 - (zv0%alignment);
+  zv1 = std::min(zc1+halo, num_cube_layers);
+}
+
+// Minimum halo is one period of the mod 6 selection pattern
+//   plus the two cube layers reached by merging.
+// Cube selection depends on selections in the preceding cubes
+//   of the mod 6 pattern.  Merging maps isosurface vertices
+//   to selected cubes up to two cubes away.
+AXIS_SIZE_TYPE SHREC::get_min_slab_halo()
+{
+  return(6+2);
+}
+
+bool SHREC::check_slab_size
+(const AXIS_SIZE_TYPE slab_thickness, const AXIS_SIZE_TYPE slab_halo,
+ IJK::ERROR & error)
+{
+  // Slab cube layers start and end at the same position
+  //   in the mod 6 selection pattern.
+  if (slab_thickness == 0 || slab_thickness%6 != 0) {
+    error.AddMessage
+      ("Slab thickness ", slab_thickness, " is not a positive multiple of 6.");
+    return(false);
+  }
+
+  if (slab_halo < get_min_slab_halo()) {
+    error.AddMessage
+      ("Slab halo ", slab_halo, " is less than ", get_min_slab_halo(), ".");
+    error.AddMessage
+      ("  Halo must cover the mod 6 selection pattern and merging.");
+    return(false);
+  }
+
+  return(true);
+}
+
+bool SHREC::can_construct_by_slabs
+(const SHREC_PARAM & shrec_param, IJK::ERROR & error)
+{
+  const VERTEX_POSITION_METHOD position_method =
+    shrec_param.VertexPositionMethod();
+
+  if (position_method != GRADIENT_POSITIONING &&
+      position_method != EDGEI_INTERPOLATE &&
+      position_method != EDGEI_GRADIENT) {
+    error.AddMessage
+      ("Slabs require vertex positioning from gradients.");
+    return(false);
+  }
+
+  if (shrec_param.flag_grad2hermite || shrec_param.flag_grad2hermiteI) {
+    error.AddMessage("Slabs do not support conversion to hermite data.");
+    return(false);
+  }
+
+  if (!shrec_param.flag_merge || !shrec_param.allow_multiple_iso_vertices) {
+    error.AddMessage
+      ("Slabs require merging with multiple isosurface vertices per cube.");
+    return(false);
+  }
+
+  if (!shrec_param.flag_select_mod6) {
+    error.AddMessage
+      ("Slabs require mod 6 vertex selection (default).");
+    error.AddMessage
+      ("  Slabs do not support -select_mod3 or -select_by_dist.");
+    return(false);
+  }
+
+  return(true);
+}
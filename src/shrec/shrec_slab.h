@@ -0,0 +1,155 @@
+/// \file shrec_slab.h
+/// Construct isosurface from z-slabs of the grid.
+
+/*
+Copyright (C) 2012-2015 Arindam Bhattacharya and Rephael Wenger
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+(LGPL) as published by the Free Software Foundation; either
+version 2.1 of the License, or any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef _SHREC_SLAB_H_
+#define _SHREC_SLAB_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "shrec_types.h"
+#include "shrec_datastruct.h"
+#include "shrec_isovert.h"
+
+namespace SHREC {
+
+  // **************************************************
+  // SLAB ISOSURFACE
+  // **************************************************
+
+  /// Isosurface constructed from overlapping z-slabs of the grid.
+  /// Each slab owns cube layers [zc0,zc1) and contains cube layers
+  ///   [zv0,zv1) where zv0 < zc0 (if zc0 > 0) and zc1 <= zv1.
+  /// Slabs are added in increasing z order.
+  /// - Each slab selects and merges all the cubes in [zv0,zv1).
+  ///   With halos of at least get_min_slab_halo() cube layers,
+  ///   the decisions on the cubes in [zc0,zc1) are the same
+  ///   as the decisions on the full grid.
+  /// - Each dual quadrilateral belongs to the slab which owns the
+  ///   lower endpoint of its dual grid edge.
+  /// - Isosurface vertices are identified by global cube index
+  ///   and isosurface patch.  Vertex coordinates are global
+  ///   and are set by the slab which owns the vertex cube.
+  class SLAB_ISOSURFACE {
+
+  protected:
+    typedef long long KEY_TYPE;
+
+    /// Merged isosurface vertex and its coordinates.
+    class SLAB_ISOV {
+    public:
+      KEY_TYPE key;
+      COORD_TYPE coord[DIM3];
+    };
+
+    /// Number of grid vertices in each z layer.
+    VERTEX_INDEX num_vertices_in_layer;
+
+    /// Merged isosurface vertex of each isosurface vertex
+    ///   in the top cube layer of the previous slab.
+    std::unordered_map<KEY_TYPE, SLAB_ISOV> top_layer_isov;
+
+    /// Mesh vertex with a given key.
+    std::unordered_map<KEY_TYPE, VERTEX_INDEX> mesh_vertex;
+
+    std::vector<KEY_TYPE> vertex_key;    ///< Key of each mesh vertex.
+    COORD_ARRAY vertex_coord;            ///< Mesh vertex coordinates.
+    VERTEX_INDEX_ARRAY tri_vert;         ///< Mesh triangle vertices.
+    VERTEX_INDEX_ARRAY quad_vert;        ///< Mesh quadrilateral vertices.
+
+    /// Return key of isosurface vertex in patch ipatch of cube cube_index.
+    KEY_TYPE Key(const VERTEX_INDEX cube_index, const int ipatch) const;
+
+    /// Return z-coordinate of cube cube_index.
+    AXIS_SIZE_TYPE CubeZ(const VERTEX_INDEX cube_index) const
+    { return(cube_index/num_vertices_in_layer); }
+
+    /// Return mesh vertex with key isov.key.  Add vertex if none exists.
+    /// @param flag_owner If true, replace coordinates of existing vertex
+    ///   with isov.coord.
+    VERTEX_INDEX MeshVertex(const SLAB_ISOV & isov, const bool flag_owner);
+
+  public:
+    /// Constructor.
+    /// @param axis_size Axis sizes of full grid.
+    SLAB_ISOSURFACE(const AXIS_SIZE_TYPE * axis_size);
+
+    /// Add isosurface of slab.
+    /// @param shrec_data Scalar and gradient grids of the slab.
+    ///   Grid coordinate offsets are (0,0,zv0).
+    /// @param zv0 Global z-coordinate of lowest slab grid vertex.
+    /// @param zc0 Slab owns cubes with global z-coordinates in [zc0,zc1).
+    /// @pre Slab contains cube layers [zc0-1,zc1) if zc0 > 0
+    ///   and cube layers [0,zc1) if zc0 == 0.
+    /// @pre zc0 equals zc1 of previous slab.
+    void AddSlab
+    (const SHREC_DATA & shrec_data, const SCALAR_TYPE isovalue,
+     const AXIS_SIZE_TYPE zv0,
+     const AXIS_SIZE_TYPE zc0, const AXIS_SIZE_TYPE zc1,
+     SHREC_INFO & shrec_info);
+
+    /// Get mesh of all slabs added so far.
+    /// Mesh vertices are sorted by cube index and isosurface patch.
+    void GetMesh(DUAL_ISOSURFACE & mesh) const;
+  };
+
+
+  // **************************************************
+  // SLAB ROUTINES
+  // **************************************************
+
+  /// Return alignment of slab z-coordinates.
+  /// Vertex selection cycles through mod 3 and mod 6 patterns
+  ///   and bins cubes in blocks of bin_width.
+  /// Slabs starting at multiples of the alignment see
+  ///   the same patterns and bins as the full grid.
+  AXIS_SIZE_TYPE get_slab_alignment(const int bin_width);
+
+  /// Get grid vertex layers [zv0,zv1] of slab owning cube layers [zc0,zc1).
+  /// Slab contains halo cube layers below zc0 and above zc1.
+  /// @param num_cube_layers Number of cube layers in full grid.
+  /// @pre halo >= get_min_slab_halo().
+  void get_slab_vertex_layers
+  (const AXIS_SIZE_TYPE zc0, const AXIS_SIZE_TYPE zc1,
+   const AXIS_SIZE_TYPE halo, const AXIS_SIZE_TYPE alignment,
+   const AXIS_SIZE_TYPE num_cube_layers,
+   AXIS_SIZE_TYPE & zv0, AXIS_SIZE_TYPE & zv1);
+
+  /// Return minimum number of halo cube layers on each side of a slab.
+  AXIS_SIZE_TYPE get_min_slab_halo();
+
+  /// Return true if slabs of slab_thickness cube layers with
+  ///   slab_halo halo cube layers give the same isosurface
+  ///   as the full grid.
+  /// Slab thickness must be a multiple of the mod 6 selection pattern.
+  /// Halo must be at least get_min_slab_halo().
+  bool check_slab_size
+  (const AXIS_SIZE_TYPE slab_thickness, const AXIS_SIZE_TYPE slab_halo,
+   IJK::ERROR & error);
+
+  /// Return true if isosurface with parameters shrec_param
+  ///   can be constructed from slabs.
+  bool can_construct_by_slabs
+  (const SHREC_PARAM & shrec_param, IJK::ERROR & error);
+
+}
+
+#endif
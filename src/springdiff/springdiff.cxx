@@ -21,8 +21,10 @@
  Foundation, Inc., 89 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include <iomanip>
 #include "springdiff.h"
+#include "ijkgradient.txx"
 #include "ijkscalar_grid.txx"
 #include "sharpiso_scalar.txx"
 
@@ -42,15 +44,12 @@ namespace {
 };
 
 // local routines
-void compute_gradient_central_difference
+static void compute_gradient_central_difference
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const VERTEX_INDEX iv1, GRADIENT_COORD_TYPE * gradient);
-void compute_boundary_gradient
+static void compute_boundary_gradient
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
  const VERTEX_INDEX iv1, GRADIENT_COORD_TYPE * gradient);
-// Calculate vector magnitude.
-void vector_magnitude 
-(const float * vec, const int num_elements, float & mag);
 
 
 void compute_gradient_central_difference
@@ -123,21 +122,16 @@ void compute_boundary_gradient
 // computes the distance between the the vertex iv and v;
 void compute_dist_for_v
 (const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
- const GRADIENT_GRID & gradient_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
  const VERTEX_INDEX iv, 
  const VERTEX_INDEX u,
  float & distance
  ){
   const GRADIENT_COORD_TYPE * grad_u = gradient_grid.VectorPtrConst(u);
-  const GRADIENT_COORD_TYPE * grad_iv = gradient_grid.VectorPtrConst(iv);
   GRID_COORD_TYPE coord_u[DIM3], coord_iv[DIM3];
   scalar_grid.ComputeCoord(u, coord_u);
   scalar_grid.ComputeCoord(iv, coord_iv);
   
-  float mag_u={0.0};
-  float mag_v={0.0};
-  vector_magnitude (grad_u, DIM3,  mag_u);
-  vector_magnitude (grad_u, DIM3,  mag_v);
   compute_distance_to_gfield_plane
   (grad_u, coord_u, scalar_grid.Scalar(u), coord_iv, scalar_grid.Scalar(iv), distance);
 
@@ -160,7 +154,7 @@ void f
 // Upgrade the gdiff based on the calculated distance
 void update_gdiff 
 (
- const GRADIENT_GRID & gradient_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
  const float dist,
  const float lambda,
  const float mu,
@@ -178,88 +172,87 @@ void update_gdiff
   }
 }
 
-// Function to update all the gradients from the temporary gradient_grid
-// to the original gradient grid.
-void update_all_gradients
-( GRADIENT_GRID & temp_gradient_grid,
- GRADIENT_GRID & gradient_grid)
+// Compute spring diffusion of the gradient at vertex iv.
+// Read gradients from gradient_grid.
+// @pre iv is not a boundary vertex.
+void spring_diffusion_per_vertex
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const float lambda,
+ const float mu,
+ const VERTEX_INDEX iv,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ GRADIENT_COORD_TYPE new_grad[DIM3])
 {
-  // Copy temp_gradient_grid to gradient_grid.
-  for (int l=0; l<gradient_grid.NumVertices(); l++) {
-    GRADIENT_COORD_TYPE * grad = temp_gradient_grid.VectorPtr(l);
-    gradient_grid.Set(l, grad);
+  float distance=0.0;
+  GRADIENT_COORD_TYPE gdiff[DIM3]={0.0};
+  const GRADIENT_COORD_TYPE * grad_iv = gradient_grid.VectorPtrConst(iv);
+
+  for (int d=0; d<DIM3; d++) {
+    // prev vertices to v
+    VERTEX_INDEX prev = scalar_grid.PrevVertex(iv, d);
+    if(gradient_grid.ComputeMagnitudeSquared(prev) > EPSILON){
+      compute_dist_for_v(scalar_grid, gradient_grid, iv, prev, distance);
+      update_gdiff(gradient_grid, distance, lambda, mu, prev, iv, gdiff);
+    }
+    // next vertices to iv
+    VERTEX_INDEX next = scalar_grid.NextVertex(iv, d);
+    if(gradient_grid.ComputeMagnitudeSquared(next) > EPSILON){
+      compute_dist_for_v(scalar_grid, gradient_grid, iv, next, distance);
+      update_gdiff(gradient_grid, distance, lambda, mu, next, iv, gdiff);
+    }
+  }
+
+  // update the gradients of iv based on the weights
+  for (int d=0; d<DIM3; d++) {
+    new_grad[d] = grad_iv[d] + gdiff[d];
   }
 }
+
 // main function for computing spring based diffusion
+// Each iteration reads gradient_grid and writes a second grid.
+// The two grids swap roles after each iteration,
+//   so vertices can be processed in parallel.
 void compute_spring_diffusion
 (const SHARPISO_SCALAR_GRID_BASE &scalar_grid,
  const int num_iter,
  const float lambda,
  const float mu,
+ const int num_threads,
  GRADIENT_GRID & gradient_grid){
   
   GRADIENT_GRID temp_gradient_grid;
   const int dimension = scalar_grid.Dimension();
   temp_gradient_grid.SetSize(scalar_grid, dimension);
-  
-  BOOL_GRID boundary_grid;
-  boundary_grid.SetSize(scalar_grid);
-  compute_boundary_grid(boundary_grid);
-  
-  float distance=0.0;
+
+  GRADIENT_GRID * grad_grid = &gradient_grid;
+  GRADIENT_GRID * new_grad_grid = &temp_gradient_grid;
+
   for (int i=0; i<num_iter; i++) {
-    for (VERTEX_INDEX iv = 0; iv < scalar_grid.NumVertices(); iv++){
-      
-      if (boundary_grid.Scalar(iv)) {
-        compute_boundary_gradient(scalar_grid, iv, temp_gradient_grid.VectorPtr(iv));
-      }
-      else {
-        
-        COORD_TYPE coord[DIM3]={0.0};
-        scalar_grid.ComputeCoord(iv, coord);
-        GRADIENT_COORD_TYPE gdiff[DIM3]={0.0};
-        GRADIENT_COORD_TYPE * grad_iv = gradient_grid.VectorPtr(iv);
-        
-          for (int d=0; d<DIM3; d++) {
-            // prev vertices to v
-            VERTEX_INDEX prev = scalar_grid.PrevVertex(iv, d);
-            if(gradient_grid.ComputeMagnitudeSquared(prev) > EPSILON){
-            compute_dist_for_v(scalar_grid, gradient_grid, iv, prev, distance);
-            update_gdiff(gradient_grid, distance, lambda, mu, prev, iv, gdiff);
-            }
-            // next vertices to iv
 
-            VERTEX_INDEX next = scalar_grid.NextVertex(iv, d);
-            if(gradient_grid.ComputeMagnitudeSquared(next) > EPSILON){
-            compute_dist_for_v(scalar_grid, gradient_grid, iv, next, distance);
-            update_gdiff(gradient_grid, distance, lambda, mu, next, iv, gdiff);
-            }
+    // Boundary gradients are the same in every iteration.
+    // Set them once in each of the two grids.
+    const bool flag_set_boundary = (i < 2);
+    const GRADIENT_GRID & grid_in = *grad_grid;
+    GRADIENT_GRID & grid_out = *new_grad_grid;
+
+    IJK::for_each_vertex_3D_in_parallel
+      (scalar_grid, num_threads,
+       [&](const VERTEX_INDEX iv, const bool is_boundary) {
+        if (is_boundary) {
+          if (flag_set_boundary) {
+            compute_boundary_gradient
+              (scalar_grid, iv, grid_out.VectorPtr(iv));
           }
-        
-        GRADIENT_COORD_TYPE temp_grad[DIM3]={0.0};
-        // update the gradients of iv based on the weights
-        for (int d=0; d<DIM3; d++) {
-          temp_grad[d] = grad_iv[d] + gdiff[d];
         }
-        temp_gradient_grid.Set(iv, temp_grad);
-      }
-    }
-    //update all gradients
-    update_all_gradients(temp_gradient_grid, gradient_grid);
-  }
-};
-
+        else {
+          spring_diffusion_per_vertex
+            (scalar_grid, lambda, mu, iv, grid_in, grid_out.VectorPtr(iv));
+        }
+      });
 
-//local routines 
-// Calculate vector magnitude.
-void vector_magnitude (const float * vec, const int num_elements, float & mag)
-{
-  float sum = 0.0;
-  mag = 0.0;
-  for (int i=0; i<num_elements; i++) {
-    sum = sum + vec[i]*vec[i];
+    std::swap(grad_grid, new_grad_grid);
   }
-  mag = sqrt(sum);
-}
-
 
+  if (grad_grid != &gradient_grid)
+    { gradient_grid.CopyVector(*grad_grid); }
+};
@@ -35,6 +35,7 @@ void compute_spring_diffusion
  const int num_iter,
  const float lambda,
  const float mu,
+ const int num_threads,
  SHARPISO::GRADIENT_GRID & gradient_grid);
 
 
@@ -0,0 +1,57 @@
+/// \file springdiff_info.h
+/// Input information for springdiff.
+
+/*
+  IJK: Isosurface Jeneration Kode
+  Copyright (C) 2011 Rephael Wenger
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef _SPRINGDIFF_INFO_
+#define _SPRINGDIFF_INFO_
+
+#include <iostream>
+
+/// Spring diffusion parameters read from the command line.
+class INPUT_INFO {
+public:
+	int num_iteration;   // number of diffusion iterations
+	float lambda;
+	float mu;
+
+	INPUT_INFO() { set_defaults(); }
+
+	// Set the default values.
+	void set_defaults() {
+		num_iteration = 20;
+		lambda = 0.25;
+		mu = 0.1;
+	}
+
+	// Print input parameters.
+	void print_input_info() const {
+		std::cout << "num_iter: " << num_iteration
+		          << "  lambda: " << lambda
+		          << "  mu: " << mu << std::endl;
+	}
+};
+
+class INFO {
+public:
+	INPUT_INFO in_info;
+};
+
+#endif
@@ -44,6 +44,7 @@ bool flag_gzip = false;
 int num_iter=20;
 float lambda = 0.25;
 float mu = 0.1;
+int num_threads = 0;      // 0: Use all hardware threads.
 
 
 using namespace std;
@@ -83,7 +84,8 @@ int main(int argc, char **argv)
 		// compute the central difference
 		compute_gradient_central_difference(full_scalar_grid, gradient_grid);
 		// compute the spring diffusion
-		compute_spring_diffusion(full_scalar_grid, num_iter, lambda, mu, gradient_grid);
+		compute_spring_diffusion
+		(full_scalar_grid, num_iter, lambda, mu, num_threads, gradient_grid);
 
 
 		if (flag_gzip) {
@@ -161,6 +163,13 @@ void parse_command_line(int argc, char **argv, INFO &inf)
 			sscanf(argv[iarg], "%f", &mu);
 			inf.in_info.mu=atof(argv[iarg]);
 		}
+		else if (string(argv[iarg]) == "-num_threads")
+		{
+			iarg++;
+			if (iarg >= argc) { usage_error(); };
+			num_threads = atoi(argv[iarg]);
+			if (num_threads < 0) { usage_error(); };
+		}
 		else
 		{ usage_error(); }
 		iarg++;
@@ -178,7 +187,8 @@ void usage_msg()
 	cerr <<"options: "<<endl;
 	cerr <<"\t\t-num_iter <n>  number of iterations."<<endl;
 	cerr <<"\t\t-lambda <f>"<<endl;
-	cerr<<"\t\t-mu <f>\n" << endl;
+	cerr<<"\t\t-mu <f>"<<endl;
+	cerr<<"\t\t-num_threads <n>  number of threads. (Default: all hardware threads.)\n" << endl;
 }
 
 void usage_error()
@@ -0,0 +1,339 @@
+// Compare time of symmetric 3x3 eigen decomposition
+//   and Eigen JacobiSVD in computing sharp points.
+// Compare time of computing sharp points one cube at a time
+//   and in batches (LINDSTROM_BATCH).
+// Matrices are constructed from gradients read from a gradient nrrd file.
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "ijkcoord.txx"
+#include "ijkgrid_macros.h"
+#include "ijkgrid_nrrd.txx"
+#include "ijktime.txx"
+
+#include "sharpiso_grids.h"
+#include "sharpiso_svd.h"
+
+using namespace std;
+using namespace IJK;
+using namespace SHARPISO;
+
+// global variables
+char * gradient_filename = NULL;
+int num_repeat = 10;
+int batch_size = 256;
+EIGENVALUE_TYPE max_small_eigenvalue = 0.1;
+GRADIENT_COORD_TYPE max_small_magnitude = 0.001;
+
+// routines
+void read_gradient_nrrd
+(const char * input_filename, GRADIENT_GRID & gradient_grid);
+void set_matrices
+(const GRADIENT_GRID & gradient_grid,
+ std::vector<COORD_TYPE> & A_list, std::vector<COORD_TYPE> & B_list,
+ std::vector<COORD_TYPE> & pointX_list,
+ std::vector<NUM_TYPE> & first_vert,
+ std::vector<COORD_TYPE> & vert_coord,
+ std::vector<GRADIENT_COORD_TYPE> & vert_grad,
+ std::vector<SCALAR_TYPE> & vert_scalar);
+void time_batch
+(const std::vector<COORD_TYPE> & pointX_list,
+ const std::vector<NUM_TYPE> & first_vert,
+ const std::vector<COORD_TYPE> & vert_coord,
+ const std::vector<GRADIENT_COORD_TYPE> & vert_grad,
+ const std::vector<SCALAR_TYPE> & vert_scalar);
+void usage_error();
+void parse_command_line(int argc, char **argv);
+
+
+int main(int argc, char ** argv)
+{
+  GRADIENT_GRID gradient_grid;
+  vector<COORD_TYPE> A_list, B_list, pointX_list;
+  vector<NUM_TYPE> first_vert;
+  vector<COORD_TYPE> vert_coord;
+  vector<GRADIENT_COORD_TYPE> vert_grad;
+  vector<SCALAR_TYPE> vert_scalar;
+  clock_t t0, t1;
+  float seconds_jacobi, seconds_symmetric;
+
+  try {
+
+    parse_command_line(argc, argv);
+
+    read_gradient_nrrd(gradient_filename, gradient_grid);
+    set_matrices(gradient_grid, A_list, B_list, pointX_list,
+                 first_vert, vert_coord, vert_grad, vert_scalar);
+
+    const NUM_TYPE num_matrices = B_list.size()/DIM3;
+    vector<COORD_TYPE> coord_jacobi(DIM3*num_matrices);
+    vector<COORD_TYPE> coord_symmetric(DIM3*num_matrices);
+    vector<NUM_TYPE> num_large_jacobi(num_matrices);
+    vector<NUM_TYPE> num_large_symmetric(num_matrices);
+
+    cout << "Number of matrices: " << num_matrices << endl;
+    if (num_matrices == 0) { return 0; }
+
+    t0 = clock();
+    for (int k = 0; k < num_repeat; k++) {
+      for (NUM_TYPE i = 0; i < num_matrices; i++) {
+        EIGENVALUE_TYPE eigenvalues[DIM3];
+        COORD_TYPE edge_dir[DIM3], orth_dir[DIM3];
+        compute_sharp_point_lindstrom_3x3_jacobi
+          (&(A_list[i*DIM3*DIM3]), &(B_list[i*DIM3]), max_small_eigenvalue,
+           &(pointX_list[i*DIM3]), num_large_jacobi[i], eigenvalues,
+           &(coord_jacobi[i*DIM3]), edge_dir, orth_dir);
+      }
+    }
+    t1 = clock();
+    clock2seconds(t1-t0, seconds_jacobi);
+
+    t0 = clock();
+    for (int k = 0; k < num_repeat; k++) {
+      for (NUM_TYPE i = 0; i < num_matrices; i++) {
+        EIGENVALUE_TYPE eigenvalues[DIM3];
+        COORD_TYPE edge_dir[DIM3], orth_dir[DIM3];
+        compute_sharp_point_lindstrom_3x3
+          (&(A_list[i*DIM3*DIM3]), &(B_list[i*DIM3]), max_small_eigenvalue,
+           &(pointX_list[i*DIM3]), num_large_symmetric[i], eigenvalues,
+           &(coord_symmetric[i*DIM3]), edge_dir, orth_dir);
+      }
+    }
+    t1 = clock();
+    clock2seconds(t1-t0, seconds_symmetric);
+
+    NUM_TYPE num_mismatch = 0;
+    COORD_TYPE max_diff = 0;
+    for (NUM_TYPE i = 0; i < num_matrices; i++) {
+      if (num_large_jacobi[i] != num_large_symmetric[i])
+        { num_mismatch++; }
+      else {
+        for (int d = 0; d < DIM3; d++) {
+          COORD_TYPE diff =
+            std::abs(coord_jacobi[i*DIM3+d] - coord_symmetric[i*DIM3+d]);
+          if (diff > max_diff) { max_diff = diff; }
+        }
+      }
+    }
+
+    cout << "JacobiSVD time (sec): " << seconds_jacobi << endl;
+    cout << "Symmetric eigen time (sec): " << seconds_symmetric << endl;
+    if (seconds_symmetric > 0) {
+      cout << "Speedup: " << seconds_jacobi/seconds_symmetric << endl;
+    }
+    cout << "Number of mismatched num_large_eigenvalues: "
+         << num_mismatch << endl;
+    cout << "Max coordinate difference: " << max_diff << endl;
+
+    time_batch(pointX_list, first_vert, vert_coord, vert_grad, vert_scalar);
+  }
+  catch (ERROR error) {
+    if (error.NumMessages() == 0) {
+      cerr << "Unknown error." << endl;
+    }
+    else { error.Print(cerr); }
+    cerr << "Exiting." << endl;
+    exit(30);
+  }
+
+  return 0;
+}
+
+void read_gradient_nrrd
+(const char * input_filename, GRADIENT_GRID & gradient_grid)
+{
+  IJK::PROCEDURE_ERROR error("read_gradient_nrrd");
+  GRID_NRRD_IN<int,AXIS_SIZE_TYPE> nrrd_in_gradient;
+  NRRD_DATA<int,AXIS_SIZE_TYPE> nrrd_header;
+
+  nrrd_in_gradient.ReadVectorGrid
+    (input_filename, gradient_grid, nrrd_header, error);
+  if (nrrd_in_gradient.ReadFailed()) { throw error; }
+}
+
+// Set matrices A and vectors B using gradients at cube vertices.
+// Each isosurface plane passes through its grid vertex.
+// Store cube vertex coordinates, gradients and scalars 
+//   of cube i at locations first_vert[i] to first_vert[i+1]-1.
+void set_matrices
+(const GRADIENT_GRID & gradient_grid,
+ std::vector<COORD_TYPE> & A_list, std::vector<COORD_TYPE> & B_list,
+ std::vector<COORD_TYPE> & pointX_list,
+ std::vector<NUM_TYPE> & first_vert,
+ std::vector<COORD_TYPE> & vert_coord,
+ std::vector<GRADIENT_COORD_TYPE> & vert_grad,
+ std::vector<SCALAR_TYPE> & vert_scalar)
+{
+  const GRADIENT_COORD_TYPE max_small_mag_squared =
+    max_small_magnitude*max_small_magnitude;
+  const SCALAR_TYPE isovalue = 0;
+  std::vector<COORD_TYPE> point_coord;
+  std::vector<GRADIENT_COORD_TYPE> gradient_coord;
+  std::vector<SCALAR_TYPE> scalar;
+  COORD_TYPE A[DIM3*DIM3], B[DIM3], pointX[DIM3];
+
+  if (gradient_grid.Dimension() != DIM3) {
+    cerr << "Gradient grid must have dimension 3." << endl;
+    exit(20);
+  }
+
+  IJK_FOR_EACH_GRID_CUBE(icube, gradient_grid, VERTEX_INDEX) {
+
+    point_coord.clear();
+    gradient_coord.clear();
+    scalar.clear();
+
+    for (NUM_TYPE k = 0; k < gradient_grid.NumCubeVertices(); k++) {
+      const VERTEX_INDEX iv = gradient_grid.CubeVertex(icube, k);
+      if (gradient_grid.ComputeMagnitudeSquared(iv) > max_small_mag_squared) {
+        COORD_TYPE coord[DIM3];
+        gradient_grid.ComputeCoord(iv, coord);
+        for (int d = 0; d < DIM3; d++) {
+          point_coord.push_back(coord[d]);
+          gradient_coord.push_back(gradient_grid.Vector(iv, d));
+        }
+        scalar.push_back(isovalue);
+      }
+    }
+
+    if (scalar.size() == 0) { continue; }
+
+    compute_A_B(scalar.size(), max_small_eigenvalue, isovalue,
+                &(scalar[0]), &(point_coord[0]), &(gradient_coord[0]), A, B);
+    gradient_grid.ComputeCubeCenterCoord(icube, pointX);
+
+    A_list.insert(A_list.end(), A, A+DIM3*DIM3);
+    B_list.insert(B_list.end(), B, B+DIM3);
+    pointX_list.insert(pointX_list.end(), pointX, pointX+DIM3);
+
+    first_vert.push_back(vert_scalar.size());
+    vert_coord.insert(vert_coord.end(), point_coord.begin(), point_coord.end());
+    vert_grad.insert
+      (vert_grad.end(), gradient_coord.begin(), gradient_coord.end());
+    vert_scalar.insert(vert_scalar.end(), scalar.begin(), scalar.end());
+  }
+
+  first_vert.push_back(vert_scalar.size());
+}
+
+// Compare time computing sharp points one cube at a time
+//   and in batches.
+void time_batch
+(const std::vector<COORD_TYPE> & pointX_list,
+ const std::vector<NUM_TYPE> & first_vert,
+ const std::vector<COORD_TYPE> & vert_coord,
+ const std::vector<GRADIENT_COORD_TYPE> & vert_grad,
+ const std::vector<SCALAR_TYPE> & vert_scalar)
+{
+  const SCALAR_TYPE isovalue = 0;
+  const NUM_TYPE num_cubes = pointX_list.size()/DIM3;
+  vector<COORD_TYPE> coord_single(DIM3*num_cubes);
+  vector<COORD_TYPE> coord_batch(DIM3*num_cubes);
+  vector<NUM_TYPE> num_large_single(num_cubes);
+  vector<NUM_TYPE> num_large_batch(num_cubes);
+  LINDSTROM_BATCH batch(batch_size);
+  clock_t t0, t1;
+  float seconds_single, seconds_batch;
+
+  t0 = clock();
+  for (int k = 0; k < num_repeat; k++) {
+    for (NUM_TYPE i = 0; i < num_cubes; i++) {
+      const NUM_TYPE iv = first_vert[i];
+      EIGENVALUE_TYPE eigenvalues[DIM3];
+      COORD_TYPE edge_dir[DIM3], orth_dir[DIM3];
+      svd_calculate_sharpiso_vertex_using_lindstrom_fast
+        (first_vert[i+1]-iv, max_small_eigenvalue, isovalue,
+         &(vert_scalar[iv]), &(vert_coord[iv*DIM3]), &(vert_grad[iv*DIM3]),
+         &(pointX_list[i*DIM3]), num_large_single[i], eigenvalues,
+         &(coord_single[i*DIM3]), edge_dir, orth_dir);
+    }
+  }
+  t1 = clock();
+  clock2seconds(t1-t0, seconds_single);
+
+  t0 = clock();
+  for (int k = 0; k < num_repeat; k++) {
+    for (NUM_TYPE i0 = 0; i0 < num_cubes; i0 += batch_size) {
+      batch.Clear();
+      for (NUM_TYPE i = i0; i < num_cubes && !batch.IsFull(); i++) {
+        const NUM_TYPE iv = first_vert[i];
+        batch.AddCube
+          (first_vert[i+1]-iv, &(vert_scalar[iv]), &(vert_coord[iv*DIM3]),
+           &(vert_grad[iv*DIM3]), &(pointX_list[i*DIM3]));
+      }
+
+      batch.ComputeSharpPoints(isovalue, max_small_eigenvalue);
+
+      for (NUM_TYPE j = 0; j < batch.NumCubes(); j++) {
+        num_large_batch[i0+j] = batch.NumLargeEigenvalues(j);
+        copy_coord_3D(batch.SharpCoord(j), &(coord_batch[(i0+j)*DIM3]));
+      }
+    }
+  }
+  t1 = clock();
+  clock2seconds(t1-t0, seconds_batch);
+
+  NUM_TYPE num_diff = 0;
+  for (NUM_TYPE i = 0; i < num_cubes; i++) {
+    if (num_large_single[i] != num_large_batch[i] ||
+        !is_coord_equal_3D(&(coord_single[i*DIM3]), &(coord_batch[i*DIM3])))
+      { num_diff++; }
+  }
+
+  cout << "Single cube time (sec): " << seconds_single << endl;
+  cout << "Batch (size " << batch_size << ") time (sec): " 
+       << seconds_batch << endl;
+  if (seconds_batch > 0) {
+    cout << "Speedup: " << seconds_single/seconds_batch << endl;
+  }
+  cout << "Number of cubes with different batch results: " 
+       << num_diff << endl;
+}
+
+void usage_msg()
+{
+  cerr << "Usage: testeigen3x3 [-repeat {N}] [-max_eigen {E}] [-batch_size {B}]"
+       << " {gradient nrrd file}" << endl;
+}
+
+void usage_error()
+{
+  usage_msg();
+  exit(10);
+}
+
+void parse_command_line(int argc, char **argv)
+{
+  int iarg = 1;
+  while (iarg < argc && argv[iarg][0] == '-') {
+
+    string s = string(argv[iarg]);
+
+    if (s == "-repeat") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      num_repeat = atoi(argv[iarg]);
+    }
+    else if (s == "-max_eigen") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      max_small_eigenvalue = atof(argv[iarg]);
+    }
+    else if (s == "-batch_size") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      batch_size = atoi(argv[iarg]);
+      if (batch_size < 1) { usage_error(); }
+    }
+    else
+      { usage_error(); }
+
+    iarg++;
+  }
+
+  if (iarg+1 != argc) { usage_error(); }
+
+  gradient_filename = argv[iarg];
+}
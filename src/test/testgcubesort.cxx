@@ -0,0 +1,183 @@
+// Test sort_gcube_index_list and resort_gcube_index_list.
+// Compare with sorting the gcube index list using std::sort and
+//   the comparison of the original selection code.
+// Lists must be identical, including the order of cubes with equal keys.
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "shrec_isovert.h"
+
+using namespace std;
+using namespace SHARPISO;
+using namespace SHREC;
+
+// Comparison used by the original selection code.
+// Cubes with equal keys are left in the order chosen by std::sort.
+class ORIGINAL_GCUBE_COMPARE {
+
+public:
+  const std::vector<GRID_CUBE_DATA> * gcube_list;
+
+  ORIGINAL_GCUBE_COMPARE(const std::vector<GRID_CUBE_DATA> & gcube_list)
+  { this->gcube_list = &gcube_list; };
+
+  bool operator () (int i,int j)
+  {
+    int num_eigen_i = gcube_list->at(i).num_eigenvalues;
+    int num_eigen_j = gcube_list->at(j).num_eigenvalues;
+
+    if (num_eigen_i == num_eigen_j) {
+
+      COORD_TYPE d_i = 
+        gcube_list->at(i).linf_dist + gcube_list->at(i).L1_dist_to_cube;
+      COORD_TYPE d_j = 
+        gcube_list->at(j).linf_dist + gcube_list->at(j).L1_dist_to_cube;
+
+      return ((d_i < d_j));
+    }
+    else {
+      return ((num_eigen_i > num_eigen_j));
+    }
+  }
+};
+
+// global variables
+int num_gcube = 10000;
+int num_resort = 20;
+int random_seed = 1;
+
+// routines
+void set_random_key(const bool flag_distinct, GRID_CUBE_DATA & gcube);
+void test_sort(const bool flag_distinct);
+void compare_lists
+(const char * msg, const vector<NUM_TYPE> & list0,
+ const vector<NUM_TYPE> & list1);
+void usage_error();
+void parse_command_line(int argc, char **argv);
+
+
+int main(int argc, char ** argv)
+{
+  parse_command_line(argc, argv);
+
+  srandom(random_seed);
+
+  // Keys drawn from a few values, so many keys are equal.
+  test_sort(false);
+
+  // Distinct keys.
+  test_sort(true);
+
+  cout << "Passed all tests." << endl;
+
+  return 0;
+}
+
+
+// Set random number of eigenvalues and distances.
+// If flag_distinct is false, distances are drawn from a few values.
+void set_random_key(const bool flag_distinct, GRID_CUBE_DATA & gcube)
+{
+  gcube.num_eigenvalues = 1 + random()%3;
+  if (flag_distinct) {
+    gcube.linf_dist = float(random())/RAND_MAX;
+    gcube.L1_dist_to_cube = float(random())/RAND_MAX;
+  }
+  else {
+    gcube.linf_dist = (random()%4)*0.25;
+    gcube.L1_dist_to_cube = (random()%3)*0.5;
+  }
+}
+
+
+void test_sort(const bool flag_distinct)
+{
+  vector<GRID_CUBE_DATA> gcube_list(num_gcube);
+  vector<NUM_TYPE> list0, list1;
+  vector<GCUBE_SORT_KEY> sort_key;
+
+  for (size_t i = 0; i < gcube_list.size(); i++) {
+    set_random_key(flag_distinct, gcube_list[i]);
+    if (gcube_list[i].num_eigenvalues > 1) {
+      list0.push_back(i);
+      list1.push_back(i);
+    }
+  }
+
+  ORIGINAL_GCUBE_COMPARE gcube_compare(gcube_list);
+  sort(list0.begin(), list0.end(), gcube_compare);
+  sort_gcube_index_list(gcube_list, list1, sort_key);
+  compare_lists("sort_gcube_index_list", list0, list1);
+
+  for (int k = 0; k < num_resort; k++) {
+
+    // Change the keys of a few cubes.  Some resorts change no keys.
+    const int num_changed = (k%5 == 0) ? 0 : 1 + random()%(k+1);
+    for (int j = 0; j < num_changed && !list0.empty(); j++) {
+      const NUM_TYPE gcube_index = list0[random()%list0.size()];
+      const int num_eigenvalues = gcube_list[gcube_index].num_eigenvalues;
+      set_random_key(flag_distinct, gcube_list[gcube_index]);
+      // Keep cube in the list.
+      gcube_list[gcube_index].num_eigenvalues = num_eigenvalues;
+    }
+
+    sort(list0.begin(), list0.end(), gcube_compare);
+    resort_gcube_index_list(gcube_list, list1, sort_key);
+    compare_lists("resort_gcube_index_list", list0, list1);
+  }
+}
+
+
+void compare_lists
+(const char * msg, const vector<NUM_TYPE> & list0,
+ const vector<NUM_TYPE> & list1)
+{
+  if (list0.size() != list1.size()) {
+    cerr << "Error.  " << msg << " list length " << list1.size()
+         << ".  Expected " << list0.size() << "." << endl;
+    exit(20);
+  }
+
+  for (size_t i = 0; i < list0.size(); i++) {
+    if (list0[i] != list1[i]) {
+      cerr << "Error.  " << msg << " list location " << i
+           << " is gcube " << list1[i]
+           << ".  Expected gcube " << list0[i] << "." << endl;
+      exit(20);
+    }
+  }
+}
+
+
+void usage_msg()
+{
+  cerr << "Usage: testgcubesort [-n {num gcube}] [-num_resort {N}] [-seed {S}]"
+       << endl;
+}
+
+void usage_error()
+{
+  usage_msg();
+  exit(10);
+}
+
+void parse_command_line(int argc, char **argv)
+{
+  int iarg = 1;
+  while (iarg < argc && argv[iarg][0] == '-') {
+    const string s = argv[iarg];
+    iarg++;
+    if (iarg >= argc) { usage_error(); }
+
+    if (s == "-n") { num_gcube = atoi(argv[iarg]); }
+    else if (s == "-num_resort") { num_resort = atoi(argv[iarg]); }
+    else if (s == "-seed") { random_seed = atoi(argv[iarg]); }
+    else { usage_error(); }
+    iarg++;
+  }
+
+  if (iarg != argc) { usage_error(); }
+}
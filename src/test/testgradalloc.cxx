@@ -0,0 +1,223 @@
+// Count memory allocations and time in computing sharp isosurface vertices.
+// Compare computing each cube with fresh storage
+//   and reusing storage (GET_GRADIENTS_BUFFER) for all cubes.
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include "ijkcoord.txx"
+#include "ijkgrid_macros.h"
+#include "ijkgrid_nrrd.txx"
+#include "ijktime.txx"
+
+#include "sharpiso_feature.h"
+#include "sharpiso_get_gradients.h"
+#include "sharpiso_grids.h"
+
+using namespace std;
+using namespace IJK;
+using namespace SHARPISO;
+
+// global variables
+char * scalar_filename = NULL;
+char * gradient_filename = NULL;
+SCALAR_TYPE isovalue = 0;
+GRAD_SELECTION_METHOD grad_selection_method = GRAD_5x5x5;
+long num_alloc = 0;
+
+// count allocations
+void * operator new(size_t size)
+{
+  num_alloc++;
+  void * p = malloc(size);
+  if (p == NULL) { throw std::bad_alloc(); }
+  return(p);
+}
+
+void operator delete(void * p) noexcept
+{ free(p); }
+
+// routines
+void read_nrrd
+(const char * scalar_filename, const char * gradient_filename,
+ SHARPISO_SCALAR_GRID & scalar_grid, GRADIENT_GRID & gradient_grid);
+void get_bipolar_cubes
+(const SHARPISO_SCALAR_GRID & scalar_grid, const SCALAR_TYPE isovalue,
+ std::vector<VERTEX_INDEX> & cube_list);
+void usage_error();
+void parse_command_line(int argc, char **argv);
+
+
+int main(int argc, char ** argv)
+{
+  SHARPISO_SCALAR_GRID scalar_grid;
+  GRADIENT_GRID gradient_grid;
+  SHARP_ISOVERT_PARAM sharpiso_param;
+  OFFSET_VOXEL voxel;
+  vector<VERTEX_INDEX> cube_list;
+  clock_t t0, t1;
+  float seconds_fresh, seconds_reuse;
+  long num_alloc_fresh, num_alloc_reuse;
+
+  try {
+
+    parse_command_line(argc, argv);
+
+    read_nrrd(scalar_filename, gradient_filename, scalar_grid, gradient_grid);
+    get_bipolar_cubes(scalar_grid, isovalue, cube_list);
+
+    sharpiso_param.SetGradSelectionMethod(grad_selection_method);
+    voxel.SetVertexCoord
+      (scalar_grid.SpacingPtrConst(),
+       sharpiso_param.grad_selection_cube_offset);
+
+    const NUM_TYPE num_cubes = cube_list.size();
+    vector<COORD_TYPE> coord_fresh(DIM3*num_cubes);
+    vector<COORD_TYPE> coord_reuse(DIM3*num_cubes);
+
+    cout << "Number of cubes: " << num_cubes << endl;
+    if (num_cubes == 0) { return 0; }
+
+    num_alloc = 0;
+    t0 = clock();
+    for (NUM_TYPE i = 0; i < num_cubes; i++) {
+      COORD_TYPE edge_dir[DIM3], orth_dir[DIM3];
+      EIGENVALUE_TYPE eigenvalues[DIM3];
+      NUM_TYPE num_large_eigenvalues;
+      SVD_INFO svd_info;
+
+      svd_compute_sharp_vertex_for_cube_lindstrom
+        (scalar_grid, gradient_grid, cube_list[i], isovalue, sharpiso_param,
+         voxel, &(coord_fresh[i*DIM3]), edge_dir, orth_dir, eigenvalues,
+         num_large_eigenvalues, svd_info);
+    }
+    t1 = clock();
+    clock2seconds(t1-t0, seconds_fresh);
+    num_alloc_fresh = num_alloc;
+
+    GET_GRADIENTS_BUFFER buffer;
+
+    num_alloc = 0;
+    t0 = clock();
+    for (NUM_TYPE i = 0; i < num_cubes; i++) {
+      COORD_TYPE edge_dir[DIM3], orth_dir[DIM3];
+      EIGENVALUE_TYPE eigenvalues[DIM3];
+      NUM_TYPE num_large_eigenvalues;
+      SVD_INFO svd_info;
+
+      svd_compute_sharp_vertex_for_cube_lindstrom
+        (scalar_grid, gradient_grid, cube_list[i], isovalue, sharpiso_param,
+         voxel, &(coord_reuse[i*DIM3]), edge_dir, orth_dir, eigenvalues,
+         num_large_eigenvalues, svd_info, buffer);
+    }
+    t1 = clock();
+    clock2seconds(t1-t0, seconds_reuse);
+    num_alloc_reuse = num_alloc;
+
+    NUM_TYPE num_diff = 0;
+    for (NUM_TYPE i = 0; i < num_cubes; i++) {
+      if (!is_coord_equal_3D(&(coord_fresh[i*DIM3]), &(coord_reuse[i*DIM3])))
+        { num_diff++; }
+    }
+
+    cout << "Fresh storage.  Allocations: " << num_alloc_fresh
+         << "  Allocations per cube: " << float(num_alloc_fresh)/num_cubes
+         << "  Time (sec): " << seconds_fresh << endl;
+    cout << "Reused storage.  Allocations: " << num_alloc_reuse
+         << "  Allocations per cube: " << float(num_alloc_reuse)/num_cubes
+         << "  Time (sec): " << seconds_reuse << endl;
+    cout << "Number of cubes with different sharp vertices: "
+         << num_diff << endl;
+  }
+  catch (ERROR error) {
+    if (error.NumMessages() == 0) {
+      cerr << "Unknown error." << endl;
+    }
+    else { error.Print(cerr); }
+    cerr << "Exiting." << endl;
+    exit(30);
+  }
+
+  return 0;
+}
+
+void read_nrrd
+(const char * scalar_filename, const char * gradient_filename,
+ SHARPISO_SCALAR_GRID & scalar_grid, GRADIENT_GRID & gradient_grid)
+{
+  IJK::PROCEDURE_ERROR error("read_nrrd");
+  GRID_NRRD_IN<int,AXIS_SIZE_TYPE> nrrd_in;
+  NRRD_DATA<int,AXIS_SIZE_TYPE> nrrd_header;
+  GRID_NRRD_IN<int,AXIS_SIZE_TYPE> nrrd_in_gradient;
+  NRRD_DATA<int,AXIS_SIZE_TYPE> nrrd_header_gradient;
+
+  nrrd_in.ReadScalarGrid(scalar_filename, scalar_grid, nrrd_header, error);
+  if (nrrd_in.ReadFailed()) { throw error; }
+
+  nrrd_in_gradient.ReadVectorGrid
+    (gradient_filename, gradient_grid, nrrd_header_gradient, error);
+  if (nrrd_in_gradient.ReadFailed()) { throw error; }
+
+  if (!gradient_grid.Check
+      (scalar_grid, "gradient grid", "scalar grid", error))
+    { throw error; }
+}
+
+// Get cubes with some vertex scalar <= isovalue
+//   and some vertex scalar > isovalue.
+void get_bipolar_cubes
+(const SHARPISO_SCALAR_GRID & scalar_grid, const SCALAR_TYPE isovalue,
+ std::vector<VERTEX_INDEX> & cube_list)
+{
+  IJK_FOR_EACH_GRID_CUBE(icube, scalar_grid, VERTEX_INDEX) {
+    NUM_TYPE num_le = 0;
+    for (NUM_TYPE k = 0; k < scalar_grid.NumCubeVertices(); k++) {
+      const VERTEX_INDEX iv = scalar_grid.CubeVertex(icube, k);
+      if (scalar_grid.Scalar(iv) <= isovalue) { num_le++; }
+    }
+
+    if (num_le > 0 && num_le < scalar_grid.NumCubeVertices())
+      { cube_list.push_back(icube); }
+  }
+}
+
+void usage_msg()
+{
+  cerr << "Usage: testgradalloc [-gradsel {method}] {isovalue} {scalar nrrd file} {gradient nrrd file}"
+       << endl;
+}
+
+void usage_error()
+{
+  usage_msg();
+  exit(10);
+}
+
+void parse_command_line(int argc, char **argv)
+{
+  int iarg = 1;
+  while (iarg < argc && argv[iarg][0] == '-') {
+
+    string s = string(argv[iarg]);
+
+    if (s == "-gradsel") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      grad_selection_method = get_grad_selection_method(argv[iarg]);
+      if (grad_selection_method == UNKNOWN_GRAD_SELECTION_METHOD)
+        { usage_error(); }
+    }
+    else
+      { usage_error(); }
+
+    iarg++;
+  }
+
+  if (iarg+3 != argc) { usage_error(); }
+
+  isovalue = atof(argv[iarg]);
+  scalar_filename = argv[iarg+1];
+  gradient_filename = argv[iarg+2];
+}
@@ -0,0 +1,317 @@
+// Test and time parallel gradient computations.
+// Supersample a scalar grid to production size.
+// Run central difference, spring diffusion (springdiff)
+//   and reliable gradient tests (religrad) using 1 to N threads.
+// Check that each number of threads gives the same result as 1 thread.
+// Report time and speedup over 1 thread.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ijkgradient.txx"
+#include "ijkgrid_nrrd.txx"
+#include "ijktime.txx"
+
+#include "springdiff.h"
+#include "religrad_computations.h"
+
+using namespace std;
+using namespace IJK;
+using namespace SHARPISO;
+
+// global variables
+char * scalar_filename = NULL;
+int supersample_period = 16;
+int max_num_threads = 0;           // 0: Number of hardware threads.
+int num_spring_iter = 2;
+
+// types
+typedef IJK::BOOL_GRID<RELIGRADIENT_GRID> RELIABLE_GRID;
+
+// Results and times for one number of threads.
+class RUN_RESULT {
+public:
+  GRADIENT_GRID gradient_grid;
+  GRADIENT_MAGNITUDE_GRID magnitude_grid;
+  GRADIENT_GRID spring_gradient_grid;
+  RELIABLE_GRID angle_reliable_grid;
+  RELIABLE_GRID curv_reliable_grid;
+  unsigned long num_reliable;
+  unsigned long num_unreliable;
+  unsigned long grad_mag_zero;
+
+  float seconds_cdiff;
+  float seconds_spring;
+  float seconds_angle;
+  float seconds_curv;
+};
+
+// routines
+void run_all
+(const RELIGRADIENT_SCALAR_GRID_BASE & scalar_grid,
+ const int num_threads, RUN_RESULT & result);
+template <typename GRID_TYPE>
+bool are_grids_equal(const GRID_TYPE & grid0, const GRID_TYPE & grid1);
+template <typename GRID_TYPE>
+bool are_scalar_grids_equal(const GRID_TYPE & grid0, const GRID_TYPE & grid1);
+void compare_results
+(const RUN_RESULT & result0, const RUN_RESULT & result,
+ const int num_threads);
+void report_time
+(const char * label, const float seconds, const float seconds0);
+void usage_error();
+void parse_command_line(int argc, char **argv);
+
+
+int main(int argc, char ** argv)
+{
+  RELIGRADIENT_SCALAR_GRID scalar_grid0, scalar_grid;
+  GRID_NRRD_IN<int,int> nrrd_in;
+  NRRD_DATA<int,int> nrrd_header;
+  PROCEDURE_ERROR error("testgradthreads");
+
+  try {
+
+    parse_command_line(argc, argv);
+
+    nrrd_in.ReadScalarGrid(scalar_filename, scalar_grid0, nrrd_header, error);
+    if (nrrd_in.ReadFailed()) { throw error; }
+
+    if (scalar_grid0.Dimension() != DIM3) {
+      error.AddMessage("Scalar grid has dimension ",
+                       scalar_grid0.Dimension(), ".");
+      error.AddMessage("  Only 3D grids are supported.");
+      throw error;
+    }
+
+    scalar_grid.Supersample(scalar_grid0, supersample_period);
+
+    const int num_threads = get_num_threads(max_num_threads);
+
+    cout << "Grid: " << scalar_grid.AxisSize(0) << " x "
+         << scalar_grid.AxisSize(1) << " x " << scalar_grid.AxisSize(2)
+         << "  Vertices: " << scalar_grid.NumVertices()
+         << "  Hardware threads: " << get_num_threads(0) << endl;
+
+    RUN_RESULT result0;
+    run_all(scalar_grid, 1, result0);
+
+    for (int k = 1; k <= num_threads; k++) {
+      RUN_RESULT result;
+      const RUN_RESULT * result_ptr = &result0;
+
+      if (k > 1) {
+        run_all(scalar_grid, k, result);
+        compare_results(result0, result, k);
+        result_ptr = &result;
+      }
+
+      cout << "Threads: " << k << endl;
+      report_time("Central difference", result_ptr->seconds_cdiff,
+                  result0.seconds_cdiff);
+      report_time("Spring diffusion", result_ptr->seconds_spring,
+                  result0.seconds_spring);
+      report_time("Angle test", result_ptr->seconds_angle,
+                  result0.seconds_angle);
+      report_time("Curvature test", result_ptr->seconds_curv,
+                  result0.seconds_curv);
+    }
+
+  }
+  catch (ERROR error) {
+    if (error.NumMessages() == 0) {
+      cerr << "Unknown error." << endl;
+    }
+    else { error.Print(cerr); }
+    cerr << "Exiting." << endl;
+    exit(30);
+  }
+
+  cout << "Passed all tests." << endl;
+
+  return 0;
+}
+
+// Run central difference, spring diffusion and reliable gradient tests
+//   using num_threads threads.
+void run_all
+(const RELIGRADIENT_SCALAR_GRID_BASE & scalar_grid,
+ const int num_threads, RUN_RESULT & result)
+{
+  INPUT_INFO io_info;
+  RELIGRADIENT::BOOL_GRID boundary_grid;
+  WALL_TIME_POINT t0, t1, t2, t3, t4;
+
+  io_info.set_defaults();
+  io_info.num_threads = num_threads;
+
+  boundary_grid.SetSize(scalar_grid);
+  compute_boundary_grid(boundary_grid);
+  result.angle_reliable_grid.SetSize(scalar_grid);
+  result.angle_reliable_grid.SetAll(true);
+  result.curv_reliable_grid.SetSize(scalar_grid);
+  result.curv_reliable_grid.SetAll(false);
+  result.spring_gradient_grid.SetSize(scalar_grid, DIM3);
+
+  t0 = wall_clock();
+  compute_gradient_central_difference_normalized
+    (scalar_grid, result.gradient_grid, result.magnitude_grid, io_info);
+  t1 = wall_clock();
+
+  result.spring_gradient_grid.CopyVector(result.gradient_grid);
+  compute_spring_diffusion
+    (scalar_grid, num_spring_iter, 0.25, 0.1, num_threads,
+     result.spring_gradient_grid);
+  t2 = wall_clock();
+
+  compute_reliable_gradients_angle
+    (scalar_grid, result.gradient_grid, result.magnitude_grid,
+     result.angle_reliable_grid, io_info);
+  t3 = wall_clock();
+
+  compute_reliable_gradients_curvature_basedB
+    (scalar_grid, boundary_grid, result.gradient_grid, result.magnitude_grid,
+     result.curv_reliable_grid, io_info);
+  t4 = wall_clock();
+
+  result.num_reliable = io_info.out_info.num_reliable;
+  result.num_unreliable = io_info.out_info.num_unreliable;
+  result.grad_mag_zero = io_info.out_info.grad_mag_zero;
+
+  clock2seconds(t1-t0, result.seconds_cdiff);
+  clock2seconds(t2-t1, result.seconds_spring);
+  clock2seconds(t3-t2, result.seconds_angle);
+  clock2seconds(t4-t3, result.seconds_curv);
+}
+
+// Return true if grids have identical values.
+template <typename GRID_TYPE>
+bool are_grids_equal(const GRID_TYPE & grid0, const GRID_TYPE & grid1)
+{
+  const VERTEX_INDEX numv = grid0.NumVertices();
+  const int n0 = grid0.VectorLength();
+
+  if (grid1.NumVertices() != numv) { return(false); }
+  if (grid1.VectorLength() != n0) { return(false); }
+
+  for (VERTEX_INDEX iv = 0; iv < numv; iv++) {
+    for (int j = 0; j < n0; j++) {
+      if (grid0.Vector(iv, j) != grid1.Vector(iv, j)) { return(false); }
+    }
+  }
+
+  return(true);
+}
+
+// Return true if scalar grids have identical values.
+template <typename GRID_TYPE>
+bool are_scalar_grids_equal(const GRID_TYPE & grid0, const GRID_TYPE & grid1)
+{
+  const VERTEX_INDEX numv = grid0.NumVertices();
+
+  if (grid1.NumVertices() != numv) { return(false); }
+
+  for (VERTEX_INDEX iv = 0; iv < numv; iv++) {
+    if (grid0.Scalar(iv) != grid1.Scalar(iv)) { return(false); }
+  }
+
+  return(true);
+}
+
+// Exit with an error if result differs from result0.
+void compare_results
+(const RUN_RESULT & result0, const RUN_RESULT & result,
+ const int num_threads)
+{
+  string msg;
+
+  if (!are_grids_equal(result0.gradient_grid, result.gradient_grid))
+    { msg = "Central difference gradients"; }
+  else if (!are_scalar_grids_equal
+           (result0.magnitude_grid, result.magnitude_grid))
+    { msg = "Gradient magnitudes"; }
+  else if (!are_grids_equal
+           (result0.spring_gradient_grid, result.spring_gradient_grid))
+    { msg = "Spring diffusion gradients"; }
+  else if (!are_scalar_grids_equal
+           (result0.angle_reliable_grid, result.angle_reliable_grid))
+    { msg = "Angle test reliable gradients"; }
+  else if (!are_scalar_grids_equal
+           (result0.curv_reliable_grid, result.curv_reliable_grid))
+    { msg = "Curvature test reliable gradients"; }
+  else if (result0.num_reliable != result.num_reliable ||
+           result0.num_unreliable != result.num_unreliable ||
+           result0.grad_mag_zero != result.grad_mag_zero)
+    { msg = "Reliable gradient counts"; }
+
+  if (msg != "") {
+    cerr << "Error.  " << msg << " computed with " << num_threads
+         << " threads differ from " << msg << " computed with 1 thread."
+         << endl;
+    exit(20);
+  }
+}
+
+void report_time
+(const char * label, const float seconds, const float seconds0)
+{
+  cout << "  " << label << ": " << seconds << " sec.";
+  if (seconds > 0) { cout << "  Speedup: " << seconds0/seconds; }
+  cout << endl;
+}
+
+void usage_msg()
+{
+  cerr << "Usage: testgradthreads [-supersample {S}] [-num_threads {N}] [-num_iter {K}] {scalar nrrd file}"
+       << endl;
+  cerr << "  -supersample {S}: Supersample grid by S.  (Default: 16.)" << endl;
+  cerr << "  -num_threads {N}: Run with 1 to N threads." << endl;
+  cerr << "      (Default: Number of hardware threads.)" << endl;
+  cerr << "  -num_iter {K}: Number of spring diffusion iterations.  (Default: 2.)"
+       << endl;
+  cerr << "  Example: testgradthreads data/cube3D.A10x.nrrd" << endl;
+}
+
+void usage_error()
+{
+  usage_msg();
+  exit(10);
+}
+
+void parse_command_line(int argc, char **argv)
+{
+  int iarg = 1;
+  while (iarg < argc && argv[iarg][0] == '-') {
+
+    string s = string(argv[iarg]);
+
+    if (s == "-supersample") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      supersample_period = atoi(argv[iarg]);
+      if (supersample_period < 1) { usage_error(); }
+    }
+    else if (s == "-num_threads") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      max_num_threads = atoi(argv[iarg]);
+      if (max_num_threads < 1) { usage_error(); }
+    }
+    else if (s == "-num_iter") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      num_spring_iter = atoi(argv[iarg]);
+      if (num_spring_iter < 0) { usage_error(); }
+    }
+    else
+      { usage_error(); }
+
+    iarg++;
+  }
+
+  if (iarg+1 != argc) { usage_error(); }
+
+  scalar_filename = argv[iarg];
+}
@@ -0,0 +1,233 @@
+// Test and time is_isopatch_disk3D.
+// Capture isosurface patches around unmerged and selected cubes
+//   from isosurfaces of a scalar and gradient grid.
+// Replay the patches through is_isopatch_disk3D (fixed size arrays)
+//   and is_isopatch_disk3D_hash (hash tables).
+// Report differences and time for both versions.
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "ijkgrid_nrrd.txx"
+#include "ijkmesh.txx"
+#include "ijktime.txx"
+
+#include "shrec.h"
+#include "shrec_merge.h"
+
+using namespace std;
+using namespace IJK;
+using namespace SHARPISO;
+using namespace SHREC;
+
+// global variables
+char * scalar_filename = NULL;
+char * gradient_filename = NULL;
+vector<SCALAR_TYPE> isovalue;
+int num_repeat = 20;
+
+// types
+typedef vector<ISO_VERTEX_INDEX> POLY_VERT_LIST;
+
+// routines
+void capture_patches
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const SCALAR_TYPE isovalue,
+ vector<POLY_VERT_LIST> & tri_vert_list,
+ vector<POLY_VERT_LIST> & quad_vert_list);
+void usage_error();
+void parse_command_line(int argc, char **argv);
+
+
+int main(int argc, char ** argv)
+{
+  SHARPISO_SCALAR_GRID scalar_grid;
+  GRADIENT_GRID gradient_grid;
+  GRID_NRRD_IN<int,AXIS_SIZE_TYPE> nrrd_in;
+  NRRD_DATA<int,AXIS_SIZE_TYPE> nrrd_header;
+  PROCEDURE_ERROR error("testisopatchdisk");
+  clock_t t0, t1, t2;
+  float seconds_array, seconds_hash;
+
+  try {
+
+    parse_command_line(argc, argv);
+
+    nrrd_in.ReadScalarGrid(scalar_filename, scalar_grid, nrrd_header, error);
+    if (nrrd_in.ReadFailed()) { throw error; }
+
+    nrrd_in.ReadVectorGrid
+      (gradient_filename, gradient_grid, nrrd_header, error);
+    if (nrrd_in.ReadFailed()) { throw error; }
+
+    for (int i = 0; i < isovalue.size(); i++) {
+      vector<POLY_VERT_LIST> tri_vert_list, quad_vert_list;
+      NUM_TYPE num_disk = 0, num_disk_hash = 0;
+
+      capture_patches(scalar_grid, gradient_grid, isovalue[i],
+                      tri_vert_list, quad_vert_list);
+
+      NUM_TYPE max_num_poly = 0;
+      for (NUM_TYPE j = 0; j < tri_vert_list.size(); j++) {
+        const NUM_TYPE num_poly = tri_vert_list[j].size()/NUM_VERT_PER_TRI +
+          quad_vert_list[j].size()/NUM_VERT_PER_QUAD;
+        if (num_poly > max_num_poly) { max_num_poly = num_poly; }
+      }
+
+      cout << "Isovalue " << isovalue[i]
+           << ".  Isosurface patches: " << tri_vert_list.size()
+           << "  Max polygons per patch: " << max_num_poly << endl;
+
+      for (NUM_TYPE j = 0; j < tri_vert_list.size(); j++) {
+        const bool is_disk =
+          is_isopatch_disk3D(tri_vert_list[j], quad_vert_list[j]);
+        const bool is_disk_hash =
+          is_isopatch_disk3D_hash(tri_vert_list[j], quad_vert_list[j]);
+        if (is_disk != is_disk_hash) {
+          cerr << "Error.  is_isopatch_disk3D returned " << is_disk
+               << " on patch " << j << ".  Expected "
+               << is_disk_hash << "." << endl;
+          exit(20);
+        }
+      }
+
+      t0 = clock();
+      for (int k = 0; k < num_repeat; k++) {
+        for (NUM_TYPE j = 0; j < tri_vert_list.size(); j++) {
+          if (is_isopatch_disk3D(tri_vert_list[j], quad_vert_list[j]))
+            { num_disk++; }
+        }
+      }
+      t1 = clock();
+      for (int k = 0; k < num_repeat; k++) {
+        for (NUM_TYPE j = 0; j < tri_vert_list.size(); j++) {
+          if (is_isopatch_disk3D_hash(tri_vert_list[j], quad_vert_list[j]))
+            { num_disk_hash++; }
+        }
+      }
+      t2 = clock();
+      clock2seconds(t1-t0, seconds_array);
+      clock2seconds(t2-t1, seconds_hash);
+
+      cout << "  Disk patches: " << num_disk/num_repeat
+           << "  Non-disk patches: "
+           << tri_vert_list.size()-num_disk/num_repeat << endl;
+      cout << "  Time for " << num_repeat << " repetitions (sec).  Arrays: "
+           << seconds_array << "  Hash tables: " << seconds_hash << endl;
+
+      if (num_disk != num_disk_hash) {
+        cerr << "Error.  Number of disks differ." << endl;
+        exit(20);
+      }
+    }
+  }
+  catch (ERROR error) {
+    if (error.NumMessages() == 0) {
+      cerr << "Unknown error." << endl;
+    }
+    else { error.Print(cerr); }
+    cerr << "Exiting." << endl;
+    exit(30);
+  }
+
+  cout << "Passed all tests." << endl;
+
+  return 0;
+}
+
+// Construct isosurface merging cubes around sharp vertices.
+// Capture isosurface patches incident on cubes which are not mapped
+//   to other cubes, as in the merge disk check.
+void capture_patches
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const SCALAR_TYPE isovalue,
+ vector<POLY_VERT_LIST> & tri_vert_list,
+ vector<POLY_VERT_LIST> & quad_vert_list)
+{
+  const int dist2cube = 1;
+  SHARPISO_MINMAX_PYRAMID minmax_pyramid;
+  SHREC_PARAM shrec_param;
+  DUAL_ISOSURFACE dual_isosurface;
+  ISOVERT isovert;
+  SHREC_INFO shrec_info(scalar_grid.Dimension());
+  vector<VERTEX_INDEX> gcube_map;
+  POLY_VERT_LIST tri_vert, quad_vert;
+
+  // Use shrec default parameters.
+  SHREC_DEFAULTS shrec_defaults;
+  shrec_param.vertex_position_method = shrec_defaults.vertex_position_method;
+  shrec_param.SetGradSelectionMethod(shrec_defaults.grad_selection_method);
+  shrec_param.flag_select_mod6 = shrec_defaults.flag_select_mod6;
+  shrec_param.flag_map_extended = shrec_defaults.flag_map_extended;
+  shrec_param.max_dist = shrec_defaults.max_dist;
+  shrec_param.max_small_eigenvalue = shrec_defaults.max_small_eigenvalue;
+  shrec_param.grad_selection_cube_offset = 
+    shrec_defaults.grad_selection_cube_offset;
+  shrec_param.flag_allow_conflict = true;
+  shrec_param.flag_clamp_conflict = false;
+
+  minmax_pyramid.ComputeMinMax(scalar_grid, 4);
+  dual_contouring_merge_sharp_from_grad
+    (scalar_grid, minmax_pyramid, gradient_grid, isovalue, shrec_param,
+     dual_isosurface, isovert, shrec_info);
+
+  gcube_map.resize(isovert.gcube_list.size());
+  for (NUM_TYPE i = 0; i < isovert.gcube_list.size(); i++)
+    { gcube_map[i] = isovert.GCubeIndex(isovert.gcube_list[i].maps_to_cube); }
+
+  tri_vert_list.clear();
+  quad_vert_list.clear();
+  for (NUM_TYPE i = 0; i < isovert.gcube_list.size(); i++) {
+    if (gcube_map[i] != i) { continue; }
+
+    extract_dual_isopatch_incident_on
+      (scalar_grid, isovalue, isovert, isovert.gcube_list[i].cube_index,
+       gcube_map, dist2cube, tri_vert, quad_vert);
+    reorder_quad_vertices(quad_vert);
+
+    tri_vert_list.push_back(tri_vert);
+    quad_vert_list.push_back(quad_vert);
+  }
+}
+
+void usage_msg()
+{
+  cerr << "Usage: testisopatchdisk [-repeat {N}] {scalar nrrd file} {gradient nrrd file} {isovalue1} [{isovalue2} ...]"
+       << endl;
+}
+
+void usage_error()
+{
+  usage_msg();
+  exit(10);
+}
+
+void parse_command_line(int argc, char **argv)
+{
+  int iarg = 1;
+  while (iarg < argc && argv[iarg][0] == '-') {
+
+    string s = string(argv[iarg]);
+
+    if (s == "-repeat") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      num_repeat = atoi(argv[iarg]);
+      if (num_repeat < 1) { usage_error(); }
+    }
+    else
+      { usage_error(); }
+
+    iarg++;
+  }
+
+  if (iarg+3 > argc) { usage_error(); }
+
+  scalar_filename = argv[iarg];
+  gradient_filename = argv[iarg+1];
+  for (int j = iarg+2; j < argc; j++)
+    { isovalue.push_back(atof(argv[j])); }
+}
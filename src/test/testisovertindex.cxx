@@ -0,0 +1,169 @@
+// Test and time SPARSE_GCUBE_INDEX.
+// Compare sparse (hash table) and dense (full grid) index
+//   from active cubes to gcube_list locations.
+// Report memory and lookup time for both layouts.
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "ijkgrid_macros.h"
+#include "ijkgrid_nrrd.txx"
+#include "ijktime.txx"
+
+#include "shrec_isovert.h"
+
+using namespace std;
+using namespace IJK;
+using namespace SHARPISO;
+using namespace SHREC;
+
+// global variables
+char * scalar_filename = NULL;
+vector<SCALAR_TYPE> isovalue;
+
+// routines
+long get_peak_rss_kb();
+void usage_error();
+void parse_command_line(int argc, char **argv);
+
+
+int main(int argc, char ** argv)
+{
+  SHARPISO_SCALAR_GRID scalar_grid;
+  SHARPISO_MINMAX_PYRAMID minmax_pyramid;
+  GRID_NRRD_IN<int,AXIS_SIZE_TYPE> nrrd_in;
+  NRRD_DATA<int,AXIS_SIZE_TYPE> nrrd_header;
+  PROCEDURE_ERROR error("testisovertindex");
+  clock_t t0, t1, t2;
+  float seconds_sparse, seconds_dense;
+
+  try {
+
+    parse_command_line(argc, argv);
+
+    nrrd_in.ReadScalarGrid(scalar_filename, scalar_grid, nrrd_header, error);
+    if (nrrd_in.ReadFailed()) { throw error; }
+
+    minmax_pyramid.ComputeMinMax(scalar_grid, 4);
+
+    const VERTEX_INDEX num_cubes = scalar_grid.ComputeNumCubes();
+    cout << "Number of cubes: " << num_cubes << endl;
+
+    for (int i = 0; i < isovalue.size(); i++) {
+      vector<VERTEX_INDEX> cube_list;
+      SPARSE_GCUBE_INDEX sparse_index;
+      SHARPISO_INDEX_GRID index_grid;
+      long sum_sparse = 0, sum_dense = 0;
+
+      minmax_pyramid.GetActiveCubes(scalar_grid, isovalue[i], cube_list);
+
+      cout << "Isovalue " << isovalue[i]
+           << ".  Active cubes: " << cube_list.size() << endl;
+
+      // Build sparse index before dense index so that the increase
+      //   in peak resident set size reflects each layout.
+      const long rss0 = get_peak_rss_kb();
+      sparse_index.Reserve(cube_list.size());
+      for (NUM_TYPE j = 0; j < cube_list.size(); j++)
+        { sparse_index.Insert(cube_list[j], j); }
+      const long rss1 = get_peak_rss_kb();
+
+      index_grid.SetSize(scalar_grid);
+      index_grid.SetAll(ISOVERT::NO_INDEX);
+      for (NUM_TYPE j = 0; j < cube_list.size(); j++)
+        { index_grid.Set(cube_list[j], j); }
+      const long rss2 = get_peak_rss_kb();
+
+      const long dense_bytes =
+        long(index_grid.NumVertices())*long(sizeof(INDEX_DIFF_TYPE));
+      cout << "  Sparse index (bytes): " << sparse_index.NumBytes()
+           << "  Dense index (bytes): " << dense_bytes << endl;
+      cout << "  Increase in peak RSS (KB).  Sparse: " << rss1-rss0
+           << "  Dense: " << rss2-rss1 << endl;
+
+      // Lookup every active cube and its x-neighbor, as in
+      //   neighbor traversals of the isosurface vertex routines.
+      t0 = clock();
+      for (NUM_TYPE j = 0; j < cube_list.size(); j++) {
+        const VERTEX_INDEX icube = cube_list[j];
+        sum_sparse += sparse_index.Find(icube);
+        if (icube+1 < num_cubes)
+          { sum_sparse += sparse_index.Find(icube+1); }
+      }
+      t1 = clock();
+      for (NUM_TYPE j = 0; j < cube_list.size(); j++) {
+        const VERTEX_INDEX icube = cube_list[j];
+        sum_dense += index_grid.Scalar(icube);
+        if (icube+1 < num_cubes)
+          { sum_dense += index_grid.Scalar(icube+1); }
+      }
+      t2 = clock();
+      clock2seconds(t1-t0, seconds_sparse);
+      clock2seconds(t2-t1, seconds_dense);
+
+      cout << "  Lookup time (sec).  Sparse: " << seconds_sparse
+           << "  Dense: " << seconds_dense << endl;
+
+      if (sum_sparse != sum_dense) {
+        cerr << "Error.  Sparse and dense lookups differ." << endl;
+        exit(20);
+      }
+
+      for (VERTEX_INDEX iv = 0; iv < index_grid.NumVertices(); iv++) {
+        if (sparse_index.Find(iv) != index_grid.Scalar(iv)) {
+          cerr << "Error.  Sparse index of cube " << iv << " is "
+               << sparse_index.Find(iv) << ".  Expected "
+               << index_grid.Scalar(iv) << "." << endl;
+          exit(20);
+        }
+      }
+    }
+  }
+  catch (ERROR error) {
+    if (error.NumMessages() == 0) {
+      cerr << "Unknown error." << endl;
+    }
+    else { error.Print(cerr); }
+    cerr << "Exiting." << endl;
+    exit(30);
+  }
+
+  cout << "Passed all tests." << endl;
+
+  return 0;
+}
+
+// Return peak resident set size in kilobytes.
+long get_peak_rss_kb()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return(usage.ru_maxrss);
+}
+
+void usage_msg()
+{
+  cerr << "Usage: testisovertindex {scalar nrrd file} {isovalue1} [{isovalue2} ...]"
+       << endl;
+}
+
+void usage_error()
+{
+  usage_msg();
+  exit(10);
+}
+
+void parse_command_line(int argc, char **argv)
+{
+  int iarg = 1;
+  if (iarg < argc && argv[iarg][0] == '-') { usage_error(); }
+
+  if (iarg+2 > argc) { usage_error(); }
+
+  scalar_filename = argv[iarg];
+  for (int j = iarg+1; j < argc; j++)
+    { isovalue.push_back(atof(argv[j])); }
+}
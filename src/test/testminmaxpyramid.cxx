@@ -0,0 +1,146 @@
+// Test MINMAX_PYRAMID.
+// Compare active cubes found using the min/max pyramid
+//   with active cubes found by testing every grid cube.
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "ijkgrid_macros.h"
+#include "ijkgrid_nrrd.txx"
+#include "ijktime.txx"
+
+#include "sharpiso_grids.h"
+
+using namespace std;
+using namespace IJK;
+using namespace SHARPISO;
+
+// global variables
+char * scalar_filename = NULL;
+vector<SCALAR_TYPE> isovalue;
+AXIS_SIZE_TYPE region_edge_length = 4;
+
+// routines
+void get_active_cubes
+(const SHARPISO_SCALAR_GRID & scalar_grid, const SCALAR_TYPE isovalue,
+ std::vector<VERTEX_INDEX> & cube_list);
+void usage_error();
+void parse_command_line(int argc, char **argv);
+
+
+int main(int argc, char ** argv)
+{
+  SHARPISO_SCALAR_GRID scalar_grid;
+  SHARPISO_MINMAX_PYRAMID minmax_pyramid;
+  GRID_NRRD_IN<int,AXIS_SIZE_TYPE> nrrd_in;
+  NRRD_DATA<int,AXIS_SIZE_TYPE> nrrd_header;
+  PROCEDURE_ERROR error("testminmaxpyramid");
+  clock_t t0, t1, t2;
+  float seconds;
+
+  try {
+
+    parse_command_line(argc, argv);
+
+    nrrd_in.ReadScalarGrid(scalar_filename, scalar_grid, nrrd_header, error);
+    if (nrrd_in.ReadFailed()) { throw error; }
+
+    t0 = clock();
+    minmax_pyramid.ComputeMinMax(scalar_grid, region_edge_length);
+    t1 = clock();
+    clock2seconds(t1-t0, seconds);
+
+    cout << "Number of cubes: " << scalar_grid.ComputeNumCubes() << endl;
+    cout << "Region edge length: " << minmax_pyramid.RegionEdgeLength()
+         << "  Number of levels: " << minmax_pyramid.NumLevels() << endl;
+    cout << "Time to build pyramid (sec): " << seconds << endl;
+
+    for (size_t i = 0; i < isovalue.size(); i++) {
+      vector<VERTEX_INDEX> cube_list, cube_list2;
+      float seconds_full, seconds_pyramid;
+
+      t0 = clock();
+      get_active_cubes(scalar_grid, isovalue[i], cube_list);
+      t1 = clock();
+      minmax_pyramid.GetActiveCubes(scalar_grid, isovalue[i], cube_list2);
+      t2 = clock();
+      clock2seconds(t1-t0, seconds_full);
+      clock2seconds(t2-t1, seconds_pyramid);
+
+      cout << "Isovalue " << isovalue[i]
+           << ".  Active cubes: " << cube_list.size() << endl;
+      cout << "  Time testing all cubes (sec): " << seconds_full
+           << "  Time using pyramid (sec): " << seconds_pyramid << endl;
+
+      if (cube_list != cube_list2) {
+        cerr << "Error.  Pyramid found " << cube_list2.size()
+             << " active cubes.  Expected " << cube_list.size()
+             << " active cubes." << endl;
+        exit(20);
+      }
+    }
+  }
+  catch (ERROR error) {
+    if (error.NumMessages() == 0) {
+      cerr << "Unknown error." << endl;
+    }
+    else { error.Print(cerr); }
+    cerr << "Exiting." << endl;
+    exit(30);
+  }
+
+  cout << "Passed all tests." << endl;
+
+  return 0;
+}
+
+// Get active cubes by testing every grid cube.
+void get_active_cubes
+(const SHARPISO_SCALAR_GRID & scalar_grid, const SCALAR_TYPE isovalue,
+ std::vector<VERTEX_INDEX> & cube_list)
+{
+  cube_list.clear();
+  IJK_FOR_EACH_GRID_CUBE(icube, scalar_grid, VERTEX_INDEX) {
+    if (is_gt_cube_min_le_cube_max(scalar_grid, icube, isovalue))
+      { cube_list.push_back(icube); }
+  }
+}
+
+void usage_msg()
+{
+  cerr << "Usage: testminmaxpyramid [-region_length {L}] {scalar nrrd file} {isovalue1} [{isovalue2} ...]"
+       << endl;
+}
+
+void usage_error()
+{
+  usage_msg();
+  exit(10);
+}
+
+void parse_command_line(int argc, char **argv)
+{
+  int iarg = 1;
+  while (iarg < argc && argv[iarg][0] == '-') {
+
+    string s = string(argv[iarg]);
+
+    if (s == "-region_length") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      region_edge_length = atoi(argv[iarg]);
+      if (region_edge_length < 1) { usage_error(); }
+    }
+    else
+      { usage_error(); }
+
+    iarg++;
+  }
+
+  if (iarg+2 > argc) { usage_error(); }
+
+  scalar_filename = argv[iarg];
+  for (int j = iarg+1; j < argc; j++)
+    { isovalue.push_back(atof(argv[j])); }
+}
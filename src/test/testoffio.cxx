@@ -0,0 +1,253 @@
+// Test and time reading and writing Geomview .off files.
+// Generate a quadrilateral mesh of a height field.
+// Write the mesh with ijkoutOFF and read it with ijkinOFF.
+// Compare with writing/reading one number at a time
+//   through std::ostream/std::istream.
+// Report throughput in MB/s.
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ijkIO.txx"
+#include "ijktime.txx"
+
+using namespace std;
+using namespace IJK;
+
+// global variables
+int num_quads_per_row = 1415;     // Default: about 2 million quads.
+int num_repeat = 1;
+
+// routines
+void generate_mesh
+(const int num_quads_per_row,
+ vector<float> & coord, vector<int> & quad_vert);
+void write_off_stream
+(ostream & out, const vector<float> & coord, const vector<int> & quad_vert);
+void read_off_stream
+(istream & in, vector<float> & coord, vector<int> & quad_vert);
+void report_rate
+(const char * label, const size_t num_bytes, const float seconds);
+void usage_error();
+void parse_command_line(int argc, char **argv);
+
+
+int main(int argc, char ** argv)
+{
+  const int DIM3 = 3;
+  const int NUMV_PER_QUAD = 4;
+  vector<float> coord, coord2, coord3;
+  vector<int> quad_vert, quad_vert2, quad_vert3;
+  string off_text, off_text2;
+  float seconds;
+  clock_t t0, t1;
+
+  try {
+
+    parse_command_line(argc, argv);
+
+    generate_mesh(num_quads_per_row, coord, quad_vert);
+
+    cout << "Mesh vertices: " << coord.size()/DIM3
+         << "  Quadrilaterals: " << quad_vert.size()/NUMV_PER_QUAD << endl;
+
+    // Write.
+    t0 = clock();
+    for (int k = 0; k < num_repeat; k++) {
+      ostringstream out;
+      ijkoutOFF(out, DIM3, NUMV_PER_QUAD, coord, quad_vert);
+      off_text = out.str();
+    }
+    t1 = clock();
+    clock2seconds(t1-t0, seconds);
+    report_rate("Write (ijkoutOFF)", num_repeat*off_text.size(), seconds);
+
+    t0 = clock();
+    for (int k = 0; k < num_repeat; k++) {
+      ostringstream out;
+      write_off_stream(out, coord, quad_vert);
+      off_text2 = out.str();
+    }
+    t1 = clock();
+    clock2seconds(t1-t0, seconds);
+    report_rate("Write (ostream)", num_repeat*off_text2.size(), seconds);
+
+    if (off_text != off_text2) {
+      cerr << "Error.  ijkoutOFF output differs from ostream output."
+           << endl;
+      exit(20);
+    }
+
+    // Read.
+    t0 = clock();
+    for (int k = 0; k < num_repeat; k++) {
+      istringstream in(off_text);
+      int dim, mesh_dim;
+      ijkinOFF(in, dim, mesh_dim, coord2, quad_vert2);
+
+      if (dim != DIM3 || mesh_dim != NUMV_PER_QUAD-1) {
+        cerr << "Error.  ijkinOFF returned dimension " << dim
+             << " and mesh dimension " << mesh_dim << "." << endl;
+        exit(20);
+      }
+    }
+    t1 = clock();
+    clock2seconds(t1-t0, seconds);
+    report_rate("Read (ijkinOFF)", num_repeat*off_text.size(), seconds);
+
+    t0 = clock();
+    for (int k = 0; k < num_repeat; k++) {
+      istringstream in(off_text);
+      read_off_stream(in, coord3, quad_vert3);
+    }
+    t1 = clock();
+    clock2seconds(t1-t0, seconds);
+    report_rate("Read (istream)", num_repeat*off_text.size(), seconds);
+
+    if (coord2 != coord3) {
+      cerr << "Error.  ijkinOFF coordinates differ from istream coordinates."
+           << endl;
+      exit(20);
+    }
+
+    if (quad_vert2 != quad_vert || quad_vert3 != quad_vert) {
+      cerr << "Error.  Quadrilateral vertices read differ from vertices written."
+           << endl;
+      exit(20);
+    }
+
+  }
+  catch (ERROR error) {
+    if (error.NumMessages() == 0) {
+      cerr << "Unknown error." << endl;
+    }
+    else { error.Print(cerr); }
+    cerr << "Exiting." << endl;
+    exit(30);
+  }
+
+  cout << "Passed all tests." << endl;
+
+  return 0;
+}
+
+// Generate quadrilateral mesh of height field over a square grid.
+void generate_mesh
+(const int num_quads_per_row,
+ vector<float> & coord, vector<int> & quad_vert)
+{
+  const int n = num_quads_per_row+1;
+
+  coord.clear();
+  quad_vert.clear();
+  coord.reserve(3*n*n);
+  quad_vert.reserve(4*num_quads_per_row*num_quads_per_row);
+
+  for (int y = 0; y < n; y++) {
+    for (int x = 0; x < n; x++) {
+      coord.push_back(0.37f*x);
+      coord.push_back(0.37f*y);
+      coord.push_back(float(10*sin(0.013*x)*cos(0.017*y)));
+    }
+  }
+
+  for (int y = 0; y+1 < n; y++) {
+    for (int x = 0; x+1 < n; x++) {
+      const int iv = y*n + x;
+      quad_vert.push_back(iv);
+      quad_vert.push_back(iv+1);
+      quad_vert.push_back(iv+n+1);
+      quad_vert.push_back(iv+n);
+    }
+  }
+}
+
+// Write .off file one number at a time through std::ostream.
+void write_off_stream
+(ostream & out, const vector<float> & coord, const vector<int> & quad_vert)
+{
+  const int numv = coord.size()/3;
+  const int numq = quad_vert.size()/4;
+
+  out << "OFF" << endl;
+  out << numv << " " << numq << " " << 0 << endl;
+
+  for (int iv = 0; iv < numv; iv++) {
+    out << coord[3*iv] << " " << coord[3*iv+1] << " "
+        << coord[3*iv+2] << endl;
+  }
+  out << endl;
+
+  for (int iq = 0; iq < numq; iq++) {
+    out << 4 << " ";
+    out << quad_vert[4*iq] << " " << quad_vert[4*iq+1] << " "
+        << quad_vert[4*iq+2] << " " << quad_vert[4*iq+3] << endl;
+  }
+}
+
+// Read .off file one number at a time through std::istream.
+void read_off_stream
+(istream & in, vector<float> & coord, vector<int> & quad_vert)
+{
+  int dim, numv, numq, nume;
+
+  ijkinOFFheader(in, dim, numv, numq, nume);
+  ijkinOFFcoord(in, dim, numv, coord);
+  quad_vert.resize(4*numq);
+  ijkinOFFsimplex(in, 0, numq, 4, quad_vert);
+}
+
+void report_rate
+(const char * label, const size_t num_bytes, const float seconds)
+{
+  const double MB = double(num_bytes)/(1024.0*1024.0);
+
+  cout << "  " << label << ": " << MB << " MB in " << seconds << " sec.";
+  if (seconds > 0) { cout << "  " << MB/seconds << " MB/s."; }
+  cout << endl;
+}
+
+void usage_msg()
+{
+  cerr << "Usage: testoffio [-n {N}] [-repeat {R}]" << endl;
+  cerr << "  -n {N}: Mesh has N x N quadrilaterals." << endl;
+  cerr << "  -repeat {R}: Repeat each read and write R times." << endl;
+}
+
+void usage_error()
+{
+  usage_msg();
+  exit(10);
+}
+
+void parse_command_line(int argc, char **argv)
+{
+  int iarg = 1;
+  while (iarg < argc && argv[iarg][0] == '-') {
+
+    string s = string(argv[iarg]);
+
+    if (s == "-n") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      num_quads_per_row = atoi(argv[iarg]);
+      if (num_quads_per_row < 1) { usage_error(); }
+    }
+    else if (s == "-repeat") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      num_repeat = atoi(argv[iarg]);
+      if (num_repeat < 1) { usage_error(); }
+    }
+    else
+      { usage_error(); }
+
+    iarg++;
+  }
+
+  if (iarg != argc) { usage_error(); }
+}
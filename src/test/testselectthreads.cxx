@@ -0,0 +1,241 @@
+// Test and time parallel selection of sharp isosurface vertices.
+// Compute isosurface vertices from scalar and gradient grids
+//   and run select_sharp_isovert_mod6 using 1 to N threads.
+// Check that each number of threads gives the same result as 1 thread.
+// Report time and speedup over 1 thread.
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ijkgrid_nrrd.txx"
+#include "ijktime.txx"
+
+#include "shrec_isovert.h"
+#include "shrec_select.h"
+
+using namespace std;
+using namespace IJK;
+using namespace SHARPISO;
+using namespace SHREC;
+
+// global variables
+char * scalar_filename = NULL;
+char * gradient_filename = NULL;
+SCALAR_TYPE isovalue = 0;
+int max_num_threads = 0;           // 0: Number of hardware threads.
+int num_repeat = 1;
+
+// routines
+void run_select
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const int num_threads, ISOVERT & isovert, float & seconds);
+void compare_isovert
+(const ISOVERT & isovert0, const ISOVERT & isovert, const int num_threads);
+void report_time
+(const char * label, const float seconds, const float seconds0);
+void usage_error();
+void parse_command_line(int argc, char **argv);
+
+
+int main(int argc, char ** argv)
+{
+  SHARPISO_SCALAR_GRID scalar_grid;
+  GRADIENT_GRID gradient_grid;
+  SHARPISO_MINMAX_PYRAMID minmax_pyramid;
+  GRID_NRRD_IN<int,AXIS_SIZE_TYPE> nrrd_in;
+  NRRD_DATA<int,AXIS_SIZE_TYPE> nrrd_header;
+  PROCEDURE_ERROR error("testselectthreads");
+
+  try {
+
+    parse_command_line(argc, argv);
+
+    nrrd_in.ReadScalarGrid(scalar_filename, scalar_grid, nrrd_header, error);
+    if (nrrd_in.ReadFailed()) { throw error; }
+
+    nrrd_in.ReadVectorGrid(gradient_filename, gradient_grid, error);
+    if (nrrd_in.ReadFailed()) { throw error; }
+
+    if (scalar_grid.Dimension() != DIM3) {
+      error.AddMessage("Scalar grid has dimension ",
+                       scalar_grid.Dimension(), ".");
+      error.AddMessage("  Only 3D grids are supported.");
+      throw error;
+    }
+
+    if (!gradient_grid.Check
+        (scalar_grid, "gradient grid", "scalar grid", error))
+      { throw error; }
+
+    minmax_pyramid.ComputeMinMax(scalar_grid, 4);
+
+    const int num_hardware_threads = 
+      std::max(int(std::thread::hardware_concurrency()), 1);
+    int num_threads = max_num_threads;
+    if (num_threads < 1) { num_threads = num_hardware_threads; }
+
+    ISOVERT isovert1;
+    float seconds1;
+    run_select(scalar_grid, minmax_pyramid, gradient_grid, 1, 
+               isovert1, seconds1);
+
+    cout << "Grid: " << scalar_grid.AxisSize(0) << " x "
+         << scalar_grid.AxisSize(1) << " x " << scalar_grid.AxisSize(2)
+         << "  Isovalue: " << isovalue
+         << "  Active cubes: " << isovert1.gcube_list.size()
+         << "  Hardware threads: " << num_hardware_threads << endl;
+
+    for (int k = 1; k <= num_threads; k++) {
+      ISOVERT isovert;
+      float seconds = seconds1;
+
+      if (k > 1) {
+        run_select(scalar_grid, minmax_pyramid, gradient_grid, k, 
+                   isovert, seconds);
+        compare_isovert(isovert1, isovert, k);
+      }
+
+      cout << "Threads: " << k << endl;
+      report_time("Select mod 6", seconds, seconds1);
+    }
+
+  }
+  catch (ERROR error) {
+    if (error.NumMessages() == 0) {
+      cerr << "Unknown error." << endl;
+    }
+    else { error.Print(cerr); }
+    cerr << "Exiting." << endl;
+    exit(30);
+  }
+
+  cout << "Passed all tests." << endl;
+
+  return 0;
+}
+
+// Compute isovert and run select_sharp_isovert_mod6 using num_threads
+//   threads.  Repeat num_repeat times.
+// Return total time of the selections (not of compute_dual_isovert)
+//   in seconds.
+void run_select
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const SHARPISO_MINMAX_PYRAMID & minmax_pyramid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const int num_threads, ISOVERT & isovert, float & seconds)
+{
+  SHARP_ISOVERT_PARAM isovert_param;
+  WALL_TIME_POINT t0, t1;
+
+  isovert_param.num_threads = num_threads;
+  seconds = 0;
+
+  for (int k = 0; k < num_repeat; k++) {
+    float seconds_k;
+
+    isovert.gcube_list.clear();
+    compute_dual_isovert
+      (scalar_grid, minmax_pyramid, gradient_grid, isovalue, isovert_param,
+       GRADIENT_POSITIONING, isovert);
+
+    t0 = wall_clock();
+    select_sharp_isovert_mod6
+      (scalar_grid, gradient_grid, isovalue, isovert_param, isovert);
+    t1 = wall_clock();
+    clock2seconds(t1-t0, seconds_k);
+    seconds += seconds_k;
+  }
+}
+
+// Exit with an error if isovert differs from isovert0.
+void compare_isovert
+(const ISOVERT & isovert0, const ISOVERT & isovert, const int num_threads)
+{
+  if (isovert.gcube_list.size() != isovert0.gcube_list.size()) {
+    cerr << "Error.  Number of active cubes differs." << endl;
+    exit(20);
+  }
+
+  for (NUM_TYPE i = 0; i < isovert0.gcube_list.size(); i++) {
+    const GRID_CUBE_DATA & gcube0 = isovert0.gcube_list[i];
+    const GRID_CUBE_DATA & gcube = isovert.gcube_list[i];
+    bool flag_equal =
+      (gcube.flag == gcube0.flag && gcube.covered_by == gcube0.covered_by &&
+       gcube.flag_ignore_mismatch == gcube0.flag_ignore_mismatch &&
+       gcube.cube_containing_isovert == gcube0.cube_containing_isovert);
+
+    for (int d = 0; d < DIM3; d++) {
+      if (gcube.isovert_coord[d] != gcube0.isovert_coord[d])
+        { flag_equal = false; }
+    }
+
+    if (!flag_equal) {
+      cerr << "Error.  Cube " << gcube0.cube_index
+           << " selected with " << num_threads
+           << " threads differs from cube selected with 1 thread." << endl;
+      exit(20);
+    }
+  }
+}
+
+void report_time
+(const char * label, const float seconds, const float seconds0)
+{
+  cout << "  " << label << ": " << seconds << " sec.";
+  if (seconds > 0) { cout << "  Speedup: " << seconds0/seconds; }
+  cout << endl;
+}
+
+void usage_msg()
+{
+  cerr << "Usage: testselectthreads [-num_threads {N}] [-repeat {R}] {isovalue} {scalar nrrd file} {gradient nrrd file}"
+       << endl;
+  cerr << "  -num_threads {N}: Run with 1 to N threads." << endl;
+  cerr << "      (Default: Number of hardware threads.)" << endl;
+  cerr << "  -repeat {R}: Repeat each selection R times." << endl;
+  cerr << "  Example: testselectthreads 10.5 data/cube3D.A10x.nrrd data/cube3D.A10x.grad.nrrd" << endl;
+}
+
+void usage_error()
+{
+  usage_msg();
+  exit(10);
+}
+
+void parse_command_line(int argc, char **argv)
+{
+  int iarg = 1;
+  while (iarg < argc && argv[iarg][0] == '-') {
+
+    string s = string(argv[iarg]);
+
+    if (s == "-num_threads") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      max_num_threads = atoi(argv[iarg]);
+      if (max_num_threads < 1) { usage_error(); }
+    }
+    else if (s == "-repeat") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      num_repeat = atoi(argv[iarg]);
+      if (num_repeat < 1) { usage_error(); }
+    }
+    else
+      { usage_error(); }
+
+    iarg++;
+  }
+
+  if (iarg+3 != argc) { usage_error(); }
+
+  isovalue = atof(argv[iarg]);
+  scalar_filename = argv[iarg+1];
+  gradient_filename = argv[iarg+2];
+}
@@ -0,0 +1,448 @@
+// Test construction of isosurface from z-slabs.
+// Construct isosurface from the full grid and from z-slabs of the grid
+//   using SLAB_ISOSURFACE.
+// Check that both constructions give the same isosurface.
+// Isosurface vertices must be in the same order with the same coordinates.
+// Polygons are compared as cyclic lists of vertices.
+// Option -blob constructs a grid of a rotated cube and a sphere
+//   whose sharp edges and corners cross slab boundaries.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ijkgrid_nrrd.txx"
+
+#include "shrec.h"
+#include "shrec_slab.h"
+
+using namespace std;
+using namespace IJK;
+using namespace SHARPISO;
+using namespace SHREC;
+
+typedef vector<VERTEX_INDEX> POLY_VERT;
+
+// global variables
+char * scalar_filename = NULL;
+char * gradient_filename = NULL;
+SCALAR_TYPE isovalue = 0;
+AXIS_SIZE_TYPE blob_size = 0;
+AXIS_SIZE_TYPE slab_thickness = 12;
+AXIS_SIZE_TYPE slab_halo = get_min_slab_halo();
+COORD_TYPE tolerance = 1.0e-5;
+
+// routines
+void set_shrec_param(SHREC_PARAM & shrec_param);
+void set_blob_grid
+(const AXIS_SIZE_TYPE n, SHARPISO_SCALAR_GRID & scalar_grid,
+ GRADIENT_GRID & gradient_grid);
+void construct_by_slabs
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const SHREC_PARAM & shrec_param, DUAL_ISOSURFACE & mesh);
+void copy_slab
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const AXIS_SIZE_TYPE zv0, const AXIS_SIZE_TYPE zv1,
+ SHARPISO_SCALAR_GRID & slab_scalar_grid,
+ GRADIENT_GRID & slab_gradient_grid);
+void compare_vertices
+(const DUAL_ISOSURFACE & mesh0, const DUAL_ISOSURFACE & mesh);
+void get_polygons
+(const VERTEX_INDEX_ARRAY & poly_vert, const NUM_TYPE num_poly_vert,
+ const bool flag_quad, vector<POLY_VERT> & poly_list);
+void compare_polygons
+(const char * poly_type, const vector<POLY_VERT> & poly_list0,
+ const vector<POLY_VERT> & poly_list);
+void usage_error();
+void parse_command_line(int argc, char **argv);
+
+
+int main(int argc, char ** argv)
+{
+  SHARPISO_SCALAR_GRID scalar_grid;
+  GRADIENT_GRID gradient_grid;
+  GRID_NRRD_IN<int,AXIS_SIZE_TYPE> nrrd_in;
+  NRRD_DATA<int,AXIS_SIZE_TYPE> nrrd_header;
+  PROCEDURE_ERROR error("testslab");
+
+  try {
+
+    parse_command_line(argc, argv);
+
+    if (!check_slab_size(slab_thickness, slab_halo, error))
+      { throw error; }
+
+    if (blob_size > 0) {
+      set_blob_grid(blob_size, scalar_grid, gradient_grid);
+    }
+    else {
+      nrrd_in.ReadScalarGrid
+        (scalar_filename, scalar_grid, nrrd_header, error);
+      if (nrrd_in.ReadFailed()) { throw error; }
+
+      nrrd_in.ReadVectorGrid(gradient_filename, gradient_grid, error);
+      if (nrrd_in.ReadFailed()) { throw error; }
+    }
+
+    if (scalar_grid.Dimension() != DIM3) {
+      error.AddMessage("Scalar grid has dimension ",
+                       scalar_grid.Dimension(), ".");
+      error.AddMessage("  Only 3D grids are supported.");
+      throw error;
+    }
+
+    if (!gradient_grid.Check
+        (scalar_grid, "gradient grid", "scalar grid", error))
+      { throw error; }
+
+    SHREC_PARAM shrec_param;
+    set_shrec_param(shrec_param);
+
+    SHREC_DATA shrec_data;
+    SHREC_INFO shrec_info(DIM3);
+    DUAL_ISOSURFACE mesh0, mesh;
+
+    shrec_data.ReferenceGrids(scalar_grid, gradient_grid);
+    shrec_data.Set(shrec_param);
+    dual_contouring(shrec_data, isovalue, mesh0, shrec_info);
+
+    construct_by_slabs(scalar_grid, gradient_grid, shrec_param, mesh);
+
+    cout << "Grid: " << scalar_grid.AxisSize(0) << " x "
+         << scalar_grid.AxisSize(1) << " x " << scalar_grid.AxisSize(2)
+         << "  Isovalue: " << isovalue
+         << "  Slab: " << slab_thickness << "  Halo: " << slab_halo
+         << endl;
+    cout << "  Vertices: " << mesh0.NumVertices()
+         << "  Triangles: " << mesh0.NumTri()
+         << "  Quadrilaterals: " << mesh0.NumQuad() << endl;
+
+    vector<POLY_VERT> poly_list0, poly_list;
+    compare_vertices(mesh0, mesh);
+
+    get_polygons(mesh0.tri_vert, NUM_VERT_PER_TRI, false, poly_list0);
+    get_polygons(mesh.tri_vert, NUM_VERT_PER_TRI, false, poly_list);
+    compare_polygons("triangles", poly_list0, poly_list);
+
+    get_polygons(mesh0.quad_vert, NUM_VERT_PER_QUAD, true, poly_list0);
+    get_polygons(mesh.quad_vert, NUM_VERT_PER_QUAD, true, poly_list);
+    compare_polygons("quadrilaterals", poly_list0, poly_list);
+  }
+  catch (ERROR error) {
+    if (error.NumMessages() == 0) {
+      cerr << "Unknown error." << endl;
+    }
+    else { error.Print(cerr); }
+    cerr << "Exiting." << endl;
+    exit(30);
+  }
+
+  cout << "Passed all tests." << endl;
+
+  return 0;
+}
+
+// Set shrec default parameters.
+void set_shrec_param(SHREC_PARAM & shrec_param)
+{
+  SHREC_DEFAULTS shrec_defaults;
+
+  shrec_param.vertex_position_method = shrec_defaults.vertex_position_method;
+  shrec_param.SetGradSelectionMethod(shrec_defaults.grad_selection_method);
+  shrec_param.flag_select_mod6 = shrec_defaults.flag_select_mod6;
+  shrec_param.flag_map_extended = shrec_defaults.flag_map_extended;
+  shrec_param.max_dist = shrec_defaults.max_dist;
+  shrec_param.max_small_eigenvalue = shrec_defaults.max_small_eigenvalue;
+  shrec_param.grad_selection_cube_offset =
+    shrec_defaults.grad_selection_cube_offset;
+  shrec_param.flag_allow_conflict = true;
+  shrec_param.flag_clamp_conflict = false;
+}
+
+// Set scalar and gradient grids of size n x n x n.
+// Scalar values are the minimum of the L-infinity distance
+//   to the center of a rotated cube and a multiple of the distance
+//   to the center of a sphere.
+void set_blob_grid
+(const AXIS_SIZE_TYPE n, SHARPISO_SCALAR_GRID & scalar_grid,
+ GRADIENT_GRID & gradient_grid)
+{
+  const AXIS_SIZE_TYPE axis_size[DIM3] = { n, n, n };
+  const double a = 0.5;
+  const double b = 0.3;
+  const double sphere_scale = 0.9;
+  const double cube_center = n/2.0 - 0.37;
+  const double sphere_center = n*0.62;
+  // Rotation rz(a)*rx(b).
+  const double rotate[DIM3][DIM3] =
+    { { cos(a), -sin(a)*cos(b), sin(a)*sin(b) },
+      { sin(a), cos(a)*cos(b), -cos(a)*sin(b) },
+      { 0, sin(b), cos(b) } };
+
+  scalar_grid.SetSize(DIM3, axis_size);
+  gradient_grid.SetSize(DIM3, axis_size, DIM3);
+
+  for (VERTEX_INDEX iv = 0; iv < scalar_grid.NumVertices(); iv++) {
+    GRID_COORD_TYPE coord[DIM3];
+    double p[DIM3], q[DIM3], ps[DIM3];
+    GRADIENT_COORD_TYPE * grad = gradient_grid.VectorPtr(iv);
+
+    scalar_grid.ComputeCoord(iv, coord);
+    for (int d = 0; d < DIM3; d++) {
+      p[d] = coord[d] - cube_center;
+      ps[d] = coord[d] - sphere_center;
+    }
+
+    // Coordinates in the rotated cube frame.
+    for (int i = 0; i < DIM3; i++) {
+      q[i] = 0;
+      for (int j = 0; j < DIM3; j++)
+        { q[i] += rotate[j][i]*p[j]; }
+    }
+
+    int axis = 0;
+    for (int d = 1; d < DIM3; d++) {
+      if (fabs(q[d]) > fabs(q[axis])) { axis = d; }
+    }
+
+    const double cube_value = fabs(q[axis]);
+    const double r = sqrt(ps[0]*ps[0] + ps[1]*ps[1] + ps[2]*ps[2]);
+    const double sphere_value = sphere_scale*r;
+
+    if (cube_value < sphere_value) {
+      scalar_grid.Set(iv, cube_value);
+      const double sign = (q[axis] > 0) ? 1 : -1;
+      for (int d = 0; d < DIM3; d++)
+        { grad[d] = sign*rotate[d][axis]; }
+    }
+    else {
+      scalar_grid.Set(iv, sphere_value);
+      for (int d = 0; d < DIM3; d++)
+        { grad[d] = (r > 0) ? sphere_scale*ps[d]/r : 0; }
+    }
+  }
+}
+
+// Construct isosurface from z-slabs of scalar_grid and gradient_grid.
+void construct_by_slabs
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const SHREC_PARAM & shrec_param, DUAL_ISOSURFACE & mesh)
+{
+  const AXIS_SIZE_TYPE num_cube_layers = scalar_grid.AxisSize(DIM3-1)-1;
+  const AXIS_SIZE_TYPE slab_alignment =
+    get_slab_alignment(shrec_param.bin_width);
+  SLAB_ISOSURFACE slab_isosurface(scalar_grid.AxisSize());
+  PROCEDURE_ERROR error("construct_by_slabs");
+
+  if (!can_construct_by_slabs(shrec_param, error)) { throw error; }
+
+  for (AXIS_SIZE_TYPE zc0 = 0; zc0 < num_cube_layers;
+       zc0 += slab_thickness) {
+
+    const AXIS_SIZE_TYPE zc1 =
+      std::min(zc0+slab_thickness, num_cube_layers);
+    AXIS_SIZE_TYPE zv0, zv1;
+    SHARPISO_SCALAR_GRID slab_scalar_grid;
+    GRADIENT_GRID slab_gradient_grid;
+    SHREC_DATA shrec_data;
+    SHREC_INFO shrec_info(DIM3);
+
+    get_slab_vertex_layers
+      (zc0, zc1, slab_halo, slab_alignment, num_cube_layers, zv0, zv1);
+    copy_slab(scalar_grid, gradient_grid, zv0, zv1,
+              slab_scalar_grid, slab_gradient_grid);
+
+    shrec_data.ReferenceGrids(slab_scalar_grid, slab_gradient_grid);
+    shrec_data.Set(shrec_param);
+    slab_isosurface.AddSlab
+      (shrec_data, isovalue, zv0, zc0, zc1, shrec_info);
+  }
+
+  slab_isosurface.GetMesh(mesh);
+}
+
+// Copy grid vertex layers [zv0,zv1] of scalar_grid and gradient_grid.
+void copy_slab
+(const SHARPISO_SCALAR_GRID_BASE & scalar_grid,
+ const GRADIENT_GRID_BASE & gradient_grid,
+ const AXIS_SIZE_TYPE zv0, const AXIS_SIZE_TYPE zv1,
+ SHARPISO_SCALAR_GRID & slab_scalar_grid,
+ GRADIENT_GRID & slab_gradient_grid)
+{
+  const AXIS_SIZE_TYPE slab_axis_size[DIM3] =
+    { scalar_grid.AxisSize(0), scalar_grid.AxisSize(1), zv1-zv0+1 };
+  const VERTEX_INDEX num_vertices_in_layer =
+    scalar_grid.AxisSize(0)*scalar_grid.AxisSize(1);
+  const VERTEX_INDEX iv0 = zv0*num_vertices_in_layer;
+  const GRID_COORD_TYPE coord_offset[DIM3] = { 0, 0, zv0 };
+
+  slab_scalar_grid.SetSize(DIM3, slab_axis_size);
+  std::copy(scalar_grid.ScalarPtrConst()+iv0,
+            scalar_grid.ScalarPtrConst()+iv0+slab_scalar_grid.NumVertices(),
+            slab_scalar_grid.ScalarPtr());
+
+  slab_gradient_grid.SetSize(DIM3, slab_axis_size, DIM3);
+  std::copy(gradient_grid.VectorPtrConst(iv0),
+            gradient_grid.VectorPtrConst(iv0)
+            + DIM3*slab_gradient_grid.NumVertices(),
+            slab_gradient_grid.VectorPtr());
+
+  for (int d = 0; d < DIM3; d++) {
+    slab_scalar_grid.SetSpacing(d, scalar_grid.Spacing(d));
+    slab_gradient_grid.SetSpacing(d, gradient_grid.Spacing(d));
+  }
+  slab_scalar_grid.SetCoordOffset(coord_offset);
+  slab_gradient_grid.SetCoordOffset(coord_offset);
+}
+
+// Exit with an error if mesh and mesh0 have different numbers of vertices
+//   or if the coordinates of some vertex differ by more than tolerance.
+void compare_vertices
+(const DUAL_ISOSURFACE & mesh0, const DUAL_ISOSURFACE & mesh)
+{
+  if (mesh.NumVertices() != mesh0.NumVertices()) {
+    cerr << "Error.  Slab isosurface has " << mesh.NumVertices()
+         << " vertices.  Isosurface has " << mesh0.NumVertices()
+         << " vertices." << endl;
+    exit(20);
+  }
+
+  for (VERTEX_INDEX iv = 0; iv < mesh0.NumVertices(); iv++) {
+    const COORD_TYPE * coord0 = &(mesh0.vertex_coord[iv*DIM3]);
+    const COORD_TYPE * coord = &(mesh.vertex_coord[iv*DIM3]);
+
+    for (int d = 0; d < DIM3; d++) {
+      if (abs(coord[d]-coord0[d]) > tolerance) {
+        cerr << "Error.  Slab isosurface vertex " << iv << " ("
+             << coord[0] << "," << coord[1] << "," << coord[2]
+             << ") differs from isosurface vertex ("
+             << coord0[0] << "," << coord0[1] << "," << coord0[2]
+             << ")." << endl;
+        exit(20);
+      }
+    }
+  }
+}
+
+// Get sorted list of polygons.
+// Rotate vertices of each polygon so that the smallest vertex is first.
+// If flag_quad, quadrilateral vertices are listed in grid order,
+//   i.e., vertices 2 and 3 are swapped from the order around the polygon.
+void get_polygons
+(const VERTEX_INDEX_ARRAY & poly_vert, const NUM_TYPE num_poly_vert,
+ const bool flag_quad, vector<POLY_VERT> & poly_list)
+{
+  const NUM_TYPE num_poly = poly_vert.size()/num_poly_vert;
+
+  poly_list.resize(num_poly);
+  for (NUM_TYPE i = 0; i < num_poly; i++) {
+    POLY_VERT & poly = poly_list[i];
+    poly.assign(poly_vert.begin()+i*num_poly_vert,
+                poly_vert.begin()+(i+1)*num_poly_vert);
+
+    if (flag_quad) { std::swap(poly[2], poly[3]); }
+    std::rotate(poly.begin(), std::min_element(poly.begin(), poly.end()),
+                poly.end());
+  }
+
+  std::sort(poly_list.begin(), poly_list.end());
+}
+
+// Exit with an error if poly_list differs from poly_list0.
+void compare_polygons
+(const char * poly_type, const vector<POLY_VERT> & poly_list0,
+ const vector<POLY_VERT> & poly_list)
+{
+  if (poly_list.size() != poly_list0.size()) {
+    cerr << "Error.  Slab isosurface has " << poly_list.size() << " "
+         << poly_type << ".  Isosurface has " << poly_list0.size()
+         << " " << poly_type << "." << endl;
+    exit(20);
+  }
+
+  for (size_t i = 0; i < poly_list0.size(); i++) {
+    if (poly_list[i] != poly_list0[i]) {
+      cerr << "Error.  Slab isosurface " << poly_type
+           << " differ from isosurface " << poly_type << "." << endl;
+      exit(20);
+    }
+  }
+}
+
+void usage_msg()
+{
+  cerr << "Usage: testslab [-slab {T}] [-slab_halo {H}] [-tol {D}] {isovalue} {scalar nrrd file} {gradient nrrd file}"
+       << endl;
+  cerr << "       testslab [-slab {T}] [-slab_halo {H}] [-tol {D}] -blob {N} {isovalue}"
+       << endl;
+  cerr << "  -slab {T}: Slabs of T cube layers.  T must be a multiple of 6."
+       << "  (Default: 12.)" << endl;
+  cerr << "  -slab_halo {H}: H halo cube layers.  H must be at least "
+       << get_min_slab_halo() << ".  (Default: "
+       << get_min_slab_halo() << ".)" << endl;
+  cerr << "  -tol {D}: Tolerance for comparing vertex coordinates."
+       << "  (Default: 1.0e-5.)" << endl;
+  cerr << "  -blob {N}: Use N x N x N grid of a rotated cube and a sphere."
+       << endl;
+  cerr << "  Example: testslab 10.5 data/cube3D.A10x.nrrd data/cube3D.A10x.grad.nrrd" << endl;
+  cerr << "  Example: testslab -blob 160 20.2" << endl;
+}
+
+void usage_error()
+{
+  usage_msg();
+  exit(10);
+}
+
+void parse_command_line(int argc, char **argv)
+{
+  int iarg = 1;
+  while (iarg < argc && argv[iarg][0] == '-') {
+
+    string s = string(argv[iarg]);
+
+    if (s == "-slab") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      slab_thickness = atoi(argv[iarg]);
+    }
+    else if (s == "-slab_halo") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      slab_halo = atoi(argv[iarg]);
+    }
+    else if (s == "-blob") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      blob_size = atoi(argv[iarg]);
+      if (blob_size < 2) { usage_error(); }
+    }
+    else if (s == "-tol") {
+      iarg++;
+      if (iarg >= argc) { usage_error(); }
+      tolerance = atof(argv[iarg]);
+      if (tolerance <= 0) { usage_error(); }
+    }
+    else
+      { usage_error(); }
+
+    iarg++;
+  }
+
+  if (blob_size > 0) {
+    if (iarg+1 != argc) { usage_error(); }
+    isovalue = atof(argv[iarg]);
+  }
+  else {
+    if (iarg+3 != argc) { usage_error(); }
+    isovalue = atof(argv[iarg]);
+    scalar_filename = argv[iarg+1];
+    gradient_filename = argv[iarg+2];
+  }
+}